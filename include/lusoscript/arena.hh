@@ -20,6 +20,8 @@ struct NoopDeleter {
 
 class Arena {
  public:
+  // `size` is the capacity of the first memory block. When it runs out, the
+  // arena chains further blocks of (at least) the same size.
   explicit Arena(std::size_t size);
 
   ~Arena();
@@ -27,32 +29,26 @@ class Arena {
   template <typename T, typename... Args>
   T *create(Args &&...args) {
     // Allocate space for object.
-    auto [ptr, new_offset] = allocate(offset_, sizeof(T), alignof(T));
+    void *ptr = allocate(sizeof(T), alignof(T));
 
     if constexpr (std::is_trivially_destructible_v<T>) {
       // If T has trivial destructor, construct object as usual.
-      T *obj = new (ptr) T(std::forward<Args>(args)...);
-      offset_ = new_offset;
-      return obj;
+      return new (ptr) T(std::forward<Args>(args)...);
     } else {
       // If not, create a DestructNode to store the destructor that will be
       // called later on.
 
       // Allocate space for DestructNode.
-      auto [dnode_ptr, final_offset] =
-          allocate(new_offset, sizeof(DestructNode), alignof(DestructNode));
+      void *dnode_ptr = allocate(sizeof(DestructNode), alignof(DestructNode));
 
       // Only construct T after successful allocation.
       T *obj = new (ptr) T(std::forward<Args>(args)...);
 
-      auto dtor_call = [](void *p) { static_cast<T *>(p)->~T(); };
-      DestructNode *new_node =
-          new (dtor_call) DestructNode{dtor_call, tail_, obj};
-
-      tail_ = new_node;
+      // Store the destructor function pointer.
+      void (*dtor)(void *) = [](void *p) { static_cast<T *>(p)->~T(); };
 
-      // Commit offset after successful allocation and construction.
-      offset_ = final_offset;
+      // Create new destruction node.
+      tail_ = new (dnode_ptr) DestructNode{dtor, tail_, obj};
 
       return obj;
     }
@@ -62,50 +58,34 @@ class Arena {
   // `unique_ptr`.
   template <typename T, typename... Args>
   std::unique_ptr<T, NoopDeleter<T>> make_unique(Args &&...args) {
-    auto [ptr, new_offset] = allocate(offset_, sizeof(T), alignof(T));
-
-    if constexpr (std::is_trivially_destructible_v<T>) {
-      T *obj = new (ptr) T(std::forward<Args>(args)...);
-      offset_ = new_offset;
-      return std::unique_ptr<T, NoopDeleter<T>>(ptr);
-    } else {
-      auto [dnode_ptr, final_offset] =
-          allocate(new_offset, sizeof(DestructNode), alignof(DestructNode));
-
-      T *obj = new (ptr) T(std::forward<Args>(args)...);
-
-      // Store the destructor function pointer.
-      void (*dtor)(void *) = [](void *p) { static_cast<T *>(p)->~T(); };
-
-      // Create new destruction node.
-      DestructNode *new_node = new (dnode_ptr) DestructNode{dtor, tail_, obj};
-
-      tail_ = new_node;
-      offset_ = final_offset;
-
-      return std::unique_ptr<T, NoopDeleter<T>>(obj);
-    }
+    return std::unique_ptr<T, NoopDeleter<T>>(
+        create<T>(std::forward<Args>(args)...));
   }
 
-  void reset() {
-    callDestructors();
-    offset_ = 0;
-  }
+  // Destroys every object and releases all blocks but the first one, which is
+  // kept for reuse.
+  void reset();
 
   // Non-copyable, non-moveable type
   Arena(const Arena &) = delete;
   Arena(Arena &&) = delete;
 
  private:
-  char *buffer_;
-  std::size_t capacity_;
+  // Header at the start of every memory block, linking it to the previous one.
+  struct BlockHeader {
+    BlockHeader *prev;
+    std::size_t capacity;
+  };
+
+  BlockHeader *first_;
+  BlockHeader *current_;
   std::size_t offset_;
   DestructNode *tail_ = nullptr;
 
   void callDestructors();
-  std::pair<void *, std::size_t> allocate(std::size_t curr_offset,
-                                          std::size_t size,
-                                          std::size_t alignment);
+  void *allocate(std::size_t size, std::size_t alignment);
+  void *allocateInBlock(std::size_t size, std::size_t alignment);
+  static BlockHeader *newBlock(BlockHeader *prev, std::size_t capacity);
 };
 };  // namespace arena
 
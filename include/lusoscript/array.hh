@@ -0,0 +1,51 @@
+#ifndef LUSOSCRIPT_ARRAY_H
+#define LUSOSCRIPT_ARRAY_H
+
+#include <any>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "container.hh"
+#include "counted.hh"
+
+// An array value, written `[1, 2, 3]` in scripts. While all of its elements
+// are numbers, it packs them in a buffer of `float`, which the built-in
+// functions on arrays run SIMD kernels over; storing anything else moves the
+// elements to a buffer of values for good. Arrays are shared, not copied, by
+// the variables holding them.
+class Array : public Container {
+ public:
+  using Ref = CountedRef<Array>;
+
+  // An array of `values`, packed if they are all numbers.
+  static Ref create(std::vector<std::any> values);
+  static Ref create(std::vector<float> numbers);
+
+  [[nodiscard]] std::size_t size() const;
+  [[nodiscard]] bool isPacked() const { return packed_; }
+  // The elements of a packed array.
+  [[nodiscard]] std::span<float> getNumbers() { return numbers_; }
+  [[nodiscard]] std::span<const float> getNumbers() const { return numbers_; }
+
+  // The element at `index`, which must be less than `size()`.
+  [[nodiscard]] std::any get(std::size_t index) const;
+  void set(std::size_t index, std::any value);
+  void append(std::any value);
+
+ private:
+  explicit Array(std::vector<float> numbers);
+  explicit Array(std::vector<std::any> values);
+
+  bool packed_;
+  std::vector<float> numbers_;
+  std::vector<std::any> values_;
+
+  void unpack();
+};
+
+static_assert(sizeof(Array::Ref) == sizeof(void *) &&
+              std::is_nothrow_move_constructible_v<Array::Ref>);
+
+#endif
@@ -1,13 +1,21 @@
 #ifndef LUSOSCRIPT_AST_H
 #define LUSOSCRIPT_AST_H
 
+#include <any>
+#include <cstddef>
 #include <memory>
+#include <optional>
+#include <string>
 #include <variant>
 #include <vector>
 
 #include "arena.hh"
 #include "token.hh"
 
+class Parser;
+class CaseTable;
+class PropertyCache;
+
 namespace ast {
 struct Expr;
 struct Stmt;
@@ -15,9 +23,36 @@ struct Stmt;
 using ExprPtr = std::unique_ptr<Expr, arena::NoopDeleter<Expr>>;
 using StmtPtr = std::unique_ptr<Stmt, arena::NoopDeleter<Stmt>>;
 
+// Where a variable that is read or assigned lives, as found by the resolver
+// (see resolver.hh): a global, looked up by name, a slot of the frame of the
+// running function, or one of the variables the function captured.
+struct Binding {
+  enum class Kind { GLOBAL, LOCAL, CAPTURED };
+
+  Kind kind = Kind::GLOBAL;
+  int index = 0;
+};
+
 struct Assign {
   token::Token name;
   ExprPtr value;
+  Binding binding;
+};
+
+// `nome += valor`, `-=`, `*=` or `/=`, or `nome++`, `++nome`, `nome--` or
+// `--nome`, which add or subtract 1. The variable is found once and updated
+// where it lives.
+struct Update {
+  token::Token name;
+  // The operator as written, where errors are reported.
+  token::Token opr;
+  // The binary operator applied: `+`, `-`, `*` or `/`.
+  token::TokenType operation;
+  // Null when the operator adds or subtracts 1.
+  ExprPtr value;
+  // Whether the expression is worth the value before the update.
+  bool postfix = false;
+  Binding binding;
 };
 
 struct Ternary {
@@ -56,6 +91,91 @@ struct Unary {
 
 struct Variable {
   token::Token name;
+  Binding binding;
+};
+
+// `funcao(argumentos)`.
+struct Call {
+  ExprPtr callee;
+  // The closing parenthesis, where the errors of the call are reported.
+  token::Token paren;
+  std::vector<ExprPtr> arguments;
+};
+
+// `canal(tipo)` or `canal(tipo, capacidade)`, where the type is `numero`,
+// `texto` or `logico`.
+struct Canal {
+  token::Token keyword;
+  token::Token type;
+  std::optional<ExprPtr> capacity;
+};
+
+// `receba(canal)`: the next value of the channel, or `nulo` once it is closed
+// and empty.
+struct Receba {
+  token::Token keyword;
+  ExprPtr channel;
+};
+
+// `objeto.nome`: a field of an instance, or one of its methods. The cache is
+// shared by the interpreters running the node (see object.hh).
+struct Get {
+  ExprPtr object;
+  token::Token name;
+  std::shared_ptr<PropertyCache> cache;
+};
+
+// `objeto.nome = valor`.
+struct Set {
+  ExprPtr object;
+  token::Token name;
+  ExprPtr value;
+  std::shared_ptr<PropertyCache> cache;
+};
+
+// `esse`: the instance the running method was called on.
+struct Esse {
+  token::Token keyword;
+  Binding binding;
+};
+
+// `super.metodo`: the method of the superclass, bound to `esse`.
+struct Super {
+  token::Token keyword;
+  token::Token method;
+  // Where the superclass and `esse` live.
+  Binding binding;
+  Binding receiver;
+  std::shared_ptr<PropertyCache> cache;
+};
+
+// `[elemento, ...]`.
+struct ArrayLiteral {
+  token::Token bracket;
+  std::vector<ExprPtr> elements;
+};
+
+// `{chave: valor, ...}`.
+struct DictionaryLiteral {
+  token::Token curly;
+  std::vector<ExprPtr> keys;
+  std::vector<ExprPtr> values;
+};
+
+// `lista[indice]` or `dicionario[chave]`.
+struct Index {
+  ExprPtr object;
+  // The opening bracket, where the errors of the access are reported.
+  token::Token bracket;
+  ExprPtr index;
+};
+
+// `lista[indice] = valor` or `dicionario[chave] = valor`.
+struct SetIndex {
+  ExprPtr object;
+  token::Token bracket;
+  ExprPtr index;
+  ExprPtr value;
 };
 
 struct ErrorExpr {
@@ -63,8 +183,9 @@ struct ErrorExpr {
 };
 
 struct Expr {
-  std::variant<Assign, Ternary, Binary, Grouping, Literal, Logical, Unary,
-               Variable, ErrorExpr>
+  std::variant<Assign, Update, Ternary, Binary, Grouping, Literal, Logical,
+               Unary, Variable, Call, Canal, Receba, Get, Set, Esse, Super,
+               ArrayLiteral, DictionaryLiteral, Index, SetIndex, ErrorExpr>
       var;
 };
 
@@ -86,9 +207,14 @@ struct Imprima {
   ExprPtr expression;
 };
 
+// Declarations hold the slot of the variable they declare, or -1 for a
+// global.
 struct Var {
   token::Token name;
   std::optional<ExprPtr> initializer;
+  // Declared with `constante`: the variable is never assigned.
+  bool constant = false;
+  int slot = -1;
 };
 
 struct While {
@@ -96,12 +222,169 @@ struct While {
   StmtPtr body;
 };
 
+// How the private copies of a reduction variable are combined.
+enum class ReductionKind { SOMA, MINIMO, MAXIMO };
+
+struct Reduction {
+  ReductionKind kind;
+  token::Token target;
+  Binding binding;
+};
+
+// `para paralelo (var i = start; i < end; i = i + step) reduza(...) body`.
+// Iterations may run concurrently; the parser checks that they only assign
+// their own variables and the reduction targets.
+struct ParallelFor {
+  token::Token keyword;
+  token::Token variable;
+  ExprPtr start;
+  ExprPtr end;
+  // Whether the condition is `<=` rather than `<`.
+  bool inclusive;
+  ExprPtr step;
+  std::vector<Reduction> reductions;
+  StmtPtr body;
+  int slot = -1;
+};
+
+// `para cada (var x em fonte) body`, where the source is a range, an array or
+// a dictionary. The variable is rebound in its slot for each iteration.
+struct ForEach {
+  token::Token keyword;
+  token::Token variable;
+  ExprPtr source;
+  StmtPtr body;
+  int slot = -1;
+};
+
+// `escolha (valor) { caso 1, 2: ... caso "a": ... padrao: ... }`: runs the
+// statements of the case labeled with the value, or of `padrao`, if any. Only
+// one case runs; there is no falling through to the next.
+struct Escolha {
+  token::Token keyword;
+  ExprPtr value;
+  // The labels of each case, numbers and strings, and its body, a `Block`.
+  // `padrao` is the case with no labels.
+  std::vector<std::vector<std::any>> labels;
+  std::vector<StmtPtr> bodies;
+  // The index of `padrao`, or -1.
+  int fallback = -1;
+  // Built from the labels by the parser.
+  std::shared_ptr<const CaseTable> table;
+};
+
+// `tarefa { ... }`: runs the block as a task, concurrently with the rest of
+// the program, on a copy of the variables visible where it starts.
+struct Tarefa {
+  token::Token keyword;
+  StmtPtr body;
+};
+
+// `envie(canal, valor);`
+struct Envie {
+  token::Token keyword;
+  ExprPtr channel;
+  ExprPtr value;
+};
+
+// `feche(canal);`
+struct Feche {
+  token::Token keyword;
+  ExprPtr channel;
+};
+
+// `instantaneo;`: where a snapshot of the global variables is taken, so that
+// later runs can start from it. Only allowed at the top level.
+struct Instantaneo {
+  token::Token keyword;
+};
+
+// `importe "caminho.luso";`: runs the module at the path, relative to the
+// importing file, unless it already ran. Only allowed at the top level.
+struct Importe {
+  token::Token keyword;
+  // The string literal of the path.
+  token::Token path;
+};
+
+// Where a function finds a variable it captures when it is declared: in a
+// slot of the frame it is declared in, or among the variables captured by the
+// function it is declared in.
+struct Capture {
+  bool local;
+  int index;
+};
+
+// `funcao nome(parametros) { ... }`, or a method of a class. Methods take the
+// instance they are called on, `esse`, in slot 0, before their parameters;
+// the initializer, `inicie`, is the method that classes call on the instances
+// they create.
+struct Function {
+  enum class Kind { FUNCTION, METHOD, INITIALIZER };
+
+  token::Token name;
+  std::vector<token::Token> params;
+  std::vector<StmtPtr> body;
+  int slot = -1;
+  // Slots taken by the parameters and the locals of the body at most.
+  int frame_size = 0;
+  std::vector<Capture> captures;
+  Kind kind = Kind::FUNCTION;
+};
+
+// `retorne;` or `retorne valor;`. Only allowed in the body of a function.
+struct Retorne {
+  token::Token keyword;
+  std::optional<ExprPtr> value;
+};
+
+// `classe Nome < Superclasse { metodo(parametros) { ... } ... }`, where the
+// superclass is optional.
+struct Classe {
+  token::Token name;
+  // A `Variable`.
+  std::optional<ExprPtr> superclass;
+  std::vector<Function> methods;
+  int slot = -1;
+  // The slot of `super`, which the methods capture, when there is a
+  // superclass.
+  int super_slot = -1;
+};
+
 struct ErrorStmt {
   token::Token token;
 };
 
+// A local of the scopes enclosing a lazy block. A constant has the literal its
+// value folded to, if any.
+struct ScopeLocal {
+  std::string name;
+  bool constant = false;
+  std::optional<Literal> value;
+};
+
+// A braced body whose tokens, [begin, end), were validated but not parsed yet.
+// `Parser::parseLazyBlock()` parses it on first use and caches the result.
+struct LazyBlock {
+  Parser *parser;
+  int begin;
+  int end;
+  mutable Stmt *parsed = nullptr;
+  // The body as parsed to validate it, which the resolver checks in the scope
+  // of the block and drops.
+  StmtPtr validated;
+  // The locals of the enclosing scopes, by slot, and the number of constants
+  // the script had declared, which the resolver records to resolve the body
+  // once parsed.
+  std::vector<ScopeLocal> scope;
+  std::size_t constants = 0;
+};
+
 struct Stmt {
-  std::variant<Block, Expression, Imprima, Var, If, While, ErrorStmt> var;
+  std::variant<Block, Expression, Imprima, Var, If, While, LazyBlock,
+               ParallelFor, ForEach, Escolha, Tarefa, Envie, Feche,
+               Instantaneo, Importe, Function, Retorne, Classe, ErrorStmt>
+      var;
 };
 
 class AstPrinter {
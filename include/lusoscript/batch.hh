@@ -0,0 +1,22 @@
+#ifndef LUSOSCRIPT_BATCH_H
+#define LUSOSCRIPT_BATCH_H
+
+#include <string>
+#include <vector>
+
+// Runs many source files concurrently in one process. Every script writes to
+// its own buffers, which are flushed in the order the files were given, so
+// the output does not depend on scheduling.
+class Batch {
+ public:
+  explicit Batch(int jobs);
+
+  // Runs every file and reports the exit code of each one on the standard
+  // error. Returns the first non-zero exit code, or zero if all succeeded.
+  int run(const std::vector<std::string> &file_paths);
+
+ private:
+  int jobs_;
+};
+
+#endif
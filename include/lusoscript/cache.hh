@@ -0,0 +1,62 @@
+#ifndef LUSOSCRIPT_CACHE_H
+#define LUSOSCRIPT_CACHE_H
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "arena.hh"
+#include "ast.hh"
+#include "environment.hh"
+
+// Cache of compiled programs in `.lusoc` files, so that running a script
+// again skips lexing and parsing it, and of snapshots in `.lusnap` files, so
+// that it also skips the statements before its `instantaneo;` marker. Files
+// hold the key of the source they were made from, a fingerprint of the AST
+// and a checksum, so that stale or damaged files are ignored.
+namespace cache {
+// Key of `source`: a hash of its contents.
+std::uint64_t key(std::string_view source);
+
+// Where the file with `extension` of the script at `script_path` is cached:
+// next to the script, or in the directory named by the LUSOSCRIPT_CACHE_DIR
+// environment variable, named after `key`.
+std::string path(const std::string &script_path, std::uint64_t key,
+                 std::string_view extension);
+
+// Loads the program cached at `path` into `allocator`. Returns nothing if
+// there is no such file, or if it holds another source or is invalid.
+std::optional<std::vector<ast::Stmt>> load(const std::string &path,
+                                           std::uint64_t key,
+                                           arena::Arena &allocator);
+
+// Caches `statements`, the program of the source of `key`, at `path`.
+// Returns whether the file could be written.
+bool store(const std::string &path, std::uint64_t key,
+           const std::vector<ast::Stmt> &statements);
+
+// The state of a script at its `instantaneo;` marker.
+struct Snapshot {
+  env::Environment globals;
+  // What the script printed before the marker.
+  std::string output;
+};
+
+// Loads the snapshot at `path`, like `load()`.
+std::optional<Snapshot> loadSnapshot(const std::string &path,
+                                     std::uint64_t key);
+
+// Stores a snapshot of `globals` and `output` for the source of `key` at
+// `path`. The functions and classes declared by `prelude`, the statements
+// before the marker, are left out, for the run restoring the snapshot to
+// declare again. Returns false, writing nothing, if a variable holds a value
+// that cannot be stored, such as a channel, which `problem` then describes.
+bool storeSnapshot(const std::string &path, std::uint64_t key,
+                   const env::Environment &globals, std::string_view output,
+                   std::span<const ast::Stmt> prelude, std::string &problem);
+}  // namespace cache
+
+#endif
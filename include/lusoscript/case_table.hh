@@ -0,0 +1,52 @@
+#ifndef LUSOSCRIPT_CASE_TABLE_H
+#define LUSOSCRIPT_CASE_TABLE_H
+
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "dictionary.hh"
+
+// How an `escolha` statement finds the case of a value, which the parser
+// builds from the labels of the cases. Whole numbers spanning a small range
+// become a jump table, indexed by the value. Other labels go in a perfect
+// hash table: the labels are split in buckets by their hash, and the parser
+// searches a seed for each bucket that sends its labels to slots no other
+// label took, so that finding a case hashes the value, reads the seed of its
+// bucket and compares the value to the one label of its slot. A handful of
+// labels, or labels no seeds are found for, are compared in turn.
+class CaseTable {
+ public:
+  enum class Kind { JUMP, HASH, LINEAR };
+
+  // A table for the cases labeled `labels[case]`, which must be numbers and
+  // strings that are distinct as keys of dictionaries.
+  static std::shared_ptr<const CaseTable> create(
+      const std::vector<std::vector<std::any>> &labels);
+
+  [[nodiscard]] Kind getKind() const { return kind_; }
+  // The case labeled `value`, or -1.
+  [[nodiscard]] int find(const std::any &value) const;
+
+ private:
+  Kind kind_ = Kind::LINEAR;
+  // The case of each whole number from `base_` on, or -1.
+  double base_ = 0;
+  std::vector<int> jumps_;
+  // The seed of each bucket.
+  std::vector<std::uint32_t> seeds_;
+  // The label in each slot, with its case, or -1 for an empty slot. Compared
+  // in turn when linear.
+  std::vector<std::pair<Dictionary::Key, int>> slots_;
+
+  bool buildJumps(const std::vector<std::pair<Dictionary::Key, int>> &labels);
+  bool buildHash(const std::vector<std::pair<Dictionary::Key, int>> &labels);
+  [[nodiscard]] std::size_t slotOf(std::uint64_t hash) const;
+  template <typename Value>
+  [[nodiscard]] int findLabel(const Value &value) const;
+};
+
+#endif
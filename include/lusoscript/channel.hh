@@ -0,0 +1,39 @@
+#ifndef LUSOSCRIPT_CHANNEL_H
+#define LUSOSCRIPT_CHANNEL_H
+
+#include <any>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+#include "mpmc_queue.hh"
+
+// A bounded channel of values of one type, for tasks to talk to each other.
+// Values are moved through a lock-free queue; a full or empty channel blocks
+// the sender or receiver until the other side makes progress.
+class Channel {
+ public:
+  enum class Type { NUMERO, TEXTO, LOGICO };
+
+  explicit Channel(Type type, std::size_t capacity);
+
+  [[nodiscard]] Type getType() const;
+
+  // Blocks while the channel is full. Returns false if it is closed.
+  bool send(std::any value);
+  // Blocks while the channel is empty and open. Returns nothing once it is
+  // closed and drained.
+  std::optional<std::any> receive();
+  void close();
+
+ private:
+  Type type_;
+  MpmcQueue<std::any> queue_;
+  std::atomic<bool> closed_;
+  // Bumped after every push (and on close) and after every pop, for blocked
+  // receivers and senders to wait on.
+  std::atomic<std::uint32_t> pushes_;
+  std::atomic<std::uint32_t> pops_;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef LUSOSCRIPT_CLOSURE_H
+#define LUSOSCRIPT_CLOSURE_H
+
+#include <any>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ast.hh"
+#include "container.hh"
+#include "counted.hh"
+
+// A local captured by a function. Locals live in the slots of the call stack
+// until a function declared in their scope captures them, which moves them
+// into a cell that the slot and the function then share.
+struct Cell : Owned {
+  explicit Cell(std::any value) : value(std::move(value)) {}
+
+  std::any value;
+};
+
+// A function value: a function declaration along with the cells of the
+// variables it captured.
+class Closure : public Counted {
+ public:
+  using Ref = CountedRef<const Closure>;
+
+  static Ref create(const ast::Function &declaration,
+                    std::vector<std::shared_ptr<Cell>> cells);
+
+  // Another reference to this closure.
+  [[nodiscard]] Ref share() const;
+  [[nodiscard]] const ast::Function &getDeclaration() const;
+  [[nodiscard]] const std::shared_ptr<Cell> &getCell(int index) const;
+
+ private:
+  explicit Closure(const ast::Function &declaration,
+                   std::vector<std::shared_ptr<Cell>> cells);
+
+  const ast::Function &declaration_;
+  // In the order of the captures of the declaration.
+  std::vector<std::shared_ptr<Cell>> cells_;
+};
+
+static_assert(sizeof(Closure::Ref) == sizeof(void *) &&
+              std::is_nothrow_move_constructible_v<Closure::Ref>);
+
+#endif
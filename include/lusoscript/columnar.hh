@@ -0,0 +1,127 @@
+#ifndef LUSOSCRIPT_COLUMNAR_H
+#define LUSOSCRIPT_COLUMNAR_H
+
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "error.hh"
+#include "token.hh"
+
+// Batch evaluation of rules over columns. A rule is a LusoScript expression
+// whose variables are the columns of a table; it is compiled once into a
+// program of column operations, which then runs over the whole table a chunk
+// of rows at a time, using the SIMD kernels of simd.hh for numbers and
+// booleans. See docs/columnar.md.
+namespace columnar {
+enum class Type : char { NUMERO = 'n', TEXTO = 't', LOGICO = 'l' };
+
+// A column of values of one type. Only the vector of its type is used.
+struct Column {
+  Type type;
+  std::vector<float> numbers;
+  std::vector<std::string> texts;
+  // One byte per value, 0 or 1.
+  std::vector<std::uint8_t> booleans;
+
+  [[nodiscard]] std::size_t size() const;
+};
+
+struct Table {
+  std::vector<std::string> names;
+  std::vector<Column> columns;
+
+  [[nodiscard]] const Column *find(std::string_view name) const;
+  [[nodiscard]] std::size_t rows() const;
+};
+
+// Reads or writes a table in the binary columnar file format.
+error::Result<Table, std::string> read(const std::string &path);
+error::Result<void, std::string> write(const Table &table,
+                                       const std::string &path);
+
+class RuleCompiler;
+
+class Rule {
+ public:
+  // Compiles `source`, a single expression statement (the `;` is optional),
+  // for tables with the columns of `schema`. Errors are reported to
+  // `error_state`.
+  static std::optional<Rule> compile(const std::string &source,
+                                     const Table &schema,
+                                     error::ErrorState &error_state);
+
+  // Type of the column the rule produces.
+  [[nodiscard]] Type type() const;
+  // Evaluates the rule for every row of `table`, which needs the columns the
+  // rule was compiled for. It only reads the rule, so a rule can be evaluated
+  // by many threads at once.
+  error::RuntimeResult<Column> evaluate(const Table &table) const;
+
+ private:
+  enum class Op {
+    COLUMN,
+    CONSTANT,
+    NEGATE,
+    NOT,
+    ADD,
+    SUBTRACT,
+    MULTIPLY,
+    DIVIDE,
+    CONCAT,
+    GREATER,
+    GREATER_EQUAL,
+    LESS,
+    LESS_EQUAL,
+    EQUAL,
+    NOT_EQUAL,
+    AND,
+    OR,
+    SELECT,
+    // The value of the second operand, after the first one (comma operator).
+    SEQUENCE,
+  };
+
+  // Computes one column from the columns of earlier instructions.
+  struct Instruction {
+    Op op;
+    Type type;
+    // Instructions whose results are the operands, or -1.
+    int a = -1;
+    int b = -1;
+    int c = -1;
+    // For COLUMN.
+    std::string column{};
+    // For CONSTANT: a float, std::string or bool.
+    std::any constant{};
+    // For the error messages.
+    token::Token token{};
+    // Whether a division by zero can happen in this instruction or in the
+    // ones it depends on.
+    bool can_fail = false;
+  };
+
+  // In dependency order: the last instruction computes the result.
+  std::vector<Instruction> program_;
+
+  struct Registers;
+  friend class RuleCompiler;
+
+  void run(Registers &registers, std::size_t begin, std::size_t count) const;
+};
+
+// Evaluates the rule in the script at `rule_path` over the table at
+// `table_path`. The result is written as a table with a single `resultado`
+// column to `output_path` if given, or else printed one row per line to
+// `output`. Returns the exit code, like `SourceFile::run()`.
+int run(const std::string &rule_path, const std::string &table_path,
+        const std::optional<std::string> &output_path, std::ostream &output,
+        std::ostream &error_output);
+}  // namespace columnar
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef LUSOSCRIPT_CONTAINER_H
+#define LUSOSCRIPT_CONTAINER_H
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#include "counted.hh"
+
+// Base of what the chunks of iterations of a parallel loop may share: the
+// values holding other values, and the cells of captured variables. The chunks
+// read those of the program at the same time, so a chunk may only change the
+// ones it created itself. Each remembers the chunk running on its thread when
+// it was created, its owner; outside of parallel loops there is no chunk, and
+// everything can be changed.
+class Owned {
+ public:
+  // Makes the chunk running on this thread, for as long as it lives, a new
+  // owner, which nothing has yet.
+  class Ownership {
+   public:
+    Ownership()
+        : previous_(std::exchange(
+              current_owner_,
+              next_owner_.fetch_add(1, std::memory_order_relaxed))) {}
+    ~Ownership() { current_owner_ = previous_; }
+
+    Ownership(const Ownership &) = delete;
+    Ownership &operator=(const Ownership &) = delete;
+
+   private:
+    std::uint64_t previous_;
+  };
+
+  // Whether a chunk other than the one that created this runs on this thread,
+  // which must then leave it as it is.
+  [[nodiscard]] bool isShared() const {
+    return current_owner_ != 0 && owner_ != current_owner_;
+  }
+
+ protected:
+  Owned() : owner_(current_owner_) {}
+
+ private:
+  inline static thread_local std::uint64_t current_owner_ = 0;
+  inline static std::atomic<std::uint64_t> next_owner_ = 1;
+
+  std::uint64_t owner_;
+};
+
+// Base of the values that hold other values: arrays, dictionaries and
+// instances.
+class Container : public Counted, public Owned {
+ protected:
+  Container() = default;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef LUSOSCRIPT_COROUTINE_H
+#define LUSOSCRIPT_COROUTINE_H
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace coro {
+// Lazily started coroutine producing a `T`. Awaiting a task starts it and
+// resumes the awaiting coroutine once it finishes; control moves between
+// them by symmetric transfer, so deep or long chains do not grow the stack.
+template <typename T>
+class [[nodiscard]] Task {
+ public:
+  struct promise_type {
+    std::optional<T> value;
+    std::coroutine_handle<> continuation;
+
+    // Not an aggregate, so that the promise is never initialized with the
+    // arguments of the coroutine, which could convert to a `T`.
+    promise_type() = default;
+
+    Task get_return_object() {
+      return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    auto final_suspend() noexcept {
+      struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+
+        std::coroutine_handle<> await_suspend(
+            std::coroutine_handle<promise_type> handle) noexcept {
+          const auto continuation = handle.promise().continuation;
+          return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+      };
+      return FinalAwaiter{};
+    }
+
+    template <typename U>
+    void return_value(U &&result) {
+      value.emplace(std::forward<U>(result));
+    }
+
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  explicit Task(std::coroutine_handle<promise_type> handle)
+      : handle_(handle) {}
+
+  Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+
+  Task &operator=(Task &&other) noexcept {
+    if (this != &other) {
+      if (handle_) handle_.destroy();
+      handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+  }
+
+  ~Task() {
+    if (handle_) handle_.destroy();
+  }
+
+  bool await_ready() const noexcept { return false; }
+
+  std::coroutine_handle<> await_suspend(
+      std::coroutine_handle<> awaiting) noexcept {
+    handle_.promise().continuation = awaiting;
+    return handle_;
+  }
+
+  T await_resume() { return std::move(handle_.promise().value.value()); }
+
+  // Used to drive a task from outside any coroutine.
+  [[nodiscard]] std::coroutine_handle<> handle() const { return handle_; }
+  [[nodiscard]] bool done() const { return handle_.done(); }
+  [[nodiscard]] T &result() { return handle_.promise().value.value(); }
+
+ private:
+  std::coroutine_handle<promise_type> handle_;
+};
+
+// Execution budget of a resumable computation, counted in steps. Awaiting
+// `checkpoint()` spends one step, or suspends the running coroutine once the
+// budget is exhausted and remembers it as the point to resume from.
+class Slice {
+ public:
+  void refill(int steps) { remaining_ = steps; }
+
+  // The coroutine suspended by the last exhausted checkpoint, if any. Taking
+  // it clears it.
+  [[nodiscard]] std::coroutine_handle<> takeResumePoint() {
+    return std::exchange(resume_point_, {});
+  }
+
+  auto checkpoint() {
+    struct Checkpoint {
+      Slice &slice;
+      bool suspended = false;
+
+      bool await_ready() noexcept {
+        if (slice.remaining_ == 0) return false;
+
+        slice.remaining_--;
+        return true;
+      }
+
+      void await_suspend(std::coroutine_handle<> handle) noexcept {
+        suspended = true;
+        slice.resume_point_ = handle;
+      }
+
+      // Resumed with a fresh budget: spend the step that was postponed.
+      void await_resume() noexcept {
+        if (suspended && slice.remaining_ > 0) slice.remaining_--;
+      }
+    };
+    return Checkpoint{*this};
+  }
+
+ private:
+  int remaining_ = 0;
+  std::coroutine_handle<> resume_point_;
+};
+}  // namespace coro
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef LUSOSCRIPT_COUNTED_H
+#define LUSOSCRIPT_COUNTED_H
+
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+// Base of the objects that values share, such as functions and instances,
+// which count the references to them rather than being held by
+// `std::shared_ptr`.
+class Counted {
+ protected:
+  Counted() = default;
+
+ private:
+  template <typename T>
+  friend class CountedRef;
+
+  // A new object has the reference its creator adopts.
+  mutable std::atomic<int> references_ = 1;
+};
+
+// Counted reference to a `T`, derived from `Counted`, which is const for the
+// objects that never change once created. It is the size of a pointer, so
+// that a `std::any` holds it without allocating, and reading a value holding
+// it from a variable costs no more than reading a number.
+template <typename T>
+class CountedRef {
+ public:
+  CountedRef() = default;
+
+  CountedRef(const CountedRef &other) : object_(other.object_) {
+    if (object_ != nullptr) {
+      object_->references_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  CountedRef(CountedRef &&other) noexcept
+      : object_(std::exchange(other.object_, nullptr)) {}
+
+  CountedRef &operator=(CountedRef other) noexcept {
+    std::swap(object_, other.object_);
+    return *this;
+  }
+
+  ~CountedRef() {
+    if (object_ != nullptr &&
+        object_->references_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete object_;
+    }
+  }
+
+  // Takes over the reference a new `object` starts with.
+  static CountedRef adopt(T *object) {
+    CountedRef ref;
+    ref.object_ = object;
+
+    return ref;
+  }
+
+  // Another reference to `object`, which is already referred to.
+  static CountedRef share(T *object) {
+    object->references_.fetch_add(1, std::memory_order_relaxed);
+    return adopt(object);
+  }
+
+  T *get() const { return object_; }
+  T *operator->() const { return object_; }
+  T &operator*() const { return *object_; }
+  bool operator==(const CountedRef &other) const = default;
+
+ private:
+  T *object_ = nullptr;
+};
+
+#endif
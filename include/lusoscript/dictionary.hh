@@ -0,0 +1,98 @@
+#ifndef LUSOSCRIPT_DICTIONARY_H
+#define LUSOSCRIPT_DICTIONARY_H
+
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "container.hh"
+#include "counted.hh"
+
+// A dictionary value, written `{"chave": valor}` in scripts, mapping strings
+// and numbers to values. It is an open-addressing hash table in the style of
+// the Swiss tables: the slots are split in groups of 16, each with a control
+// byte per slot holding 7 bits of the hash of its key, so that probing a
+// group compares the 16 bytes at once, with SIMD, and only reads the keys
+// whose byte matches. The slots refer to the entries, which are kept apart,
+// in the order they were added, with the hash of their key, so that growing
+// the table never hashes a key again. Like arrays, dictionaries are shared by
+// the variables holding them.
+class Dictionary : public Container {
+ public:
+  using Ref = CountedRef<Dictionary>;
+  // Numbers are keys by value, with 0 and -0 the same key, and NaN a key like
+  // any other number.
+  using Key = std::variant<std::string, float>;
+
+  static Ref create();
+
+  // The key `value` is, if it is a string or a number.
+  static std::optional<Key> toKey(const std::any &value);
+  static std::any toValue(const Key &key);
+
+  [[nodiscard]] std::size_t size() const { return size_; }
+  // The value of `key`, or null.
+  [[nodiscard]] std::any *find(const Key &key);
+  void insert(Key key, std::any value);
+  // Inserts several entries, hashing their keys first and growing the table
+  // once.
+  void insert(std::span<std::pair<Key, std::any>> entries);
+  // Returns whether the dictionary had `key`.
+  bool erase(const Key &key);
+  // Makes room for `count` entries in all.
+  void reserve(std::size_t count);
+
+  // Calls `visit(key, value)` for each entry, in the order they were added.
+  template <typename Visit>
+  void forEach(Visit visit) const {
+    for (const Entry &entry : entries_) {
+      if (entry.live) visit(entry.key, entry.value);
+    }
+  }
+
+ private:
+  struct Entry {
+    Key key;
+    std::any value;
+    std::uint64_t hash;
+    bool live;
+  };
+
+  // Control bytes of the slots with no entry, and of the slots whose entry was
+  // erased, which probes go past. A slot with an entry has the low 7 bits of
+  // its hash; all three have the high bit clear only when full.
+  static constexpr std::uint8_t kEmpty = 0x80;
+  static constexpr std::uint8_t kDeleted = 0xFE;
+
+  std::vector<std::uint8_t> control_;
+  // The index of the entry of each slot.
+  std::vector<std::uint32_t> slots_;
+  std::vector<Entry> entries_;
+  std::size_t size_ = 0;
+  // The slots that are not empty: the full and the deleted ones.
+  std::size_t used_ = 0;
+
+  Dictionary() = default;
+
+  static std::uint64_t hash(const Key &key);
+  // The slot with `key`, or -1.
+  [[nodiscard]] std::ptrdiff_t findSlot(const Key &key,
+                                        std::uint64_t hash) const;
+  void add(Key key, std::any value, std::uint64_t hash);
+  // Rebuilds the table with room for `count` entries, dropping the ones that
+  // were erased.
+  void rehash(std::size_t count);
+  void place(std::uint32_t entry, std::uint64_t hash);
+};
+
+static_assert(sizeof(Dictionary::Ref) == sizeof(void *) &&
+              std::is_nothrow_move_constructible_v<Dictionary::Ref>);
+
+#endif
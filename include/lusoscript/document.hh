@@ -0,0 +1,74 @@
+#ifndef LUSOSCRIPT_DOCUMENT_H
+#define LUSOSCRIPT_DOCUMENT_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arena.hh"
+#include "ast.hh"
+#include "error.hh"
+#include "resolver.hh"
+#include "token.hh"
+
+// A source text that stays lexed and parsed across edits, for editors and the
+// language server. An edit re-lexes only the damaged token range and re-parses
+// only the top-level declarations that depend on it; everything else (tokens,
+// ASTs and diagnostics) is reused. Declarations depend on the constants
+// declared before them too, which they cannot assign.
+class Document {
+ public:
+  explicit Document(std::string text);
+
+  // Replaces `length` bytes at `offset` with `text`.
+  void edit(int offset, int length, const std::string &text);
+
+  [[nodiscard]] const std::string &getText();
+  [[nodiscard]] const std::vector<token::Token> &getTokens();
+  // Lexical and syntax errors of the whole document, ordered by line.
+  [[nodiscard]] std::vector<error::Diagnostic> getDiagnostics();
+  // The top-level statements. A reused statement keeps the token lines it was
+  // parsed with; only its diagnostics are moved to the current lines.
+  [[nodiscard]] std::vector<const ast::Stmt *> getStatements();
+
+ private:
+  // A top-level declaration spanning tokens [first, end). Its parse depends
+  // on those tokens and on the lookahead token at `end`.
+  struct Declaration {
+    int first;
+    int end;
+    // Lines the declaration moved by since it was parsed.
+    int line_shift;
+    std::vector<error::Diagnostic> diagnostics;
+    // The constants declared by the declarations up to this one.
+    Resolver::Constants constants;
+    std::unique_ptr<arena::Arena> allocator;
+    ast::Stmt stmt;
+  };
+
+  // A lexical error, anchored at the source offset where its scan started.
+  struct LexicalError {
+    int offset;
+    error::Diagnostic diagnostic;
+  };
+
+  // The token range replaced by an edit: old tokens [first, old_end) became
+  // new tokens [first, old_end + token_delta).
+  struct Damage {
+    int first;
+    int old_end;
+    int token_delta;
+    int line_delta;
+  };
+
+  std::string text_;
+  // Always ends with the EOF token.
+  std::vector<token::Token> tokens_;
+  std::vector<Declaration> declarations_;
+  std::vector<LexicalError> lexical_errors_;
+
+  Damage relex(int offset, int length, int inserted, int line_delta);
+  void reparse(const Damage &damage);
+};
+
+#endif
@@ -1,11 +1,21 @@
 #ifndef LUSOSCRIPT_DRIVER_H
 #define LUSOSCRIPT_DRIVER_H
 
+#include <string>
+
+#include "arena.hh"
 #include "state.hh"
 
 class Driver {
  public:
   void process(state::AppState *app_state);
+  // Same, allocating the program in `allocator`, which the caller can reset
+  // and reuse for the next one.
+  void process(state::AppState *app_state, arena::Arena &allocator);
+  // Same, for the script at `script_path`: the program is loaded from the
+  // compiled program cache when it holds this source, and stored there
+  // otherwise.
+  void process(state::AppState *app_state, const std::string &script_path);
 };
 
 #endif
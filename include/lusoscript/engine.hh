@@ -0,0 +1,76 @@
+#ifndef LUSOSCRIPT_ENGINE_H
+#define LUSOSCRIPT_ENGINE_H
+
+#include <any>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "environment.hh"
+#include "error.hh"
+#include "native.hh"
+
+// API for embedding LusoScript in a host program. An `Engine` compiles a
+// script once into a `Program`, which can then run any number of times, with
+// the inputs of each run bound as variables. See docs/embedding.md.
+namespace lusoscript {
+// Values are `float`, `std::string`, `bool` or `nullptr`, as in scripts, or
+// functions of the host (see `Context::define()`).
+using Inputs = std::unordered_map<std::string, std::any>;
+
+// The global variables of the runs of programs. A context reused across runs
+// keeps what the earlier ones defined and assigned. Functions and classes it
+// holds refer to the program declaring them, which must outlive the context.
+class Context {
+ public:
+  explicit Context(const Inputs &inputs = {});
+
+  // Defines the global variable `name`, or replaces its value.
+  void set(const std::string &name, std::any value);
+  // Defines the global variable `name` as a function calling `function`,
+  // as wrapped by `NativeFunction::create()`.
+  template <typename F>
+  void define(const std::string &name, F function) {
+    set(name, NativeFunction::create(name, std::move(function)));
+  }
+  // The value of the global variable `name`, if it is defined.
+  std::optional<std::any> get(const std::string &name);
+
+ private:
+  env::Environment env_;
+
+  friend class Program;
+};
+
+// A compiled script. Programs are immutable and cheap to copy, and a program
+// can run on many threads at once, as long as each run has its own context.
+class Program {
+ public:
+  // Runs the program in `context`, writing what it prints to `output`.
+  error::RuntimeResult<> run(Context &context, std::ostream &output) const;
+  // Runs the program in a fresh context holding `inputs`, and returns what it
+  // printed.
+  error::RuntimeResult<std::string> run(const Inputs &inputs = {}) const;
+
+ private:
+  struct Compiled;
+
+  std::shared_ptr<const Compiled> compiled_;
+
+  explicit Program(std::shared_ptr<const Compiled> compiled);
+
+  friend class Engine;
+};
+
+class Engine {
+ public:
+  // Compiles `source`, or returns its syntax errors.
+  error::Result<Program, std::vector<error::Diagnostic>> compile(
+      const std::string &source) const;
+};
+}  // namespace lusoscript
+
+#endif
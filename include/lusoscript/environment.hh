@@ -4,7 +4,9 @@
 #include <any>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
+#include "lusoscript/error.hh"
 #include "lusoscript/token.hh"
 
 namespace env {
@@ -15,13 +17,29 @@ class Environment {
   explicit Environment();
   explicit Environment(Environment *enclosing);
 
-  std::any get(const token::Token &token);
+  error::RuntimeResult<std::any> get(const token::Token &token);
+  // Where the variable lives, for it to be updated in place.
+  error::RuntimeResult<std::any *> find(const token::Token &token);
   void define(const std::string &name, const std::any &value);
-  void assign(const token::Token &token, const std::any &value);
+  // Defines a variable that cannot be assigned, until it is defined again.
+  void defineConstant(const std::string &name, const std::any &value);
+  error::RuntimeResult<> assign(const token::Token &token,
+                                const std::any &value);
+  // Copies every variable visible from this scope into a scope of its own,
+  // with no enclosing one. Inner definitions shadow outer ones.
+  Environment snapshot() const;
+  // Whether `name` is a constant of this scope itself.
+  [[nodiscard]] bool isConstant(const std::string &name) const;
+  // The variables defined in this scope itself.
+  const std::unordered_map<std::string, std::any> &getValues() const;
+  std::unordered_map<std::string, std::any> &getValues();
 
  private:
   Environment *enclosing_;
   std::unordered_map<std::string, std::any> values_;
+  std::unordered_set<std::string> constants_;
+
+  error::RuntimeResult<> checkAssignable(const token::Token &token) const;
 };
 }  // namespace env
 
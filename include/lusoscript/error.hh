@@ -1,57 +1,140 @@
 #ifndef LUSOSCRIPT_ERROR_H
 #define LUSOSCRIPT_ERROR_H
 
-#include <stdexcept>
+#include <optional>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
 
 #include "token.hh"
 
 namespace error {
 class RuntimeError;
 
+// A reported compile-time error, as printed by `ErrorState`.
+struct Diagnostic {
+  int line;
+  std::string where;
+  std::string message;
+};
+
 class ErrorState {
  public:
   explicit ErrorState();
+  // Reports go to `output`; a null `output` only records them.
+  explicit ErrorState(std::ostream *output);
 
   void error(int line, std::string message);
   void error(token::Token token, std::string message);
+  // Reports an error already described by a diagnostic.
+  void error(Diagnostic diagnostic);
   void runtimeError(const RuntimeError &error);
+  // Reports a problem that does not stop the program.
+  void warning(int line, std::string message);
   [[nodiscard]] bool getHadError();
   [[nodiscard]] bool getHadRuntimeError();
+  [[nodiscard]] const std::vector<Diagnostic> &getDiagnostics();
   void resetHadError();
   void resetHadRuntimeError();
-  void summary();
+  void summary(std::ostream &output);
 
  private:
+  std::ostream *output_;
   bool had_error_;
   bool had_runtime_error_;
   int error_count_;
   int warning_count_;
+  std::vector<Diagnostic> diagnostics_;
 
   void report(int line, std::string where, std::string message);
   void setHadError();
 };
 
-class ParserError : public std::runtime_error {
+// A syntax error that aborts the current declaration. It has already been
+// reported to `ErrorState` when it is created.
+class ParserError {
  public:
-  explicit ParserError(const std::string &message);
+  explicit ParserError(std::string message);
 
-  const char *what() const noexcept override;
+  [[nodiscard]] const std::string &getMessage() const;
 
  private:
   std::string message_;
 };
 
-class RuntimeError : public std::runtime_error {
+class RuntimeError {
  public:
-  explicit RuntimeError(const token::Token &token, const std::string &message);
+  explicit RuntimeError(const token::Token &token, std::string message);
 
-  const char *what() const noexcept override;
-  [[nodiscard]] token::Token getToken() const;
+  [[nodiscard]] const std::string &getMessage() const;
+  [[nodiscard]] int getLine() const;
 
  private:
   std::string message_;
-  const token::Token &token_;
+  // Copied from the token, so that the error does not refer to the AST.
+  int line_;
+};
+
+// The error alternative of a `Result`, used to tell it apart from a value
+// when both could be built from the same thing (e.g. an `std::any`).
+template <typename E>
+struct Unexpected {
+  E error;
+};
+
+// Value of type `T`, or the `E` that prevented computing it. Errors travel
+// back to the caller as return values instead of exceptions.
+template <typename T, typename E>
+class [[nodiscard]] Result {
+ public:
+  template <typename U = T>
+    requires(std::is_constructible_v<T, U &&> &&
+             !std::is_same_v<std::remove_cvref_t<U>, Result> &&
+             !std::is_same_v<std::remove_cvref_t<U>, Unexpected<E>> &&
+             !std::is_same_v<std::remove_cvref_t<U>, E>)
+  Result(U &&value) : var_(std::in_place_index<0>, std::forward<U>(value)) {}
+
+  Result(Unexpected<E> unexpected)
+      : var_(std::in_place_index<1>, std::move(unexpected.error)) {}
+
+  [[nodiscard]] bool hasValue() const { return var_.index() == 0; }
+  explicit operator bool() const { return hasValue(); }
+
+  [[nodiscard]] T &value() { return *std::get_if<0>(&var_); }
+  [[nodiscard]] const T &value() const { return *std::get_if<0>(&var_); }
+  [[nodiscard]] const E &error() const { return *std::get_if<1>(&var_); }
+
+  // The error, ready to be returned from a function with another result
+  // type.
+  [[nodiscard]] Unexpected<E> unexpected() const { return {error()}; }
+
+ private:
+  std::variant<T, E> var_;
 };
+
+template <typename E>
+class [[nodiscard]] Result<void, E> {
+ public:
+  Result() = default;
+  Result(Unexpected<E> unexpected) : error_(std::move(unexpected.error)) {}
+
+  [[nodiscard]] bool hasValue() const { return !error_.has_value(); }
+  explicit operator bool() const { return hasValue(); }
+
+  [[nodiscard]] const E &error() const { return *error_; }
+  [[nodiscard]] Unexpected<E> unexpected() const { return {error()}; }
+
+ private:
+  std::optional<E> error_;
+};
+
+template <typename T>
+using ParseResult = Result<T, ParserError>;
+
+template <typename T = void>
+using RuntimeResult = Result<T, RuntimeError>;
 };  // namespace error
 
 #endif
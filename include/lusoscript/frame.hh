@@ -0,0 +1,72 @@
+#ifndef LUSOSCRIPT_FRAME_H
+#define LUSOSCRIPT_FRAME_H
+
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+
+// Framing of the messages between `luso --serve` and its clients. Every frame
+// is a type byte, the length of the payload as four little-endian bytes, and
+// the payload.
+//
+// A client sends RUN frames, whose payload is the source of a script, and
+// gets back OUTPUT and ERROR_OUTPUT frames with what the script prints,
+// followed by an EXIT frame with the exit code (four little-endian bytes).
+// STATS is answered by an OUTPUT frame with the latency report and an EXIT
+// frame; STOP shuts the server down. A connection can carry any number of
+// requests.
+namespace frame {
+enum class Type : char {
+  RUN = 'R',
+  STATS = 'S',
+  STOP = 'Q',
+  OUTPUT = 'O',
+  ERROR_OUTPUT = 'E',
+  EXIT = 'X',
+};
+
+struct Frame {
+  Type type;
+  std::string payload;
+};
+
+// Largest payload accepted, so that a bad length cannot exhaust the memory.
+inline constexpr std::uint32_t kMaxPayload = 64 * 1024 * 1024;
+
+// Reads the next frame from `fd`. Returns false at the end of the input or on
+// an error.
+bool read(int fd, Frame &frame);
+bool write(int fd, Type type, std::string_view payload);
+bool writeExit(int fd, int exit_code);
+int exitCode(const Frame &frame);
+
+// Output stream sending what is written to it as frames of one type, every
+// time it is flushed or its buffer fills up.
+class Writer : public std::ostream {
+ public:
+  explicit Writer(int fd, Type type);
+  ~Writer() override;
+
+ private:
+  class Buffer : public std::streambuf {
+   public:
+    explicit Buffer(int fd, Type type);
+
+    int sync() override;
+
+   protected:
+    int_type overflow(int_type c) override;
+
+   private:
+    int fd_;
+    Type type_;
+    char data_[4096];
+  };
+
+  Buffer buffer_;
+};
+}  // namespace frame
+
+#endif
@@ -5,6 +5,8 @@
 
 namespace helper {
 bool endsWith(const std::string &str, const std::string &suffix);
+// Formats a number the way `imprima` prints it.
+std::string formatNumber(float number);
 }  // namespace helper
 
 #endif
@@ -1,34 +1,208 @@
 #ifndef LUSOSCRIPT_INTERPRETER_H
 #define LUSOSCRIPT_INTERPRETER_H
 
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "array.hh"
 #include "ast.hh"
+#include "channel.hh"
+#include "closure.hh"
+#include "coroutine.hh"
+#include "dictionary.hh"
 #include "environment.hh"
+#include "module_loader.hh"
+#include "native.hh"
+#include "object.hh"
+#include "range.hh"
 #include "state.hh"
+#include "task_runtime.hh"
 
 class Interpreter {
  public:
   explicit Interpreter(error::ErrorState &error_state,
-                       const state::RunningMode &mode);
+                       const state::RunningMode &mode, std::ostream &output);
+  // An interpreter whose global scope is `env`.
+  explicit Interpreter(error::ErrorState &error_state,
+                       const state::RunningMode &mode, std::ostream &output,
+                       env::Environment env);
 
-  void interpret(const std::vector<ast::Stmt> &stmts);
+  void interpret(std::span<const ast::Stmt> stmts);
+  // Same as `interpret()`, but returns the error instead of reporting it.
+  error::RuntimeResult<> run(std::span<const ast::Stmt> stmts);
+  // Resumable version of `interpret()`. Before every statement and at every
+  // loop back-edge, including those of the functions that statements call, it
+  // awaits a checkpoint of `slice`, which suspends it once the slice is spent.
+  coro::Task<error::RuntimeResult<>> interpretResumable(
+      const std::vector<ast::Stmt> &stmts, coro::Slice &slice);
+  // The global scope, with what the statements run so far defined.
+  env::Environment &getEnvironment();
+  // Called with the global scope when the program reaches `instantaneo;`,
+  // unless it has started tasks. Without a handler, markers do nothing.
+  void setSnapshotHandler(
+      std::function<void(const env::Environment &)> handler);
+  // Lets `importe` run the modules of `loader`, which loaded `script`, the
+  // program this interpreter runs. Without modules, importing is an error.
+  void setModules(const ModuleLoader &loader,
+                  const ModuleLoader::Module &script);
+  // Records the modules that `stmts` import as already run, for a program
+  // resuming after them.
+  void assumeImported(std::span<const ast::Stmt> stmts);
+  // Declares again the functions and classes that `stmts` declared, for a
+  // program resuming after them from a snapshot, which leaves them out. A
+  // variable of the same name that the snapshot restored is left as it is.
+  error::RuntimeResult<> restoreDeclarations(std::span<const ast::Stmt> stmts);
 
  private:
+  // The slots of the locals of a running function, or of the blocks of the
+  // script, on the call stack.
+  struct Frame {
+    // Null for the script.
+    const Closure *closure = nullptr;
+    std::size_t base = 0;
+    // One past the last slot in use.
+    std::size_t top = 0;
+  };
+
+  class LoopSource;
+
   error::ErrorState &error_state_;
-  env::Environment current_env_;
+  env::Environment globals_;
+  // Contiguous, and reserved up front, so that calls do not allocate.
+  std::vector<std::any> stack_;
+  Frame frame_;
+  int depth_ = 0;
+  // Set by `retorne` until the call it returns from ends.
+  bool returning_ = false;
+  std::any return_value_;
+  // Set, along with `returning_`, by a `retorne` of a call, for the call
+  // running it to make in its frame. The arguments are in the slots from
+  // `tail_arguments_`.
+  Closure::Ref tail_call_;
+  std::size_t tail_arguments_ = 0;
+  // Operands that `resolveResumable()` evaluated ahead of the expression or
+  // statement using them, which `evaluate()` returns, once, instead of
+  // evaluating them again.
+  std::vector<std::pair<const ast::Expr *, std::any>> resolved_;
+  // Keeps the closure of a task's frame alive, as the task may outlive it.
+  Closure::Ref closure_;
   const state::RunningMode &mode_;
+  std::ostream &output_;
+  // Set for the interpreters running the iterations of a parallel loop.
+  // Nested parallel loops run sequentially in them.
+  bool worker_;
+  // Shared by a program and its tasks, which print to the same stream. Not
+  // set in the interpreters of parallel loops, which print to buffers of
+  // their own.
+  std::shared_ptr<std::mutex> output_mutex_;
+  // The tasks started by the program, created by the first one.
+  std::shared_ptr<TaskGroup> tasks_;
+  std::function<void(const env::Environment &)> snapshot_handler_;
+  const ModuleLoader *modules_ = nullptr;
+  // The modules that ran, or are running, in this program.
+  std::unordered_set<const ModuleLoader::Module *> imported_;
+
+  // An interpreter for a chunk of iterations of a parallel loop: it defines
+  // its globals in a scope of its own, enclosed by the one of `parent`, which
+  // it only reads, and runs on a copy of the frame of `parent`.
+  explicit Interpreter(Interpreter &parent, std::ostream &output);
+  // An interpreter for a task started by `parent`, running on `env` and on a
+  // copy of the frame of `parent`.
+  explicit Interpreter(Interpreter &parent, env::Environment env);
 
-  void execute(const ast::Stmt &stmt);
-  void executeBlock(const ast::Block &block, const env::Environment &env);
-  std::any evaluate(const ast::Expr &expr);
+  error::RuntimeResult<> execute(const ast::Stmt &stmt);
+  error::RuntimeResult<> executeBlock(const std::vector<ast::StmtPtr> &stmts);
+  coro::Task<error::RuntimeResult<>> executeResumable(const ast::Stmt &stmt,
+                                                      coro::Slice &slice);
+  coro::Task<error::RuntimeResult<>> executeBlockResumable(
+      const std::vector<ast::StmtPtr> &stmts, coro::Slice &slice);
+  // Whether `executeResumable()` can suspend in the middle of `stmt`.
+  bool isResumable(const ast::Stmt &stmt) const;
+  coro::Task<error::RuntimeResult<std::any>> evaluateResumable(
+      const ast::Expr &expr, coro::Slice &slice);
+  coro::Task<error::RuntimeResult<>> resolveResumable(
+      std::vector<const ast::Expr *> operands, coro::Slice &slice);
+  error::RuntimeResult<> executeParallelFor(const ast::ParallelFor &loop);
+  error::RuntimeResult<> runModule(const ast::Importe &importe);
+  Closure::Ref createClosure(const ast::Function &function);
+  void declareFunction(const ast::Function &function);
+  error::RuntimeResult<> declareClass(const ast::Classe &klass);
+  error::RuntimeResult<std::any> call(const ast::Call &call);
+  coro::Task<error::RuntimeResult<std::any>> callResumable(
+      const ast::Call &call, coro::Slice &slice);
+  Closure::Ref takeTailCall(std::size_t base);
+  error::RuntimeResult<std::any> leaveCall(
+      const Frame &caller, const Closure &closure,
+      const error::RuntimeResult<> &result);
+  error::RuntimeResult<std::any> prepareCall(const ast::Call &call);
+  error::RuntimeResult<std::any> evaluateCallee(const ast::Expr &callee,
+                                                std::any &receiver);
+  error::RuntimeResult<std::any> getProperty(const ast::Get &get,
+                                             std::any &receiver);
+  error::RuntimeResult<std::any> getSuper(const ast::Super &super,
+                                          std::any &receiver);
+  error::RuntimeResult<std::any> callNative(const NativeFunction &function,
+                                            const token::Token &paren);
+  void copyFrame(const Interpreter &parent);
+  void ensureStack(std::size_t size);
+  std::any &declareLocal(int slot);
+  std::any &local(int slot);
+  std::shared_ptr<Cell> box(int slot);
+  void define(const token::Token &name, int slot, std::any value);
+  error::RuntimeResult<std::any> lookUp(const token::Token &name,
+                                        const ast::Binding &binding);
+  error::RuntimeResult<> assign(const token::Token &name,
+                                const ast::Binding &binding,
+                                const std::any &value);
+  error::RuntimeResult<std::any *> locate(const token::Token &name,
+                                          const ast::Binding &binding);
+  // Fails in the interpreters of parallel loops for the globals they share.
+  error::RuntimeResult<> checkGlobalAssignable(const token::Token &name) const;
+  // Fails in the same interpreters for the captured variables they share.
+  error::RuntimeResult<> checkCellAssignable(const token::Token &name,
+                                             const Cell &cell) const;
+  error::RuntimeResult<std::any *> update(const ast::Update &update,
+                                          std::any *before);
+  void startTask(const ast::Tarefa &tarefa);
+  std::optional<error::RuntimeError> joinTasks();
+  error::RuntimeResult<std::shared_ptr<Channel>> evaluateChannel(
+      const token::Token &keyword, const ast::Expr &expr);
+  error::RuntimeResult<LoopSource> evaluateSource(const ast::ForEach &loop);
+  error::RuntimeResult<const ast::Stmt *> evaluateCase(
+      const ast::Escolha &escolha);
+  error::RuntimeResult<Dictionary::Key> evaluateKey(
+      const token::Token &token, const ast::Expr &expr);
+  error::RuntimeResult<std::size_t> evaluateIndex(const token::Token &bracket,
+                                                  const Array &array,
+                                                  const ast::Expr &expr);
+  std::unique_lock<std::mutex> lockOutput();
+  error::RuntimeResult<std::any> evaluate(const ast::Expr &expr);
   bool isTruthy(std::any value);
   bool isEqual(std::any a, std::any b);
-  void checkNumberOperand(token::Token opr, std::any value);
-  void checkNumberOperands(token::Token opr, std::any left, std::any right);
-  std::any combineStrict(const token::Token &opr, const std::any &left,
-                         const std::any &right);
-  std::any combineLoose(const token::Token &opr, const std::any &left,
-                        const std::any &right);
+  error::RuntimeResult<> checkNumberOperand(const token::Token &opr,
+                                            const std::any &value);
+  error::RuntimeResult<> checkNumberOperands(const token::Token &opr,
+                                             const std::any &left,
+                                             const std::any &right);
+  error::RuntimeResult<std::any> arithmetic(const token::Token &opr,
+                                            token::TokenType operation,
+                                            const std::any &left,
+                                            const std::any &right);
+  error::RuntimeResult<std::any> combineStrict(const token::Token &opr,
+                                               const std::any &left,
+                                               const std::any &right);
+  error::RuntimeResult<std::any> combineLoose(const token::Token &opr,
+                                              const std::any &left,
+                                              const std::any &right);
   std::string stringify(const std::any &value);
+  std::string stringify(const std::any &value, int depth);
 };
 
 #endif
@@ -0,0 +1,31 @@
+#ifndef LUSOSCRIPT_JSON_H
+#define LUSOSCRIPT_JSON_H
+
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+// Minimal JSON support for the language server protocol.
+namespace json {
+struct Value;
+
+using Array = std::vector<Value>;
+using Object = std::map<std::string, Value>;
+
+struct Value {
+  std::variant<std::nullptr_t, bool, double, std::string, Array, Object> var;
+
+  // Member `key` of an object, or null if absent or not an object.
+  [[nodiscard]] const Value *get(std::string_view key) const;
+  [[nodiscard]] const std::string *getString(std::string_view key) const;
+  [[nodiscard]] std::optional<double> getNumber(std::string_view key) const;
+};
+
+std::optional<Value> parse(std::string_view text);
+std::string serialize(const Value &value);
+}  // namespace json
+
+#endif
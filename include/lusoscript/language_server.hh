@@ -0,0 +1,40 @@
+#ifndef LUSOSCRIPT_LANGUAGE_SERVER_H
+#define LUSOSCRIPT_LANGUAGE_SERVER_H
+
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+
+#include "document.hh"
+#include "json.hh"
+
+// A language server speaking the Language Server Protocol over a pair of
+// streams. It keeps every open file as an incremental `Document` and publishes
+// its diagnostics after each change.
+class LanguageServer {
+ public:
+  explicit LanguageServer(std::istream &input, std::ostream &output);
+
+  // Serves messages until `exit`. Returns the process exit code.
+  int run();
+
+ private:
+  std::istream &input_;
+  std::ostream &output_;
+  std::map<std::string, Document> documents_;
+  bool shutdown_;
+
+  std::optional<json::Value> readMessage();
+  void send(const json::Value &message);
+  void respond(const json::Value &id, json::Value result);
+  void respondError(const json::Value &id, int code,
+                    const std::string &message);
+  void handle(const json::Value &message);
+  void didOpen(const json::Value &params);
+  void didChange(const json::Value &params);
+  void didClose(const json::Value &params);
+  void publishDiagnostics(const std::string &uri);
+};
+
+#endif
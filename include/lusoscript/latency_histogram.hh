@@ -0,0 +1,33 @@
+#ifndef LUSOSCRIPT_LATENCY_HISTOGRAM_H
+#define LUSOSCRIPT_LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Counts latencies in power-of-two buckets of microseconds: bucket 0 holds
+// those under 1 us, and bucket `i` those in [2^(i-1), 2^i) us. Recording is
+// lock-free, so that any thread can do it.
+class LatencyHistogram {
+ public:
+  explicit LatencyHistogram(std::string name);
+
+  void record(std::chrono::nanoseconds latency);
+  // Describes the counts, with the bounds of the median and the 99th
+  // percentile.
+  [[nodiscard]] std::string report() const;
+
+ private:
+  static constexpr std::size_t kBuckets = 40;
+
+  std::string name_;
+  std::array<std::atomic<std::uint64_t>, kBuckets> buckets_;
+
+  // Upper bound of bucket `index`, in microseconds.
+  static std::uint64_t bound(std::size_t index);
+};
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef LUSOSCRIPT_LEXER_H
 #define LUSOSCRIPT_LEXER_H
 
+#include <optional>
 #include <vector>
 
 #include "state.hh"
@@ -9,8 +10,15 @@
 class Lexer {
  public:
   explicit Lexer(const std::string &source, error::ErrorState &error_state);
+  // Starts lexing at `offset`, which must lie between two tokens, on `line`.
+  explicit Lexer(const std::string &source, error::ErrorState &error_state,
+                 int offset, int line);
 
   std::vector<token::Token> scanTokens();
+  // Scans a single token, for incremental lexing. Returns nothing at the end
+  // of the source (no EOF token is produced).
+  std::optional<token::Token> nextToken();
+  [[nodiscard]] int offset();
 
  private:
   const std::string &source_;
@@ -0,0 +1,60 @@
+#ifndef LUSOSCRIPT_MODULE_LOADER_H
+#define LUSOSCRIPT_MODULE_LOADER_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "arena.hh"
+#include "ast.hh"
+#include "error.hh"
+
+class ThreadPool;
+
+// Loads a script along with the modules it imports, and the ones they import
+// in turn. Modules are read, lexed and parsed in parallel, each one is kept in
+// the compiled program cache (see cache.hh), and a module imported from many
+// files is loaded once.
+class ModuleLoader {
+ public:
+  struct Module {
+    // Canonical path of the file.
+    std::string path;
+    std::uint64_t key = 0;
+    std::unique_ptr<arena::Arena> allocator;
+    std::vector<ast::Stmt> statements;
+  };
+
+  // Loads the script at `path`, whose contents are `source`, and its imports.
+  // Syntax errors and imports that cannot be read are reported to
+  // `error_state`. Returns the script, or nothing if there were errors.
+  const Module *load(const std::string &path, const std::string &source,
+                     error::ErrorState &error_state);
+  // The module an `importe` statement of a loaded file refers to.
+  [[nodiscard]] const Module *find(const ast::Importe &importe) const;
+  // Key of the contents of the script and all the modules loaded with it.
+  [[nodiscard]] std::uint64_t getKey() const;
+
+ private:
+  // Owns the modules, which never move once created.
+  std::deque<Module> modules_;
+  // Modules by canonical path.
+  std::unordered_map<std::string, Module *> paths_;
+  std::unordered_map<const ast::Importe *, const Module *> imports_;
+  // Errors of the imported modules, reported once they are all loaded.
+  std::unordered_map<const Module *, std::vector<error::Diagnostic>> errors_;
+  // Guards the members above while modules load.
+  std::mutex mutex_;
+
+  void parse(Module &module, const std::string &source,
+             error::ErrorState &error_state);
+  void resolveImports(Module &module, error::ErrorState &error_state,
+                      ThreadPool *pool);
+  void loadImported(Module &module, ThreadPool *pool);
+};
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef LUSOSCRIPT_MPMC_QUEUE_H
+#define LUSOSCRIPT_MPMC_QUEUE_H
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Bounded lock-free queue for any number of producers and consumers (Dmitry
+// Vyukov's design). Each cell carries a sequence number telling whether it is
+// ready to be written or read in the current lap, so producers and consumers
+// only contend on their own position counter.
+template <typename T>
+class MpmcQueue {
+ public:
+  // The capacity is rounded up to a power of two.
+  explicit MpmcQueue(std::size_t capacity)
+      : mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+        cells_(std::make_unique<Cell[]>(mask_ + 1)),
+        enqueue_position_(0),
+        dequeue_position_(0) {
+    for (std::size_t i = 0; i <= mask_; i++) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpmcQueue(const MpmcQueue &) = delete;
+  MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+  // Moves `value` into the queue, unless it is full.
+  bool tryPush(T &value) {
+    std::size_t position = enqueue_position_.load(std::memory_order_relaxed);
+    Cell *cell;
+
+    while (true) {
+      cell = &cells_[position & mask_];
+      const std::size_t sequence =
+          cell->sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<std::ptrdiff_t>(sequence) -
+                              static_cast<std::ptrdiff_t>(position);
+
+      if (difference == 0) {
+        if (enqueue_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = enqueue_position_.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->value = std::move(value);
+    cell->sequence.store(position + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  // Moves the oldest value into `value`, unless the queue is empty.
+  bool tryPop(T &value) {
+    std::size_t position = dequeue_position_.load(std::memory_order_relaxed);
+    Cell *cell;
+
+    while (true) {
+      cell = &cells_[position & mask_];
+      const std::size_t sequence =
+          cell->sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<std::ptrdiff_t>(sequence) -
+                              static_cast<std::ptrdiff_t>(position + 1);
+
+      if (difference == 0) {
+        if (dequeue_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = dequeue_position_.load(std::memory_order_relaxed);
+      }
+    }
+
+    value = std::move(cell->value);
+    cell->value = T();
+    cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+
+    return true;
+  }
+
+ private:
+  struct Cell {
+    std::atomic<std::size_t> sequence;
+    T value;
+  };
+
+  // Keeps the two positions on separate cache lines.
+  static constexpr std::size_t kCacheLine = 64;
+
+  const std::size_t mask_;
+  const std::unique_ptr<Cell[]> cells_;
+  alignas(kCacheLine) std::atomic<std::size_t> enqueue_position_;
+  alignas(kCacheLine) std::atomic<std::size_t> dequeue_position_;
+};
+
+#endif
@@ -0,0 +1,285 @@
+#ifndef LUSOSCRIPT_NATIVE_H
+#define LUSOSCRIPT_NATIVE_H
+
+#include <any>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "array.hh"
+#include "counted.hh"
+#include "dictionary.hh"
+#include "environment.hh"
+#include "error.hh"
+#include "range.hh"
+
+// A function of the host, callable from scripts like the ones they declare.
+// See `NativeFunction::create()`.
+class NativeFunction : public Counted {
+ public:
+  using Ref = CountedRef<const NativeFunction>;
+
+  virtual ~NativeFunction() = default;
+
+  // Wraps `function`, a function pointer or a lambda, whose parameters and
+  // result are converted from and to values as `native::Convert` tells:
+  //
+  //   NativeFunction::create("hipotenusa", [](float a, float b) {
+  //     return std::sqrt(a * a + b * b);
+  //   });
+  //
+  // The conversions are picked at compile time from the signature of
+  // `function`, so a call only checks the types of its arguments. A function
+  // can fail by returning an `error::Result<T, std::string>`, whose error
+  // becomes a runtime error of the call.
+  template <typename F>
+  static Ref create(std::string name, F function);
+
+  [[nodiscard]] const std::string &getName() const { return name_; }
+  [[nodiscard]] std::size_t getArity() const { return arity_; }
+
+  // Calls the function with `arguments`, as many as its parameters, which it
+  // may move from. Fails with the message of a runtime error.
+  virtual error::Result<std::any, std::string> call(
+      std::span<std::any> arguments) const = 0;
+
+ protected:
+  NativeFunction(std::string name, std::size_t arity)
+      : name_(std::move(name)), arity_(arity) {}
+
+ private:
+  std::string name_;
+  std::size_t arity_;
+};
+
+static_assert(sizeof(NativeFunction::Ref) == sizeof(void *));
+
+namespace native {
+// How values of the C++ type `T` are taken from arguments and returned to
+// scripts. `from()` returns something that converts to false when the
+// argument has another type, and dereferences to the value otherwise;
+// `kName` describes the expected type in errors.
+template <typename T>
+struct Convert {
+  static_assert(sizeof(T) == 0,
+                "Unsupported parameter or result type of a native function.");
+};
+
+template <>
+struct Convert<float> {
+  static constexpr std::string_view kName = "a number";
+  static const float *from(const std::any &value) {
+    return std::any_cast<float>(&value);
+  }
+  static std::any to(float value) { return value; }
+};
+
+template <>
+struct Convert<double> {
+  static constexpr std::string_view kName = "a number";
+  static std::optional<double> from(const std::any &value) {
+    const auto *number = std::any_cast<float>(&value);
+    if (number == nullptr) return std::nullopt;
+
+    return *number;
+  }
+  static std::any to(double value) { return static_cast<float>(value); }
+};
+
+// Only whole numbers in the range of `int` convert, rather than being
+// truncated, which would be undefined out of the range and for NaN.
+template <>
+struct Convert<int> {
+  static constexpr std::string_view kName = "a whole number";
+  static std::optional<int> from(const std::any &value) {
+    const auto *number = std::any_cast<float>(&value);
+    if (number == nullptr) return std::nullopt;
+
+    // -2^31 and 2^31, both exact as floats, unlike the largest `int`.
+    if (!(*number >= -2147483648.f && *number < 2147483648.f) ||
+        *number != std::trunc(*number)) {
+      return std::nullopt;
+    }
+
+    return static_cast<int>(*number);
+  }
+  static std::any to(int value) { return static_cast<float>(value); }
+};
+
+template <>
+struct Convert<bool> {
+  static constexpr std::string_view kName = "a boolean";
+  static const bool *from(const std::any &value) {
+    return std::any_cast<bool>(&value);
+  }
+  static std::any to(bool value) { return value; }
+};
+
+template <>
+struct Convert<std::string> {
+  static constexpr std::string_view kName = "a string";
+  // A `const std::string &` parameter refers to the argument itself.
+  static std::string *from(std::any &value) {
+    return std::any_cast<std::string>(&value);
+  }
+  static std::any to(std::string value) { return value; }
+};
+
+template <>
+struct Convert<std::string_view> {
+  static constexpr std::string_view kName = "a string";
+  static std::optional<std::string_view> from(const std::any &value) {
+    const auto *str = std::any_cast<std::string>(&value);
+    if (str == nullptr) return std::nullopt;
+
+    return *str;
+  }
+  static std::any to(std::string_view value) { return std::string(value); }
+};
+
+// A `const Array::Ref &` parameter refers to the argument itself.
+template <>
+struct Convert<Array::Ref> {
+  static constexpr std::string_view kName = "an array";
+  static Array::Ref *from(std::any &value) {
+    return std::any_cast<Array::Ref>(&value);
+  }
+  static std::any to(Array::Ref value) { return value; }
+};
+
+template <>
+struct Convert<Dictionary::Ref> {
+  static constexpr std::string_view kName = "a dictionary";
+  static Dictionary::Ref *from(std::any &value) {
+    return std::any_cast<Dictionary::Ref>(&value);
+  }
+  static std::any to(Dictionary::Ref value) { return value; }
+};
+
+template <>
+struct Convert<Range::Ref> {
+  static constexpr std::string_view kName = "a range";
+  static Range::Ref *from(std::any &value) {
+    return std::any_cast<Range::Ref>(&value);
+  }
+  static std::any to(Range::Ref value) { return value; }
+};
+
+// Any value, unconverted.
+template <>
+struct Convert<std::any> {
+  static constexpr std::string_view kName = "a value";
+  static std::any *from(std::any &value) { return &value; }
+  static std::any to(std::any value) { return value; }
+};
+
+// The parameters and result of a callable.
+template <typename F>
+struct Signature : Signature<decltype(&F::operator())> {};
+
+template <typename R, typename... Args>
+struct Signature<R (*)(Args...)> {
+  using Result = R;
+  using Parameters = std::tuple<Args...>;
+};
+
+template <typename R, typename... Args>
+struct Signature<R (*)(Args...) noexcept> : Signature<R (*)(Args...)> {};
+
+template <typename C, typename R, typename... Args>
+struct Signature<R (C::*)(Args...) const> : Signature<R (*)(Args...)> {};
+
+template <typename C, typename R, typename... Args>
+struct Signature<R (C::*)(Args...) const noexcept>
+    : Signature<R (*)(Args...)> {};
+
+template <typename T>
+struct IsResult : std::false_type {};
+
+template <typename T>
+struct IsResult<error::Result<T, std::string>> : std::true_type {};
+
+template <typename R>
+error::Result<std::any, std::string> toValue(R &&result) {
+  using T = std::remove_cvref_t<R>;
+
+  if constexpr (IsResult<T>::value) {
+    if (!result) return error::Unexpected<std::string>{result.error()};
+    return toValue(std::move(result.value()));
+  } else {
+    return Convert<T>::to(std::forward<R>(result));
+  }
+}
+
+template <typename F, typename Parameters>
+class Binding;
+
+template <typename F, typename... Args>
+class Binding<F, std::tuple<Args...>> : public NativeFunction {
+ public:
+  Binding(std::string name, F function)
+      : NativeFunction(std::move(name), sizeof...(Args)),
+        function_(std::move(function)) {}
+
+  error::Result<std::any, std::string> call(
+      std::span<std::any> arguments) const override {
+    return call(arguments, std::index_sequence_for<Args...>{});
+  }
+
+ private:
+  static constexpr std::array<std::string_view, sizeof...(Args)> kNames = {
+      Convert<std::remove_cvref_t<Args>>::kName...};
+
+  F function_;
+
+  template <std::size_t... I>
+  error::Result<std::any, std::string> call(
+      [[maybe_unused]] std::span<std::any> arguments,
+      std::index_sequence<I...>) const {
+    auto values = std::make_tuple(
+        Convert<std::remove_cvref_t<Args>>::from(arguments[I])...);
+
+    // The first argument of the wrong type, counting from 1.
+    std::size_t wrong = 0;
+    (void)((std::get<I>(values) ? false : (wrong = I + 1, true)) || ...);
+
+    if (wrong != 0) {
+      return error::Unexpected<std::string>{
+          "Argument " + std::to_string(wrong) + " of '" + getName() +
+          "' must be " + std::string(kNames[wrong - 1])};
+    }
+
+    using R = std::invoke_result_t<const F &, Args...>;
+
+    if constexpr (std::is_void_v<R>) {
+      function_(static_cast<Args>(*std::move(std::get<I>(values)))...);
+      return std::any{nullptr};
+    } else {
+      return toValue(
+          function_(static_cast<Args>(*std::move(std::get<I>(values)))...));
+    }
+  }
+};
+
+// Defines the built-in functions in `globals`, except where a variable of
+// the same name is already defined.
+void defineBuiltins(env::Environment &globals);
+}  // namespace native
+
+template <typename F>
+NativeFunction::Ref NativeFunction::create(std::string name, F function) {
+  using Callable = std::decay_t<F>;
+  using Parameters = typename native::Signature<Callable>::Parameters;
+
+  return Ref::adopt(new native::Binding<Callable, Parameters>(
+      std::move(name), std::move(function)));
+}
+
+#endif
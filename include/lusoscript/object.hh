@@ -0,0 +1,173 @@
+#ifndef LUSOSCRIPT_OBJECT_H
+#define LUSOSCRIPT_OBJECT_H
+
+#include <any>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "closure.hh"
+#include "container.hh"
+#include "counted.hh"
+
+// The layout of the fields of instances: the slot each field is in. The
+// instances of a class that got the same fields in the same order share a
+// shape, so that telling whether an instance has a layout seen before takes a
+// single comparison. The shapes of a class make a tree, rooted at the shape
+// of the instances with no fields, each child adding one field to its parent.
+class Shape {
+ public:
+  Shape() = default;
+
+  // The shape with the field `name` added, which is created the first time it
+  // is asked for. Safe to call from several threads.
+  const Shape *with(const std::string &name) const;
+  // The slot of the field `name`, or -1.
+  [[nodiscard]] int find(const std::string &name) const;
+  // The field in `slot`.
+  [[nodiscard]] const std::string &name(int slot) const {
+    return fields_[slot];
+  }
+  [[nodiscard]] std::size_t size() const { return fields_.size(); }
+
+ private:
+  // The names of the fields, by slot.
+  std::vector<std::string> fields_;
+  mutable std::mutex mutex_;
+  mutable std::unordered_map<std::string, std::unique_ptr<Shape>>
+      transitions_;
+};
+
+// A class value: the closures of its methods, and the shapes of its
+// instances, which only it has.
+class Class : public Counted {
+ public:
+  using Ref = CountedRef<const Class>;
+
+  static Ref create(std::string name, Ref superclass,
+                    std::unordered_map<std::string, Closure::Ref> methods);
+
+  [[nodiscard]] const std::string &getName() const;
+  [[nodiscard]] const Ref &getSuperclass() const;
+  // The methods the class declares, not the inherited ones.
+  [[nodiscard]] const std::unordered_map<std::string, Closure::Ref> &
+  getMethods() const;
+  // The method `name`, declared by the class or inherited, or null.
+  [[nodiscard]] const Closure::Ref *findMethod(const std::string &name) const;
+  // The method `inicie`, or null.
+  [[nodiscard]] const Closure::Ref *getInitializer() const;
+  // The shape of the instances with no fields.
+  [[nodiscard]] const Shape *getShape() const;
+  // The most fields an instance of the class got so far, which new instances
+  // reserve slots for.
+  [[nodiscard]] std::size_t getFieldCount() const;
+  void countFields(std::size_t count) const;
+
+ private:
+  Class(std::string name, Ref superclass,
+        std::unordered_map<std::string, Closure::Ref> methods);
+
+  std::string name_;
+  Ref superclass_;
+  std::unordered_map<std::string, Closure::Ref> methods_;
+  const Closure::Ref *initializer_;
+  Shape root_;
+  mutable std::atomic<std::size_t> field_count_ = 0;
+};
+
+// An instance of a class, with its fields in the slots its shape tells.
+// Instances are shared, not copied, by the variables holding them.
+class Instance : public Container {
+ public:
+  using Ref = CountedRef<Instance>;
+
+  static Ref create(Class::Ref klass);
+
+  [[nodiscard]] const Class::Ref &getClass() const;
+  [[nodiscard]] const Shape *getShape() const;
+  [[nodiscard]] std::any &getField(int slot);
+  // Adds a field, in the next slot, moving the instance to `shape`, which is
+  // its current shape with the field.
+  void addField(const Shape *shape, std::any value);
+
+ private:
+  explicit Instance(Class::Ref klass);
+
+  Class::Ref class_;
+  const Shape *shape_;
+  std::vector<std::any> fields_;
+};
+
+// A method read from an instance rather than called on it, which is called
+// on that instance later.
+class BoundMethod : public Counted {
+ public:
+  using Ref = CountedRef<const BoundMethod>;
+
+  static Ref create(Instance::Ref receiver, Closure::Ref method);
+
+  [[nodiscard]] const Instance::Ref &getReceiver() const;
+  [[nodiscard]] const Closure::Ref &getMethod() const;
+
+ private:
+  BoundMethod(Instance::Ref receiver, Closure::Ref method);
+
+  Instance::Ref receiver_;
+  Closure::Ref method_;
+};
+
+static_assert(sizeof(Class::Ref) == sizeof(void *) &&
+              sizeof(Instance::Ref) == sizeof(void *) &&
+              std::is_nothrow_move_constructible_v<Instance::Ref>);
+
+// The inline cache of a node reading or assigning a property: the shapes of
+// the instances it met, each with where it found the property. A node that
+// meets one shape (monomorphic) or a few (polymorphic) finds the property of
+// an instance with a comparison per shape; past `kEntries` shapes
+// (megamorphic), it looks properties up by name. Entries are only ever
+// added, and written once, so that the interpreters running a program share
+// the caches of its nodes without locking.
+class PropertyCache {
+ public:
+  static constexpr int kEntries = 4;
+
+  // Where a property was found: in the slot of a field or, when the slot is
+  // -1, among the methods, unless the method is null too.
+  struct Property {
+    int slot = -1;
+    const Closure::Ref *method = nullptr;
+  };
+
+  // The property `name` of `instance`.
+  Property get(const Instance &instance, const std::string &name);
+  // The method `name` of `klass`, or null. Used by `super`.
+  const Closure::Ref *getMethod(const Class::Ref &klass,
+                                const std::string &name);
+  // Assigns the field `name` of `instance`, adding it if it has none.
+  void set(Instance &instance, const std::string &name, std::any value);
+
+ private:
+  struct Entry {
+    Property property;
+    // Set when assigning the property adds it: the shape with it.
+    const Shape *transition = nullptr;
+    // Keeps the shapes of the entry alive.
+    Class::Ref owner;
+  };
+
+  std::array<Entry, kEntries> entries_;
+  // The shape of each entry, published once the entry is written.
+  std::array<std::atomic<const Shape *>, kEntries> shapes_{};
+  std::atomic<int> used_ = 0;
+
+  const Entry *find(const Shape *shape) const;
+  void add(const Shape *shape, Entry entry);
+};
+
+#endif
@@ -1,54 +1,155 @@
 #ifndef LUSOSCRIPT_PARSER_H
 #define LUSOSCRIPT_PARSER_H
 
+#include <array>
+#include <functional>
+#include <string>
+
 #include "arena.hh"
 #include "ast.hh"
 #include "error.hh"
+#include "resolver.hh"
 #include "token.hh"
 
 class Parser {
  public:
   explicit Parser(arena::Arena *allocator, error::ErrorState &error_state,
-                  std::vector<token::Token> tokens);
+                  const std::vector<token::Token> &tokens,
+                  bool lazy_blocks = false);
 
   std::vector<ast::Stmt> parse();
+  // Parses the top-level declaration starting at token `position`, leaving
+  // `position` at the token that follows it. Used for incremental re-parsing.
+  // `constants` holds those of the declarations before it, to which the ones
+  // it declares are added.
+  ast::Stmt parseDeclaration(int &position, Resolver::Constants &constants);
+  const ast::Stmt &parseLazyBlock(const ast::LazyBlock &lazy);
+  // Whether the body of `lazy` may assign a constant, either one declared in
+  // it or one for which `constant` holds.
+  [[nodiscard]] bool mayAssign(
+      const ast::LazyBlock &lazy,
+      const std::function<bool(const std::string &)> &constant) const;
 
  private:
+  ast::Stmt topLevelDeclaration();
   ast::Stmt declaration();
-  ast::Stmt varDeclaration();
-  ast::Stmt statement();
-  ast::Stmt forStatement();
-  ast::Stmt ifStatement();
-  ast::Stmt imprimaStatement();
-  ast::Stmt whileStatement();
-  std::vector<ast::Stmt> block();
-  ast::Stmt expressionStatement();
-  ast::Expr expression();
-  ast::Expr comma();
-  ast::Expr assignment();
-  ast::Expr ternary();
-  ast::Expr logicalOr();
-  ast::Expr logicalAnd();
-  ast::Expr equality();
-  ast::Expr comparison();
-  ast::Expr term();
-  ast::Expr factor();
-  ast::Expr unary();
-  ast::Expr primary();
-  bool match(std::vector<token::TokenType> types);
-  token::Token consume(token::TokenType type, std::string message);
+  error::ParseResult<ast::Stmt> varDeclaration(bool constant = false);
+  error::ParseResult<ast::Stmt> functionDeclaration();
+  error::ParseResult<ast::Function> function(ast::Function::Kind kind);
+  error::ParseResult<ast::Stmt> classDeclaration();
+  error::ParseResult<ast::Stmt> statement();
+  error::ParseResult<ast::Stmt> forStatement();
+  error::ParseResult<ast::Stmt> parallelForStatement();
+  error::ParseResult<ast::Stmt> forEachStatement();
+  error::ParseResult<ast::Reduction> reduction();
+  void checkParallelBody(const token::Token &variable,
+                         const std::vector<ast::Reduction> &reductions,
+                         const ast::Stmt &body);
+  error::ParseResult<ast::Stmt> ifStatement();
+  error::ParseResult<ast::Stmt> imprimaStatement();
+  error::ParseResult<ast::Stmt> whileStatement();
+  error::ParseResult<ast::Stmt> escolhaStatement();
+  error::ParseResult<std::any> caseLabel();
+  error::ParseResult<ast::Stmt> tarefaStatement();
+  error::ParseResult<ast::Stmt> envieStatement();
+  error::ParseResult<ast::Stmt> fecheStatement();
+  error::ParseResult<ast::Stmt> instantaneoStatement();
+  error::ParseResult<ast::Stmt> importeStatement();
+  error::ParseResult<ast::Stmt> retorneStatement();
+  error::ParseResult<std::vector<ast::Stmt>> block();
+  error::ParseResult<ast::Stmt> bodyStatement();
+  void skipBlock();
+  error::ParseResult<ast::Stmt> expressionStatement();
+  error::ParseResult<ast::Expr> expression();
+
+  // Binding power of the expression operators, from the loosest (comma) to
+  // the tightest (unary). See docs/grammar.md.
+  enum class Precedence {
+    NONE,
+    COMMA,
+    ASSIGNMENT,
+    TERNARY,
+    LOGIC_OR,
+    LOGIC_AND,
+    EQUALITY,
+    COMPARISON,
+    TERM,
+    FACTOR,
+    UNARY,
+    CALL,
+  };
+
+  enum class InfixKind {
+    NONE,
+    BINARY,
+    LOGICAL,
+    ASSIGNMENT,
+    TERNARY,
+    CALL,
+    PROPERTY,
+    INDEX,
+    UPDATE,
+    POSTFIX
+  };
+
+  // The class whose body is being parsed, if any.
+  enum class ClassKind { NONE, CLASS, SUBCLASS };
+
+  struct InfixRule {
+    Precedence precedence;
+    InfixKind kind;
+    // Whether a dangling occurrence of the operator (one with no left-hand
+    // side) is reported and parsed past instead of failing the expression.
+    bool recovers;
+  };
+
+  static const std::array<InfixRule, token::kTokenTypeCount> kInfixRules;
+  // Most parameters of a function, and arguments of a call.
+  static constexpr std::size_t kMaxArguments = 255;
+
+  error::ParseResult<ast::Expr> parsePrecedence(Precedence min_precedence);
+  error::ParseResult<ast::Expr> prefix(Precedence min_precedence);
+  error::ParseResult<ast::Expr> infix(ast::Expr left, const InfixRule &rule);
+  ast::Expr update(ast::Expr target, const token::Token &opr,
+                   ast::ExprPtr value, bool postfix);
+  error::ParseResult<ast::Expr> call(ast::Expr callee);
+  error::ParseResult<ast::Expr> primary();
+  error::ParseResult<ast::Expr> super();
+  error::ParseResult<ast::Expr> channel();
+  error::ParseResult<ast::Expr> array();
+  error::ParseResult<ast::Expr> dictionary();
+  ast::ExprPtr wrap(ast::Expr expr);
+  ast::StmtPtr wrap(ast::Stmt stmt);
+  bool match(token::TokenType type);
+  bool match(token::TokenSet types);
+  error::ParseResult<token::Token> consume(token::TokenType type,
+                                           std::string message);
   bool check(token::TokenType type);
-  token::Token advance();
+  const token::Token &advance();
   bool isAtEnd();
-  token::Token peek();
-  token::Token previous();
-  error::ParserError error(token::Token token, std::string message);
+  const token::Token &peek();
+  const token::Token &previous();
+  error::Unexpected<error::ParserError> error(const token::Token &token,
+                                              std::string message);
   void synchronize();
 
   arena::Arena *allocator_;
   error::ErrorState &error_state_;
-  const std::vector<token::Token> tokens_;
+  const std::vector<token::Token> &tokens_;
   int current_;
+  bool lazy_blocks_;
+  // Set while a lazy body is scanned for errors only.
+  bool validating_;
+  // Set once parsing happens inside an already validated lazy body.
+  bool validated_;
+  // Set in the body of a function, but not in the tasks and parallel loops
+  // inside it.
+  bool returns_allowed_;
+  // Set in the body of an initializer, which cannot return a value.
+  bool initializer_;
+  ClassKind class_kind_;
+  // The constants declared at the top level so far.
+  Resolver::Constants constants_;
 };
 
 #endif
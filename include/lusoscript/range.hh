@@ -0,0 +1,40 @@
+#ifndef LUSOSCRIPT_RANGE_H
+#define LUSOSCRIPT_RANGE_H
+
+#include <cstdint>
+#include <type_traits>
+
+#include "counted.hh"
+
+// A range value, made by `intervalo(inicio, fim, passo)`: the numbers from
+// `inicio` by `passo` up to `fim`, which is excluded. Nothing is stored but
+// the three numbers; a `para cada` loop computes each number as it gets to
+// it.
+class Range : public Counted {
+ public:
+  using Ref = CountedRef<const Range>;
+
+  // `step` must be finite and not zero, and `start` and `end` finite.
+  static Ref create(float start, float end, float step);
+
+  [[nodiscard]] float getStart() const { return start_; }
+  [[nodiscard]] float getEnd() const { return end_; }
+  [[nodiscard]] float getStep() const { return step_; }
+  [[nodiscard]] std::uint64_t size() const { return size_; }
+  // The number at `index`, which is computed from the start rather than by
+  // adding up steps, so that rounding errors do not pile up.
+  [[nodiscard]] float at(std::uint64_t index) const;
+
+ private:
+  Range(float start, float end, float step);
+
+  float start_;
+  float end_;
+  float step_;
+  std::uint64_t size_;
+};
+
+static_assert(sizeof(Range::Ref) == sizeof(void *) &&
+              std::is_nothrow_move_constructible_v<Range::Ref>);
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef LUSOSCRIPT_RESOLVER_H
+#define LUSOSCRIPT_RESOLVER_H
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ast.hh"
+#include "error.hh"
+
+// Decides where every variable lives, filling in the bindings, slots and
+// captures of the nodes of a parsed top-level statement. Variables declared
+// at the top level of the script are globals, looked up by name. Any other
+// variable is a local: it takes a slot of the frame of the function declaring
+// it (the blocks of the script share a frame of their own), which calls push
+// on the call stack of the interpreter. A function that uses a local of an
+// enclosing function captures it, and finds it through the captures of its
+// declaration.
+//
+// Constants cannot be assigned, which the resolver reports. When the value of
+// a constant folds to a literal, its uses are replaced by the literal, and so
+// are the operators whose operands are all literals, so that neither is looked
+// up nor computed when the program runs.
+class Resolver {
+ public:
+  // A constant of the script, in the order they are declared, with the literal
+  // its value folded to, if any.
+  struct Constant {
+    std::size_t order;
+    std::optional<ast::Literal> value;
+  };
+  using Constants = std::unordered_map<std::string, Constant>;
+
+  // The constants of the script are kept in `constants` from one top-level
+  // statement to the next.
+  Resolver(error::ErrorState &error_state, Constants &constants);
+
+  void resolve(ast::Stmt &stmt);
+  // Resolves `block`, which `lazy` was parsed into, in the scope recorded for
+  // `lazy` when the statement around it was resolved.
+  void resolve(const ast::LazyBlock &lazy, ast::Stmt &block);
+
+ private:
+  struct Local {
+    const std::string *name;
+    int depth;
+    bool constant = false;
+    std::optional<ast::Literal> value;
+  };
+
+  // A function being resolved, or the script, which comes first.
+  struct FunctionScope {
+    ast::Function *function;
+    // The locals in scope, each in the slot of its index.
+    std::vector<Local> locals;
+    int depth = 0;
+  };
+
+  error::ErrorState &error_state_;
+  Constants &constants_;
+  // The constants of the script that were declared before the statements
+  // being resolved.
+  std::size_t visible_constants_;
+  std::vector<FunctionScope> functions_;
+  // The constants that are reductions of the parallel loops being resolved,
+  // reported once there rather than at each assignment in their bodies.
+  std::unordered_set<std::string> reduced_constants_;
+
+  void resolve(ast::Expr &expr);
+  void resolve(std::vector<ast::StmtPtr> &stmts);
+  void function(ast::Function &function);
+  void beginScope();
+  void endScope();
+  int declare(const token::Token &name);
+  int declare(const std::string &name);
+  void freeze(const ast::Var &var);
+  void assign(const token::Token &name);
+  [[nodiscard]] const std::optional<ast::Literal> *constant(
+      const std::string &name) const;
+  ast::Binding bind(const token::Token &name);
+  ast::Binding bind(const std::string &identifier);
+  static int find(const FunctionScope &scope, const std::string &name);
+  int capture(std::size_t function, const std::string &name);
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef LUSOSCRIPT_SCHEDULER_H
+#define LUSOSCRIPT_SCHEDULER_H
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "thread_pool.hh"
+
+// Interleaves many scripts on a few threads. Each script runs as a resumable
+// interpreter that yields after a time slice, measured in executed
+// statements, and goes back to the end of the queue; a long loop in one
+// script therefore cannot starve the others.
+class Scheduler {
+ public:
+  explicit Scheduler(int threads, int slice);
+  ~Scheduler();
+
+  // Queues a script. Its output and errors go to the given streams, which
+  // must outlive `run()`.
+  void add(std::string source, std::ostream &output,
+           std::ostream &error_output);
+
+  // Runs every queued script to completion. Returns their exit codes, in the
+  // order they were added.
+  std::vector<int> run();
+
+ private:
+  struct Script;
+
+  int slice_;
+  ThreadPool pool_;
+  std::vector<std::unique_ptr<Script>> scripts_;
+
+  void step(Script &script);
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef LUSOSCRIPT_SERVER_H
+#define LUSOSCRIPT_SERVER_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "frame.hh"
+#include "latency_histogram.hh"
+
+// A long-lived process running the scripts sent to it over a Unix domain
+// socket (see frame.hh for the protocol). Requests are served by a pool of
+// threads, each reusing one arena for the programs it runs, so a request only
+// pays for lexing, parsing and running its script. Connections waiting for
+// their next request hold no thread: the thread accepting them polls them,
+// and hands each request to the pool once it starts arriving.
+class Server {
+ public:
+  explicit Server(std::string socket_path, int threads);
+
+  // Serves connections until a STOP request. Returns the exit code of the
+  // process.
+  int run();
+
+ private:
+  std::string socket_path_;
+  int threads_;
+  int listener_;
+  // A pipe whose write end wakes up the polling thread.
+  int wake_[2];
+  std::atomic<bool> stopping_;
+  // Connections whose request was served, for the polling thread to watch
+  // again.
+  std::mutex mutex_;
+  std::vector<int> served_;
+  // From the request being read to its exit code being sent.
+  LatencyHistogram request_latency_;
+  // Lexing, parsing and running the script alone.
+  LatencyHistogram script_latency_;
+
+  // Serves the request arriving on `connection`, then hands it back to the
+  // polling thread, unless it is done with.
+  void serve(int connection);
+  void giveBack(int connection);
+  void wake();
+  std::string report() const;
+};
+
+// Sends requests to a server started with `luso --serve`.
+class Client {
+ public:
+  explicit Client(std::string socket_path);
+
+  // Runs the script at `file_path` on the server, streaming what it prints to
+  // the standard output and error. Returns its exit code.
+  int run(const std::string &file_path);
+  // Prints the latency report of the server.
+  int stats();
+  int stop();
+
+ private:
+  std::string socket_path_;
+
+  int request(frame::Type type, std::string_view payload);
+};
+
+#endif
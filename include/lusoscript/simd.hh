@@ -0,0 +1,63 @@
+#ifndef LUSOSCRIPT_SIMD_H
+#define LUSOSCRIPT_SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Element-wise kernels over arrays of `n` numbers or booleans (one byte each,
+// 0 or 1), used by the columnar evaluator and by the built-in functions on
+// arrays. They use SSE2 where the target has it and plain loops elsewhere;
+// both give the same results. Outputs may alias inputs.
+namespace simd {
+void add(const float *a, const float *b, float *out, std::size_t n);
+void subtract(const float *a, const float *b, float *out, std::size_t n);
+void multiply(const float *a, const float *b, float *out, std::size_t n);
+void divide(const float *a, const float *b, float *out, std::size_t n);
+void negate(const float *a, float *out, std::size_t n);
+
+void greater(const float *a, const float *b, std::uint8_t *out,
+             std::size_t n);
+void greaterEqual(const float *a, const float *b, std::uint8_t *out,
+                  std::size_t n);
+void equal(const float *a, const float *b, std::uint8_t *out, std::size_t n);
+void notEqual(const float *a, const float *b, std::uint8_t *out,
+              std::size_t n);
+void equal(const std::uint8_t *a, const std::uint8_t *b, std::uint8_t *out,
+           std::size_t n);
+void notEqual(const std::uint8_t *a, const std::uint8_t *b, std::uint8_t *out,
+              std::size_t n);
+
+void logicalAnd(const std::uint8_t *a, const std::uint8_t *b,
+                std::uint8_t *out, std::size_t n);
+void logicalOr(const std::uint8_t *a, const std::uint8_t *b, std::uint8_t *out,
+               std::size_t n);
+void logicalNot(const std::uint8_t *a, std::uint8_t *out, std::size_t n);
+
+// `out[i] = mask[i] ? a[i] : b[i]`.
+void select(const std::uint8_t *mask, const float *a, const float *b,
+            float *out, std::size_t n);
+void select(const std::uint8_t *mask, const std::uint8_t *a,
+            const std::uint8_t *b, std::uint8_t *out, std::size_t n);
+
+// Index of the first zero (or negative zero) in `a`, or `n` if none.
+std::size_t findZero(const float *a, std::size_t n);
+
+void fill(float *out, float value, std::size_t n);
+
+// Reductions. They combine the numbers in four lanes, in the same order with
+// or without SSE2. `minimum()` and `maximum()` need `n > 0`.
+float sum(const float *a, std::size_t n);
+float dot(const float *a, const float *b, std::size_t n);
+float minimum(const float *a, std::size_t n);
+float maximum(const float *a, std::size_t n);
+
+// Searches of the 16 control bytes of a group of a hash table (see
+// dictionary.hh). Bit `i` of the result is set for byte `i`.
+inline constexpr std::size_t kGroupSize = 16;
+// The bytes equal to `value`.
+std::uint32_t matchBytes(const std::uint8_t *group, std::uint8_t value);
+// The bytes with their high bit set.
+std::uint32_t highBits(const std::uint8_t *group);
+}  // namespace simd
+
+#endif
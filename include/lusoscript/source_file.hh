@@ -1,11 +1,34 @@
 #ifndef LUSOSCRIPT_SOURCE_FILE_H
 #define LUSOSCRIPT_SOURCE_FILE_H
 
+#include <optional>
+#include <ostream>
 #include <string>
 
+#include "arena.hh"
+#include "state.hh"
+
 class SourceFile {
  public:
-  void run(std::string file_path);
+  // Runs the script at `file_path`, writing what it prints to `output` and
+  // its errors to `error_output`. Returns the exit code of the script. The
+  // program is kept in the compiled program cache (see cache.hh).
+  int run(std::string file_path, std::ostream &output,
+          std::ostream &error_output);
+  // Runs the script `source`, like `run()`. If `allocator` is given, the
+  // program is allocated in it.
+  int runSource(std::string source, std::ostream &output,
+                std::ostream &error_output,
+                arena::Arena *allocator = nullptr);
+  // Reads the script at `file_path`, or reports why it cannot to
+  // `error_output`.
+  std::optional<std::string> read(std::string file_path,
+                                  std::ostream &error_output);
+
+ private:
+  // Exit code of a script that ran with `app_state`. Syntax errors are
+  // summarized to `output`.
+  int exitCode(state::AppState &app_state, std::ostream &output);
 };
 
 #endif
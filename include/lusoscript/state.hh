@@ -1,6 +1,9 @@
 #ifndef LUSOSCRIPT_STATE_H
 #define LUSOSCRIPT_STATE_H
 
+#include <iostream>
+#include <ostream>
+
 #include "error.hh"
 
 namespace state {
@@ -10,6 +13,8 @@ struct AppState {
   RunningMode mode;
   std::string source;
   error::ErrorState error;
+  // Destination of what the script prints.
+  std::ostream *output = &std::cout;
 };
 };  // namespace state
 
@@ -0,0 +1,90 @@
+#ifndef LUSOSCRIPT_TASK_RUNTIME_H
+#define LUSOSCRIPT_TASK_RUNTIME_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "error.hh"
+#include "mpmc_queue.hh"
+
+// Worker threads running the tasks started by scripts, fed by a lock-free
+// queue. A task that blocks (on a channel) parks its thread; when every
+// worker is parked, the runtime starts another one, so that queued tasks can
+// still run and unblock the others.
+class TaskRuntime {
+ public:
+  explicit TaskRuntime(int threads);
+  ~TaskRuntime();
+
+  TaskRuntime(const TaskRuntime &) = delete;
+  TaskRuntime &operator=(const TaskRuntime &) = delete;
+
+  // Runtime shared by the whole process, with one worker per hardware thread
+  // to begin with.
+  static TaskRuntime &shared();
+
+  void spawn(std::function<void()> job);
+
+  // Marks the current thread as blocked for as long as it lives. Does nothing
+  // outside the runtime's workers.
+  class BlockingScope {
+   public:
+    BlockingScope();
+    ~BlockingScope();
+
+    BlockingScope(const BlockingScope &) = delete;
+    BlockingScope &operator=(const BlockingScope &) = delete;
+
+   private:
+    TaskRuntime *runtime_;
+  };
+
+ private:
+  MpmcQueue<std::function<void()>> queue_;
+  // Bumped after every push, for idle workers to wait on.
+  std::atomic<std::uint32_t> pushes_;
+  std::atomic<int> workers_;
+  std::atomic<int> blocked_;
+  std::atomic<bool> stopping_;
+  std::mutex threads_mutex_;
+  std::vector<std::thread> threads_;
+
+  void addWorker();
+  void work();
+  bool runOne();
+};
+
+// The tasks started by one program. Failures are kept, so that the program
+// can report the one of the earliest started task.
+class TaskGroup {
+ public:
+  explicit TaskGroup(TaskRuntime &runtime);
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
+
+  void spawn(std::function<error::RuntimeResult<>()> body);
+  // Blocks until every task has finished, and returns the error of the
+  // earliest started task that failed, if any.
+  std::optional<error::RuntimeError> wait();
+
+ private:
+  TaskRuntime &runtime_;
+  std::mutex mutex_;
+  std::condition_variable done_;
+  // Guarded by `mutex_`.
+  std::size_t started_;
+  std::size_t pending_;
+  std::optional<std::size_t> failed_task_;
+  std::optional<error::RuntimeError> failure_;
+};
+
+#endif
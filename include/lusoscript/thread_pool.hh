@@ -0,0 +1,38 @@
+#ifndef LUSOSCRIPT_THREAD_POOL_H
+#define LUSOSCRIPT_THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads running submitted tasks in submission order.
+// The pool can be reused: `wait()` returns once it is idle again.
+class ThreadPool {
+ public:
+  explicit ThreadPool(int threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  void submit(std::function<void()> task);
+  // Blocks until every submitted task has finished.
+  void wait();
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable available_;
+  std::condition_variable idle_;
+  std::deque<std::function<void()>> tasks_;
+  // Tasks submitted and not finished yet.
+  int pending_;
+  bool stopping_;
+  std::vector<std::thread> workers_;
+
+  void work();
+};
+
+#endif
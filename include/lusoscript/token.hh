@@ -1,10 +1,16 @@
 #ifndef LUSOSCRIPT_TOKEN_H
 #define LUSOSCRIPT_TOKEN_H
 
+#include <algorithm>
 #include <any>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
 #include <optional>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <utility>
 
 namespace token {
 enum class TokenType {
@@ -25,12 +31,27 @@ enum class TokenType {
   KW_VERDADEIRO,
   KW_VAR,
   KW_ENQUANTO,
+  KW_PARALELO,
+  KW_REDUZA,
+  KW_TAREFA,
+  KW_CANAL,
+  KW_ENVIE,
+  KW_RECEBA,
+  KW_FECHE,
+  KW_INSTANTANEO,
+  KW_IMPORTE,
+  KW_ESCOLHA,
+  KW_CASO,
+  KW_PADRAO,
+  KW_CONSTANTE,
 
   // Single-character tokens
   SC_OPEN_PAREN,
   SC_CLOSE_PAREN,
   SC_OPEN_CURLY,
   SC_CLOSE_CURLY,
+  SC_OPEN_BRACKET,
+  SC_CLOSE_BRACKET,
   SC_COMMA,
   SC_DOT,
   SC_MINUS,
@@ -50,6 +71,12 @@ enum class TokenType {
   MC_GREATER_EQUAL,
   MC_LESS,
   MC_LESS_EQUAL,
+  MC_PLUS_EQUAL,
+  MC_PLUS_PLUS,
+  MC_MINUS_EQUAL,
+  MC_MINUS_MINUS,
+  MC_STAR_EQUAL,
+  MC_SLASH_EQUAL,
 
   // Literals
   LT_IDENTIFIER,
@@ -59,51 +86,174 @@ enum class TokenType {
   END_OF_FILE,
 };
 
-const std::string KW_E = "e";
-const std::string KW_CLASSE = "classe";
-const std::string KW_SENAO = "senao";
-const std::string KW_FALSO = "falso";
-const std::string KW_FUNCAO = "funcao";
-const std::string KW_PARA = "para";
-const std::string KW_SE = "se";
-const std::string KW_NULO = "nulo";
-const std::string KW_OU = "ou";
-const std::string KW_IMPRIMA = "imprima";
-const std::string KW_RETORNE = "retorne";
-const std::string KW_SUPER = "super";
-const std::string KW_ESSE = "esse";
-const std::string KW_VERDADEIRO = "verdadeiro";
-const std::string KW_VAR = "var";
-const std::string KW_ENQUANTO = "enquanto";
-const std::string SC_OPEN_PAREN = "(";
-const std::string SC_CLOSE_PAREN = ")";
-const std::string SC_OPEN_CURLY = "{";
-const std::string SC_CLOSE_CURLY = "}";
-const std::string SC_COMMA = ",";
-const std::string SC_DOT = ".";
-const std::string SC_MINUS = "-";
-const std::string SC_PLUS = "+";
-const std::string SC_COLON = ":";
-const std::string SC_SEMICOLON = ";";
-const std::string SC_FORWARD_SLASH = "/";
-const std::string SC_STAR = "*";
-const std::string MC_QUESTION = "?";
-const std::string MC_EXCL = "!";
-const std::string MC_EXCL_EQUAL = "!=";
-const std::string MC_EQUAL = "=";
-const std::string MC_EQUAL_EQUAL = "==";
-const std::string MC_GREATER = ">";
-const std::string MC_GREATER_EQUAL = ">=";
-const std::string MC_LESS = "<";
-const std::string MC_LESS_EQUAL = "<=";
-const std::string LT_IDENTIFIER = "identifier";
-const std::string LT_STRING = "string";
-const std::string LT_NUMBER = "number";
-const std::string END_OF_FILE = "EOF";
-
-std::string toString(TokenType token_type);
-
-const std::unordered_map<std::string, TokenType> Keywords = {
+inline constexpr std::string_view KW_E = "e";
+inline constexpr std::string_view KW_CLASSE = "classe";
+inline constexpr std::string_view KW_SENAO = "senao";
+inline constexpr std::string_view KW_FALSO = "falso";
+inline constexpr std::string_view KW_FUNCAO = "funcao";
+inline constexpr std::string_view KW_PARA = "para";
+inline constexpr std::string_view KW_SE = "se";
+inline constexpr std::string_view KW_NULO = "nulo";
+inline constexpr std::string_view KW_OU = "ou";
+inline constexpr std::string_view KW_IMPRIMA = "imprima";
+inline constexpr std::string_view KW_RETORNE = "retorne";
+inline constexpr std::string_view KW_SUPER = "super";
+inline constexpr std::string_view KW_ESSE = "esse";
+inline constexpr std::string_view KW_VERDADEIRO = "verdadeiro";
+inline constexpr std::string_view KW_VAR = "var";
+inline constexpr std::string_view KW_ENQUANTO = "enquanto";
+inline constexpr std::string_view KW_PARALELO = "paralelo";
+inline constexpr std::string_view KW_REDUZA = "reduza";
+inline constexpr std::string_view KW_TAREFA = "tarefa";
+inline constexpr std::string_view KW_CANAL = "canal";
+inline constexpr std::string_view KW_ENVIE = "envie";
+inline constexpr std::string_view KW_RECEBA = "receba";
+inline constexpr std::string_view KW_FECHE = "feche";
+inline constexpr std::string_view KW_INSTANTANEO = "instantaneo";
+inline constexpr std::string_view KW_IMPORTE = "importe";
+inline constexpr std::string_view KW_ESCOLHA = "escolha";
+inline constexpr std::string_view KW_CASO = "caso";
+inline constexpr std::string_view KW_PADRAO = "padrao";
+inline constexpr std::string_view KW_CONSTANTE = "constante";
+inline constexpr std::string_view SC_OPEN_PAREN = "(";
+inline constexpr std::string_view SC_CLOSE_PAREN = ")";
+inline constexpr std::string_view SC_OPEN_CURLY = "{";
+inline constexpr std::string_view SC_CLOSE_CURLY = "}";
+inline constexpr std::string_view SC_OPEN_BRACKET = "[";
+inline constexpr std::string_view SC_CLOSE_BRACKET = "]";
+inline constexpr std::string_view SC_COMMA = ",";
+inline constexpr std::string_view SC_DOT = ".";
+inline constexpr std::string_view SC_MINUS = "-";
+inline constexpr std::string_view SC_PLUS = "+";
+inline constexpr std::string_view SC_COLON = ":";
+inline constexpr std::string_view SC_SEMICOLON = ";";
+inline constexpr std::string_view SC_FORWARD_SLASH = "/";
+inline constexpr std::string_view SC_STAR = "*";
+inline constexpr std::string_view MC_QUESTION = "?";
+inline constexpr std::string_view MC_EXCL = "!";
+inline constexpr std::string_view MC_EXCL_EQUAL = "!=";
+inline constexpr std::string_view MC_EQUAL = "=";
+inline constexpr std::string_view MC_EQUAL_EQUAL = "==";
+inline constexpr std::string_view MC_GREATER = ">";
+inline constexpr std::string_view MC_GREATER_EQUAL = ">=";
+inline constexpr std::string_view MC_LESS = "<";
+inline constexpr std::string_view MC_LESS_EQUAL = "<=";
+inline constexpr std::string_view MC_PLUS_EQUAL = "+=";
+inline constexpr std::string_view MC_PLUS_PLUS = "++";
+inline constexpr std::string_view MC_MINUS_EQUAL = "-=";
+inline constexpr std::string_view MC_MINUS_MINUS = "--";
+inline constexpr std::string_view MC_STAR_EQUAL = "*=";
+inline constexpr std::string_view MC_SLASH_EQUAL = "/=";
+inline constexpr std::string_view LT_IDENTIFIER = "identifier";
+inline constexpr std::string_view LT_STRING = "string";
+inline constexpr std::string_view LT_NUMBER = "number";
+inline constexpr std::string_view END_OF_FILE = "EOF";
+
+inline constexpr std::size_t kTokenTypeCount =
+    static_cast<std::size_t>(TokenType::END_OF_FILE) + 1;
+
+// Printable names indexed by `TokenType`. The order must follow the enum.
+inline constexpr std::array<std::string_view, kTokenTypeCount> kTokenNames = {
+    KW_E,
+    KW_CLASSE,
+    KW_SENAO,
+    KW_FALSO,
+    KW_FUNCAO,
+    KW_PARA,
+    KW_SE,
+    KW_NULO,
+    KW_OU,
+    KW_IMPRIMA,
+    KW_RETORNE,
+    KW_SUPER,
+    KW_ESSE,
+    KW_VERDADEIRO,
+    KW_VAR,
+    KW_ENQUANTO,
+    KW_PARALELO,
+    KW_REDUZA,
+    KW_TAREFA,
+    KW_CANAL,
+    KW_ENVIE,
+    KW_RECEBA,
+    KW_FECHE,
+    KW_INSTANTANEO,
+    KW_IMPORTE,
+    KW_ESCOLHA,
+    KW_CASO,
+    KW_PADRAO,
+    KW_CONSTANTE,
+    SC_OPEN_PAREN,
+    SC_CLOSE_PAREN,
+    SC_OPEN_CURLY,
+    SC_CLOSE_CURLY,
+    SC_OPEN_BRACKET,
+    SC_CLOSE_BRACKET,
+    SC_COMMA,
+    SC_DOT,
+    SC_MINUS,
+    SC_PLUS,
+    SC_COLON,
+    SC_SEMICOLON,
+    SC_FORWARD_SLASH,
+    SC_STAR,
+    MC_QUESTION,
+    MC_EXCL,
+    MC_EXCL_EQUAL,
+    MC_EQUAL,
+    MC_EQUAL_EQUAL,
+    MC_GREATER,
+    MC_GREATER_EQUAL,
+    MC_LESS,
+    MC_LESS_EQUAL,
+    MC_PLUS_EQUAL,
+    MC_PLUS_PLUS,
+    MC_MINUS_EQUAL,
+    MC_MINUS_MINUS,
+    MC_STAR_EQUAL,
+    MC_SLASH_EQUAL,
+    LT_IDENTIFIER,
+    LT_STRING,
+    LT_NUMBER,
+    END_OF_FILE,
+};
+
+static_assert(std::ranges::none_of(kTokenNames,
+                                   [](auto name) { return name.empty(); }),
+              "Every token type must have a name.");
+
+constexpr std::string_view toString(TokenType token_type) {
+  return kTokenNames[static_cast<std::size_t>(token_type)];
+}
+
+// A set of token types stored as a bitset. Sets are cheap to build (also at
+// compile time) and membership is a shift and a mask.
+class TokenSet {
+ public:
+  constexpr TokenSet() = default;
+
+  constexpr TokenSet(std::initializer_list<TokenType> types) {
+    for (const TokenType type : types) {
+      const auto index = static_cast<std::size_t>(type);
+      words_[index / 64] |= std::uint64_t{1} << (index % 64);
+    }
+  }
+
+  constexpr bool contains(TokenType type) const {
+    const auto index = static_cast<std::size_t>(type);
+    return (words_[index / 64] >> (index % 64)) & 1;
+  }
+
+ private:
+  std::array<std::uint64_t, (kTokenTypeCount + 63) / 64> words_{};
+};
+
+struct Keyword {
+  std::string_view text;
+  TokenType type;
+};
+
+inline constexpr Keyword kKeywords[] = {
     {KW_E, TokenType::KW_E},
     {KW_CLASSE, TokenType::KW_CLASSE},
     {KW_SENAO, TokenType::KW_SENAO},
@@ -111,6 +261,7 @@ const std::unordered_map<std::string, TokenType> Keywords = {
     {KW_FUNCAO, TokenType::KW_FUNCAO},
     {KW_PARA, TokenType::KW_PARA},
     {KW_SE, TokenType::KW_SE},
+    {KW_NULO, TokenType::KW_NULO},
     {KW_OU, TokenType::KW_OU},
     {KW_IMPRIMA, TokenType::KW_IMPRIMA},
     {KW_RETORNE, TokenType::KW_RETORNE},
@@ -119,14 +270,97 @@ const std::unordered_map<std::string, TokenType> Keywords = {
     {KW_VERDADEIRO, TokenType::KW_VERDADEIRO},
     {KW_VAR, TokenType::KW_VAR},
     {KW_ENQUANTO, TokenType::KW_ENQUANTO},
+    {KW_PARALELO, TokenType::KW_PARALELO},
+    {KW_REDUZA, TokenType::KW_REDUZA},
+    {KW_TAREFA, TokenType::KW_TAREFA},
+    {KW_CANAL, TokenType::KW_CANAL},
+    {KW_ENVIE, TokenType::KW_ENVIE},
+    {KW_RECEBA, TokenType::KW_RECEBA},
+    {KW_FECHE, TokenType::KW_FECHE},
+    {KW_INSTANTANEO, TokenType::KW_INSTANTANEO},
+    {KW_IMPORTE, TokenType::KW_IMPORTE},
+    {KW_ESCOLHA, TokenType::KW_ESCOLHA},
+    {KW_CASO, TokenType::KW_CASO},
+    {KW_PADRAO, TokenType::KW_PADRAO},
+    {KW_CONSTANTE, TokenType::KW_CONSTANTE},
 };
 
+// Keyword recognition uses a perfect hash computed at compile time: a seeded
+// FNV-1a hash is searched for a seed that sends every keyword to a distinct
+// slot, so a lookup is a single hash, an index and one comparison.
+inline constexpr std::size_t kKeywordTableBits = 6;
+inline constexpr std::size_t kKeywordTableSize = 1 << kKeywordTableBits;
+
+constexpr std::size_t keywordSlot(std::string_view text, std::uint32_t seed) {
+  std::uint32_t hash = 2166136261u ^ seed;
+  for (const char c : text) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+  }
+  return (hash * 2654435769u) >> (32 - kKeywordTableBits);
+}
+
+constexpr std::uint32_t findKeywordSeed() {
+  for (std::uint32_t seed = 0; seed < 100000; seed++) {
+    std::array<bool, kKeywordTableSize> used{};
+    bool collision = false;
+
+    for (const auto &keyword : kKeywords) {
+      const auto slot = keywordSlot(keyword.text, seed);
+      if (used[slot]) {
+        collision = true;
+        break;
+      }
+      used[slot] = true;
+    }
+
+    if (!collision) return seed;
+  }
+
+  return UINT32_MAX;
+}
+
+inline constexpr std::uint32_t kKeywordSeed = findKeywordSeed();
+static_assert(kKeywordSeed != UINT32_MAX, "No perfect hash for the keywords.");
+
+inline constexpr auto kKeywordTable = [] {
+  std::array<Keyword, kKeywordTableSize> table{};
+  for (const auto &keyword : kKeywords) {
+    table[keywordSlot(keyword.text, kKeywordSeed)] = keyword;
+  }
+  return table;
+}();
+
+inline constexpr auto kKeywordLengths = [] {
+  std::pair<std::size_t, std::size_t> lengths{SIZE_MAX, 0};
+  for (const auto &keyword : kKeywords) {
+    lengths.first = std::min(lengths.first, keyword.text.size());
+    lengths.second = std::max(lengths.second, keyword.text.size());
+  }
+  return lengths;
+}();
+
+constexpr std::optional<TokenType> lookupKeyword(std::string_view text) {
+  if (text.size() < kKeywordLengths.first ||
+      text.size() > kKeywordLengths.second) {
+    return std::nullopt;
+  }
+
+  // Empty slots hold an empty text, which never matches an identifier.
+  const auto &entry = kKeywordTable[keywordSlot(text, kKeywordSeed)];
+  if (entry.text != text) return std::nullopt;
+
+  return entry.type;
+}
+
 class Token {
  public:
   TokenType type;
   std::optional<std::string> lexeme;
   std::any literal;
   int line;
+  // Source offsets of the lexeme, as [start, end).
+  int start = 0;
+  int end = 0;
 
   std::string toString();
 };
@@ -0,0 +1,68 @@
+#ifndef LUSOSCRIPT_WORK_STEALING_POOL_H
+#define LUSOSCRIPT_WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread pool for data-parallel loops. Each worker owns a deque of index
+// ranges: it splits its range in halves, keeps working on the first half and
+// pushes the second one to the back of its deque, while idle workers steal
+// from the front of the others' deques, where the largest ranges are.
+class WorkStealingPool {
+ public:
+  explicit WorkStealingPool(int threads);
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool &) = delete;
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+  // Pool shared by the whole process, with one worker per hardware thread.
+  static WorkStealingPool &shared();
+
+  // Calls `body(i)` for every `i` in [0, count) and returns once all calls
+  // are done. The calling thread runs jobs too while it waits.
+  void parallelFor(std::size_t count,
+                   const std::function<void(std::size_t)> &body);
+
+ private:
+  struct Group {
+    const std::function<void(std::size_t)> *body;
+    // Calls not finished yet, guarded by `mutex`.
+    std::size_t remaining;
+    std::mutex mutex;
+    std::condition_variable done;
+  };
+
+  struct Job {
+    Group *group;
+    std::size_t begin;
+    std::size_t end;
+  };
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+  };
+
+  // One queue per worker, plus a last one shared by outside threads.
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  std::atomic<std::size_t> queued_;
+  bool stopping_;
+
+  void work(std::size_t index);
+  bool runOne(std::size_t index);
+  void execute(Job job, std::size_t index);
+  void push(std::size_t index, Job job);
+};
+
+#endif
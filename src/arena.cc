@@ -1,13 +1,27 @@
 #include "lusoscript/arena.hh"
 
+#include <algorithm>
+
 arena::Arena::Arena(std::size_t size)
-    : buffer_(static_cast<char *>(::operator new(size))),
-      capacity_(size),
-      offset_(0) {}
+    : first_(newBlock(nullptr, size)),
+      current_(first_),
+      offset_(sizeof(BlockHeader)) {}
 
 arena::Arena::~Arena() {
+  reset();
+  ::operator delete(first_);
+}
+
+void arena::Arena::reset() {
   callDestructors();
-  ::operator delete(buffer_);
+
+  while (current_ != first_) {
+    BlockHeader *prev = current_->prev;
+    ::operator delete(current_);
+    current_ = prev;
+  }
+
+  offset_ = sizeof(BlockHeader);
 }
 
 void arena::Arena::callDestructors() {
@@ -17,21 +31,46 @@ void arena::Arena::callDestructors() {
   }
 }
 
+// Returns memory of `size` bytes with specified `alignment`, chaining a new
+// block if the current one is exhausted.
+void *arena::Arena::allocate(std::size_t size, std::size_t alignment) {
+  if (void *ptr = allocateInBlock(size, alignment)) return ptr;
+
+  // The new block is large enough for the request even in the worst
+  // alignment case.
+  const std::size_t capacity =
+      std::max(first_->capacity, sizeof(BlockHeader) + size + alignment);
+
+  current_ = newBlock(current_, capacity);
+  offset_ = sizeof(BlockHeader);
+
+  return allocateInBlock(size, alignment);
+}
+
 // Checks if there's memory of `size` bytes with specified `alignment`
-// available.
-std::pair<void *, std::size_t> arena::Arena::allocate(std::size_t curr_offset,
-                                                      std::size_t size,
-                                                      std::size_t alignment) {
-  char *current_ptr = buffer_ + curr_offset;
-  std::size_t space = capacity_ - curr_offset;
-  void *aligned_ptr = current_ptr;
+// available in the current block.
+void *arena::Arena::allocateInBlock(std::size_t size, std::size_t alignment) {
+  char *buffer = reinterpret_cast<char *>(current_);
+  std::size_t space = current_->capacity - offset_;
+  void *aligned_ptr = buffer + offset_;
 
   // Align the pointer to the specified alignment.
   if (std::align(alignment, size, aligned_ptr, space) == nullptr) {
-    throw std::bad_alloc();
+    return nullptr;
   }
 
-  auto new_offset = static_cast<char *>(aligned_ptr) - buffer_ + size;
+  offset_ = static_cast<char *>(aligned_ptr) - buffer + size;
+
+  return aligned_ptr;
+}
+
+arena::Arena::BlockHeader *arena::Arena::newBlock(BlockHeader *prev,
+                                                  std::size_t capacity) {
+  capacity = std::max(capacity, sizeof(BlockHeader));
+
+  auto *block = static_cast<BlockHeader *>(::operator new(capacity));
+  block->prev = prev;
+  block->capacity = capacity;
 
-  return {aligned_ptr, new_offset};
+  return block;
 }
@@ -0,0 +1,75 @@
+#include "lusoscript/array.hh"
+
+#include <utility>
+
+Array::Ref Array::create(std::vector<std::any> values) {
+  for (const std::any &value : values) {
+    if (value.type() != typeid(float)) {
+      return Ref::adopt(new Array(std::move(values)));
+    }
+  }
+
+  std::vector<float> numbers;
+  numbers.reserve(values.size());
+
+  for (const std::any &value : values) {
+    numbers.push_back(std::any_cast<float>(value));
+  }
+
+  return create(std::move(numbers));
+}
+
+Array::Ref Array::create(std::vector<float> numbers) {
+  return Ref::adopt(new Array(std::move(numbers)));
+}
+
+std::size_t Array::size() const {
+  return packed_ ? numbers_.size() : values_.size();
+}
+
+std::any Array::get(std::size_t index) const {
+  if (packed_) return numbers_[index];
+  return values_[index];
+}
+
+void Array::set(std::size_t index, std::any value) {
+  if (packed_) {
+    if (const auto *number = std::any_cast<float>(&value)) {
+      numbers_[index] = *number;
+      return;
+    }
+
+    unpack();
+  }
+
+  values_[index] = std::move(value);
+}
+
+void Array::append(std::any value) {
+  if (packed_) {
+    if (const auto *number = std::any_cast<float>(&value)) {
+      numbers_.push_back(*number);
+      return;
+    }
+
+    unpack();
+  }
+
+  values_.push_back(std::move(value));
+}
+
+Array::Array(std::vector<float> numbers)
+    : packed_(true), numbers_(std::move(numbers)) {}
+
+Array::Array(std::vector<std::any> values)
+    : packed_(false), values_(std::move(values)) {}
+
+// An array does not go back to being packed when it holds numbers only again,
+// which would mean checking every element on each store.
+void Array::unpack() {
+  values_.reserve(numbers_.size() + 1);
+  for (const float number : numbers_) values_.emplace_back(number);
+
+  numbers_ = {};
+  packed_ = false;
+}
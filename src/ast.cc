@@ -19,6 +19,24 @@ std::string ast::AstPrinter::print(const Expr &expression) {
       printer.output_.append(")");
     }
 
+    void operator()(const Update &update) {
+      printer.output_.append("(");
+
+      printer.output_.append(token::toString(update.opr.type));
+      printer.output_.append(" ");
+      printer.output_.append(update.name.lexeme.value());
+
+      if (update.value != nullptr) {
+        printer.output_.append("[");
+        printer.print(*update.value);
+        printer.output_.append("]");
+      } else if (update.postfix) {
+        printer.output_.append(" postfix");
+      }
+
+      printer.output_.append(")");
+    }
+
     void operator()(const Ternary &ternary) {
       printer.output_.append("(");
 
@@ -113,6 +131,138 @@ std::string ast::AstPrinter::print(const Expr &expression) {
       printer.output_.append(")");
     }
 
+    void operator()(const Call &call) {
+      printer.output_.append("(");
+
+      printer.output_.append("call");
+      printer.output_.append(" ");
+      printer.print(*call.callee);
+
+      for (const auto &argument : call.arguments) {
+        printer.output_.append(" ");
+        printer.print(*argument);
+      }
+
+      printer.output_.append(")");
+    }
+
+    void operator()(const Canal &canal) {
+      printer.output_.append("(");
+
+      printer.output_.append(token::KW_CANAL);
+      printer.output_.append(" ");
+      printer.output_.append(canal.type.lexeme.value());
+
+      if (canal.capacity.has_value()) {
+        printer.output_.append(" ");
+        printer.print(*canal.capacity.value());
+      }
+
+      printer.output_.append(")");
+    }
+
+    void operator()(const Receba &receba) {
+      printer.output_.append("(");
+
+      printer.output_.append(token::KW_RECEBA);
+      printer.output_.append(" ");
+      printer.print(*receba.channel);
+
+      printer.output_.append(")");
+    }
+
+    void operator()(const Get &get) {
+      printer.output_.append("(");
+
+      printer.output_.append("get");
+      printer.output_.append(" ");
+      printer.print(*get.object);
+      printer.output_.append(" ");
+      printer.output_.append(get.name.lexeme.value());
+
+      printer.output_.append(")");
+    }
+
+    void operator()(const Set &set) {
+      printer.output_.append("(");
+
+      printer.output_.append("set");
+      printer.output_.append(" ");
+      printer.print(*set.object);
+      printer.output_.append(" ");
+      printer.output_.append(set.name.lexeme.value());
+      printer.output_.append(" ");
+      printer.print(*set.value);
+
+      printer.output_.append(")");
+    }
+
+    void operator()(const Esse &) { printer.output_.append(token::KW_ESSE); }
+
+    void operator()(const Super &super) {
+      printer.output_.append("(");
+
+      printer.output_.append(token::KW_SUPER);
+      printer.output_.append(" ");
+      printer.output_.append(super.method.lexeme.value());
+
+      printer.output_.append(")");
+    }
+
+    void operator()(const ArrayLiteral &array) {
+      printer.output_.append("(");
+
+      printer.output_.append("array");
+
+      for (const auto &element : array.elements) {
+        printer.output_.append(" ");
+        printer.print(*element);
+      }
+
+      printer.output_.append(")");
+    }
+
+    void operator()(const DictionaryLiteral &dictionary) {
+      printer.output_.append("(");
+
+      printer.output_.append("dictionary");
+
+      for (std::size_t i = 0; i < dictionary.keys.size(); i++) {
+        printer.output_.append(" ");
+        printer.print(*dictionary.keys[i]);
+        printer.output_.append(" ");
+        printer.print(*dictionary.values[i]);
+      }
+
+      printer.output_.append(")");
+    }
+
+    void operator()(const Index &index) {
+      printer.output_.append("(");
+
+      printer.output_.append("index");
+      printer.output_.append(" ");
+      printer.print(*index.object);
+      printer.output_.append(" ");
+      printer.print(*index.index);
+
+      printer.output_.append(")");
+    }
+
+    void operator()(const SetIndex &set) {
+      printer.output_.append("(");
+
+      printer.output_.append("set-index");
+      printer.output_.append(" ");
+      printer.print(*set.object);
+      printer.output_.append(" ");
+      printer.print(*set.index);
+      printer.output_.append(" ");
+      printer.print(*set.value);
+
+      printer.output_.append(")");
+    }
+
     void operator()(const ErrorExpr &error) {
       printer.output_.append("(");
 
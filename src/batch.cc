@@ -0,0 +1,68 @@
+#include "lusoscript/batch.hh"
+
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+#include "lusoscript/source_file.hh"
+#include "lusoscript/thread_pool.hh"
+
+Batch::Batch(int jobs) : jobs_(jobs) {}
+
+int Batch::run(const std::vector<std::string> &file_paths) {
+  struct Script {
+    std::ostringstream output;
+    std::ostringstream error_output;
+    int exit_code = 0;
+    bool done = false;
+  };
+
+  std::vector<Script> scripts(file_paths.size());
+  std::mutex mutex;
+  std::condition_variable finished;
+
+  ThreadPool pool(jobs_);
+
+  for (std::size_t i = 0; i < file_paths.size(); i++) {
+    pool.submit([&, i] {
+      Script &script = scripts[i];
+
+      SourceFile source_file;
+      const int exit_code = source_file.run(file_paths[i], script.output,
+                                            script.error_output);
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        script.exit_code = exit_code;
+        script.done = true;
+      }
+
+      finished.notify_all();
+    });
+  }
+
+  int exit_code = EXIT_SUCCESS;
+
+  // Flushes each script as soon as it and all the ones before it are done.
+  for (std::size_t i = 0; i < scripts.size(); i++) {
+    Script &script = scripts[i];
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      finished.wait(lock, [&script] { return script.done; });
+    }
+
+    std::cout << script.output.view() << std::flush;
+    std::cerr << script.error_output.view() << file_paths[i]
+              << ": exit code " << script.exit_code << std::endl;
+
+    if (exit_code == EXIT_SUCCESS) exit_code = script.exit_code;
+
+    // The buffers are no longer needed.
+    script.output = std::ostringstream();
+    script.error_output = std::ostringstream();
+  }
+
+  return exit_code;
+}
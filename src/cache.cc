@@ -0,0 +1,1416 @@
+#include "lusoscript/cache.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unordered_map>
+
+#include "lusoscript/array.hh"
+#include "lusoscript/case_table.hh"
+#include "lusoscript/channel.hh"
+#include "lusoscript/dictionary.hh"
+#include "lusoscript/native.hh"
+#include "lusoscript/object.hh"
+#include "lusoscript/parser.hh"
+#include "lusoscript/range.hh"
+
+namespace {
+constexpr char kProgramMagic[] = {'L', 'U', 'S', 'C'};
+constexpr char kSnapshotMagic[] = {'L', 'U', 'S', 'N'};
+// Bump whenever the encoding changes in a way the fingerprint cannot see.
+constexpr std::uint32_t kVersion = 7;
+// Magic, version, fingerprint, key and checksum.
+constexpr std::size_t kHeaderSize = 28;
+
+// Changes with the token types and the node types, so that files written by
+// other builds of the interpreter are not misread.
+constexpr std::uint32_t kFingerprint =
+    static_cast<std::uint32_t>(token::kTokenTypeCount) << 16 |
+    static_cast<std::uint32_t>(
+        std::variant_size_v<decltype(ast::Expr::var)>)
+        << 8 |
+    static_cast<std::uint32_t>(std::variant_size_v<decltype(ast::Stmt::var)>);
+
+// Index of `T` among the alternatives of `Variant`, which is how nodes are
+// tagged in the file.
+template <typename T, typename Variant>
+struct IndexOf;
+
+template <typename T, typename... Types>
+struct IndexOf<T, std::variant<Types...>> {
+  static constexpr std::uint64_t value = [] {
+    std::uint64_t index = 0;
+    (void)((std::is_same_v<T, Types> || (index++, false)) || ...);
+    return index;
+  }();
+};
+
+template <typename T>
+constexpr std::uint64_t kExprTag = IndexOf<T, decltype(ast::Expr::var)>::value;
+
+template <typename T>
+constexpr std::uint64_t kStmtTag = IndexOf<T, decltype(ast::Stmt::var)>::value;
+
+// Arrays and dictionaries nested deeper than this are not stored, rather
+// than overflowing the stack when written or read.
+constexpr int kMaxValueDepth = 256;
+
+// Tags of the values of `std::any` literals, and of the global variables of
+// snapshots.
+enum class ValueTag : std::uint8_t {
+  NONE,
+  NULO,
+  BOOLEAN,
+  NUMBER,
+  STRING,
+  UNINITIALIZED,
+  ARRAY,
+  DICTIONARY,
+  RANGE,
+  // An array or a dictionary written before, by its index among them, so
+  // that values shared by several variables, or holding themselves, stay so.
+  REFERENCE,
+};
+
+// Writes integers in little-endian order, whatever the byte order of the
+// machine.
+class Writer {
+ public:
+  std::string data;
+  // Set when a value cannot be written.
+  bool failed = false;
+  // What the value that could not be written is, such as "a channel".
+  std::string unstorable;
+
+  void integer(std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+      data.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+  }
+
+  void text(const std::string &value) {
+    integer(value.size(), 4);
+    data.append(value);
+  }
+
+  void value(const std::any &value) {
+    if (!value.has_value()) {
+      integer(static_cast<std::uint8_t>(ValueTag::NONE), 1);
+    } else if (value.type() == typeid(std::nullptr_t)) {
+      integer(static_cast<std::uint8_t>(ValueTag::NULO), 1);
+    } else if (const auto *boolean = std::any_cast<bool>(&value)) {
+      integer(static_cast<std::uint8_t>(ValueTag::BOOLEAN), 1);
+      integer(*boolean, 1);
+    } else if (const auto *number = std::any_cast<float>(&value)) {
+      integer(static_cast<std::uint8_t>(ValueTag::NUMBER), 1);
+      this->number(*number);
+    } else if (const auto *str = std::any_cast<std::string>(&value)) {
+      integer(static_cast<std::uint8_t>(ValueTag::STRING), 1);
+      text(*str);
+    } else if (value.type() == typeid(env::Uninitialized)) {
+      integer(static_cast<std::uint8_t>(ValueTag::UNINITIALIZED), 1);
+    } else if (const auto *range = std::any_cast<Range::Ref>(&value)) {
+      integer(static_cast<std::uint8_t>(ValueTag::RANGE), 1);
+      this->number((*range)->getStart());
+      this->number((*range)->getEnd());
+      this->number((*range)->getStep());
+    } else if (const auto *array = std::any_cast<Array::Ref>(&value)) {
+      container(array->get(), [&] {
+        integer(static_cast<std::uint8_t>(ValueTag::ARRAY), 1);
+        integer((*array)->size(), 4);
+
+        for (std::size_t i = 0; i < (*array)->size(); i++) {
+          this->value((*array)->get(i));
+        }
+      });
+    } else if (const auto *dictionary =
+                   std::any_cast<Dictionary::Ref>(&value)) {
+      container(dictionary->get(), [&] {
+        integer(static_cast<std::uint8_t>(ValueTag::DICTIONARY), 1);
+        integer((*dictionary)->size(), 4);
+
+        (*dictionary)->forEach([&](const Dictionary::Key &key,
+                                   const std::any &entry) {
+          this->value(Dictionary::toValue(key));
+          this->value(entry);
+        });
+      });
+    } else {
+      fail(value);
+    }
+  }
+
+  void number(float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    integer(bits, 4);
+  }
+
+  // Writes `container` with `write`, the first time, and as a reference to
+  // that afterwards.
+  template <typename Write>
+  void container(const Container *container, Write write) {
+    if (const auto found = containers_.find(container);
+        found != containers_.end()) {
+      integer(static_cast<std::uint8_t>(ValueTag::REFERENCE), 1);
+      integer(found->second, 4);
+      return;
+    }
+
+    if (depth_ == kMaxValueDepth) {
+      failed = true;
+      unstorable = "arrays or dictionaries nested too deeply";
+      return;
+    }
+
+    containers_.emplace(container, containers_.size());
+
+    depth_++;
+    write();
+    depth_--;
+  }
+
+  void fail(const std::any &value) {
+    if (!failed) {
+      if (value.type() == typeid(std::shared_ptr<Channel>)) {
+        unstorable = "a channel";
+      } else if (value.type() == typeid(Instance::Ref)) {
+        unstorable = "an instance";
+      } else if (value.type() == typeid(Class::Ref)) {
+        unstorable = "a class";
+      } else {
+        unstorable = "a function";
+      }
+    }
+
+    failed = true;
+  }
+
+  // Magic, version and fingerprint, then `key`, then room for the checksum
+  // `seal()` writes.
+  void header(const char (&magic)[4], std::uint64_t key) {
+    data.append(magic, sizeof(magic));
+    integer(kVersion, 4);
+    integer(kFingerprint, 4);
+    integer(key, 8);
+    integer(0, 8);
+  }
+
+  // Writes the checksum of what follows the header into it, once everything
+  // else is written.
+  void seal() {
+    const std::uint64_t checksum =
+        cache::key(std::string_view(data).substr(kHeaderSize));
+
+    for (std::size_t i = 0; i < 8; i++) {
+      data[kHeaderSize - 8 + i] =
+          static_cast<char>((checksum >> (8 * i)) & 0xFF);
+    }
+  }
+
+  void token(const token::Token &token) {
+    integer(static_cast<std::uint8_t>(token.type), 1);
+    integer(token.lexeme.has_value(), 1);
+    if (token.lexeme.has_value()) text(token.lexeme.value());
+    value(token.literal);
+    integer(static_cast<std::uint32_t>(token.line), 4);
+    integer(static_cast<std::uint32_t>(token.start), 4);
+    integer(static_cast<std::uint32_t>(token.end), 4);
+  }
+
+  // Slots are -1 for globals.
+  void slot(int slot) { integer(static_cast<std::uint32_t>(slot), 4); }
+
+  void binding(const ast::Binding &binding) {
+    integer(static_cast<std::uint8_t>(binding.kind), 1);
+    slot(binding.index);
+  }
+
+  // Null nodes are written as a lone 0, and others after a 1.
+  void expr(const ast::Expr *expr) {
+    integer(expr != nullptr, 1);
+    if (expr == nullptr) return;
+
+    integer(expr->var.index(), 1);
+
+    struct Visitor {
+      Writer &writer;
+
+      void operator()(const ast::Assign &assign) {
+        writer.token(assign.name);
+        writer.expr(assign.value.get());
+        writer.binding(assign.binding);
+      }
+
+      void operator()(const ast::Update &update) {
+        writer.token(update.name);
+        writer.token(update.opr);
+        writer.integer(static_cast<std::uint8_t>(update.operation), 1);
+        writer.expr(update.value.get());
+        writer.integer(update.postfix, 1);
+        writer.binding(update.binding);
+      }
+
+      void operator()(const ast::Ternary &ternary) {
+        writer.expr(ternary.condition.get());
+        writer.token(ternary.then_opr);
+        writer.expr(ternary.then_expr.get());
+        writer.token(ternary.else_opr);
+        writer.expr(ternary.else_expr.get());
+      }
+
+      void operator()(const ast::Binary &binary) {
+        writer.expr(binary.left.get());
+        writer.token(binary.opr);
+        writer.expr(binary.right.get());
+      }
+
+      void operator()(const ast::Grouping &grouping) {
+        writer.expr(grouping.expression.get());
+      }
+
+      void operator()(const ast::Literal &literal) {
+        writer.integer(static_cast<std::uint8_t>(literal.token_type), 1);
+        writer.value(literal.value);
+      }
+
+      void operator()(const ast::Logical &logical) {
+        writer.expr(logical.left.get());
+        writer.token(logical.opr);
+        writer.expr(logical.right.get());
+      }
+
+      void operator()(const ast::Unary &unary) {
+        writer.token(unary.opr);
+        writer.expr(unary.right.get());
+      }
+
+      void operator()(const ast::Variable &variable) {
+        writer.token(variable.name);
+        writer.binding(variable.binding);
+      }
+
+      void operator()(const ast::Call &call) {
+        writer.expr(call.callee.get());
+        writer.token(call.paren);
+        writer.integer(call.arguments.size(), 4);
+        for (const auto &argument : call.arguments) writer.expr(argument.get());
+      }
+
+      void operator()(const ast::Canal &canal) {
+        writer.token(canal.keyword);
+        writer.token(canal.type);
+        writer.expr(canal.capacity.has_value() ? canal.capacity->get()
+                                               : nullptr);
+      }
+
+      void operator()(const ast::Receba &receba) {
+        writer.token(receba.keyword);
+        writer.expr(receba.channel.get());
+      }
+
+      void operator()(const ast::Get &get) {
+        writer.expr(get.object.get());
+        writer.token(get.name);
+      }
+
+      void operator()(const ast::Set &set) {
+        writer.expr(set.object.get());
+        writer.token(set.name);
+        writer.expr(set.value.get());
+      }
+
+      void operator()(const ast::Esse &esse) {
+        writer.token(esse.keyword);
+        writer.binding(esse.binding);
+      }
+
+      void operator()(const ast::Super &super) {
+        writer.token(super.keyword);
+        writer.token(super.method);
+        writer.binding(super.binding);
+        writer.binding(super.receiver);
+      }
+
+      void operator()(const ast::ArrayLiteral &array) {
+        writer.token(array.bracket);
+        writer.integer(array.elements.size(), 4);
+        for (const auto &element : array.elements) writer.expr(element.get());
+      }
+
+      void operator()(const ast::DictionaryLiteral &dictionary) {
+        writer.token(dictionary.curly);
+        writer.integer(dictionary.keys.size(), 4);
+
+        for (std::size_t i = 0; i < dictionary.keys.size(); i++) {
+          writer.expr(dictionary.keys[i].get());
+          writer.expr(dictionary.values[i].get());
+        }
+      }
+
+      void operator()(const ast::Index &index) {
+        writer.expr(index.object.get());
+        writer.token(index.bracket);
+        writer.expr(index.index.get());
+      }
+
+      void operator()(const ast::SetIndex &set) {
+        writer.expr(set.object.get());
+        writer.token(set.bracket);
+        writer.expr(set.index.get());
+        writer.expr(set.value.get());
+      }
+
+      void operator()(const ast::ErrorExpr &error_expr) {
+        writer.expr(error_expr.expr.get());
+      }
+    };
+    std::visit(Visitor{.writer = *this}, expr->var);
+  }
+
+  void stmt(const ast::Stmt *stmt) {
+    // Lazy blocks are written parsed, since the tokens they refer to are not.
+    if (stmt != nullptr) {
+      if (const auto *lazy = std::get_if<ast::LazyBlock>(&stmt->var)) {
+        stmt = &lazy->parser->parseLazyBlock(*lazy);
+      }
+    }
+
+    integer(stmt != nullptr, 1);
+    if (stmt == nullptr) return;
+
+    integer(stmt->var.index(), 1);
+
+    struct Visitor {
+      Writer &writer;
+
+      void operator()(const ast::Block &block) {
+        writer.integer(block.stmts.size(), 4);
+        for (const auto &stmt : block.stmts) writer.stmt(stmt.get());
+      }
+
+      void operator()(const ast::Expression &expression) {
+        writer.expr(expression.expression.get());
+      }
+
+      void operator()(const ast::Imprima &imprima) {
+        writer.expr(imprima.expression.get());
+      }
+
+      void operator()(const ast::Var &var) {
+        writer.token(var.name);
+        writer.expr(var.initializer.has_value() ? var.initializer->get()
+                                                : nullptr);
+        writer.integer(var.constant, 1);
+        writer.slot(var.slot);
+      }
+
+      void operator()(const ast::If &if_stmt) {
+        writer.expr(if_stmt.condition.get());
+        writer.stmt(if_stmt.then_branch.get());
+        writer.stmt(if_stmt.else_branch.has_value()
+                        ? if_stmt.else_branch->get()
+                        : nullptr);
+      }
+
+      void operator()(const ast::While &while_stmt) {
+        writer.expr(while_stmt.condition.get());
+        writer.stmt(while_stmt.body.get());
+      }
+
+      void operator()(const ast::LazyBlock &) {}
+
+      void operator()(const ast::ParallelFor &loop) {
+        writer.token(loop.keyword);
+        writer.token(loop.variable);
+        writer.expr(loop.start.get());
+        writer.expr(loop.end.get());
+        writer.integer(loop.inclusive, 1);
+        writer.expr(loop.step.get());
+        writer.integer(loop.reductions.size(), 4);
+
+        for (const auto &reduction : loop.reductions) {
+          writer.integer(static_cast<std::uint8_t>(reduction.kind), 1);
+          writer.token(reduction.target);
+          writer.binding(reduction.binding);
+        }
+
+        writer.slot(loop.slot);
+        writer.stmt(loop.body.get());
+      }
+
+      void operator()(const ast::ForEach &loop) {
+        writer.token(loop.keyword);
+        writer.token(loop.variable);
+        writer.expr(loop.source.get());
+        writer.slot(loop.slot);
+        writer.stmt(loop.body.get());
+      }
+
+      // The table is built again from the labels when read.
+      void operator()(const ast::Escolha &escolha) {
+        writer.token(escolha.keyword);
+        writer.expr(escolha.value.get());
+        writer.integer(escolha.bodies.size(), 4);
+
+        for (std::size_t i = 0; i < escolha.bodies.size(); i++) {
+          writer.integer(escolha.labels[i].size(), 4);
+          for (const auto &label : escolha.labels[i]) writer.value(label);
+          writer.stmt(escolha.bodies[i].get());
+        }
+
+        writer.slot(escolha.fallback);
+      }
+
+      void operator()(const ast::Tarefa &tarefa) {
+        writer.token(tarefa.keyword);
+        writer.stmt(tarefa.body.get());
+      }
+
+      void operator()(const ast::Envie &envie) {
+        writer.token(envie.keyword);
+        writer.expr(envie.channel.get());
+        writer.expr(envie.value.get());
+      }
+
+      void operator()(const ast::Feche &feche) {
+        writer.token(feche.keyword);
+        writer.expr(feche.channel.get());
+      }
+
+      void operator()(const ast::Instantaneo &instantaneo) {
+        writer.token(instantaneo.keyword);
+      }
+
+      void operator()(const ast::Importe &importe) {
+        writer.token(importe.keyword);
+        writer.token(importe.path);
+      }
+
+      // The slots of a function, and of a class, come before its body, in
+      // which they are declared already.
+      void operator()(const ast::Function &function) {
+        writer.integer(static_cast<std::uint8_t>(function.kind), 1);
+        writer.token(function.name);
+        writer.slot(function.slot);
+        writer.integer(function.params.size(), 4);
+        for (const auto &param : function.params) writer.token(param);
+        writer.integer(function.body.size(), 4);
+        for (const auto &stmt : function.body) writer.stmt(stmt.get());
+        writer.integer(static_cast<std::uint32_t>(function.frame_size), 4);
+        writer.integer(function.captures.size(), 4);
+
+        for (const auto &capture : function.captures) {
+          writer.integer(capture.local, 1);
+          writer.slot(capture.index);
+        }
+      }
+
+      void operator()(const ast::Retorne &retorne) {
+        writer.token(retorne.keyword);
+        writer.expr(retorne.value.has_value() ? retorne.value->get()
+                                              : nullptr);
+      }
+
+      void operator()(const ast::Classe &klass) {
+        writer.token(klass.name);
+        writer.expr(klass.superclass.has_value() ? klass.superclass->get()
+                                                 : nullptr);
+        writer.slot(klass.slot);
+        writer.slot(klass.super_slot);
+        writer.integer(klass.methods.size(), 4);
+        for (const auto &method : klass.methods) (*this)(method);
+      }
+
+      void operator()(const ast::ErrorStmt &error_stmt) {
+        writer.token(error_stmt.token);
+      }
+    };
+    std::visit(Visitor{.writer = *this}, stmt->var);
+  }
+
+ private:
+  // The arrays and dictionaries written so far, by index.
+  std::unordered_map<const Container *, std::uint32_t> containers_;
+  int depth_ = 0;
+};
+
+// Rebuilds the nodes written by `Writer` in an arena, which is only needed to
+// read nodes. Reading past the end, an unexpected tag or a slot out of the
+// frame it refers to makes the reader fail, after which it only returns
+// placeholder values.
+class Reader {
+ public:
+  explicit Reader(std::string_view data, arena::Arena *allocator = nullptr)
+      : data_(data),
+        offset_(0),
+        failed_(false),
+        allocator_(allocator),
+        frames_(1) {}
+
+  [[nodiscard]] bool failed() const { return failed_; }
+  [[nodiscard]] bool atEnd() const { return offset_ == data_.size(); }
+
+  std::uint64_t integer(int bytes) {
+    if (failed_ || data_.size() - offset_ < static_cast<std::size_t>(bytes)) {
+      failed_ = true;
+      return 0;
+    }
+
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+      value |= static_cast<std::uint64_t>(
+                   static_cast<unsigned char>(data_[offset_ + i]))
+               << (8 * i);
+    }
+    offset_ += bytes;
+
+    return value;
+  }
+
+  // A count of items taking at least a byte each, checked against what is
+  // left to read.
+  std::size_t count() {
+    const std::uint64_t value = integer(4);
+    if (value > data_.size() - offset_) failed_ = true;
+
+    return failed_ ? 0 : value;
+  }
+
+  std::string text() {
+    const std::size_t length = count();
+    if (failed_) return {};
+
+    std::string value(data_.substr(offset_, length));
+    offset_ += length;
+
+    return value;
+  }
+
+  std::any value() {
+    switch (static_cast<ValueTag>(integer(1))) {
+      case ValueTag::NONE:
+        return {};
+      case ValueTag::NULO:
+        return nullptr;
+      case ValueTag::BOOLEAN:
+        return integer(1) != 0;
+      case ValueTag::NUMBER:
+        return number();
+      case ValueTag::STRING:
+        return text();
+      case ValueTag::UNINITIALIZED:
+        return env::Uninitialized{};
+      case ValueTag::RANGE: {
+        const float start = number();
+        const float end = number();
+        const float step = number();
+
+        if (failed_ || !std::isfinite(start) || !std::isfinite(end) ||
+            !std::isfinite(step) || step == 0.f) {
+          failed_ = true;
+          return {};
+        }
+
+        return Range::create(start, end, step);
+      }
+      case ValueTag::ARRAY: {
+        if (depth_ == kMaxValueDepth) break;
+
+        auto array = Array::create(std::vector<float>{});
+        containers_.emplace_back(array);
+
+        depth_++;
+        for (std::size_t i = count(); i > 0 && !failed_; i--) {
+          array->append(value());
+        }
+        depth_--;
+
+        return array;
+      }
+      case ValueTag::DICTIONARY: {
+        if (depth_ == kMaxValueDepth) break;
+
+        auto dictionary = Dictionary::create();
+        containers_.emplace_back(dictionary);
+
+        depth_++;
+        for (std::size_t i = count(); i > 0 && !failed_; i--) {
+          const auto key = Dictionary::toKey(value());
+          if (!key.has_value()) failed_ = true;
+
+          std::any entry = value();
+          if (!failed_) dictionary->insert(key.value(), std::move(entry));
+        }
+        depth_--;
+
+        return dictionary;
+      }
+      case ValueTag::REFERENCE: {
+        const std::uint64_t index = integer(4);
+        if (failed_ || index >= containers_.size()) break;
+
+        return containers_[index];
+      }
+      default:
+        break;
+    }
+
+    failed_ = true;
+    return {};
+  }
+
+  float number() {
+    const auto bits = static_cast<std::uint32_t>(integer(4));
+    float number;
+    std::memcpy(&number, &bits, sizeof(number));
+    return number;
+  }
+
+  // Whether the header written by `Writer::header()` matches.
+  bool header(const char (&magic)[4], std::uint64_t key) {
+    if (data_.substr(offset_, sizeof(magic)) !=
+        std::string_view(magic, sizeof(magic))) {
+      return false;
+    }
+    offset_ += sizeof(magic);
+
+    if (integer(4) != kVersion || integer(4) != kFingerprint ||
+        integer(8) != key) {
+      return false;
+    }
+
+    const std::uint64_t checksum = integer(8);
+
+    return !failed_ && checksum == cache::key(data_.substr(offset_));
+  }
+
+  token::TokenType tokenType() {
+    const std::uint64_t type = integer(1);
+    if (type >= token::kTokenTypeCount) failed_ = true;
+
+    return failed_ ? token::TokenType::END_OF_FILE
+                   : static_cast<token::TokenType>(type);
+  }
+
+  int slot() { return static_cast<std::int32_t>(integer(4)); }
+
+  // The slot of a variable being declared in the frame being read: the one
+  // past those declared so far at most, or -1 for a global of the script.
+  int declaration() {
+    const int slot = this->slot();
+    Frame &frame = frames_.back();
+
+    if (slot < (frames_.size() == 1 ? -1 : 0) || slot > frame.declared) {
+      failed_ = true;
+    } else {
+      frame.declared = std::max(frame.declared, slot + 1);
+    }
+
+    return slot;
+  }
+
+  ast::Binding binding() {
+    const std::uint64_t kind = integer(1);
+    if (kind > static_cast<std::uint8_t>(ast::Binding::Kind::CAPTURED)) {
+      failed_ = true;
+    }
+
+    const ast::Binding binding{.kind = static_cast<ast::Binding::Kind>(kind),
+                               .index = slot()};
+    refer(binding.kind, binding.index);
+
+    return binding;
+  }
+
+  // Checks a variable of the frame being read: a local is one of the slots
+  // declared so far, and a captured variable one of the captures of the
+  // function, which come after its body.
+  void refer(ast::Binding::Kind kind, int index) {
+    Frame &frame = frames_.back();
+
+    if (kind == ast::Binding::Kind::LOCAL) {
+      if (index < 0 || index >= frame.declared) failed_ = true;
+    } else if (kind == ast::Binding::Kind::CAPTURED) {
+      if (index < 0 || frames_.size() == 1) {
+        failed_ = true;
+      } else {
+        frame.captured =
+            std::max(frame.captured, static_cast<std::size_t>(index) + 1);
+      }
+    }
+  }
+
+  token::Token token() {
+    token::Token token;
+    token.type = tokenType();
+
+    if (integer(1) != 0) token.lexeme = text();
+    token.literal = value();
+    token.line = static_cast<int>(integer(4));
+    token.start = static_cast<int>(integer(4));
+    token.end = static_cast<int>(integer(4));
+
+    return token;
+  }
+
+  ast::ExprPtr expr() {
+    if (integer(1) == 0 || failed_) return nullptr;
+
+    switch (integer(1)) {
+      case kExprTag<ast::Assign>: {
+        ast::Assign assign;
+        assign.name = token();
+        assign.value = expr();
+        assign.binding = binding();
+        return wrap(ast::Expr{std::move(assign)});
+      }
+      case kExprTag<ast::Update>: {
+        ast::Update update;
+        update.name = token();
+        update.opr = token();
+        update.operation = tokenType();
+        update.value = expr();
+        update.postfix = integer(1) != 0;
+        update.binding = binding();
+        return wrap(ast::Expr{std::move(update)});
+      }
+      case kExprTag<ast::Ternary>: {
+        ast::Ternary ternary;
+        ternary.condition = expr();
+        ternary.then_opr = token();
+        ternary.then_expr = expr();
+        ternary.else_opr = token();
+        ternary.else_expr = expr();
+        return wrap(ast::Expr{std::move(ternary)});
+      }
+      case kExprTag<ast::Binary>: {
+        ast::Binary binary;
+        binary.left = expr();
+        binary.opr = token();
+        binary.right = expr();
+        return wrap(ast::Expr{std::move(binary)});
+      }
+      case kExprTag<ast::Grouping>:
+        return wrap(ast::Expr{ast::Grouping{.expression = expr()}});
+      case kExprTag<ast::Literal>: {
+        ast::Literal literal;
+        literal.token_type = tokenType();
+        literal.value = value();
+        return wrap(ast::Expr{std::move(literal)});
+      }
+      case kExprTag<ast::Logical>: {
+        ast::Logical logical;
+        logical.left = expr();
+        logical.opr = token();
+        logical.right = expr();
+        return wrap(ast::Expr{std::move(logical)});
+      }
+      case kExprTag<ast::Unary>: {
+        ast::Unary unary;
+        unary.opr = token();
+        unary.right = expr();
+        return wrap(ast::Expr{std::move(unary)});
+      }
+      case kExprTag<ast::Variable>: {
+        ast::Variable variable;
+        variable.name = token();
+        variable.binding = binding();
+        return wrap(ast::Expr{std::move(variable)});
+      }
+      case kExprTag<ast::Call>: {
+        ast::Call call;
+        call.callee = expr();
+        call.paren = token();
+
+        for (std::size_t i = count(); i > 0 && !failed_; i--) {
+          call.arguments.push_back(expr());
+        }
+
+        return wrap(ast::Expr{std::move(call)});
+      }
+      case kExprTag<ast::Canal>: {
+        ast::Canal canal;
+        canal.keyword = token();
+        canal.type = token();
+        if (auto capacity = expr()) canal.capacity = std::move(capacity);
+        return wrap(ast::Expr{std::move(canal)});
+      }
+      case kExprTag<ast::Receba>: {
+        ast::Receba receba;
+        receba.keyword = token();
+        receba.channel = expr();
+        return wrap(ast::Expr{std::move(receba)});
+      }
+      case kExprTag<ast::Get>: {
+        ast::Get get;
+        get.object = expr();
+        get.name = token();
+        get.cache = std::make_shared<PropertyCache>();
+        return wrap(ast::Expr{std::move(get)});
+      }
+      case kExprTag<ast::Set>: {
+        ast::Set set;
+        set.object = expr();
+        set.name = token();
+        set.value = expr();
+        set.cache = std::make_shared<PropertyCache>();
+        return wrap(ast::Expr{std::move(set)});
+      }
+      case kExprTag<ast::Esse>: {
+        ast::Esse esse;
+        esse.keyword = token();
+        esse.binding = binding();
+        return wrap(ast::Expr{std::move(esse)});
+      }
+      case kExprTag<ast::Super>: {
+        ast::Super super;
+        super.keyword = token();
+        super.method = token();
+        super.binding = binding();
+        super.receiver = binding();
+        super.cache = std::make_shared<PropertyCache>();
+        return wrap(ast::Expr{std::move(super)});
+      }
+      case kExprTag<ast::ArrayLiteral>: {
+        ast::ArrayLiteral array;
+        array.bracket = token();
+
+        for (std::size_t i = count(); i > 0 && !failed_; i--) {
+          array.elements.push_back(expr());
+        }
+
+        return wrap(ast::Expr{std::move(array)});
+      }
+      case kExprTag<ast::DictionaryLiteral>: {
+        ast::DictionaryLiteral dictionary;
+        dictionary.curly = token();
+
+        for (std::size_t i = count(); i > 0 && !failed_; i--) {
+          dictionary.keys.push_back(expr());
+          dictionary.values.push_back(expr());
+        }
+
+        return wrap(ast::Expr{std::move(dictionary)});
+      }
+      case kExprTag<ast::Index>: {
+        ast::Index index;
+        index.object = expr();
+        index.bracket = token();
+        index.index = expr();
+        return wrap(ast::Expr{std::move(index)});
+      }
+      case kExprTag<ast::SetIndex>: {
+        ast::SetIndex set;
+        set.object = expr();
+        set.bracket = token();
+        set.index = expr();
+        set.value = expr();
+        return wrap(ast::Expr{std::move(set)});
+      }
+      case kExprTag<ast::ErrorExpr>:
+        return wrap(ast::Expr{ast::ErrorExpr{.expr = expr()}});
+      default:
+        failed_ = true;
+        return nullptr;
+    }
+  }
+
+  ast::StmtPtr stmt() {
+    if (integer(1) == 0 || failed_) return nullptr;
+
+    switch (integer(1)) {
+      case kStmtTag<ast::Block>: {
+        ast::Block block;
+
+        for (std::size_t i = count(); i > 0 && !failed_; i--) {
+          block.stmts.push_back(stmt());
+        }
+
+        return wrap(ast::Stmt{std::move(block)});
+      }
+      case kStmtTag<ast::Expression>:
+        return wrap(ast::Stmt{ast::Expression{.expression = expr()}});
+      case kStmtTag<ast::Imprima>:
+        return wrap(ast::Stmt{ast::Imprima{.expression = expr()}});
+      case kStmtTag<ast::Var>: {
+        ast::Var var;
+        var.name = token();
+        if (auto initializer = expr()) var.initializer = std::move(initializer);
+        var.constant = integer(1) != 0;
+        var.slot = declaration();
+        return wrap(ast::Stmt{std::move(var)});
+      }
+      case kStmtTag<ast::If>: {
+        ast::If if_stmt;
+        if_stmt.condition = expr();
+        if_stmt.then_branch = stmt();
+        if (auto else_branch = stmt()) {
+          if_stmt.else_branch = std::move(else_branch);
+        }
+        return wrap(ast::Stmt{std::move(if_stmt)});
+      }
+      case kStmtTag<ast::While>: {
+        ast::While while_stmt;
+        while_stmt.condition = expr();
+        while_stmt.body = stmt();
+        return wrap(ast::Stmt{std::move(while_stmt)});
+      }
+      case kStmtTag<ast::ParallelFor>: {
+        ast::ParallelFor loop;
+        loop.keyword = token();
+        loop.variable = token();
+        loop.start = expr();
+        loop.end = expr();
+        loop.inclusive = integer(1) != 0;
+        loop.step = expr();
+
+        for (std::size_t i = count(); i > 0 && !failed_; i--) {
+          const std::uint64_t kind = integer(1);
+          if (kind > static_cast<std::uint8_t>(ast::ReductionKind::MAXIMO)) {
+            failed_ = true;
+          }
+
+          ast::Reduction reduction;
+          reduction.kind = static_cast<ast::ReductionKind>(kind);
+          reduction.target = token();
+          reduction.binding = binding();
+          loop.reductions.push_back(std::move(reduction));
+        }
+
+        loop.slot = declaration();
+        loop.body = stmt();
+        return wrap(ast::Stmt{std::move(loop)});
+      }
+      case kStmtTag<ast::ForEach>: {
+        ast::ForEach loop;
+        loop.keyword = token();
+        loop.variable = token();
+        loop.source = expr();
+        loop.slot = declaration();
+        loop.body = stmt();
+        return wrap(ast::Stmt{std::move(loop)});
+      }
+      case kStmtTag<ast::Escolha>: {
+        ast::Escolha escolha;
+        escolha.keyword = token();
+        escolha.value = expr();
+
+        for (std::size_t i = count(); i > 0 && !failed_; i--) {
+          auto &labels = escolha.labels.emplace_back();
+
+          for (std::size_t j = count(); j > 0 && !failed_; j--) {
+            labels.push_back(value());
+            if (!Dictionary::toKey(labels.back()).has_value()) failed_ = true;
+          }
+
+          escolha.bodies.push_back(stmt());
+        }
+
+        escolha.fallback = slot();
+        if (escolha.fallback >= static_cast<int>(escolha.bodies.size())) {
+          failed_ = true;
+        }
+        if (failed_) return nullptr;
+
+        escolha.table = CaseTable::create(escolha.labels);
+        return wrap(ast::Stmt{std::move(escolha)});
+      }
+      case kStmtTag<ast::Tarefa>: {
+        ast::Tarefa tarefa;
+        tarefa.keyword = token();
+        tarefa.body = stmt();
+        return wrap(ast::Stmt{std::move(tarefa)});
+      }
+      case kStmtTag<ast::Envie>: {
+        ast::Envie envie;
+        envie.keyword = token();
+        envie.channel = expr();
+        envie.value = expr();
+        return wrap(ast::Stmt{std::move(envie)});
+      }
+      case kStmtTag<ast::Feche>: {
+        ast::Feche feche;
+        feche.keyword = token();
+        feche.channel = expr();
+        return wrap(ast::Stmt{std::move(feche)});
+      }
+      case kStmtTag<ast::Instantaneo>:
+        return wrap(ast::Stmt{ast::Instantaneo{.keyword = token()}});
+      case kStmtTag<ast::Importe>: {
+        ast::Importe importe;
+        importe.keyword = token();
+        importe.path = token();
+        return wrap(ast::Stmt{std::move(importe)});
+      }
+      case kStmtTag<ast::Function>: {
+        const std::uint64_t kind = integer(1);
+        if (kind != static_cast<std::uint8_t>(ast::Function::Kind::FUNCTION)) {
+          failed_ = true;
+        }
+
+        ast::Function function;
+        function.name = token();
+        function.slot = declaration();
+        return wrap(ast::Stmt{this->function(std::move(function))});
+      }
+      case kStmtTag<ast::Retorne>: {
+        ast::Retorne retorne;
+        retorne.keyword = token();
+        if (auto value = expr()) retorne.value = std::move(value);
+        return wrap(ast::Stmt{std::move(retorne)});
+      }
+      case kStmtTag<ast::Classe>: {
+        ast::Classe klass;
+        klass.name = token();
+        if (auto superclass = expr()) klass.superclass = std::move(superclass);
+
+        klass.slot = declaration();
+        klass.super_slot =
+            klass.superclass.has_value() ? declaration() : slot();
+
+        for (std::size_t i = count(); i > 0 && !failed_; i--) {
+          using Kind = ast::Function::Kind;
+
+          const std::uint64_t kind = integer(1);
+          if (kind == static_cast<std::uint8_t>(Kind::FUNCTION) ||
+              kind > static_cast<std::uint8_t>(Kind::INITIALIZER)) {
+            failed_ = true;
+          }
+
+          ast::Function method;
+          method.name = token();
+          method.kind = static_cast<Kind>(kind);
+          method.slot = slot();
+          klass.methods.push_back(function(std::move(method)));
+        }
+
+        return wrap(ast::Stmt{std::move(klass)});
+      }
+      case kStmtTag<ast::ErrorStmt>:
+        return wrap(ast::Stmt{ast::ErrorStmt{.token = token()}});
+      default:
+        failed_ = true;
+        return nullptr;
+    }
+  }
+
+  // The fields of `function`, a function or a method, after its slot. Its
+  // body is read in a frame of its own, which starts with the slots of the
+  // arguments, and its captures then refer to the frame around it.
+  ast::Function function(ast::Function function) {
+    for (std::size_t i = count(); i > 0 && !failed_; i--) {
+      function.params.push_back(token());
+    }
+
+    frames_.push_back({.declared = static_cast<int>(
+                           function.params.size() +
+                           (function.kind == ast::Function::Kind::FUNCTION
+                                ? 0
+                                : 1))});
+
+    for (std::size_t i = count(); i > 0 && !failed_; i--) {
+      function.body.push_back(stmt());
+    }
+
+    const Frame frame = frames_.back();
+    frames_.pop_back();
+
+    function.frame_size = static_cast<std::int32_t>(integer(4));
+    if (function.frame_size != frame.declared) failed_ = true;
+
+    for (std::size_t i = count(); i > 0 && !failed_; i--) {
+      ast::Capture capture;
+      capture.local = integer(1) != 0;
+      capture.index = slot();
+
+      refer(capture.local ? ast::Binding::Kind::LOCAL
+                          : ast::Binding::Kind::CAPTURED,
+            capture.index);
+      function.captures.push_back(capture);
+    }
+
+    if (frame.captured > function.captures.size()) {
+      failed_ = true;
+    }
+
+    return function;
+  }
+
+ private:
+  std::string_view data_;
+  std::size_t offset_;
+  bool failed_;
+  arena::Arena *allocator_;
+
+  // The bounds of a frame being read.
+  struct Frame {
+    // Past the slots declared so far.
+    int declared = 0;
+    // Past the captures the body refers to.
+    std::size_t captured = 0;
+  };
+
+  // The frames of the functions being read, inside the one of the script.
+  std::vector<Frame> frames_;
+  // The arrays and dictionaries read so far, by index.
+  std::vector<std::any> containers_;
+  int depth_ = 0;
+
+  ast::ExprPtr wrap(ast::Expr expr) {
+    if (failed_) return nullptr;
+    return allocator_->make_unique<ast::Expr>(std::move(expr));
+  }
+
+  ast::StmtPtr wrap(ast::Stmt stmt) {
+    if (failed_) return nullptr;
+    return allocator_->make_unique<ast::Stmt>(std::move(stmt));
+  }
+};
+
+// A read-only mapping of a whole file.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &path) : data_(nullptr), size_(0) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+
+    struct stat status;
+    if (::fstat(fd, &status) == 0 && status.st_size > 0) {
+      void *data = ::mmap(nullptr, static_cast<std::size_t>(status.st_size),
+                          PROT_READ, MAP_PRIVATE, fd, 0);
+
+      if (data != MAP_FAILED) {
+        data_ = static_cast<const char *>(data);
+        size_ = static_cast<std::size_t>(status.st_size);
+      }
+    }
+
+    ::close(fd);
+  }
+
+  ~MappedFile() {
+    if (data_ != nullptr) ::munmap(const_cast<char *>(data_), size_);
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  [[nodiscard]] std::string_view contents() const { return {data_, size_}; }
+
+ private:
+  const char *data_;
+  std::size_t size_;
+};
+
+// Whether `value`, the value of the global `name`, is the function or the
+// class that a statement of `prelude` declared under that name. A class is
+// told from another of the same name by its methods.
+bool isDeclaration(std::span<const ast::Stmt> prelude, const std::string &name,
+                   const std::any &value) {
+  const auto *closure = std::any_cast<Closure::Ref>(&value);
+  const auto *klass = std::any_cast<Class::Ref>(&value);
+
+  if (closure == nullptr && (klass == nullptr || (*klass)->getName() != name)) {
+    return false;
+  }
+
+  for (const ast::Stmt &stmt : prelude) {
+    if (const auto *function = std::get_if<ast::Function>(&stmt.var)) {
+      if (closure != nullptr && &(*closure)->getDeclaration() == function &&
+          function->name.lexeme.value() == name) {
+        return true;
+      }
+    } else if (const auto *classe = std::get_if<ast::Classe>(&stmt.var)) {
+      if (klass == nullptr || classe->name.lexeme.value() != name) continue;
+
+      const auto &methods = (*klass)->getMethods();
+      if (methods.empty()) return classe->methods.empty();
+
+      const ast::Function *method = &methods.begin()->second->getDeclaration();
+      if (std::ranges::any_of(classe->methods,
+                              [&](const ast::Function &declared) {
+                                return &declared == method;
+                              })) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+// Writes `data` aside and renames it into place, so that concurrent runs of
+// the same script never read a partial file.
+bool writeFile(const std::string &path, std::string_view data) {
+  const std::string temporary =
+      path + "." + std::to_string(::getpid()) + "." +
+      std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) +
+      ".tmp";
+
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!file) {
+      std::error_code error;
+      std::filesystem::remove(temporary, error);
+      return false;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temporary, path, error);
+  if (error) std::filesystem::remove(temporary, error);
+
+  return !error;
+}
+}  // namespace
+
+// 64-bit FNV-1a.
+std::uint64_t cache::key(std::string_view source) {
+  std::uint64_t hash = 0xcbf29ce484222325;
+
+  for (const char c : source) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3;
+  }
+
+  return hash;
+}
+
+std::string cache::path(const std::string &script_path, std::uint64_t key,
+                        std::string_view extension) {
+  const char *directory = std::getenv("LUSOSCRIPT_CACHE_DIR");
+
+  if (directory == nullptr || *directory == '\0') {
+    return std::filesystem::path(script_path).replace_extension(extension);
+  }
+
+  char name[17];
+  std::snprintf(name, sizeof(name), "%016llx",
+                static_cast<unsigned long long>(key));
+
+  return std::filesystem::path(directory) /
+         (std::string(name) + std::string(extension));
+}
+
+std::optional<std::vector<ast::Stmt>> cache::load(const std::string &path,
+                                                  std::uint64_t key,
+                                                  arena::Arena &allocator) {
+  const MappedFile file(path);
+  Reader reader(file.contents(), &allocator);
+
+  if (!reader.header(kProgramMagic, key)) return std::nullopt;
+
+  std::vector<ast::Stmt> statements;
+
+  for (std::size_t i = reader.count(); i > 0 && !reader.failed(); i--) {
+    ast::StmtPtr stmt = reader.stmt();
+    if (stmt == nullptr) return std::nullopt;
+
+    statements.push_back(std::move(*stmt));
+  }
+
+  if (reader.failed() || !reader.atEnd()) return std::nullopt;
+
+  return statements;
+}
+
+bool cache::store(const std::string &path, std::uint64_t key,
+                  const std::vector<ast::Stmt> &statements) {
+  Writer writer;
+  writer.header(kProgramMagic, key);
+  writer.integer(statements.size(), 4);
+
+  for (const ast::Stmt &stmt : statements) writer.stmt(&stmt);
+
+  writer.seal();
+
+  return writeFile(path, writer.data);
+}
+
+// Variables are restored straight from the mapping, with no statement run.
+std::optional<cache::Snapshot> cache::loadSnapshot(const std::string &path,
+                                                   std::uint64_t key) {
+  const MappedFile file(path);
+  Reader reader(file.contents());
+
+  if (!reader.header(kSnapshotMagic, key)) return std::nullopt;
+
+  Snapshot snapshot;
+  snapshot.output = reader.text();
+
+  for (std::size_t i = reader.count(); i > 0 && !reader.failed(); i--) {
+    std::string name = reader.text();
+    std::any value = reader.value();
+
+    if (reader.integer(1) != 0) {
+      snapshot.globals.defineConstant(name, value);
+    } else {
+      snapshot.globals.define(name, value);
+    }
+  }
+
+  if (reader.failed() || !reader.atEnd()) return std::nullopt;
+
+  return snapshot;
+}
+
+bool cache::storeSnapshot(const std::string &path, std::uint64_t key,
+                          const env::Environment &globals,
+                          std::string_view output,
+                          std::span<const ast::Stmt> prelude,
+                          std::string &problem) {
+  const env::Environment flat = globals.snapshot();
+
+  Writer writer;
+  writer.header(kSnapshotMagic, key);
+  writer.integer(output.size(), 4);
+  writer.data.append(output);
+
+  // Built-in functions are defined again by the interpreter restoring the
+  // snapshot.
+  const auto builtin = [](const std::string &name, const std::any &value) {
+    const auto *native = std::any_cast<NativeFunction::Ref>(&value);
+    return native != nullptr && (*native)->getName() == name;
+  };
+
+  // So are the functions and classes that the prelude declared.
+  const auto skipped = [&](const std::string &name, const std::any &value) {
+    return builtin(name, value) || isDeclaration(prelude, name, value);
+  };
+
+  std::size_t count = 0;
+  for (const auto &[name, value] : flat.getValues()) {
+    if (!skipped(name, value)) count++;
+  }
+
+  writer.integer(count, 4);
+
+  for (const auto &[name, value] : flat.getValues()) {
+    if (skipped(name, value)) continue;
+
+    writer.text(name);
+    writer.value(value);
+    writer.integer(flat.isConstant(name), 1);
+
+    if (writer.failed) {
+      problem = "'" + name + "' holds " + writer.unstorable;
+      return false;
+    }
+  }
+
+  writer.seal();
+
+  return writeFile(path, writer.data);
+}
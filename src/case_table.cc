@@ -0,0 +1,203 @@
+#include "lusoscript/case_table.hh"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <string>
+#include <variant>
+
+namespace {
+// Fewer labels are compared in turn, which is as fast as hashing the value.
+constexpr std::size_t kMinHashed = 4;
+// A jump table may have up to twice as many slots as labels, and this many
+// more, for the numbers between them that label no case.
+constexpr std::size_t kJumpSlack = 8;
+// Buckets have 4 labels on average, and the slots are at most half full.
+constexpr std::size_t kBucketSize = 4;
+// The seeds tried for a bucket before giving up on a perfect hash.
+constexpr std::uint32_t kMaxSeeds = 1 << 16;
+
+std::uint64_t mix(std::uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9u;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBu;
+  x ^= x >> 31;
+
+  return x;
+}
+
+std::uint64_t hashOf(const std::string &text) {
+  return mix(std::hash<std::string>{}(text) ^ 0x9E3779B97F4A7C15u);
+}
+
+// 0 and -0 hash alike, as they are equal.
+std::uint64_t hashOf(float number) {
+  return mix(std::bit_cast<std::uint32_t>(number == 0.f ? 0.f : number));
+}
+
+std::uint64_t hashOf(const Dictionary::Key &key) {
+  return std::visit([](const auto &value) { return hashOf(value); }, key);
+}
+
+bool isLabel(const Dictionary::Key &label, const std::string &text) {
+  const auto *label_text = std::get_if<std::string>(&label);
+  return label_text != nullptr && *label_text == text;
+}
+
+bool isLabel(const Dictionary::Key &label, float number) {
+  const auto *label_number = std::get_if<float>(&label);
+  return label_number != nullptr && *label_number == number;
+}
+}  // namespace
+
+std::shared_ptr<const CaseTable> CaseTable::create(
+    const std::vector<std::vector<std::any>> &labels) {
+  std::vector<std::pair<Dictionary::Key, int>> cases;
+
+  for (std::size_t i = 0; i < labels.size(); i++) {
+    for (const std::any &label : labels[i]) {
+      cases.emplace_back(Dictionary::toKey(label).value(),
+                         static_cast<int>(i));
+    }
+  }
+
+  auto table = std::make_shared<CaseTable>();
+
+  if (table->buildJumps(cases)) {
+    table->kind_ = Kind::JUMP;
+  } else if (cases.size() >= kMinHashed && table->buildHash(cases)) {
+    table->kind_ = Kind::HASH;
+  } else {
+    table->seeds_.clear();
+    table->slots_ = std::move(cases);
+  }
+
+  return table;
+}
+
+int CaseTable::find(const std::any &value) const {
+  if (const auto *number = std::any_cast<float>(&value)) {
+    if (kind_ != Kind::JUMP) return findLabel(*number);
+
+    // False for NaN too.
+    const double offset = *number - base_;
+    if (!(offset >= 0 && offset < static_cast<double>(jumps_.size())) ||
+        offset != std::floor(offset)) {
+      return -1;
+    }
+
+    return jumps_[static_cast<std::size_t>(offset)];
+  }
+
+  if (const auto *text = std::any_cast<std::string>(&value)) {
+    return kind_ == Kind::JUMP ? -1 : findLabel(*text);
+  }
+
+  return -1;
+}
+
+bool CaseTable::buildJumps(
+    const std::vector<std::pair<Dictionary::Key, int>> &labels) {
+  if (labels.empty()) return false;
+
+  double low = std::numeric_limits<double>::infinity();
+  double high = -low;
+
+  for (const auto &[label, target] : labels) {
+    const auto *number = std::get_if<float>(&label);
+    if (number == nullptr || *number != std::floor(*number)) return false;
+
+    low = std::min<double>(low, *number);
+    high = std::max<double>(high, *number);
+  }
+
+  if (high - low >= static_cast<double>(labels.size() * 2 + kJumpSlack)) {
+    return false;
+  }
+
+  base_ = low;
+  jumps_.assign(static_cast<std::size_t>(high - low) + 1, -1);
+
+  for (const auto &[label, target] : labels) {
+    jumps_[static_cast<std::size_t>(std::get<float>(label) - low)] = target;
+  }
+
+  return true;
+}
+
+// The buckets with the most labels get their seeds first, while most slots are
+// still free.
+bool CaseTable::buildHash(
+    const std::vector<std::pair<Dictionary::Key, int>> &labels) {
+  seeds_.assign(std::bit_ceil((labels.size() + kBucketSize - 1) / kBucketSize),
+                0);
+  slots_.assign(std::bit_ceil(labels.size() * 2), {Dictionary::Key{}, -1});
+
+  std::vector<std::uint64_t> hashes;
+  std::vector<std::vector<std::size_t>> buckets(seeds_.size());
+
+  for (std::size_t i = 0; i < labels.size(); i++) {
+    hashes.push_back(hashOf(labels[i].first));
+    buckets[(hashes[i] >> 32) & (seeds_.size() - 1)].push_back(i);
+  }
+
+  std::vector<std::size_t> order(buckets.size());
+  for (std::size_t i = 0; i < order.size(); i++) order[i] = i;
+
+  std::stable_sort(order.begin(), order.end(),
+                   [&](std::size_t a, std::size_t b) {
+                     return buckets[a].size() > buckets[b].size();
+                   });
+
+  std::vector<bool> taken(slots_.size());
+  std::vector<std::size_t> placed;
+
+  for (const std::size_t bucket : order) {
+    for (std::uint32_t seed = 0;; seed++) {
+      if (seed == kMaxSeeds) return false;
+
+      seeds_[bucket] = seed;
+      placed.clear();
+
+      for (const std::size_t label : buckets[bucket]) {
+        const std::size_t slot = slotOf(hashes[label]);
+        if (taken[slot]) break;
+
+        taken[slot] = true;
+        placed.push_back(slot);
+      }
+
+      if (placed.size() == buckets[bucket].size()) break;
+
+      for (const std::size_t slot : placed) taken[slot] = false;
+    }
+
+    for (std::size_t i = 0; i < placed.size(); i++) {
+      slots_[placed[i]] = labels[buckets[bucket][i]];
+    }
+  }
+
+  return true;
+}
+
+std::size_t CaseTable::slotOf(std::uint64_t hash) const {
+  const std::uint32_t seed = seeds_[(hash >> 32) & (seeds_.size() - 1)];
+  return mix(hash ^ (seed * 0x9E3779B97F4A7C15u)) & (slots_.size() - 1);
+}
+
+template <typename Value>
+int CaseTable::findLabel(const Value &value) const {
+  if (kind_ == Kind::HASH) {
+    const auto &[label, target] = slots_[slotOf(hashOf(value))];
+    return isLabel(label, value) ? target : -1;
+  }
+
+  for (const auto &[label, target] : slots_) {
+    if (isLabel(label, value)) return target;
+  }
+
+  return -1;
+}
@@ -0,0 +1,58 @@
+#include "lusoscript/channel.hh"
+
+#include "lusoscript/task_runtime.hh"
+
+Channel::Channel(Type type, std::size_t capacity)
+    : type_(type), queue_(capacity), closed_(false), pushes_(0), pops_(0) {}
+
+Channel::Type Channel::getType() const { return type_; }
+
+bool Channel::send(std::any value) {
+  while (true) {
+    if (closed_.load()) return false;
+
+    // Read before trying, so that a pop in between wakes the wait up.
+    const std::uint32_t pops = pops_.load();
+
+    if (queue_.tryPush(value)) {
+      pushes_.fetch_add(1);
+      pushes_.notify_all();
+      return true;
+    }
+
+    TaskRuntime::BlockingScope blocking;
+    pops_.wait(pops);
+  }
+}
+
+std::optional<std::any> Channel::receive() {
+  std::any value;
+
+  while (true) {
+    const std::uint32_t pushes = pushes_.load();
+
+    if (queue_.tryPop(value)) {
+      pops_.fetch_add(1);
+      pops_.notify_all();
+      return value;
+    }
+
+    // Values sent before the channel was closed are still delivered.
+    if (closed_.load()) {
+      if (queue_.tryPop(value)) return value;
+      return std::nullopt;
+    }
+
+    TaskRuntime::BlockingScope blocking;
+    pushes_.wait(pushes);
+  }
+}
+
+void Channel::close() {
+  closed_.store(true);
+
+  pushes_.fetch_add(1);
+  pushes_.notify_all();
+  pops_.fetch_add(1);
+  pops_.notify_all();
+}
@@ -0,0 +1,20 @@
+#include "lusoscript/closure.hh"
+
+#include <utility>
+
+Closure::Ref Closure::create(const ast::Function &declaration,
+                             std::vector<std::shared_ptr<Cell>> cells) {
+  return Ref::adopt(new Closure(declaration, std::move(cells)));
+}
+
+Closure::Ref Closure::share() const { return Ref::share(this); }
+
+const ast::Function &Closure::getDeclaration() const { return declaration_; }
+
+const std::shared_ptr<Cell> &Closure::getCell(int index) const {
+  return cells_[index];
+}
+
+Closure::Closure(const ast::Function &declaration,
+                 std::vector<std::shared_ptr<Cell>> cells)
+    : declaration_(declaration), cells_(std::move(cells)) {}
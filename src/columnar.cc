@@ -0,0 +1,960 @@
+#include "lusoscript/columnar.hh"
+
+#include <sysexits.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+#include "lusoscript/arena.hh"
+#include "lusoscript/ast.hh"
+#include "lusoscript/helper.hh"
+#include "lusoscript/lexer.hh"
+#include "lusoscript/parser.hh"
+#include "lusoscript/simd.hh"
+#include "lusoscript/source_file.hh"
+
+namespace {
+// Rows evaluated at a time, so that the columns of a chunk stay in cache.
+constexpr std::size_t kChunkRows = 1024;
+
+constexpr char kMagic[] = {'L', 'C', 'O', 'L'};
+constexpr std::uint32_t kVersion = 1;
+
+std::string_view typeName(columnar::Type type) {
+  switch (type) {
+    case columnar::Type::TEXTO:
+      return "texto";
+    case columnar::Type::LOGICO:
+      return "logico";
+    default:
+      return "numero";
+  }
+}
+
+// Little-endian encoding, whatever the byte order of the machine.
+void putInteger(std::string &output, std::uint64_t value, int bytes) {
+  for (int i = 0; i < bytes; i++) {
+    output.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+class FileReader {
+ public:
+  explicit FileReader(std::string_view data) : data_(data), offset_(0) {}
+
+  bool integer(std::uint64_t &value, int bytes) {
+    if (data_.size() - offset_ < static_cast<std::size_t>(bytes)) return false;
+
+    value = 0;
+    for (int i = 0; i < bytes; i++) {
+      value |= static_cast<std::uint64_t>(
+                   static_cast<unsigned char>(data_[offset_ + i]))
+               << (8 * i);
+    }
+    offset_ += bytes;
+
+    return true;
+  }
+
+  bool text(std::string &value) {
+    std::uint64_t length;
+    if (!integer(length, 4) || data_.size() - offset_ < length) return false;
+
+    value.assign(data_.substr(offset_, length));
+    offset_ += length;
+
+    return true;
+  }
+
+  [[nodiscard]] bool atEnd() const { return offset_ == data_.size(); }
+
+ private:
+  std::string_view data_;
+  std::size_t offset_;
+};
+}  // namespace
+
+std::size_t columnar::Column::size() const {
+  switch (type) {
+    case Type::TEXTO:
+      return texts.size();
+    case Type::LOGICO:
+      return booleans.size();
+    default:
+      return numbers.size();
+  }
+}
+
+const columnar::Column *columnar::Table::find(std::string_view name) const {
+  for (std::size_t i = 0; i < names.size(); i++) {
+    if (names[i] == name) return &columns[i];
+  }
+
+  return nullptr;
+}
+
+std::size_t columnar::Table::rows() const {
+  return columns.empty() ? 0 : columns.front().size();
+}
+
+// The file starts with "LCOL", the format version, the number of columns and
+// the number of rows, followed by the type and name of every column and then
+// by the values of every column in turn. See docs/columnar.md.
+error::Result<columnar::Table, std::string> columnar::read(
+    const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return error::Unexpected<std::string>{"Cannot open " + path};
+
+  std::stringstream contents;
+  contents << file.rdbuf();
+  const std::string data = contents.str();
+
+  const auto invalid = [&path] {
+    return error::Unexpected<std::string>{"Invalid columnar file " + path};
+  };
+
+  if (data.size() < sizeof(kMagic) ||
+      std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+    return invalid();
+  }
+
+  FileReader reader(std::string_view(data).substr(sizeof(kMagic)));
+  std::uint64_t version, column_count, rows;
+
+  if (!reader.integer(version, 4) || version != kVersion ||
+      !reader.integer(column_count, 4) || !reader.integer(rows, 8)) {
+    return invalid();
+  }
+
+  Table table;
+
+  for (std::uint64_t i = 0; i < column_count; i++) {
+    std::uint64_t type;
+    std::string name;
+
+    if (!reader.integer(type, 1) || !reader.text(name)) return invalid();
+
+    const auto column_type = static_cast<Type>(type);
+    if (column_type != Type::NUMERO && column_type != Type::TEXTO &&
+        column_type != Type::LOGICO) {
+      return invalid();
+    }
+
+    table.names.push_back(std::move(name));
+    table.columns.emplace_back().type = column_type;
+  }
+
+  for (Column &column : table.columns) {
+    for (std::uint64_t row = 0; row < rows; row++) {
+      std::uint64_t value;
+
+      if (column.type == Type::TEXTO) {
+        if (!reader.text(column.texts.emplace_back())) return invalid();
+      } else if (column.type == Type::LOGICO) {
+        if (!reader.integer(value, 1) || value > 1) return invalid();
+        column.booleans.push_back(static_cast<std::uint8_t>(value));
+      } else {
+        if (!reader.integer(value, 4)) return invalid();
+
+        const auto bits = static_cast<std::uint32_t>(value);
+        float number;
+        std::memcpy(&number, &bits, sizeof(number));
+        column.numbers.push_back(number);
+      }
+    }
+  }
+
+  if (!reader.atEnd()) return invalid();
+
+  return table;
+}
+
+error::Result<void, std::string> columnar::write(const Table &table,
+                                                 const std::string &path) {
+  std::string data(kMagic, sizeof(kMagic));
+  putInteger(data, kVersion, 4);
+  putInteger(data, table.columns.size(), 4);
+  putInteger(data, table.rows(), 8);
+
+  for (std::size_t i = 0; i < table.columns.size(); i++) {
+    if (table.columns[i].size() != table.rows()) {
+      return error::Unexpected<std::string>{
+          "Every column must have the same number of rows"};
+    }
+
+    putInteger(data, static_cast<unsigned char>(table.columns[i].type), 1);
+    putInteger(data, table.names[i].size(), 4);
+    data.append(table.names[i]);
+  }
+
+  for (const Column &column : table.columns) {
+    for (const auto &text : column.texts) {
+      putInteger(data, text.size(), 4);
+      data.append(text);
+    }
+
+    for (const auto boolean : column.booleans) putInteger(data, boolean, 1);
+
+    for (const float number : column.numbers) {
+      std::uint32_t bits;
+      std::memcpy(&bits, &number, sizeof(bits));
+      putInteger(data, bits, 4);
+    }
+  }
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+  if (!file) return error::Unexpected<std::string>{"Cannot write " + path};
+
+  return {};
+}
+
+namespace columnar {
+// Turns the AST of a rule into instructions, checking the types of the
+// operands as it goes: rules are typed by their columns, so every type error
+// is found before any row is evaluated.
+class RuleCompiler {
+ public:
+  RuleCompiler(std::vector<Rule::Instruction> &program, const Table &schema,
+               error::ErrorState &error_state)
+      : program_(program), schema_(schema), error_state_(error_state) {}
+
+  // Returns the instruction computing `expr`, which is the last one emitted.
+  std::optional<int> compile(const ast::Expr &expr) {
+    struct Visitor {
+      RuleCompiler &compiler;
+
+      std::optional<int> operator()(const ast::Assign &assign) {
+        return compiler.fail(assign.name, "Rules cannot assign variables.");
+      }
+
+      std::optional<int> operator()(const ast::Update &update) {
+        return compiler.fail(update.name, "Rules cannot assign variables.");
+      }
+
+      std::optional<int> operator()(const ast::Ternary &ternary) {
+        return compiler.ternary(ternary);
+      }
+
+      std::optional<int> operator()(const ast::Binary &binary) {
+        return compiler.binary(binary);
+      }
+
+      std::optional<int> operator()(const ast::Grouping &grouping) {
+        return compiler.compile(*grouping.expression);
+      }
+
+      std::optional<int> operator()(const ast::Literal &literal) {
+        return compiler.literal(literal);
+      }
+
+      std::optional<int> operator()(const ast::Logical &logical) {
+        const auto left = compiler.compile(*logical.left);
+        if (!left) return std::nullopt;
+
+        const auto right = compiler.compile(*logical.right);
+        if (!right) return std::nullopt;
+
+        if (compiler.typeOf(*left) != Type::LOGICO ||
+            compiler.typeOf(*right) != Type::LOGICO) {
+          return compiler.fail(logical.opr,
+                               "Operands of 'e' and 'ou' must be booleans in "
+                               "a rule.");
+        }
+
+        const Rule::Op op = logical.opr.type == token::TokenType::KW_E
+                                ? Rule::Op::AND
+                                : Rule::Op::OR;
+
+        return compiler.emit(
+            {.op = op, .type = Type::LOGICO, .a = *left, .b = *right});
+      }
+
+      std::optional<int> operator()(const ast::Unary &unary) {
+        const auto right = compiler.compile(*unary.right);
+        if (!right) return std::nullopt;
+
+        if (unary.opr.type == token::TokenType::SC_MINUS) {
+          if (compiler.typeOf(*right) != Type::NUMERO) {
+            return compiler.fail(unary.opr, "Operand must be a number");
+          }
+
+          return compiler.emit(
+              {.op = Rule::Op::NEGATE, .type = Type::NUMERO, .a = *right});
+        }
+
+        if (compiler.typeOf(*right) == Type::LOGICO) {
+          return compiler.emit(
+              {.op = Rule::Op::NOT, .type = Type::LOGICO, .a = *right});
+        }
+
+        // Numbers and strings are always truthy.
+        return compiler.sequence(*right, compiler.constant(false));
+      }
+
+      std::optional<int> operator()(const ast::Variable &variable) {
+        const std::string &name = variable.name.lexeme.value();
+        const Column *column = compiler.schema_.find(name);
+
+        if (column == nullptr) {
+          return compiler.fail(variable.name, "Unknown column '" + name + "'.");
+        }
+
+        return compiler.emit({.op = Rule::Op::COLUMN,
+                              .type = column->type,
+                              .column = name,
+                              .token = variable.name});
+      }
+
+      std::optional<int> operator()(const ast::Call &call) {
+        return compiler.fail(call.paren, "Rules cannot call functions.");
+      }
+
+      std::optional<int> operator()(const ast::Canal &canal) {
+        return compiler.fail(canal.keyword,
+                             "Channels cannot be used in a rule.");
+      }
+
+      std::optional<int> operator()(const ast::Receba &receba) {
+        return compiler.fail(receba.keyword,
+                             "Channels cannot be used in a rule.");
+      }
+
+      std::optional<int> operator()(const ast::Get &get) {
+        return compiler.fail(get.name, "Objects cannot be used in a rule.");
+      }
+
+      std::optional<int> operator()(const ast::Set &set) {
+        return compiler.fail(set.name, "Objects cannot be used in a rule.");
+      }
+
+      std::optional<int> operator()(const ast::Esse &esse) {
+        return compiler.fail(esse.keyword,
+                             "Objects cannot be used in a rule.");
+      }
+
+      std::optional<int> operator()(const ast::Super &super) {
+        return compiler.fail(super.keyword,
+                             "Objects cannot be used in a rule.");
+      }
+
+      std::optional<int> operator()(const ast::ArrayLiteral &array) {
+        return compiler.fail(array.bracket,
+                             "Arrays cannot be used in a rule.");
+      }
+
+      std::optional<int> operator()(const ast::DictionaryLiteral &dictionary) {
+        return compiler.fail(dictionary.curly,
+                             "Dictionaries cannot be used in a rule.");
+      }
+
+      std::optional<int> operator()(const ast::Index &index) {
+        return compiler.fail(index.bracket,
+                             "Arrays and dictionaries cannot be used in a "
+                             "rule.");
+      }
+
+      std::optional<int> operator()(const ast::SetIndex &set) {
+        return compiler.fail(set.bracket,
+                             "Arrays and dictionaries cannot be used in a "
+                             "rule.");
+      }
+
+      // Already reported by the parser.
+      std::optional<int> operator()(const ast::ErrorExpr &) {
+        return std::nullopt;
+      }
+    };
+    return std::visit(Visitor{.compiler = *this}, expr.var);
+  }
+
+ private:
+  std::vector<Rule::Instruction> &program_;
+  const Table &schema_;
+  error::ErrorState &error_state_;
+  // Line of the last token seen, for the literals, which have none.
+  int line_ = 1;
+
+  std::optional<int> binary(const ast::Binary &binary) {
+    const auto left = compile(*binary.left);
+    if (!left) return std::nullopt;
+
+    const auto right = compile(*binary.right);
+    if (!right) return std::nullopt;
+
+    const Type left_type = typeOf(*left);
+    const Type right_type = typeOf(*right);
+    const bool numbers =
+        left_type == Type::NUMERO && right_type == Type::NUMERO;
+    const bool texts = left_type == Type::TEXTO && right_type == Type::TEXTO;
+
+    Rule::Instruction instruction;
+    instruction.type = Type::LOGICO;
+    instruction.a = *left;
+    instruction.b = *right;
+    instruction.token = binary.opr;
+
+    switch (binary.opr.type) {
+      case token::TokenType::SC_COMMA:
+        return sequence(*left, *right);
+      case token::TokenType::SC_MINUS:
+      case token::TokenType::SC_STAR:
+      case token::TokenType::SC_FORWARD_SLASH:
+        if (!numbers) return fail(binary.opr, "Operands must be numbers");
+
+        instruction.type = Type::NUMERO;
+        instruction.op =
+            binary.opr.type == token::TokenType::SC_MINUS ? Rule::Op::SUBTRACT
+            : binary.opr.type == token::TokenType::SC_STAR
+                ? Rule::Op::MULTIPLY
+                : Rule::Op::DIVIDE;
+        break;
+      case token::TokenType::SC_PLUS:
+        if (numbers) {
+          instruction.type = Type::NUMERO;
+          instruction.op = Rule::Op::ADD;
+        } else if (left_type == Type::TEXTO || right_type == Type::TEXTO) {
+          instruction.type = Type::TEXTO;
+          instruction.op = Rule::Op::CONCAT;
+        } else {
+          return fail(binary.opr,
+                      "Operands must be two numbers or include a string");
+        }
+        break;
+      case token::TokenType::MC_GREATER:
+      case token::TokenType::MC_GREATER_EQUAL:
+      case token::TokenType::MC_LESS:
+      case token::TokenType::MC_LESS_EQUAL:
+        if (!numbers && !texts) {
+          return fail(binary.opr,
+                      "Operands must be two numbers or two strings");
+        }
+
+        instruction.op =
+            binary.opr.type == token::TokenType::MC_GREATER ? Rule::Op::GREATER
+            : binary.opr.type == token::TokenType::MC_GREATER_EQUAL
+                ? Rule::Op::GREATER_EQUAL
+            : binary.opr.type == token::TokenType::MC_LESS
+                ? Rule::Op::LESS
+                : Rule::Op::LESS_EQUAL;
+        break;
+      case token::TokenType::MC_EQUAL_EQUAL:
+      case token::TokenType::MC_EXCL_EQUAL: {
+        const bool equal = binary.opr.type == token::TokenType::MC_EQUAL_EQUAL;
+
+        // Values of different types are never equal.
+        if (left_type != right_type) {
+          return sequence(sequence(*left, *right), constant(!equal));
+        }
+
+        instruction.op = equal ? Rule::Op::EQUAL : Rule::Op::NOT_EQUAL;
+        break;
+      }
+      default:
+        return fail(binary.opr, "Binary operation '" +
+                                    std::string(token::toString(
+                                        binary.opr.type)) +
+                                    "' not supported.");
+    }
+
+    return emit(std::move(instruction));
+  }
+
+  std::optional<int> ternary(const ast::Ternary &ternary) {
+    const auto condition = compile(*ternary.condition);
+    if (!condition) return std::nullopt;
+
+    const auto then_value = compile(*ternary.then_expr);
+    if (!then_value) return std::nullopt;
+
+    const auto else_value = compile(*ternary.else_expr);
+    if (!else_value) return std::nullopt;
+
+    if (typeOf(*then_value) != typeOf(*else_value)) {
+      return fail(ternary.then_opr,
+                  "Both branches must have the same type in a rule.");
+    }
+
+    // Numbers and strings are always truthy.
+    if (typeOf(*condition) != Type::LOGICO) {
+      return sequence(*condition, *then_value);
+    }
+
+    return emit({.op = Rule::Op::SELECT,
+                 .type = typeOf(*then_value),
+                 .a = *condition,
+                 .b = *then_value,
+                 .c = *else_value});
+  }
+
+  std::optional<int> literal(const ast::Literal &literal) {
+    switch (literal.token_type) {
+      case token::TokenType::LT_NUMBER:
+      case token::TokenType::LT_STRING:
+        return emit({.op = Rule::Op::CONSTANT,
+                     .type = literal.token_type == token::TokenType::LT_NUMBER
+                                 ? Type::NUMERO
+                                 : Type::TEXTO,
+                     .constant = literal.value});
+      case token::TokenType::KW_VERDADEIRO:
+      case token::TokenType::KW_FALSO:
+        return constant(std::any_cast<bool>(literal.value));
+      default:
+        error_state_.error(line_, "Columns cannot hold 'nulo'.");
+        return std::nullopt;
+    }
+  }
+
+  int constant(bool value) {
+    return emit(
+        {.op = Rule::Op::CONSTANT, .type = Type::LOGICO, .constant = value});
+  }
+
+  // The value of `second`, computed after `first`.
+  int sequence(int first, int second) {
+    return emit({.op = Rule::Op::SEQUENCE,
+                 .type = typeOf(second),
+                 .a = first,
+                 .b = second});
+  }
+
+  Type typeOf(int instruction) { return program_[instruction].type; }
+
+  int emit(Rule::Instruction instruction) {
+    for (const int operand : {instruction.a, instruction.b, instruction.c}) {
+      if (operand >= 0 && program_[operand].can_fail) {
+        instruction.can_fail = true;
+      }
+    }
+
+    if (instruction.op == Rule::Op::DIVIDE) instruction.can_fail = true;
+
+    program_.push_back(std::move(instruction));
+
+    return static_cast<int>(program_.size()) - 1;
+  }
+
+  std::optional<int> fail(const token::Token &token, std::string message) {
+    error_state_.error(token, std::move(message));
+    return std::nullopt;
+  }
+};
+}  // namespace columnar
+
+std::optional<columnar::Rule> columnar::Rule::compile(
+    const std::string &source, const Table &schema,
+    error::ErrorState &error_state) {
+  Lexer lexer(source, error_state);
+  std::vector<token::Token> tokens = lexer.scanTokens();
+
+  // The semicolon of the expression statement is optional.
+  if (tokens.size() > 1 &&
+      tokens[tokens.size() - 2].type != token::TokenType::SC_SEMICOLON) {
+    const int line = tokens[tokens.size() - 2].line;
+    tokens.insert(tokens.end() - 1,
+                  token::Token{.type = token::TokenType::SC_SEMICOLON,
+                               .lexeme = ";",
+                               .literal = {},
+                               .line = line});
+  }
+
+  arena::Arena allocator(64 * 1024);
+  Parser parser(&allocator, error_state, tokens);
+  const auto statements = parser.parse();
+
+  if (error_state.getHadError()) return std::nullopt;
+
+  const ast::Expression *expression =
+      statements.size() == 1
+          ? std::get_if<ast::Expression>(&statements.front().var)
+          : nullptr;
+
+  if (expression == nullptr) {
+    error_state.error(tokens.front().line,
+                      "A rule must be a single expression.");
+    return std::nullopt;
+  }
+
+  Rule rule;
+  RuleCompiler compiler(rule.program_, schema, error_state);
+
+  if (!compiler.compile(*expression->expression)) return std::nullopt;
+
+  return rule;
+}
+
+columnar::Type columnar::Rule::type() const { return program_.back().type; }
+
+// The column computed by every instruction for the current chunk. Columns of
+// the table are used in place, and constants are filled in once.
+struct columnar::Rule::Registers {
+  struct Register {
+    const float *numbers = nullptr;
+    const std::uint8_t *booleans = nullptr;
+    const std::string *texts = nullptr;
+    std::vector<float> own_numbers;
+    std::vector<std::uint8_t> own_booleans;
+    std::vector<std::string> own_texts;
+    // For the instructions that can fail: 0 for the rows that did not, or
+    // else one more than the index of the division that failed first.
+    std::vector<std::uint32_t> errors;
+  };
+
+  std::vector<Register> values;
+  std::vector<const Column *> columns;
+};
+
+error::RuntimeResult<columnar::Column> columnar::Rule::evaluate(
+    const Table &table) const {
+  Registers registers;
+  registers.values.resize(program_.size());
+  registers.columns.resize(program_.size(), nullptr);
+
+  for (std::size_t i = 0; i < program_.size(); i++) {
+    const Instruction &instruction = program_[i];
+    auto &value = registers.values[i];
+
+    if (instruction.can_fail) value.errors.resize(kChunkRows);
+
+    if (instruction.op == Op::COLUMN) {
+      const Column *column = table.find(instruction.column);
+
+      if (column == nullptr || column->type != instruction.type ||
+          column->size() != table.rows()) {
+        return error::Unexpected{error::RuntimeError(
+            instruction.token, "Column '" + instruction.column +
+                                   "' must be a " +
+                                   std::string(typeName(instruction.type)) +
+                                   " column of the table")};
+      }
+
+      registers.columns[i] = column;
+    } else if (instruction.op == Op::CONSTANT) {
+      if (instruction.type == Type::NUMERO) {
+        value.own_numbers.assign(kChunkRows,
+                                 std::any_cast<float>(instruction.constant));
+        value.numbers = value.own_numbers.data();
+      } else if (instruction.type == Type::TEXTO) {
+        value.own_texts.assign(
+            kChunkRows, std::any_cast<std::string>(instruction.constant));
+        value.texts = value.own_texts.data();
+      } else {
+        value.own_booleans.assign(kChunkRows,
+                                  std::any_cast<bool>(instruction.constant));
+        value.booleans = value.own_booleans.data();
+      }
+    }
+  }
+
+  const std::size_t rows = table.rows();
+  Column result;
+  result.type = type();
+
+  for (std::size_t begin = 0; begin < rows; begin += kChunkRows) {
+    const std::size_t count = std::min(kChunkRows, rows - begin);
+
+    run(registers, begin, count);
+
+    const auto &value = registers.values.back();
+
+    if (program_.back().can_fail) {
+      const auto failed = std::find_if(value.errors.begin(),
+                                       value.errors.begin() + count,
+                                       [](std::uint32_t id) { return id; });
+
+      if (failed != value.errors.begin() + count) {
+        const std::size_t row = begin + (failed - value.errors.begin()) + 1;
+
+        return error::Unexpected{error::RuntimeError(
+            program_[*failed - 1].token,
+            "Attempted to divide by zero in row " + std::to_string(row))};
+      }
+    }
+
+    if (result.type == Type::NUMERO) {
+      result.numbers.insert(result.numbers.end(), value.numbers,
+                            value.numbers + count);
+    } else if (result.type == Type::TEXTO) {
+      result.texts.insert(result.texts.end(), value.texts,
+                          value.texts + count);
+    } else {
+      result.booleans.insert(result.booleans.end(), value.booleans,
+                             value.booleans + count);
+    }
+  }
+
+  return result;
+}
+
+void columnar::Rule::run(Registers &registers, std::size_t begin,
+                         std::size_t count) const {
+  const auto text = [](const Registers::Register &value, Type type,
+                       std::size_t row) {
+    switch (type) {
+      case Type::TEXTO:
+        return value.texts[row];
+      case Type::LOGICO:
+        return std::string(value.booleans[row] ? token::KW_VERDADEIRO
+                                               : token::KW_FALSO);
+      default:
+        return helper::formatNumber(value.numbers[row]);
+    }
+  };
+
+  for (std::size_t i = 0; i < program_.size(); i++) {
+    const Instruction &instruction = program_[i];
+    auto &out = registers.values[i];
+
+    const auto *a = instruction.a >= 0 ? &registers.values[instruction.a]
+                                       : nullptr;
+    const auto *b = instruction.b >= 0 ? &registers.values[instruction.b]
+                                       : nullptr;
+    const auto *c = instruction.c >= 0 ? &registers.values[instruction.c]
+                                       : nullptr;
+
+    const auto numbers = [&out] {
+      out.own_numbers.resize(kChunkRows);
+      out.numbers = out.own_numbers.data();
+      return out.own_numbers.data();
+    };
+
+    const auto booleans = [&out] {
+      out.own_booleans.resize(kChunkRows);
+      out.booleans = out.own_booleans.data();
+      return out.own_booleans.data();
+    };
+
+    switch (instruction.op) {
+      case Op::COLUMN: {
+        const Column &column = *registers.columns[i];
+
+        if (column.type == Type::NUMERO) {
+          out.numbers = column.numbers.data() + begin;
+        } else if (column.type == Type::TEXTO) {
+          out.texts = column.texts.data() + begin;
+        } else {
+          out.booleans = column.booleans.data() + begin;
+        }
+        break;
+      }
+      case Op::CONSTANT:
+        break;
+      case Op::NEGATE:
+        simd::negate(a->numbers, numbers(), count);
+        break;
+      case Op::NOT:
+        simd::logicalNot(a->booleans, booleans(), count);
+        break;
+      case Op::ADD:
+        simd::add(a->numbers, b->numbers, numbers(), count);
+        break;
+      case Op::SUBTRACT:
+        simd::subtract(a->numbers, b->numbers, numbers(), count);
+        break;
+      case Op::MULTIPLY:
+        simd::multiply(a->numbers, b->numbers, numbers(), count);
+        break;
+      case Op::DIVIDE:
+        simd::divide(a->numbers, b->numbers, numbers(), count);
+        break;
+      case Op::CONCAT: {
+        const Type left = program_[instruction.a].type;
+        const Type right = program_[instruction.b].type;
+
+        out.own_texts.resize(kChunkRows);
+        out.texts = out.own_texts.data();
+
+        for (std::size_t row = 0; row < count; row++) {
+          out.own_texts[row] = text(*a, left, row) + text(*b, right, row);
+        }
+        break;
+      }
+      case Op::GREATER:
+      case Op::GREATER_EQUAL:
+      case Op::LESS:
+      case Op::LESS_EQUAL: {
+        // `a < b` is `b > a`.
+        const bool swapped =
+            instruction.op == Op::LESS || instruction.op == Op::LESS_EQUAL;
+        const bool inclusive = instruction.op == Op::GREATER_EQUAL ||
+                               instruction.op == Op::LESS_EQUAL;
+        const auto *x = swapped ? b : a;
+        const auto *y = swapped ? a : b;
+        std::uint8_t *result = booleans();
+
+        if (program_[instruction.a].type == Type::NUMERO) {
+          if (inclusive) {
+            simd::greaterEqual(x->numbers, y->numbers, result, count);
+          } else {
+            simd::greater(x->numbers, y->numbers, result, count);
+          }
+        } else {
+          for (std::size_t row = 0; row < count; row++) {
+            result[row] = inclusive ? x->texts[row] >= y->texts[row]
+                                    : x->texts[row] > y->texts[row];
+          }
+        }
+        break;
+      }
+      case Op::EQUAL:
+      case Op::NOT_EQUAL: {
+        const bool equal = instruction.op == Op::EQUAL;
+        std::uint8_t *result = booleans();
+
+        switch (program_[instruction.a].type) {
+          case Type::NUMERO:
+            if (equal) {
+              simd::equal(a->numbers, b->numbers, result, count);
+            } else {
+              simd::notEqual(a->numbers, b->numbers, result, count);
+            }
+            break;
+          case Type::LOGICO:
+            if (equal) {
+              simd::equal(a->booleans, b->booleans, result, count);
+            } else {
+              simd::notEqual(a->booleans, b->booleans, result, count);
+            }
+            break;
+          default:
+            for (std::size_t row = 0; row < count; row++) {
+              result[row] = (a->texts[row] == b->texts[row]) == equal;
+            }
+            break;
+        }
+        break;
+      }
+      case Op::AND:
+        simd::logicalAnd(a->booleans, b->booleans, booleans(), count);
+        break;
+      case Op::OR:
+        simd::logicalOr(a->booleans, b->booleans, booleans(), count);
+        break;
+      case Op::SELECT:
+        if (instruction.type == Type::NUMERO) {
+          simd::select(a->booleans, b->numbers, c->numbers, numbers(), count);
+        } else if (instruction.type == Type::LOGICO) {
+          simd::select(a->booleans, b->booleans, c->booleans, booleans(),
+                       count);
+        } else {
+          out.own_texts.resize(kChunkRows);
+          out.texts = out.own_texts.data();
+
+          for (std::size_t row = 0; row < count; row++) {
+            out.own_texts[row] =
+                a->booleans[row] ? b->texts[row] : c->texts[row];
+          }
+        }
+        break;
+      case Op::SEQUENCE:
+        out.numbers = b->numbers;
+        out.booleans = b->booleans;
+        out.texts = b->texts;
+        break;
+    }
+
+    if (!instruction.can_fail) continue;
+
+    // Only the operands that the interpreter would evaluate for a row can
+    // fail it, and the first failure in evaluation order wins.
+    const auto failure = [](const Registers::Register *value,
+                            std::size_t row) -> std::uint32_t {
+      return value != nullptr && !value->errors.empty() ? value->errors[row]
+                                                        : 0;
+    };
+
+    for (std::size_t row = 0; row < count; row++) {
+      std::uint32_t id = failure(a, row);
+
+      if (id == 0) {
+        switch (instruction.op) {
+          case Op::AND:
+            if (a->booleans[row]) id = failure(b, row);
+            break;
+          case Op::OR:
+            if (!a->booleans[row]) id = failure(b, row);
+            break;
+          case Op::SELECT:
+            id = failure(a->booleans[row] ? b : c, row);
+            break;
+          default:
+            id = failure(b, row);
+            break;
+        }
+      }
+
+      if (id == 0 && instruction.op == Op::DIVIDE && b->numbers[row] == 0.f) {
+        id = static_cast<std::uint32_t>(i) + 1;
+      }
+
+      out.errors[row] = id;
+    }
+  }
+}
+
+int columnar::run(const std::string &rule_path, const std::string &table_path,
+                  const std::optional<std::string> &output_path,
+                  std::ostream &output, std::ostream &error_output) {
+  SourceFile source_file;
+  const auto source = source_file.read(rule_path, error_output);
+  if (!source.has_value()) return EXIT_FAILURE;
+
+  auto table = read(table_path);
+  if (!table) {
+    error_output << table.error() << "." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  error::ErrorState error_state(&error_output);
+  const auto rule = Rule::compile(source.value(), table.value(), error_state);
+
+  if (!rule.has_value()) {
+    error_state.summary(output);
+    return EX_DATAERR;
+  }
+
+  auto result = rule->evaluate(table.value());
+  if (!result) {
+    error_state.runtimeError(result.error());
+    return EX_SOFTWARE;
+  }
+
+  if (output_path.has_value()) {
+    const auto written = write(
+        Table{.names = {"resultado"}, .columns = {std::move(result.value())}},
+        output_path.value());
+
+    if (!written) {
+      error_output << written.error() << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+  }
+
+  const Column &column = result.value();
+
+  for (std::size_t row = 0; row < column.size(); row++) {
+    switch (column.type) {
+      case Type::TEXTO:
+        output << column.texts[row] << '\n';
+        break;
+      case Type::LOGICO:
+        output << (column.booleans[row] ? token::KW_VERDADEIRO
+                                        : token::KW_FALSO)
+               << '\n';
+        break;
+      default:
+        output << helper::formatNumber(column.numbers[row]) << '\n';
+        break;
+    }
+  }
+
+  output.flush();
+
+  return EXIT_SUCCESS;
+}
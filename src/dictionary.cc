@@ -0,0 +1,218 @@
+#include "lusoscript/dictionary.hh"
+
+#include <bit>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+#include "lusoscript/simd.hh"
+
+namespace {
+// Slots are used up to 7/8 of the capacity, so that probes always end at a
+// group with an empty slot.
+std::size_t maxUsed(std::size_t capacity) { return capacity - capacity / 8; }
+
+// Spreads the bits of `x`, so that both the group a key starts at (the high
+// bits) and its control byte (the low ones) depend on all of them.
+std::uint64_t mix(std::uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9u;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBu;
+  x ^= x >> 31;
+
+  return x;
+}
+}  // namespace
+
+Dictionary::Ref Dictionary::create() { return Ref::adopt(new Dictionary()); }
+
+std::optional<Dictionary::Key> Dictionary::toKey(const std::any &value) {
+  if (const auto *text = std::any_cast<std::string>(&value)) return *text;
+
+  if (const auto *number = std::any_cast<float>(&value)) {
+    if (*number == 0.f) return 0.f;
+    if (std::isnan(*number)) return std::numeric_limits<float>::quiet_NaN();
+
+    return *number;
+  }
+
+  return std::nullopt;
+}
+
+std::any Dictionary::toValue(const Key &key) {
+  if (const auto *number = std::get_if<float>(&key)) return *number;
+  return std::get<std::string>(key);
+}
+
+std::any *Dictionary::find(const Key &key) {
+  const std::ptrdiff_t slot = findSlot(key, hash(key));
+  if (slot < 0) return nullptr;
+
+  return &entries_[slots_[slot]].value;
+}
+
+void Dictionary::insert(Key key, std::any value) {
+  const std::uint64_t key_hash = hash(key);
+
+  if (const std::ptrdiff_t slot = findSlot(key, key_hash); slot >= 0) {
+    entries_[slots_[slot]].value = std::move(value);
+    return;
+  }
+
+  add(std::move(key), std::move(value), key_hash);
+}
+
+void Dictionary::insert(std::span<std::pair<Key, std::any>> entries) {
+  std::vector<std::uint64_t> hashes;
+  hashes.reserve(entries.size());
+
+  for (const auto &[key, value] : entries) hashes.push_back(hash(key));
+
+  reserve(size_ + entries.size());
+
+  for (std::size_t i = 0; i < entries.size(); i++) {
+    auto &[key, value] = entries[i];
+
+    if (const std::ptrdiff_t slot = findSlot(key, hashes[i]); slot >= 0) {
+      entries_[slots_[slot]].value = std::move(value);
+    } else {
+      add(std::move(key), std::move(value), hashes[i]);
+    }
+  }
+}
+
+// A slot can be emptied rather than marked deleted when its group has an
+// empty slot already, since no probe went past the group then. The erased
+// entry stays in the entries, and once they hold more erased entries than
+// live ones, the table is rebuilt without them, so that adding and erasing
+// keys over and over takes no more room than the live entries need.
+bool Dictionary::erase(const Key &key) {
+  const std::ptrdiff_t slot = findSlot(key, hash(key));
+  if (slot < 0) return false;
+
+  Entry &entry = entries_[slots_[slot]];
+  entry.live = false;
+  entry.key = {};
+  entry.value.reset();
+
+  const std::size_t group = slot / simd::kGroupSize * simd::kGroupSize;
+
+  if (simd::matchBytes(&control_[group], kEmpty) != 0) {
+    control_[slot] = kEmpty;
+    used_--;
+  } else {
+    control_[slot] = kDeleted;
+  }
+
+  size_--;
+
+  if (entries_.size() - size_ > size_) rehash(size_);
+
+  return true;
+}
+
+void Dictionary::reserve(std::size_t count) {
+  if (count > maxUsed(control_.size())) rehash(count);
+}
+
+std::uint64_t Dictionary::hash(const Key &key) {
+  if (const auto *number = std::get_if<float>(&key)) {
+    return mix(std::bit_cast<std::uint32_t>(*number));
+  }
+
+  return mix(std::hash<std::string>{}(std::get<std::string>(key)) ^
+             0x9E3779B97F4A7C15u);
+}
+
+std::ptrdiff_t Dictionary::findSlot(const Key &key,
+                                    std::uint64_t hash) const {
+  if (control_.empty()) return -1;
+
+  const std::size_t group_mask = control_.size() / simd::kGroupSize - 1;
+  const auto tag = static_cast<std::uint8_t>(hash & 0x7F);
+  const auto *number = std::get_if<float>(&key);
+
+  // Visits every group, since their count is a power of two.
+  std::size_t group = (hash >> 7) & group_mask;
+
+  for (std::size_t step = 1;; step++) {
+    const std::size_t base = group * simd::kGroupSize;
+    const std::uint8_t *control = &control_[base];
+
+    for (std::uint32_t match = simd::matchBytes(control, tag); match != 0;
+         match &= match - 1) {
+      const std::size_t slot = base + std::countr_zero(match);
+      const Entry &entry = entries_[slots_[slot]];
+
+      if (entry.hash != hash || entry.key.index() != key.index()) continue;
+
+      // Numbers are compared by their bits, which makes NaN equal to itself.
+      if (number != nullptr
+              ? std::bit_cast<std::uint32_t>(std::get<float>(entry.key)) ==
+                    std::bit_cast<std::uint32_t>(*number)
+              : std::get<std::string>(entry.key) ==
+                    std::get<std::string>(key)) {
+        return static_cast<std::ptrdiff_t>(slot);
+      }
+    }
+
+    if (simd::matchBytes(control, kEmpty) != 0) return -1;
+
+    group = (group + step) & group_mask;
+  }
+}
+
+void Dictionary::add(Key key, std::any value, std::uint64_t hash) {
+  if (used_ + 1 > maxUsed(control_.size())) rehash(size_ + 1);
+
+  entries_.push_back({.key = std::move(key),
+                      .value = std::move(value),
+                      .hash = hash,
+                      .live = true});
+  place(static_cast<std::uint32_t>(entries_.size() - 1), hash);
+
+  size_++;
+}
+
+// Erased entries leave holes in the entries, which rehashing closes. The
+// capacity doubles until there is room for `count` entries and as many more,
+// so that a table full of erased slots is rebuilt at its size.
+void Dictionary::rehash(std::size_t count) {
+  std::size_t capacity = simd::kGroupSize;
+  while (maxUsed(capacity) < count * 2) capacity *= 2;
+
+  std::erase_if(entries_, [](const Entry &entry) { return !entry.live; });
+
+  control_.assign(capacity, kEmpty);
+  slots_.assign(capacity, 0);
+  used_ = 0;
+
+  for (std::size_t i = 0; i < entries_.size(); i++) {
+    place(static_cast<std::uint32_t>(i), entries_[i].hash);
+  }
+}
+
+// Puts the entry in the first slot of its probe that is empty or deleted.
+void Dictionary::place(std::uint32_t entry, std::uint64_t hash) {
+  const std::size_t group_mask = control_.size() / simd::kGroupSize - 1;
+  std::size_t group = (hash >> 7) & group_mask;
+
+  for (std::size_t step = 1;; step++) {
+    const std::size_t base = group * simd::kGroupSize;
+    const std::uint32_t free = simd::highBits(&control_[base]);
+
+    if (free != 0) {
+      const std::size_t slot = base + std::countr_zero(free);
+
+      if (control_[slot] == kEmpty) used_++;
+
+      control_[slot] = static_cast<std::uint8_t>(hash & 0x7F);
+      slots_[slot] = entry;
+
+      return;
+    }
+
+    group = (group + step) & group_mask;
+  }
+}
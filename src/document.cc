@@ -0,0 +1,290 @@
+#include "lusoscript/document.hh"
+
+#include <algorithm>
+
+#include "lusoscript/lexer.hh"
+#include "lusoscript/parser.hh"
+
+namespace {
+// Initial arena block of a top-level declaration. Larger declarations chain
+// more blocks.
+constexpr std::size_t kDeclarationArenaSize = 16 * 1024;
+
+bool sameValue(const std::any &a, const std::any &b) {
+  if (a.type() != b.type()) return false;
+
+  if (const auto *number = std::any_cast<float>(&a)) {
+    return *number == std::any_cast<float>(b);
+  }
+  if (const auto *text = std::any_cast<std::string>(&a)) {
+    return *text == std::any_cast<std::string>(b);
+  }
+  if (const auto *boolean = std::any_cast<bool>(&a)) {
+    return *boolean == std::any_cast<bool>(b);
+  }
+
+  return true;
+}
+
+// Whether declarations resolved with `a` or with `b` resolve the same: the
+// same constants, in the same order, folded to the same literals.
+bool sameConstants(const Resolver::Constants &a,
+                   const Resolver::Constants &b) {
+  if (a.size() != b.size()) return false;
+
+  for (const auto &[name, constant] : a) {
+    const auto it = b.find(name);
+    if (it == b.end() || it->second.order != constant.order ||
+        it->second.value.has_value() != constant.value.has_value()) {
+      return false;
+    }
+
+    if (constant.value.has_value() &&
+        (it->second.value->token_type != constant.value->token_type ||
+         !sameValue(it->second.value->value, constant.value->value))) {
+      return false;
+    }
+  }
+
+  return true;
+}
+}  // namespace
+
+Document::Document(std::string text) {
+  tokens_.push_back(
+      {.type = token::TokenType::END_OF_FILE, .lexeme = "", .line = 1});
+
+  edit(0, 0, text);
+}
+
+void Document::edit(int offset, int length, const std::string &text) {
+  const auto old_begin = text_.begin() + offset;
+  const int line_delta =
+      static_cast<int>(std::count(text.begin(), text.end(), '\n') -
+                       std::count(old_begin, old_begin + length, '\n'));
+
+  text_.replace(offset, length, text);
+
+  const Damage damage =
+      relex(offset, length, static_cast<int>(text.size()), line_delta);
+  reparse(damage);
+}
+
+const std::string &Document::getText() { return text_; }
+
+const std::vector<token::Token> &Document::getTokens() { return tokens_; }
+
+std::vector<error::Diagnostic> Document::getDiagnostics() {
+  std::vector<error::Diagnostic> diagnostics;
+
+  for (const auto &lexical_error : lexical_errors_) {
+    diagnostics.push_back(lexical_error.diagnostic);
+  }
+
+  for (const auto &declaration : declarations_) {
+    for (auto diagnostic : declaration.diagnostics) {
+      diagnostic.line += declaration.line_shift;
+      diagnostics.push_back(std::move(diagnostic));
+    }
+  }
+
+  std::stable_sort(diagnostics.begin(), diagnostics.end(),
+                   [](const error::Diagnostic &a, const error::Diagnostic &b) {
+                     return a.line < b.line;
+                   });
+
+  return diagnostics;
+}
+
+std::vector<const ast::Stmt *> Document::getStatements() {
+  std::vector<const ast::Stmt *> stmts;
+  stmts.reserve(declarations_.size());
+
+  for (const auto &declaration : declarations_) {
+    stmts.push_back(&declaration.stmt);
+  }
+
+  return stmts;
+}
+
+// Re-lexes from the last token boundary before the edit until the new tokens
+// line up again with the old ones (same shifted offset, type and length),
+// then splices the new tokens in and shifts the reused ones.
+Document::Damage Document::relex(int offset, int length, int inserted,
+                                 int line_delta) {
+  const int delta = inserted - length;
+  const int count = static_cast<int>(tokens_.size()) - 1;
+
+  // The first token affected by the edit. The lexer looks up to two
+  // characters past a token (e.g. "1." before a digit), so a token ending
+  // right before the edit is damaged too.
+  const int first = static_cast<int>(
+      std::lower_bound(tokens_.begin(), tokens_.begin() + count, offset,
+                       [](const token::Token &token, int edit_offset) {
+                         return token.end + 1 < edit_offset;
+                       }) -
+      tokens_.begin());
+
+  // The end of the previous token is a point where the lexer is between
+  // tokens, so lexing can restart there.
+  const int restart_offset = first > 0 ? tokens_[first - 1].end : 0;
+  const int restart_line = first > 0 ? tokens_[first - 1].line : 1;
+
+  error::ErrorState errors(nullptr);
+  Lexer lexer(text_, errors, restart_offset, restart_line);
+
+  std::vector<token::Token> fresh;
+  std::vector<LexicalError> fresh_errors;
+  int old_resync = count;
+
+  while (true) {
+    const int scan_offset = lexer.offset();
+    const std::size_t error_count = errors.getDiagnostics().size();
+
+    std::optional<token::Token> token = lexer.nextToken();
+
+    for (std::size_t i = error_count; i < errors.getDiagnostics().size(); i++) {
+      fresh_errors.push_back({scan_offset, errors.getDiagnostics()[i]});
+    }
+
+    if (!token.has_value()) break;
+
+    if (token->start >= offset + inserted) {
+      // Past the edit, an old token at the same (shifted) place with the same
+      // type and length means the rest of the old tokens is still valid.
+      const int old_start = token->start - delta;
+      const auto it = std::lower_bound(
+          tokens_.begin() + first, tokens_.begin() + count, old_start,
+          [](const token::Token &old, int start) { return old.start < start; });
+
+      if (it != tokens_.begin() + count && it->start == old_start &&
+          it->type == token->type &&
+          it->end - it->start == token->end - token->start) {
+        old_resync = static_cast<int>(it - tokens_.begin());
+        break;
+      }
+    }
+
+    fresh.push_back(std::move(token.value()));
+  }
+
+  // Source offset (in the new text) from which the old tokens were reused.
+  const int resync_offset =
+      old_resync < count ? tokens_[old_resync].start + delta
+                         : static_cast<int>(text_.size());
+
+  // Replace the damaged tokens and shift the reused ones.
+  tokens_.erase(tokens_.begin() + first, tokens_.begin() + old_resync);
+  tokens_.insert(tokens_.begin() + first,
+                 std::make_move_iterator(fresh.begin()),
+                 std::make_move_iterator(fresh.end()));
+
+  for (auto it = tokens_.begin() + first + fresh.size(); it != tokens_.end();
+       it++) {
+    it->start += delta;
+    it->end += delta;
+    it->line += line_delta;
+  }
+
+  tokens_.back().start = tokens_.back().end = static_cast<int>(text_.size());
+
+  // Same for the lexical errors: drop those of the re-lexed range and shift
+  // the ones after it.
+  std::erase_if(lexical_errors_, [&](const LexicalError &lexical_error) {
+    return lexical_error.offset >= restart_offset &&
+           lexical_error.offset < resync_offset - delta;
+  });
+
+  for (auto &lexical_error : lexical_errors_) {
+    if (lexical_error.offset >= resync_offset - delta) {
+      lexical_error.offset += delta;
+      lexical_error.diagnostic.line += line_delta;
+    }
+  }
+
+  lexical_errors_.insert(lexical_errors_.end(), fresh_errors.begin(),
+                         fresh_errors.end());
+  std::sort(lexical_errors_.begin(), lexical_errors_.end(),
+            [](const LexicalError &a, const LexicalError &b) {
+              return a.offset < b.offset;
+            });
+
+  return Damage{
+      .first = first,
+      .old_end = old_resync,
+      .token_delta = static_cast<int>(fresh.size()) - (old_resync - first),
+      .line_delta = line_delta,
+  };
+}
+
+// Re-parses top-level declarations from the first one that depends on a
+// damaged token until the parser reaches the start of an old declaration that
+// lies entirely after the damage, and that was parsed after the same
+// constants; that one and the rest are reused.
+void Document::reparse(const Damage &damage) {
+  // The first declaration whose tokens, or lookahead token, were damaged.
+  const auto first_decl = std::lower_bound(
+      declarations_.begin(), declarations_.end(), damage.first,
+      [](const Declaration &declaration, int first) {
+        return declaration.end < first;
+      });
+
+  int position = first_decl != declarations_.end() ? first_decl->first
+                 : declarations_.empty()            ? 0
+                                                    : declarations_.back().end;
+
+  std::vector<Declaration> parsed;
+  auto reused = first_decl;
+
+  // The constants of the declarations before the one being parsed.
+  Resolver::Constants constants = first_decl != declarations_.begin()
+                                      ? std::prev(first_decl)->constants
+                                      : Resolver::Constants{};
+
+  while (true) {
+    // Old declarations located after the damage move by `token_delta`.
+    while (reused != declarations_.end() &&
+           (reused->first < damage.old_end ||
+            reused->first + damage.token_delta < position)) {
+      reused++;
+    }
+
+    if (reused != declarations_.end() &&
+        reused->first + damage.token_delta == position &&
+        sameConstants(reused != declarations_.begin()
+                          ? std::prev(reused)->constants
+                          : Resolver::Constants{},
+                      constants)) {
+      break;
+    }
+
+    if (tokens_[position].type == token::TokenType::END_OF_FILE) {
+      reused = declarations_.end();
+      break;
+    }
+
+    Declaration declaration{.first = position, .line_shift = 0};
+    declaration.allocator =
+        std::make_unique<arena::Arena>(kDeclarationArenaSize);
+
+    error::ErrorState errors(nullptr);
+    Parser parser(declaration.allocator.get(), errors, tokens_);
+
+    declaration.stmt = parser.parseDeclaration(position, constants);
+    declaration.end = position;
+    declaration.diagnostics = errors.getDiagnostics();
+    declaration.constants = constants;
+
+    parsed.push_back(std::move(declaration));
+  }
+
+  for (auto it = reused; it != declarations_.end(); it++) {
+    it->first += damage.token_delta;
+    it->end += damage.token_delta;
+    it->line_shift += damage.line_delta;
+  }
+
+  const auto erase_end = declarations_.erase(first_decl, reused);
+  declarations_.insert(erase_end, std::make_move_iterator(parsed.begin()),
+                       std::make_move_iterator(parsed.end()));
+}
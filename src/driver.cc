@@ -1,24 +1,150 @@
 #include "lusoscript/driver.hh"
 
-#include <iostream>
+#include <algorithm>
+#include <streambuf>
 
-#include "lusoscript/arena.hh"
+#include "lusoscript/cache.hh"
 #include "lusoscript/interpreter.hh"
 #include "lusoscript/lexer.hh"
+#include "lusoscript/module_loader.hh"
 #include "lusoscript/parser.hh"
 
-void Driver::process(state::AppState *app_state) {
-  Lexer lexer(app_state->source, app_state->error);
-  std::vector<token::Token> tokens = lexer.scanTokens();
+namespace {
+// Passes everything through to another stream, keeping a copy of it until
+// told to stop.
+class RecordingBuffer : public std::streambuf {
+ public:
+  explicit RecordingBuffer(std::ostream &target)
+      : target_(target), recording_(true) {}
+
+  [[nodiscard]] bool isRecording() const { return recording_; }
+
+  // Returns what was recorded.
+  std::string stopRecording() {
+    recording_ = false;
+    return std::move(recorded_);
+  }
+
+ protected:
+  int_type overflow(int_type c) override {
+    if (traits_type::eq_int_type(c, traits_type::eof())) return 0;
+
+    const char character = traits_type::to_char_type(c);
+    return xsputn(&character, 1) == 1 ? c : traits_type::eof();
+  }
+
+  std::streamsize xsputn(const char *data, std::streamsize size) override {
+    if (recording_) recorded_.append(data, static_cast<std::size_t>(size));
 
+    target_.write(data, size);
+    return target_ ? size : 0;
+  }
+
+  int sync() override {
+    target_.flush();
+    return target_ ? 0 : -1;
+  }
+
+ private:
+  std::ostream &target_;
+  bool recording_;
+  std::string recorded_;
+};
+}  // namespace
+
+void Driver::process(state::AppState *app_state) {
   // Allocates 4 MB of memory for the arena.
   arena::Arena allocator(1024 * 1024 * 4);
 
-  Parser parser(&allocator, app_state->error, tokens);
+  process(app_state, allocator);
+}
+
+void Driver::process(state::AppState *app_state, arena::Arena &allocator) {
+  Lexer lexer(app_state->source, app_state->error);
+  std::vector<token::Token> tokens = lexer.scanTokens();
+
+  // Braced bodies are parsed on first execution; the parser must therefore
+  // outlive the interpreter.
+  Parser parser(&allocator, app_state->error, tokens, true);
   const auto statements = parser.parse();
 
   if (!app_state->error.getHadError()) {
-    Interpreter interpreter{app_state->error, app_state->mode};
+    Interpreter interpreter{app_state->error, app_state->mode,
+                            *app_state->output};
+    interpreter.interpret(statements);
+  }
+}
+
+void Driver::process(state::AppState *app_state,
+                     const std::string &script_path) {
+  ModuleLoader loader;
+  const ModuleLoader::Module *script =
+      loader.load(script_path, app_state->source, app_state->error);
+
+  if (script == nullptr) return;
+
+  const std::vector<ast::Stmt> &statements = script->statements;
+
+  const auto marker = std::find_if(
+      statements.begin(), statements.end(), [](const ast::Stmt &stmt) {
+        return std::holds_alternative<ast::Instantaneo>(stmt.var);
+      });
+
+  if (marker == statements.end()) {
+    Interpreter interpreter{app_state->error, app_state->mode,
+                            *app_state->output};
+    interpreter.setModules(loader, *script);
     interpreter.interpret(statements);
+    return;
   }
+
+  // A snapshot is only valid for the same script and modules.
+  const std::uint64_t key = loader.getKey();
+  const std::string snapshot_path = cache::path(script_path, key, ".lusnap");
+
+  // Start right after the marker, as the run that took the snapshot was.
+  if (auto snapshot = cache::loadSnapshot(snapshot_path, key)) {
+    *app_state->output << snapshot->output;
+
+    Interpreter interpreter{app_state->error, app_state->mode,
+                            *app_state->output, std::move(snapshot->globals)};
+    interpreter.setModules(loader, *script);
+    interpreter.assumeImported(
+        std::span<const ast::Stmt>(statements.begin(), marker));
+
+    if (const auto declared = interpreter.restoreDeclarations(
+            std::span<const ast::Stmt>(statements.begin(), marker));
+        !declared) {
+      app_state->error.runtimeError(declared.error());
+      return;
+    }
+
+    interpreter.interpret(
+        std::span<const ast::Stmt>(std::next(marker), statements.end()));
+    return;
+  }
+
+  // What the statements before the marker print goes in the snapshot too.
+  RecordingBuffer recording(*app_state->output);
+  std::ostream output(&recording);
+
+  Interpreter interpreter{app_state->error, app_state->mode, output};
+  interpreter.setModules(loader, *script);
+  interpreter.setSnapshotHandler(
+      [&](const env::Environment &globals) {
+        if (!recording.isRecording()) return;
+
+        std::string problem;
+
+        if (!cache::storeSnapshot(
+                snapshot_path, key, globals, recording.stopRecording(),
+                std::span<const ast::Stmt>(statements.begin(), marker),
+                problem) &&
+            !problem.empty()) {
+          app_state->error.warning(
+              std::get<ast::Instantaneo>(marker->var).keyword.line,
+              "No snapshot taken, as " + problem + ", which cannot be stored.");
+        }
+      });
+  interpreter.interpret(statements);
 }
@@ -0,0 +1,85 @@
+#include "lusoscript/engine.hh"
+
+#include <sstream>
+
+#include "lusoscript/arena.hh"
+#include "lusoscript/ast.hh"
+#include "lusoscript/interpreter.hh"
+#include "lusoscript/lexer.hh"
+#include "lusoscript/parser.hh"
+
+namespace {
+// Capacity of the first block of the arena of a program.
+constexpr std::size_t kArenaBlockSize = 64 * 1024;
+
+// Programs run like source files: expression statements print nothing.
+constexpr state::RunningMode kMode = state::RunningMode::SourceFile;
+}  // namespace
+
+// The statements of a program, in the arena that holds their nodes. Blocks
+// are parsed ahead of time, since parsing them on first execution would
+// modify the program while it runs.
+struct lusoscript::Program::Compiled {
+  arena::Arena allocator{kArenaBlockSize};
+  std::vector<ast::Stmt> statements;
+};
+
+lusoscript::Context::Context(const Inputs &inputs) {
+  for (const auto &[name, value] : inputs) env_.define(name, value);
+}
+
+void lusoscript::Context::set(const std::string &name, std::any value) {
+  env_.define(name, value);
+}
+
+std::optional<std::any> lusoscript::Context::get(const std::string &name) {
+  auto value = env_.get(token::Token{
+      .type = token::TokenType::LT_IDENTIFIER, .lexeme = name, .line = 0});
+  if (!value) return std::nullopt;
+
+  return value.value();
+}
+
+lusoscript::Program::Program(std::shared_ptr<const Compiled> compiled)
+    : compiled_(std::move(compiled)) {}
+
+error::RuntimeResult<> lusoscript::Program::run(Context &context,
+                                                std::ostream &output) const {
+  // Runtime errors are returned, so the error state only records them.
+  error::ErrorState error_state(nullptr);
+  Interpreter interpreter(error_state, kMode, output, std::move(context.env_));
+
+  const auto result = interpreter.run(compiled_->statements);
+  context.env_ = std::move(interpreter.getEnvironment());
+
+  return result;
+}
+
+error::RuntimeResult<std::string> lusoscript::Program::run(
+    const Inputs &inputs) const {
+  Context context(inputs);
+  std::ostringstream output;
+
+  const auto result = run(context, output);
+  if (!result) return result.unexpected();
+
+  return output.str();
+}
+
+error::Result<lusoscript::Program, std::vector<error::Diagnostic>>
+lusoscript::Engine::compile(const std::string &source) const {
+  error::ErrorState error_state(nullptr);
+
+  Lexer lexer(source, error_state);
+  const std::vector<token::Token> tokens = lexer.scanTokens();
+
+  auto compiled = std::make_shared<Program::Compiled>();
+  Parser parser(&compiled->allocator, error_state, tokens);
+  compiled->statements = parser.parse();
+
+  if (error_state.getHadError()) {
+    return error::Unexpected{error_state.getDiagnostics()};
+  }
+
+  return Program(std::move(compiled));
+}
@@ -1,13 +1,12 @@
 #include "lusoscript/environment.hh"
 
-#include "lusoscript/error.hh"
-
 env::Environment::Environment() : enclosing_(nullptr), values_({}) {}
 
 env::Environment::Environment(env::Environment *enclosing)
     : enclosing_(enclosing), values_({}) {}
 
-std::any env::Environment::get(const token::Token &token) {
+error::RuntimeResult<std::any> env::Environment::get(
+    const token::Token &token) {
   const auto &identifier = token.lexeme.value();
 
   const auto it = values_.find(identifier);
@@ -15,27 +14,92 @@ std::any env::Environment::get(const token::Token &token) {
 
   if (enclosing_ != nullptr) return enclosing_->get(token);
 
-  throw error::RuntimeError(token, "Undefined variable '" + identifier + "'");
+  return error::Unexpected{error::RuntimeError(
+      token, "Undefined variable '" + identifier + "'")};
+}
+
+error::RuntimeResult<std::any *> env::Environment::find(
+    const token::Token &token) {
+  const auto &identifier = token.lexeme.value();
+
+  const auto it = values_.find(identifier);
+  if (it != values_.end()) {
+    if (auto check = checkAssignable(token); !check) return check.unexpected();
+    return &it->second;
+  }
+
+  if (enclosing_ != nullptr) return enclosing_->find(token);
+
+  return error::Unexpected{error::RuntimeError(
+      token, "Undefined variable '" + identifier + "'")};
 }
 
 void env::Environment::define(const std::string &name, const std::any &value) {
   values_[name] = value;
+  if (!constants_.empty()) constants_.erase(name);
 }
 
-void env::Environment::assign(const token::Token &token,
-                              const std::any &value) {
+void env::Environment::defineConstant(const std::string &name,
+                                      const std::any &value) {
+  values_[name] = value;
+  constants_.insert(name);
+}
+
+error::RuntimeResult<> env::Environment::assign(const token::Token &token,
+                                                const std::any &value) {
   const auto &identifier = token.lexeme.value();
 
   const auto it = values_.find(identifier);
   if (it != values_.end()) {
-    values_[identifier] = value;
-    return;
+    if (auto check = checkAssignable(token); !check) return check;
+
+    it->second = value;
+    return {};
   }
 
   if (enclosing_ != nullptr) {
-    enclosing_->assign(token, value);
-    return;
+    return enclosing_->assign(token, value);
+  }
+
+  return error::Unexpected{error::RuntimeError(
+      token, "Undefined variable '" + identifier + "'")};
+}
+
+env::Environment env::Environment::snapshot() const {
+  Environment copy =
+      enclosing_ != nullptr ? enclosing_->snapshot() : Environment();
+
+  for (const auto &[name, value] : values_) {
+    copy.values_[name] = value;
+    if (!copy.constants_.empty()) copy.constants_.erase(name);
+  }
+
+  copy.constants_.insert(constants_.begin(), constants_.end());
+
+  return copy;
+}
+
+bool env::Environment::isConstant(const std::string &name) const {
+  return !constants_.empty() && constants_.contains(name);
+}
+
+const std::unordered_map<std::string, std::any> &
+env::Environment::getValues() const {
+  return values_;
+}
+
+std::unordered_map<std::string, std::any> &env::Environment::getValues() {
+  return values_;
+}
+
+// Constants the resolver could not see, such as those of the modules a script
+// imports, are only found assigned here.
+error::RuntimeResult<> env::Environment::checkAssignable(
+    const token::Token &token) const {
+  if (constants_.empty() || !constants_.contains(token.lexeme.value())) {
+    return {};
   }
 
-  throw error::RuntimeError(token, "Undefined variable '" + identifier + "'");
+  return error::Unexpected{error::RuntimeError(
+      token, "Cannot assign the constant '" + token.lexeme.value() + "'")};
 }
@@ -2,8 +2,11 @@
 
 #include <iostream>
 
-error::ErrorState::ErrorState()
-    : had_error_(false),
+error::ErrorState::ErrorState() : ErrorState(&std::cerr) {}
+
+error::ErrorState::ErrorState(std::ostream *output)
+    : output_(output),
+      had_error_(false),
       had_runtime_error_(false),
       error_count_(0),
       warning_count_(0) {}
@@ -25,30 +28,56 @@ void error::ErrorState::error(token::Token token, std::string message) {
   setHadError();
 }
 
+void error::ErrorState::error(Diagnostic diagnostic) {
+  report(diagnostic.line, std::move(diagnostic.where),
+         std::move(diagnostic.message));
+  setHadError();
+}
+
 void error::ErrorState::runtimeError(const error::RuntimeError &error) {
-  std::cerr << "RuntimeError: " << error.what() << "\n\t on line "
-            << error.getToken().line << "." << std::endl;
+  if (output_ != nullptr) {
+    *output_ << "RuntimeError: " << error.getMessage() << "\n\t on line "
+             << error.getLine() << "." << std::endl;
+  }
   had_runtime_error_ = true;
 }
 
+void error::ErrorState::warning(int line, std::string message) {
+  if (output_ != nullptr) {
+    *output_ << "[line " << line << "] Warning: " << message << std::endl;
+  }
+  warning_count_++;
+}
+
 bool error::ErrorState::getHadError() { return had_error_; }
 
 bool error::ErrorState::getHadRuntimeError() { return had_runtime_error_; };
 
-void error::ErrorState::resetHadError() { had_error_ = false; }
+const std::vector<error::Diagnostic> &error::ErrorState::getDiagnostics() {
+  return diagnostics_;
+}
+
+void error::ErrorState::resetHadError() {
+  had_error_ = false;
+  diagnostics_.clear();
+}
 
 void error::ErrorState::resetHadRuntimeError() { had_runtime_error_ = false; }
 
-void error::ErrorState::summary() {
-  std::cout << std::string(48, '-') << std::endl;
-  std::cout << "Errors: " << error_count_ << std::endl;
-  std::cout << "Warnings: " << warning_count_ << std::endl;
+void error::ErrorState::summary(std::ostream &output) {
+  output << std::string(48, '-') << std::endl;
+  output << "Errors: " << error_count_ << std::endl;
+  output << "Warnings: " << warning_count_ << std::endl;
 }
 
 void error::ErrorState::report(int line, std::string where,
                                std::string message) {
-  std::cerr << "[line " << line << "] Error" << where << ": " << message
-            << std::endl;
+  if (output_ != nullptr) {
+    *output_ << "[line " << line << "] Error" << where << ": " << message
+             << std::endl;
+  }
+
+  diagnostics_.push_back({line, std::move(where), std::move(message)});
 }
 
 void error::ErrorState::setHadError() {
@@ -56,19 +85,17 @@ void error::ErrorState::setHadError() {
   if (!had_error_) had_error_ = true;
 }
 
-error::ParserError::ParserError(const std::string &message)
-    : std::runtime_error(message), message_(message) {}
+error::ParserError::ParserError(std::string message)
+    : message_(std::move(message)) {}
 
-const char *error::ParserError::what() const noexcept {
-  return message_.c_str();
-}
+const std::string &error::ParserError::getMessage() const { return message_; }
 
 error::RuntimeError::RuntimeError(const token::Token &token,
-                                  const std::string &message)
-    : std::runtime_error(message), message_(message), token_(token) {}
+                                  std::string message)
+    : message_(std::move(message)), line_(token.line) {}
 
-const char *error::RuntimeError::what() const noexcept {
-  return message_.c_str();
+const std::string &error::RuntimeError::getMessage() const {
+  return message_;
 }
 
-token::Token error::RuntimeError::getToken() const { return token_; }
+int error::RuntimeError::getLine() const { return line_; }
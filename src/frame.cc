@@ -0,0 +1,122 @@
+#include "lusoscript/frame.hh"
+
+#include <errno.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+constexpr std::size_t kHeaderSize = 5;
+
+bool readAll(int fd, char *data, std::size_t size) {
+  while (size > 0) {
+    const ssize_t count = ::read(fd, data, size);
+
+    if (count < 0 && errno == EINTR) continue;
+    if (count <= 0) return false;
+
+    data += count;
+    size -= static_cast<std::size_t>(count);
+  }
+
+  return true;
+}
+
+// Sends without raising SIGPIPE when the other end has gone away.
+bool writeAll(int fd, const char *data, std::size_t size) {
+  while (size > 0) {
+    const ssize_t count = ::send(fd, data, size, MSG_NOSIGNAL);
+
+    if (count < 0 && errno == EINTR) continue;
+    if (count <= 0) return false;
+
+    data += count;
+    size -= static_cast<std::size_t>(count);
+  }
+
+  return true;
+}
+
+void encode(std::uint32_t value, char *bytes) {
+  for (int i = 0; i < 4; i++) {
+    bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+  }
+}
+
+std::uint32_t decode(const char *bytes) {
+  std::uint32_t value = 0;
+
+  for (int i = 0; i < 4; i++) {
+    value |= static_cast<std::uint32_t>(static_cast<unsigned char>(bytes[i]))
+             << (8 * i);
+  }
+
+  return value;
+}
+}  // namespace
+
+bool frame::read(int fd, Frame &frame) {
+  char header[kHeaderSize];
+  if (!readAll(fd, header, kHeaderSize)) return false;
+
+  const std::uint32_t length = decode(header + 1);
+  if (length > kMaxPayload) return false;
+
+  frame.type = static_cast<Type>(header[0]);
+  frame.payload.resize(length);
+
+  return readAll(fd, frame.payload.data(), length);
+}
+
+bool frame::write(int fd, Type type, std::string_view payload) {
+  // One buffer, so that the frame goes out in a single call when it can.
+  std::string message(kHeaderSize, '\0');
+  message[0] = static_cast<char>(type);
+  encode(static_cast<std::uint32_t>(payload.size()), message.data() + 1);
+  message.append(payload);
+
+  return writeAll(fd, message.data(), message.size());
+}
+
+bool frame::writeExit(int fd, int exit_code) {
+  char payload[4];
+  encode(static_cast<std::uint32_t>(exit_code), payload);
+
+  return write(fd, Type::EXIT, std::string_view(payload, 4));
+}
+
+int frame::exitCode(const Frame &frame) {
+  if (frame.payload.size() != 4) return -1;
+  return static_cast<int>(decode(frame.payload.data()));
+}
+
+frame::Writer::Writer(int fd, Type type)
+    : std::ostream(nullptr), buffer_(fd, type) {
+  rdbuf(&buffer_);
+}
+
+frame::Writer::~Writer() { flush(); }
+
+frame::Writer::Buffer::Buffer(int fd, Type type) : fd_(fd), type_(type) {
+  setp(data_, data_ + sizeof(data_));
+}
+
+int frame::Writer::Buffer::sync() {
+  const auto size = static_cast<std::size_t>(pptr() - pbase());
+  if (size == 0) return 0;
+
+  const bool sent = frame::write(fd_, type_, std::string_view(pbase(), size));
+  setp(data_, data_ + sizeof(data_));
+
+  return sent ? 0 : -1;
+}
+
+frame::Writer::Buffer::int_type frame::Writer::Buffer::overflow(int_type c) {
+  if (sync() != 0) return traits_type::eof();
+
+  if (!traits_type::eq_int_type(c, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+  }
+
+  return traits_type::not_eof(c);
+}
@@ -5,4 +5,10 @@ bool endsWith(const std::string &str, const std::string &suffix) {
   if (str.length() < suffix.length()) return false;
   return str.substr(str.length() - suffix.length()) == suffix;
 }
+
+std::string formatNumber(float number) {
+  auto str = std::to_string(number);
+
+  return endsWith(str, ".000000") ? str.substr(0, str.length() - 7) : str;
+}
 }  // namespace helper
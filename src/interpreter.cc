@@ -2,148 +2,2072 @@
 
 #include <assert.h>
 
-#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <unordered_map>
+#include <string_view>
+
+#include "lusoscript/case_table.hh"
+#include "lusoscript/helper.hh"
+#include "lusoscript/parser.hh"
+#include "lusoscript/work_stealing_pool.hh"
+
+namespace {
+// Number of chunks the iterations of a parallel loop are split into, at most.
+constexpr std::size_t kParallelChunks = 256;
+
+// Calls nested deeper than this fail rather than overflow the native stack,
+// which every call still goes down: about 1 KB per call in a debug build,
+// more when calls nest in expressions.
+constexpr int kMaxCallDepth = 1000;
+// Slots of the call stack reserved when the first local is declared.
+constexpr std::size_t kStackSlots = 4096;
+
+// The slots a call to `function` takes for its arguments: the ones of its
+// parameters, after the one of `esse` for a method.
+std::size_t argumentSlots(const ast::Function &function) {
+  return function.params.size() +
+         (function.kind == ast::Function::Kind::FUNCTION ? 0 : 1);
+}
+
+// Arrays and dictionaries nested deeper than this, which may be ones holding
+// themselves, are printed as `[...]` and `{...}`.
+constexpr int kMaxPrintDepth = 8;
+
+constexpr float kDefaultChannelCapacity = 64;
+constexpr float kMaxChannelCapacity = 1 << 20;
+
+Channel::Type channelType(const std::string &name) {
+  if (name == "texto") return Channel::Type::TEXTO;
+  if (name == "logico") return Channel::Type::LOGICO;
+  return Channel::Type::NUMERO;
+}
+
+std::string_view channelTypeName(Channel::Type type) {
+  switch (type) {
+    case Channel::Type::TEXTO:
+      return "texto";
+    case Channel::Type::LOGICO:
+      return "logico";
+    default:
+      return "numero";
+  }
+}
+
+bool carries(Channel::Type type, const std::any &value) {
+  switch (type) {
+    case Channel::Type::TEXTO:
+      return value.type() == typeid(std::string);
+    case Channel::Type::LOGICO:
+      return value.type() == typeid(bool);
+    default:
+      return value.type() == typeid(float);
+  }
+}
+
+// Copies the values a task starts with, and the objects they hold, so that
+// the task shares none of them with the program: arrays, dictionaries,
+// instances, and the cells captured by functions, along with the functions
+// and the classes whose methods captured them. An object met again, even
+// inside itself, has the copy made the first time. Functions capturing nothing
+// and classes with no such methods cannot change, and are not copied.
+class TaskCopy {
+ public:
+  std::any copy(const std::any &value) {
+    auto result = this->value(value);
+    fillCells();
+
+    return result;
+  }
+
+  Closure::Ref copy(const Closure::Ref &closure) {
+    auto result = this->closure(closure);
+    fillCells();
+
+    return result;
+  }
+
+ private:
+  std::unordered_map<const void *, std::any> copies_;
+  // Copied cells whose values are not copied yet, with their originals.
+  std::vector<std::pair<std::shared_ptr<Cell>, const Cell *>> unfilled_;
+
+  // The copy made of `object` before, if any.
+  template <typename T>
+  std::optional<T> find(const void *object) const {
+    const auto it = copies_.find(object);
+    if (it == copies_.end()) return std::nullopt;
+
+    return std::any_cast<T>(it->second);
+  }
+
+  std::any value(const std::any &value) {
+    if (const auto *array = std::any_cast<Array::Ref>(&value)) {
+      return this->array(*array);
+    }
+
+    if (const auto *dictionary = std::any_cast<Dictionary::Ref>(&value)) {
+      return this->dictionary(*dictionary);
+    }
+
+    if (const auto *instance = std::any_cast<Instance::Ref>(&value)) {
+      return this->instance(*instance);
+    }
+
+    if (const auto *closure = std::any_cast<Closure::Ref>(&value)) {
+      return this->closure(*closure);
+    }
+
+    if (const auto *klass = std::any_cast<Class::Ref>(&value)) {
+      return this->klass(*klass);
+    }
+
+    if (const auto *bound = std::any_cast<BoundMethod::Ref>(&value)) {
+      return BoundMethod::create(instance((*bound)->getReceiver()),
+                                 closure((*bound)->getMethod()));
+    }
+
+    return value;
+  }
+
+  Array::Ref array(const Array::Ref &array) {
+    if (auto copy = find<Array::Ref>(array.get())) return *copy;
+
+    if (array->isPacked()) {
+      const auto numbers = array->getNumbers();
+      const Array::Ref copy =
+          Array::create(std::vector<float>(numbers.begin(), numbers.end()));
+
+      copies_[array.get()] = copy;
+      return copy;
+    }
+
+    const Array::Ref copy = Array::create(std::vector<std::any>{});
+    copies_[array.get()] = copy;
+
+    for (std::size_t i = 0; i < array->size(); i++) {
+      copy->append(value(array->get(i)));
+    }
+
+    return copy;
+  }
+
+  Dictionary::Ref dictionary(const Dictionary::Ref &dictionary) {
+    if (auto copy = find<Dictionary::Ref>(dictionary.get())) return *copy;
+
+    const Dictionary::Ref copy = Dictionary::create();
+    copies_[dictionary.get()] = copy;
+
+    copy->reserve(dictionary->size());
+    dictionary->forEach(
+        [&](const Dictionary::Key &key, const std::any &element) {
+          copy->insert(key, value(element));
+        });
+
+    return copy;
+  }
+
+  // The fields are added in the order the instance got them, which gives the
+  // copy the same shape, unless its class was copied.
+  Instance::Ref instance(const Instance::Ref &instance) {
+    if (auto copy = find<Instance::Ref>(instance.get())) return *copy;
+
+    const Instance::Ref copy = Instance::create(klass(instance->getClass()));
+    copies_[instance.get()] = copy;
+
+    const Shape *shape = instance->getShape();
+    const Shape *copy_shape = copy->getShape();
+
+    for (std::size_t slot = 0; slot < shape->size(); slot++) {
+      const int index = static_cast<int>(slot);
+
+      copy_shape = copy_shape->with(shape->name(index));
+      copy->addField(copy_shape, value(instance->getField(index)));
+    }
+
+    return copy;
+  }
+
+  Closure::Ref closure(const Closure::Ref &closure) {
+    const ast::Function &declaration = closure->getDeclaration();
+    if (declaration.captures.empty()) return closure;
+
+    if (auto copy = find<Closure::Ref>(closure.get())) return *copy;
+
+    std::vector<std::shared_ptr<Cell>> cells;
+    cells.reserve(declaration.captures.size());
+
+    for (std::size_t i = 0; i < declaration.captures.size(); i++) {
+      cells.push_back(cell(closure->getCell(static_cast<int>(i))));
+    }
+
+    const Closure::Ref copy = Closure::create(declaration, std::move(cells));
+    copies_[closure.get()] = copy;
+
+    return copy;
+  }
+
+  Class::Ref klass(const Class::Ref &klass) {
+    if (klass.get() == nullptr) return klass;
+    if (auto copy = find<Class::Ref>(klass.get())) return *copy;
+
+    Class::Ref superclass = this->klass(klass->getSuperclass());
+    bool copied = superclass != klass->getSuperclass();
+
+    std::unordered_map<std::string, Closure::Ref> methods;
+
+    for (const auto &[name, method] : klass->getMethods()) {
+      const Closure::Ref &copy = methods[name] = closure(method);
+      copied = copied || copy != method;
+    }
+
+    const Class::Ref copy =
+        copied ? Class::create(klass->getName(), std::move(superclass),
+                               std::move(methods))
+               : klass;
+    copies_[klass.get()] = copy;
+
+    return copy;
+  }
+
+  // The value of a cell is copied later, by `fillCells`, since a function or
+  // a class captured by its own methods may be in it, and is not copied yet.
+  std::shared_ptr<Cell> cell(const std::shared_ptr<Cell> &cell) {
+    if (auto copy = find<std::shared_ptr<Cell>>(cell.get())) return *copy;
+
+    auto copy = std::make_shared<Cell>(std::any{});
+    copies_[cell.get()] = copy;
+    unfilled_.emplace_back(copy, cell.get());
+
+    return copy;
+  }
+
+  void fillCells() {
+    while (!unfilled_.empty()) {
+      auto [copy, original] = std::move(unfilled_.back());
+      unfilled_.pop_back();
+
+      copy->value = value(original->value);
+    }
+  }
+};
+
+// The operands of `call`, in the order a call evaluates them: the callee, or
+// the instance a method is read from, then the arguments.
+std::vector<const ast::Expr *> operands(const ast::Call &call) {
+  std::vector<const ast::Expr *> result;
+
+  if (const auto *get = std::get_if<ast::Get>(&call.callee->var)) {
+    result.push_back(get->object.get());
+  } else if (!std::holds_alternative<ast::Super>(call.callee->var)) {
+    result.push_back(call.callee.get());
+  }
+
+  for (const auto &argument : call.arguments) {
+    result.push_back(argument.get());
+  }
+
+  return result;
+}
+
+// The operands of an expression, in the order `Interpreter::evaluate()`
+// evaluates them, including those that a condition may skip.
+struct OperandVisitor {
+  std::vector<const ast::Expr *> operator()(const ast::Assign &assign) {
+    return {assign.value.get()};
+  }
+
+  std::vector<const ast::Expr *> operator()(const ast::Update &update) {
+    if (update.value == nullptr) return {};
+    return {update.value.get()};
+  }
+
+  std::vector<const ast::Expr *> operator()(const ast::Ternary &ternary) {
+    return {ternary.condition.get(), ternary.then_expr.get(),
+            ternary.else_expr.get()};
+  }
+
+  std::vector<const ast::Expr *> operator()(const ast::Binary &binary) {
+    return {binary.left.get(), binary.right.get()};
+  }
+
+  std::vector<const ast::Expr *> operator()(const ast::Grouping &grouping) {
+    return {grouping.expression.get()};
+  }
+
+  std::vector<const ast::Expr *> operator()(const ast::Logical &logical) {
+    return {logical.left.get(), logical.right.get()};
+  }
+
+  std::vector<const ast::Expr *> operator()(const ast::Unary &unary) {
+    return {unary.right.get()};
+  }
+
+  std::vector<const ast::Expr *> operator()(const ast::Call &call) {
+    return operands(call);
+  }
+
+  std::vector<const ast::Expr *> operator()(const ast::Canal &canal) {
+    if (!canal.capacity.has_value()) return {};
+    return {canal.capacity.value().get()};
+  }
+
+  std::vector<const ast::Expr *> operator()(const ast::Receba &receba) {
+    return {receba.channel.get()};
+  }
+
+  std::vector<const ast::Expr *> operator()(const ast::Get &get) {
+    return {get.object.get()};
+  }
+
+  std::vector<const ast::Expr *> operator()(const ast::Set &set) {
+    return {set.object.get(), set.value.get()};
+  }
+
+  std::vector<const ast::Expr *> operator()(const ast::ArrayLiteral &array) {
+    std::vector<const ast::Expr *> result;
+
+    for (const auto &element : array.elements) {
+      result.push_back(element.get());
+    }
+
+    return result;
+  }
+
+  std::vector<const ast::Expr *> operator()(
+      const ast::DictionaryLiteral &dictionary) {
+    std::vector<const ast::Expr *> result;
+
+    for (std::size_t i = 0; i < dictionary.keys.size(); i++) {
+      result.push_back(dictionary.keys[i].get());
+      result.push_back(dictionary.values[i].get());
+    }
+
+    return result;
+  }
+
+  std::vector<const ast::Expr *> operator()(const ast::Index &index) {
+    return {index.object.get(), index.index.get()};
+  }
+
+  std::vector<const ast::Expr *> operator()(const ast::SetIndex &set) {
+    return {set.object.get(), set.index.get(), set.value.get()};
+  }
+
+  // Literals, variables, `esse` and `super`.
+  std::vector<const ast::Expr *> operator()(const auto &) { return {}; }
+};
+
+std::vector<const ast::Expr *> operands(const ast::Expr &expr) {
+  return std::visit(OperandVisitor{}, expr.var);
+}
+
+// Whether evaluating `expr` may call a function.
+bool callsFunction(const ast::Expr *expr) {
+  return std::holds_alternative<ast::Call>(expr->var) ||
+         std::ranges::any_of(operands(*expr), callsFunction);
+}
+
+// The expressions a simple statement evaluates, in order, before anything
+// else. The value of an update statement is evaluated by the update itself,
+// and the callee and arguments of a call in tail position by the `retorne`.
+std::vector<const ast::Expr *> operands(const ast::Stmt &stmt) {
+  if (const auto *expression = std::get_if<ast::Expression>(&stmt.var)) {
+    if (std::holds_alternative<ast::Update>(expression->expression->var)) {
+      return operands(*expression->expression);
+    }
+
+    return {expression->expression.get()};
+  }
+
+  if (const auto *imprima = std::get_if<ast::Imprima>(&stmt.var)) {
+    return {imprima->expression.get()};
+  }
+
+  if (const auto *variable = std::get_if<ast::Var>(&stmt.var)) {
+    if (!variable->initializer.has_value()) return {};
+    return {variable->initializer.value().get()};
+  }
+
+  if (const auto *retorne = std::get_if<ast::Retorne>(&stmt.var)) {
+    if (!retorne->value.has_value()) return {};
+
+    const ast::Expr &value = *retorne->value.value();
+
+    if (const auto *call = std::get_if<ast::Call>(&value.var)) {
+      return operands(*call);
+    }
+
+    return {&value};
+  }
+
+  if (const auto *envie = std::get_if<ast::Envie>(&stmt.var)) {
+    return {envie->channel.get(), envie->value.get()};
+  }
+
+  if (const auto *feche = std::get_if<ast::Feche>(&stmt.var)) {
+    return {feche->channel.get()};
+  }
+
+  return {};
+}
+}  // namespace
+
+// What a `para cada` loop goes through: the numbers of a range, computed one
+// at a time, the elements of an array, up to its size when each is reached,
+// or the keys a dictionary had when the loop started.
+class Interpreter::LoopSource {
+ public:
+  static std::optional<LoopSource> of(const std::any &value) {
+    LoopSource source;
+
+    if (const auto *range = std::any_cast<Range::Ref>(&value)) {
+      source.range_ = *range;
+    } else if (const auto *array = std::any_cast<Array::Ref>(&value)) {
+      source.array_ = *array;
+    } else if (const auto *dictionary =
+                   std::any_cast<Dictionary::Ref>(&value)) {
+      (*dictionary)->forEach([&source](const Dictionary::Key &key,
+                                       const std::any &) {
+        source.keys_.push_back(Dictionary::toValue(key));
+      });
+    } else {
+      return std::nullopt;
+    }
+
+    return source;
+  }
+
+  // Sets `value` to the next one, if any.
+  bool next(std::any &value) {
+    if (range_.get() != nullptr) {
+      if (index_ == range_->size()) return false;
+      value = range_->at(index_++);
+    } else if (array_.get() != nullptr) {
+      if (index_ >= array_->size()) return false;
+      value = array_->get(index_++);
+    } else {
+      if (index_ == keys_.size()) return false;
+      value = std::move(keys_[index_++]);
+    }
+
+    return true;
+  }
+
+ private:
+  Range::Ref range_;
+  Array::Ref array_;
+  std::vector<std::any> keys_;
+  std::uint64_t index_ = 0;
+};
+Interpreter::Interpreter(error::ErrorState &error_state,
+                         const state::RunningMode &mode, std::ostream &output)
+    : error_state_(error_state),
+      globals_({}),
+      mode_(mode),
+      output_(output),
+      worker_(false),
+      output_mutex_(std::make_shared<std::mutex>()) {
+  native::defineBuiltins(globals_);
+}
+
+Interpreter::Interpreter(error::ErrorState &error_state,
+                         const state::RunningMode &mode, std::ostream &output,
+                         env::Environment env)
+    : error_state_(error_state),
+      globals_(std::move(env)),
+      mode_(mode),
+      output_(output),
+      worker_(false),
+      output_mutex_(std::make_shared<std::mutex>()) {
+  native::defineBuiltins(globals_);
+}
+
+Interpreter::Interpreter(Interpreter &parent, std::ostream &output)
+    : error_state_(parent.error_state_),
+      globals_(&parent.globals_),
+      mode_(parent.mode_),
+      output_(output),
+      worker_(true) {
+  copyFrame(parent);
+}
+
+Interpreter::Interpreter(Interpreter &parent, env::Environment env)
+    : error_state_(parent.error_state_),
+      globals_(std::move(env)),
+      mode_(parent.mode_),
+      output_(parent.output_),
+      worker_(false),
+      output_mutex_(parent.output_mutex_),
+      tasks_(parent.tasks_) {
+  copyFrame(parent);
+}
+
+void Interpreter::interpret(std::span<const ast::Stmt> stmts) {
+  const auto result = run(stmts);
+  if (!result) error_state_.runtimeError(result.error());
+}
+
+// Runs the statements and waits for the tasks they started. The error of the
+// program itself comes first; otherwise, the one of the earliest started task
+// that failed is returned.
+error::RuntimeResult<> Interpreter::run(std::span<const ast::Stmt> stmts) {
+  error::RuntimeResult<> result;
+
+  for (const ast::Stmt &stmt : stmts) {
+    result = execute(stmt);
+    if (!result) break;
+  }
+
+  const auto task_error = joinTasks();
+
+  if (result && task_error.has_value()) {
+    return error::Unexpected{task_error.value()};
+  }
+
+  return result;
+}
+
+env::Environment &Interpreter::getEnvironment() { return globals_; }
+
+void Interpreter::setSnapshotHandler(
+    std::function<void(const env::Environment &)> handler) {
+  snapshot_handler_ = std::move(handler);
+}
+
+void Interpreter::setModules(const ModuleLoader &loader,
+                             const ModuleLoader::Module &script) {
+  modules_ = &loader;
+  // A module importing the script back does not run it again.
+  imported_.insert(&script);
+}
+
+void Interpreter::assumeImported(std::span<const ast::Stmt> stmts) {
+  if (modules_ == nullptr) return;
+
+  for (const ast::Stmt &stmt : stmts) {
+    const auto *importe = std::get_if<ast::Importe>(&stmt.var);
+    if (importe == nullptr) continue;
+
+    const ModuleLoader::Module *module = modules_->find(*importe);
+    if (module != nullptr && imported_.insert(module).second) {
+      assumeImported(module->statements);
+    }
+  }
+}
+
+error::RuntimeResult<> Interpreter::restoreDeclarations(
+    std::span<const ast::Stmt> stmts) {
+  // Built-in functions are there whatever the snapshot holds.
+  const auto restored = [&](const std::string &name) {
+    const auto &values = globals_.getValues();
+    const auto found = values.find(name);
+    if (found == values.end()) return false;
+
+    const auto *native = std::any_cast<NativeFunction::Ref>(&found->second);
+    return native == nullptr || (*native)->getName() != name;
+  };
+
+  // Decided for all of them first, since a name may be declared twice.
+  std::vector<const ast::Stmt *> declarations;
+
+  for (const ast::Stmt &stmt : stmts) {
+    const token::Token *name = nullptr;
+
+    if (const auto *function = std::get_if<ast::Function>(&stmt.var)) {
+      name = &function->name;
+    } else if (const auto *klass = std::get_if<ast::Classe>(&stmt.var)) {
+      name = &klass->name;
+    }
+
+    if (name != nullptr && !restored(name->lexeme.value())) {
+      declarations.push_back(&stmt);
+    }
+  }
+
+  for (const ast::Stmt *declaration : declarations) {
+    const auto result = execute(*declaration);
+    if (!result) return result;
+  }
+
+  return {};
+}
+
+// Runs the module imported by `importe` in the global scope, the first time
+// it is imported. Its own snapshot marker, if any, does nothing.
+error::RuntimeResult<> Interpreter::runModule(const ast::Importe &importe) {
+  const ModuleLoader::Module *module =
+      modules_ != nullptr ? modules_->find(importe) : nullptr;
+
+  if (module == nullptr) {
+    return error::Unexpected{error::RuntimeError(
+        importe.keyword, "Modules can only be imported by scripts run from a "
+                         "file.")};
+  }
+
+  if (!imported_.insert(module).second) return {};
+
+  for (const ast::Stmt &stmt : module->statements) {
+    if (std::holds_alternative<ast::Instantaneo>(stmt.var)) continue;
+
+    const auto result = execute(stmt);
+    if (!result) return result;
+  }
+
+  return {};
+}
+
+error::RuntimeResult<> Interpreter::execute(const ast::Stmt &stmt) {
+  struct VoidVisitor {
+    Interpreter &interpreter;
+
+    error::RuntimeResult<> operator()(const ast::Block &block) {
+      return interpreter.executeBlock(block.stmts);
+    };
+
+    error::RuntimeResult<> operator()(const ast::Expression &expression) {
+      // An update whose value goes unused is not copied, which would copy
+      // the whole of a string that is appended to.
+      if (const auto *update =
+              std::get_if<ast::Update>(&expression.expression->var);
+          update != nullptr && interpreter.mode_ != state::RunningMode::REPL) {
+        const auto target = interpreter.update(*update, nullptr);
+        if (!target) return target.unexpected();
+
+        return {};
+      }
+
+      const auto result = interpreter.evaluate(*expression.expression);
+      if (!result) return result.unexpected();
+
+      // If the interpreter is running in "REPL mode," print the result of
+      // evaluated expressions.
+      if (interpreter.mode_ == state::RunningMode::REPL) {
+        const auto lock = interpreter.lockOutput();
+        interpreter.output_ << interpreter.stringify(result.value())
+                            << std::endl;
+      }
+
+      return {};
+    };
+
+    error::RuntimeResult<> operator()(const ast::Imprima &imprima) {
+      const auto value = interpreter.evaluate(*imprima.expression);
+      if (!value) return value.unexpected();
+
+      const auto lock = interpreter.lockOutput();
+      interpreter.output_ << interpreter.stringify(value.value()) << std::endl;
+
+      return {};
+    }
+
+    error::RuntimeResult<> operator()(const ast::Var &variable) {
+      std::any value = env::Uninitialized{};
+
+      const auto &initializer = variable.initializer;
+
+      if (initializer.has_value()) {
+        auto result = interpreter.evaluate(*initializer.value());
+        if (!result) return result.unexpected();
+
+        value = std::move(result.value());
+      }
+
+      if (variable.constant && variable.slot < 0) {
+        interpreter.globals_.defineConstant(variable.name.lexeme.value(),
+                                            value);
+        return {};
+      }
+
+      interpreter.define(variable.name, variable.slot, std::move(value));
+
+      return {};
+    }
+
+    error::RuntimeResult<> operator()(const ast::If &stmt) {
+      const auto condition = interpreter.evaluate(*stmt.condition);
+      if (!condition) return condition.unexpected();
+
+      if (interpreter.isTruthy(condition.value())) {
+        return interpreter.execute(*stmt.then_branch);
+      } else if (stmt.else_branch.has_value()) {
+        return interpreter.execute(*stmt.else_branch.value());
+      }
+
+      return {};
+    }
+
+    error::RuntimeResult<> operator()(const ast::While &stmt) {
+      // Immediately evaluates the condition, and, if truthy, the statement body
+      // is executed.
+      auto condition = interpreter.evaluate(*stmt.condition);
+      if (!condition) return condition.unexpected();
+
+      while (interpreter.isTruthy(condition.value())) {
+        const auto result = interpreter.execute(*stmt.body);
+        if (!result || interpreter.returning_) return result;
+
+        // Evaluates the condition again after the body is executed, because if
+        // it is not truthy, the loop will be left immediately.
+        condition = interpreter.evaluate(*stmt.condition);
+        if (!condition) return condition.unexpected();
+      }
+
+      return {};
+    }
+
+    error::RuntimeResult<> operator()(const ast::LazyBlock &lazy) {
+      return interpreter.execute(lazy.parser->parseLazyBlock(lazy));
+    }
+
+    error::RuntimeResult<> operator()(const ast::ParallelFor &loop) {
+      return interpreter.executeParallelFor(loop);
+    }
+
+    // The variable is a local, rebound in place, so that an iteration costs
+    // no more than an assignment besides its body. Closures created by an
+    // iteration capture a variable of their own, since rebinding replaces
+    // the cell they moved it to.
+    error::RuntimeResult<> operator()(const ast::ForEach &loop) {
+      auto source = interpreter.evaluateSource(loop);
+      if (!source) return source.unexpected();
+
+      std::any value;
+
+      while (source.value().next(value)) {
+        interpreter.declareLocal(loop.slot) = std::move(value);
+
+        const auto result = interpreter.execute(*loop.body);
+        if (!result || interpreter.returning_) return result;
+      }
+
+      return {};
+    }
+
+    error::RuntimeResult<> operator()(const ast::Escolha &escolha) {
+      const auto body = interpreter.evaluateCase(escolha);
+      if (!body) return body.unexpected();
+
+      if (body.value() == nullptr) return {};
+      return interpreter.execute(*body.value());
+    }
+
+    error::RuntimeResult<> operator()(const ast::Tarefa &tarefa) {
+      interpreter.startTask(tarefa);
+      return {};
+    }
+
+    error::RuntimeResult<> operator()(const ast::Envie &envie) {
+      const auto channel =
+          interpreter.evaluateChannel(envie.keyword, *envie.channel);
+      if (!channel) return channel.unexpected();
+
+      auto value = interpreter.evaluate(*envie.value);
+      if (!value) return value.unexpected();
+
+      const Channel::Type type = channel.value()->getType();
+
+      if (!carries(type, value.value())) {
+        return error::Unexpected{error::RuntimeError(
+            envie.keyword, "Channel only carries " +
+                               std::string(channelTypeName(type)) +
+                               " values")};
+      }
+
+      if (!channel.value()->send(std::move(value.value()))) {
+        return error::Unexpected{error::RuntimeError(
+            envie.keyword, "Cannot send to a closed channel")};
+      }
+
+      return {};
+    }
+
+    error::RuntimeResult<> operator()(const ast::Feche &feche) {
+      const auto channel =
+          interpreter.evaluateChannel(feche.keyword, *feche.channel);
+      if (!channel) return channel.unexpected();
+
+      channel.value()->close();
+
+      return {};
+    }
+
+    error::RuntimeResult<> operator()(const ast::Instantaneo &) {
+      // Tasks may still change what the snapshot would hold.
+      if (interpreter.snapshot_handler_ && interpreter.tasks_ == nullptr) {
+        interpreter.snapshot_handler_(interpreter.globals_);
+      }
+
+      return {};
+    }
+
+    error::RuntimeResult<> operator()(const ast::Importe &importe) {
+      return interpreter.runModule(importe);
+    }
+
+    error::RuntimeResult<> operator()(const ast::Function &function) {
+      interpreter.declareFunction(function);
+      return {};
+    }
+
+    error::RuntimeResult<> operator()(const ast::Classe &klass) {
+      return interpreter.declareClass(klass);
+    }
+
+    error::RuntimeResult<> operator()(const ast::Retorne &retorne) {
+      std::any value = nullptr;
+
+      // A call in tail position is left for the call running this one to
+      // make, in its own frame.
+      const auto *call =
+          retorne.value.has_value()
+              ? std::get_if<ast::Call>(&retorne.value.value()->var)
+              : nullptr;
+
+      if (call != nullptr) {
+        const std::size_t arguments = interpreter.frame_.top;
+
+        auto callee = interpreter.prepareCall(*call);
+        if (!callee) return callee.unexpected();
+
+        if (auto *closure = std::any_cast<Closure::Ref>(&callee.value())) {
+          interpreter.tail_call_ = std::move(*closure);
+          interpreter.tail_arguments_ = arguments;
+        } else if (const auto *native =
+                       std::any_cast<NativeFunction::Ref>(&callee.value())) {
+          // Native functions return before the native stack grows any
+          // further.
+          auto result = interpreter.callNative(**native, call->paren);
+          if (!result) return result.unexpected();
+
+          value = std::move(result.value());
+        } else {
+          // The instance of a class with no initializer.
+          value = std::move(callee.value());
+        }
+      } else if (retorne.value.has_value()) {
+        auto result = interpreter.evaluate(*retorne.value.value());
+        if (!result) return result.unexpected();
+
+        value = std::move(result.value());
+      }
+
+      interpreter.return_value_ = std::move(value);
+      interpreter.returning_ = true;
+
+      return {};
+    }
+
+    error::RuntimeResult<> operator()(const ast::ErrorStmt &error) {
+      assert(false && "Overload not implemented.");
+      return {};
+    }
+  };
+  VoidVisitor visitor{.interpreter = *this};
+  return std::visit(visitor, stmt.var);
+}
+
+// Blocks need no scope of their own at runtime: the resolver gave their
+// locals slots of the running frame.
+error::RuntimeResult<> Interpreter::executeBlock(
+    const std::vector<ast::StmtPtr> &stmts) {
+  for (const auto &stmt : stmts) {
+    const auto result = execute(*stmt);
+    if (!result || returning_) return result;
+  }
+
+  return {};
+}
+
+// Creates the closure of `function`, moving the locals of the running frame
+// it captures into cells.
+Closure::Ref Interpreter::createClosure(const ast::Function &function) {
+  std::vector<std::shared_ptr<Cell>> cells;
+  cells.reserve(function.captures.size());
+
+  for (const ast::Capture &capture : function.captures) {
+    cells.push_back(capture.local ? box(capture.index)
+                                  : frame_.closure->getCell(capture.index));
+  }
+
+  return Closure::create(function, std::move(cells));
+}
+
+void Interpreter::declareFunction(const ast::Function &function) {
+  // A local function is in the scope of its own body, so it may capture
+  // itself.
+  if (function.slot >= 0) declareLocal(function.slot) = env::Uninitialized{};
+
+  auto closure = createClosure(function);
+
+  if (function.slot >= 0) {
+    local(function.slot) = std::move(closure);
+  } else {
+    globals_.define(function.name.lexeme.value(), std::move(closure));
+  }
+}
+
+// Creates the class, whose methods capture `super` and, like a local
+// function, the class itself.
+error::RuntimeResult<> Interpreter::declareClass(const ast::Classe &klass) {
+  Class::Ref superclass;
+
+  if (klass.superclass.has_value()) {
+    auto value = evaluate(*klass.superclass.value());
+    if (!value) return value.unexpected();
+
+    const auto *ref = std::any_cast<Class::Ref>(&value.value());
+
+    if (ref == nullptr) {
+      return error::Unexpected{error::RuntimeError(
+          std::get<ast::Variable>(klass.superclass.value()->var).name,
+          "Superclass must be a class")};
+    }
+
+    superclass = *ref;
+  }
+
+  if (klass.slot >= 0) declareLocal(klass.slot) = env::Uninitialized{};
+  if (klass.super_slot >= 0) declareLocal(klass.super_slot) = superclass;
+
+  std::unordered_map<std::string, Closure::Ref> methods;
+
+  for (const ast::Function &method : klass.methods) {
+    methods[method.name.lexeme.value()] = createClosure(method);
+  }
+
+  auto value = Class::create(klass.name.lexeme.value(), std::move(superclass),
+                             std::move(methods));
+
+  if (klass.slot >= 0) {
+    local(klass.slot) = std::move(value);
+  } else {
+    globals_.define(klass.name.lexeme.value(), std::move(value));
+  }
+
+  return {};
+}
+
+// Pushes a frame for the function `call` calls, right past the slots in use,
+// and runs its body. Nothing is allocated, unless the stack has to grow.
+error::RuntimeResult<std::any> Interpreter::call(const ast::Call &call) {
+  if (depth_ == kMaxCallDepth) {
+    return error::Unexpected{error::RuntimeError(call.paren, "Stack overflow")};
+  }
+
+  const Frame caller = frame_;
+  const std::size_t base = frame_.top;
+
+  auto callee = prepareCall(call);
+  if (!callee) return callee;
+
+  if (const auto *native =
+          std::any_cast<NativeFunction::Ref>(&callee.value())) {
+    return callNative(**native, call.paren);
+  }
+
+  // The instance of a class with no initializer.
+  if (callee.value().type() == typeid(Instance::Ref)) return callee;
+
+  auto closure = std::any_cast<Closure::Ref>(std::move(callee.value()));
+
+  depth_++;
+
+  error::RuntimeResult<> result;
+
+  // Tail calls run in this same frame, one after the other, so that they
+  // grow neither the call stack nor the native one.
+  while (true) {
+    const ast::Function &function = closure->getDeclaration();
+
+    frame_ = {.closure = closure.get(),
+              .base = base,
+              .top = base + function.frame_size};
+
+    result = executeBlock(function.body);
+    if (!result || tail_call_.get() == nullptr) break;
+
+    closure = takeTailCall(base);
+  }
+
+  return leaveCall(caller, *closure, result);
+}
+
+// Mirrors `call()`, running the body of a script function through
+// `executeResumable()`, so that the loops in it are time-sliced too. The
+// calls its arguments make are resumable as well.
+coro::Task<error::RuntimeResult<std::any>> Interpreter::callResumable(
+    const ast::Call &call, coro::Slice &slice) {
+  if (depth_ == kMaxCallDepth) {
+    co_return error::Unexpected{
+        error::RuntimeError(call.paren, "Stack overflow")};
+  }
+
+  const auto resolved = co_await resolveResumable(operands(call), slice);
+  if (!resolved) co_return resolved.unexpected();
+
+  const Frame caller = frame_;
+  const std::size_t base = frame_.top;
+
+  auto callee = prepareCall(call);
+  resolved_.clear();
+  if (!callee) co_return callee;
 
-#include "lusoscript/helper.hh"
+  if (const auto *native =
+          std::any_cast<NativeFunction::Ref>(&callee.value())) {
+    co_return callNative(**native, call.paren);
+  }
+
+  if (callee.value().type() == typeid(Instance::Ref)) co_return callee;
+
+  auto closure = std::any_cast<Closure::Ref>(std::move(callee.value()));
+
+  depth_++;
+
+  error::RuntimeResult<> result;
+
+  while (true) {
+    const ast::Function &function = closure->getDeclaration();
+
+    frame_ = {.closure = closure.get(),
+              .base = base,
+              .top = base + function.frame_size};
+
+    result = co_await executeBlockResumable(function.body, slice);
+    if (!result || tail_call_.get() == nullptr) break;
+
+    closure = takeTailCall(base);
+  }
+
+  co_return leaveCall(caller, *closure, result);
+}
+
+// Moves the arguments of the tail call the running function made, evaluated
+// past its frame, into the slots of the frame at `base`, and returns the
+// function called.
+Closure::Ref Interpreter::takeTailCall(std::size_t base) {
+  Closure::Ref closure = std::move(tail_call_);
+  returning_ = false;
+
+  const std::size_t arguments = tail_arguments_;
+  const std::size_t count = argumentSlots(closure->getDeclaration());
+
+  for (std::size_t slot = base; slot < arguments; slot++) {
+    stack_[slot].reset();
+  }
+
+  for (std::size_t i = 0; i < count && arguments != base; i++) {
+    stack_[base + i] = std::move(stack_[arguments + i]);
+  }
+
+  for (std::size_t slot = base + count; slot < frame_.top; slot++) {
+    stack_[slot].reset();
+  }
+
+  ensureStack(base + closure->getDeclaration().frame_size);
+
+  return closure;
+}
+
+// Pops the frame of `closure`, which ran with `result`, back to `caller`, and
+// returns what the function returned.
+error::RuntimeResult<std::any> Interpreter::leaveCall(
+    const Frame &caller, const Closure &closure,
+    const error::RuntimeResult<> &result) {
+  depth_--;
+
+  // An initializer returns the instance it was called on.
+  if (result &&
+      closure.getDeclaration().kind == ast::Function::Kind::INITIALIZER) {
+    return_value_ = local(0);
+    returning_ = true;
+  }
+
+  // Values are released now, rather than when the slots are next used.
+  for (std::size_t slot = frame_.base; slot < frame_.top; slot++) {
+    stack_[slot].reset();
+  }
+
+  frame_ = caller;
+
+  if (!result) {
+    tail_call_ = {};
+    return result.unexpected();
+  }
+
+  if (!returning_) return std::any{nullptr};
+
+  returning_ = false;
+
+  return std::move(return_value_);
+}
+
+// Evaluates the function `call` calls, either a `Closure::Ref` or a
+// `NativeFunction::Ref`, then its arguments into the slots right past the
+// ones in use, which become the slots of its parameters. Calls made by the
+// arguments push their frames past the arguments already evaluated. A method
+// gets the instance it is called on in the slot before its arguments. Calling
+// a class creates an instance, on which its initializer is called; without
+// one, the instance is returned instead of a function.
+error::RuntimeResult<std::any> Interpreter::prepareCall(const ast::Call &call) {
+  std::any receiver;
+
+  auto callee = evaluateCallee(*call.callee, receiver);
+  if (!callee) return callee;
+
+  if (const auto *bound = std::any_cast<BoundMethod::Ref>(&callee.value())) {
+    const BoundMethod::Ref method = *bound;
+
+    receiver = method->getReceiver();
+    callee = std::any{method->getMethod()};
+  } else if (const auto *klass = std::any_cast<Class::Ref>(&callee.value())) {
+    auto instance = Instance::create(*klass);
+
+    if (const Closure::Ref *initializer = (*klass)->getInitializer()) {
+      receiver = std::move(instance);
+      callee = std::any{*initializer};
+    } else {
+      callee = std::any{std::move(instance)};
+    }
+  }
+
+  std::size_t arity;
+  std::size_t frame_size;
+
+  if (const auto *closure = std::any_cast<Closure::Ref>(&callee.value())) {
+    arity = (*closure)->getDeclaration().params.size();
+    frame_size = static_cast<std::size_t>(
+        (*closure)->getDeclaration().frame_size);
+  } else if (const auto *native =
+                 std::any_cast<NativeFunction::Ref>(&callee.value())) {
+    arity = (*native)->getArity();
+    frame_size = arity;
+  } else if (callee.value().type() == typeid(Instance::Ref)) {
+    arity = 0;
+    frame_size = 0;
+  } else {
+    return error::Unexpected{error::RuntimeError(
+        call.paren, "Can only call functions and classes")};
+  }
+
+  if (call.arguments.size() != arity) {
+    return error::Unexpected{error::RuntimeError(
+        call.paren, "Expected " + std::to_string(arity) +
+                        " arguments but got " +
+                        std::to_string(call.arguments.size()))};
+  }
+
+  const std::size_t base = frame_.top;
+  ensureStack(base + frame_size);
+
+  if (receiver.has_value()) {
+    stack_[base] = std::move(receiver);
+    frame_.top = base + 1;
+  }
+
+  const std::size_t first = frame_.top;
+
+  for (std::size_t i = 0; i < call.arguments.size(); i++) {
+    auto argument = evaluate(*call.arguments[i]);
+
+    if (!argument) {
+      for (std::size_t slot = base; slot < frame_.top; slot++) {
+        stack_[slot].reset();
+      }
+
+      frame_.top = base;
+      return argument.unexpected();
+    }
+
+    stack_[first + i] = std::move(argument.value());
+    frame_.top = first + i + 1;
+  }
+
+  return callee;
+}
+
+// Evaluates the callee of a call. A method read from an instance, or from the
+// superclass, is not bound to the instance: the instance is returned in
+// `receiver` instead, for the call to pass it.
+error::RuntimeResult<std::any> Interpreter::evaluateCallee(
+    const ast::Expr &callee, std::any &receiver) {
+  if (const auto *get = std::get_if<ast::Get>(&callee.var)) {
+    return getProperty(*get, receiver);
+  }
+
+  if (const auto *super = std::get_if<ast::Super>(&callee.var)) {
+    return getSuper(*super, receiver);
+  }
+
+  return evaluate(callee);
+}
+
+// The value of a field or, for a method, its closure, setting `receiver` to
+// the instance.
+error::RuntimeResult<std::any> Interpreter::getProperty(const ast::Get &get,
+                                                        std::any &receiver) {
+  auto object = evaluate(*get.object);
+  if (!object) return object;
+
+  auto *instance = std::any_cast<Instance::Ref>(&object.value());
+
+  if (instance == nullptr) {
+    return error::Unexpected{
+        error::RuntimeError(get.name, "Only instances have properties")};
+  }
+
+  const auto property = get.cache->get(**instance, get.name.lexeme.value());
+
+  if (property.slot >= 0) return (*instance)->getField(property.slot);
+
+  if (property.method == nullptr) {
+    return error::Unexpected{error::RuntimeError(
+        get.name, "Undefined property '" + get.name.lexeme.value() + "'")};
+  }
+
+  receiver = std::move(object.value());
+
+  return std::any{*property.method};
+}
+
+// The closure of the method of the superclass, setting `receiver` to `esse`.
+error::RuntimeResult<std::any> Interpreter::getSuper(const ast::Super &super,
+                                                     std::any &receiver) {
+  auto superclass = lookUp(super.keyword, super.binding);
+  if (!superclass) return superclass;
+
+  const Closure::Ref *method = super.cache->getMethod(
+      std::any_cast<const Class::Ref &>(superclass.value()),
+      super.method.lexeme.value());
+
+  if (method == nullptr) {
+    return error::Unexpected{error::RuntimeError(
+        super.method,
+        "Undefined property '" + super.method.lexeme.value() + "'")};
+  }
+
+  auto instance = lookUp(super.keyword, super.receiver);
+  if (!instance) return instance;
+
+  receiver = std::move(instance.value());
+
+  return std::any{*method};
+}
+
+// Calls `function` with the arguments `prepareCall()` left on top of the
+// stack, which it pops.
+error::RuntimeResult<std::any> Interpreter::callNative(
+    const NativeFunction &function, const token::Token &paren) {
+  const std::size_t base = frame_.top - function.getArity();
+
+  auto result = function.call(
+      std::span<std::any>(stack_.data() + base, function.getArity()));
+
+  for (std::size_t slot = base; slot < frame_.top; slot++) {
+    stack_[slot].reset();
+  }
+
+  frame_.top = base;
+
+  if (!result) {
+    return error::Unexpected{error::RuntimeError(paren, result.error())};
+  }
+
+  return std::move(result.value());
+}
+
+// Copies the frame `parent` is running, with the values of its captured
+// locals rather than their cells, for this interpreter to run statements of
+// that frame on its own.
+void Interpreter::copyFrame(const Interpreter &parent) {
+  const Frame &frame = parent.frame_;
+  const std::size_t size = frame.top - frame.base;
+
+  ensureStack(size);
+
+  for (std::size_t slot = 0; slot < size; slot++) {
+    const std::any &value = parent.stack_[frame.base + slot];
+    const auto *cell = std::any_cast<std::shared_ptr<Cell>>(&value);
+
+    stack_[slot] = cell != nullptr ? (*cell)->value : value;
+  }
+
+  frame_ = {.closure = frame.closure, .base = 0, .top = size};
+  if (frame.closure != nullptr) closure_ = frame.closure->share();
+}
+
+void Interpreter::ensureStack(std::size_t size) {
+  if (size <= stack_.size()) return;
+
+  if (size > stack_.capacity()) {
+    stack_.reserve(std::max({size, 2 * stack_.capacity(), kStackSlots}));
+  }
+
+  stack_.resize(size);
+}
+
+// The slot of a local being declared. The frame of the script grows as its
+// locals are declared, since lazy blocks only get their slots once parsed;
+// the frames of functions are pushed whole.
+std::any &Interpreter::declareLocal(int slot) {
+  const std::size_t index = frame_.base + static_cast<std::size_t>(slot);
+
+  if (index >= frame_.top) {
+    frame_.top = index + 1;
+    ensureStack(frame_.top);
+  }
+
+  return stack_[index];
+}
+
+// The value of a local, in its slot or in the cell it was moved to.
+std::any &Interpreter::local(int slot) {
+  std::any &value = stack_[frame_.base + static_cast<std::size_t>(slot)];
+
+  if (auto *cell = std::any_cast<std::shared_ptr<Cell>>(&value)) {
+    return (*cell)->value;
+  }
+
+  return value;
+}
+
+// Moves a local into a cell for a closure to capture, unless an earlier
+// closure did.
+std::shared_ptr<Cell> Interpreter::box(int slot) {
+  std::any &value = stack_[frame_.base + static_cast<std::size_t>(slot)];
+
+  if (const auto *cell = std::any_cast<std::shared_ptr<Cell>>(&value)) {
+    return *cell;
+  }
+
+  auto cell = std::make_shared<Cell>(std::move(value));
+  value = cell;
+
+  return cell;
+}
+
+// Declaring a local again, as a loop does, replaces the cell of the previous
+// one, if any.
+void Interpreter::define(const token::Token &name, int slot,
+                         std::any value) {
+  if (slot < 0) {
+    globals_.define(name.lexeme.value(), value);
+  } else {
+    declareLocal(slot) = std::move(value);
+  }
+}
+
+error::RuntimeResult<std::any> Interpreter::lookUp(
+    const token::Token &name, const ast::Binding &binding) {
+  switch (binding.kind) {
+    case ast::Binding::Kind::LOCAL:
+      return local(binding.index);
+    case ast::Binding::Kind::CAPTURED:
+      return frame_.closure->getCell(binding.index)->value;
+    default:
+      return globals_.get(name);
+  }
+}
+
+error::RuntimeResult<> Interpreter::assign(const token::Token &name,
+                                           const ast::Binding &binding,
+                                           const std::any &value) {
+  switch (binding.kind) {
+    case ast::Binding::Kind::LOCAL:
+      local(binding.index) = value;
+      return {};
+    case ast::Binding::Kind::CAPTURED: {
+      Cell &cell = *frame_.closure->getCell(binding.index);
+      if (auto check = checkCellAssignable(name, cell); !check) return check;
+
+      cell.value = value;
+      return {};
+    }
+    default:
+      if (auto check = checkGlobalAssignable(name); !check) return check;
+      return globals_.assign(name, value);
+  }
+}
+
+error::RuntimeResult<std::any *> Interpreter::locate(
+    const token::Token &name, const ast::Binding &binding) {
+  switch (binding.kind) {
+    case ast::Binding::Kind::LOCAL:
+      return &local(binding.index);
+    case ast::Binding::Kind::CAPTURED: {
+      Cell &cell = *frame_.closure->getCell(binding.index);
+      if (auto check = checkCellAssignable(name, cell); !check) {
+        return check.unexpected();
+      }
+
+      return &cell.value;
+    }
+    default:
+      if (auto check = checkGlobalAssignable(name); !check) {
+        return check.unexpected();
+      }
+      return globals_.find(name);
+  }
+}
+
+// The resolver only sees the assignments in the body of a parallel loop, not
+// those of the functions it calls, which would race on the globals of the
+// program. The globals of a worker are its reduction variables.
+error::RuntimeResult<> Interpreter::checkGlobalAssignable(
+    const token::Token &name) const {
+  if (!worker_ || globals_.getValues().contains(name.lexeme.value())) {
+    return {};
+  }
+
+  return error::Unexpected{error::RuntimeError(
+      name, "Parallel loop iterations cannot assign the variable '" +
+                name.lexeme.value() + "' declared outside the loop")};
+}
+
+// The chunks of the loop share the cells of the variables captured outside
+// it too, which the functions they call cannot assign either. See `Owned`.
+error::RuntimeResult<> Interpreter::checkCellAssignable(
+    const token::Token &name, const Cell &cell) const {
+  if (!cell.isShared()) return {};
+
+  return error::Unexpected{error::RuntimeError(
+      name, "Parallel loop iterations cannot assign the variable '" +
+                name.lexeme.value() + "' declared outside the loop")};
+}
+
+// Updates the variable where it lives, copying its value to `before` first
+// when given. The operand is evaluated before the variable is found, so that
+// nothing it runs can move the variable. Numbers are updated in place, and
+// strings appended to; anything else is updated as `nome = nome op valor`
+// would, errors included.
+error::RuntimeResult<std::any *> Interpreter::update(const ast::Update &update,
+                                                     std::any *before) {
+  std::any operand = 1.f;
+
+  if (update.value != nullptr) {
+    auto value = evaluate(*update.value);
+    if (!value) return value.unexpected();
+
+    operand = std::move(value.value());
+  }
+
+  const auto target = locate(update.name, update.binding);
+  if (!target) return target;
+
+  std::any &stored = *target.value();
+
+  if (stored.type() == typeid(env::Uninitialized)) {
+    return error::Unexpected{error::RuntimeError(
+        update.name,
+        "Uninitialized variable '" + update.name.lexeme.value() + "'")};
+  }
+
+  // Only numbers are incremented and decremented.
+  if (update.value == nullptr) {
+    if (auto check = checkNumberOperand(update.opr, stored); !check) {
+      return check.unexpected();
+    }
+  }
+
+  if (before != nullptr) *before = stored;
+
+  if (auto *number = std::any_cast<float>(&stored)) {
+    if (const auto *right = std::any_cast<float>(&operand)) {
+      switch (update.operation) {
+        case token::TokenType::SC_MINUS:
+          *number -= *right;
+          return &stored;
+        case token::TokenType::SC_STAR:
+          *number *= *right;
+          return &stored;
+        case token::TokenType::SC_FORWARD_SLASH:
+          if (*right == 0.f) {
+            return error::Unexpected{
+                error::RuntimeError(update.opr, "Attempted to divide by zero")};
+          }
+          *number /= *right;
+          return &stored;
+        default:
+          *number += *right;
+          return &stored;
+      }
+    }
+  } else if (auto *text = std::any_cast<std::string>(&stored);
+             text != nullptr && update.operation == token::TokenType::SC_PLUS) {
+    if (const auto *right = std::any_cast<std::string>(&operand)) {
+      text->append(*right);
+      return &stored;
+    }
+
+    if (operand.type() == typeid(float) || operand.type() == typeid(bool) ||
+        operand.type() == typeid(std::nullptr_t)) {
+      text->append(stringify(operand));
+      return &stored;
+    }
+  }
+
+  auto result = arithmetic(update.opr, update.operation, stored, operand);
+  if (!result) return result.unexpected();
+
+  stored = std::move(result.value());
+
+  return &stored;
+}
+
+coro::Task<error::RuntimeResult<>> Interpreter::interpretResumable(
+    const std::vector<ast::Stmt> &stmts, coro::Slice &slice) {
+  error::RuntimeResult<> result;
+
+  for (const ast::Stmt &stmt : stmts) {
+    if (isResumable(stmt)) {
+      result = co_await executeResumable(stmt, slice);
+    } else {
+      co_await slice.checkpoint();
+      result = execute(stmt);
+    }
+
+    if (!result) break;
+  }
+
+  const auto task_error = joinTasks();
+
+  if (!result) {
+    error_state_.runtimeError(result.error());
+    co_return result;
+  }
+
+  if (task_error.has_value()) {
+    error_state_.runtimeError(task_error.value());
+    co_return error::Unexpected{task_error.value()};
+  }
+
+  co_return error::RuntimeResult<>{};
+}
+
+// Mirrors `execute()` for the statements that contain other statements, or
+// call a function, so that a suspension can happen in the middle of them.
+// Simple statements run through `execute()` right after their checkpoint,
+// once the expressions that call functions are evaluated.
+coro::Task<error::RuntimeResult<>> Interpreter::executeResumable(
+    const ast::Stmt &stmt, coro::Slice &slice) {
+  const ast::Stmt *target = &stmt;
+
+  if (const auto *lazy = std::get_if<ast::LazyBlock>(&stmt.var)) {
+    target = &lazy->parser->parseLazyBlock(*lazy);
+  }
+
+  co_await slice.checkpoint();
+
+  if (const auto *block = std::get_if<ast::Block>(&target->var)) {
+    co_return co_await executeBlockResumable(block->stmts, slice);
+  }
+
+  if (const auto *if_stmt = std::get_if<ast::If>(&target->var)) {
+    const auto condition =
+        co_await evaluateResumable(*if_stmt->condition, slice);
+    if (!condition) co_return condition.unexpected();
+
+    if (isTruthy(condition.value())) {
+      co_return co_await executeResumable(*if_stmt->then_branch, slice);
+    } else if (if_stmt->else_branch.has_value()) {
+      co_return co_await executeResumable(*if_stmt->else_branch.value(), slice);
+    }
+
+    co_return error::RuntimeResult<>{};
+  }
+
+  if (const auto *while_stmt = std::get_if<ast::While>(&target->var)) {
+    auto condition = co_await evaluateResumable(*while_stmt->condition, slice);
+    if (!condition) co_return condition.unexpected();
+
+    while (isTruthy(condition.value())) {
+      const auto result = co_await executeResumable(*while_stmt->body, slice);
+      if (!result || returning_) co_return result;
+
+      // The loop back-edge is a checkpoint too, so that a loop whose body
+      // does nothing still yields.
+      co_await slice.checkpoint();
+
+      condition = co_await evaluateResumable(*while_stmt->condition, slice);
+      if (!condition) co_return condition.unexpected();
+    }
+
+    co_return error::RuntimeResult<>{};
+  }
+
+  if (const auto *loop = std::get_if<ast::ForEach>(&target->var)) {
+    std::vector<const ast::Expr *> source_operand = {loop->source.get()};
+
+    const auto resolved =
+        co_await resolveResumable(std::move(source_operand), slice);
+    if (!resolved) co_return resolved.unexpected();
+
+    auto source = evaluateSource(*loop);
+    resolved_.clear();
+    if (!source) co_return source.unexpected();
+
+    std::any value;
+
+    while (source.value().next(value)) {
+      declareLocal(loop->slot) = std::move(value);
+
+      const auto result = co_await executeResumable(*loop->body, slice);
+      if (!result || returning_) co_return result;
+
+      co_await slice.checkpoint();
+    }
+
+    co_return error::RuntimeResult<>{};
+  }
+
+  if (const auto *escolha = std::get_if<ast::Escolha>(&target->var)) {
+    std::vector<const ast::Expr *> value_operand = {escolha->value.get()};
+
+    const auto resolved =
+        co_await resolveResumable(std::move(value_operand), slice);
+    if (!resolved) co_return resolved.unexpected();
+
+    const auto body = evaluateCase(*escolha);
+    resolved_.clear();
+    if (!body) co_return body.unexpected();
+
+    if (body.value() == nullptr) co_return error::RuntimeResult<>{};
+    co_return co_await executeResumable(*body.value(), slice);
+  }
+
+  const auto resolved = co_await resolveResumable(operands(*target), slice);
+  if (!resolved) co_return resolved.unexpected();
+
+  const auto result = execute(*target);
+  resolved_.clear();
+
+  co_return result;
+}
+
+coro::Task<error::RuntimeResult<>> Interpreter::executeBlockResumable(
+    const std::vector<ast::StmtPtr> &stmts, coro::Slice &slice) {
+  for (const auto &stmt : stmts) {
+    error::RuntimeResult<> result;
+
+    if (isResumable(*stmt)) {
+      result = co_await executeResumable(*stmt, slice);
+    } else {
+      co_await slice.checkpoint();
+      result = execute(*stmt);
+    }
+
+    if (!result || returning_) co_return result;
+  }
+
+  co_return error::RuntimeResult<>{};
+}
+
+// Runs the iterations of a parallel loop in chunks on the work-stealing pool.
+// Each chunk has its own interpreter, output buffer and private copies of the
+// reduction variables; the buffers and the partial reductions are combined in
+// chunk order, so the result does not depend on scheduling. If iterations
+// fail, the error of the first failing chunk is reported after the output
+// that precedes it, like a sequential loop would.
+error::RuntimeResult<> Interpreter::executeParallelFor(
+    const ast::ParallelFor &loop) {
+  float bounds[3];
+  const ast::Expr *bound_exprs[] = {loop.start.get(), loop.end.get(),
+                                    loop.step.get()};
+
+  for (int i = 0; i < 3; i++) {
+    const auto value = evaluate(*bound_exprs[i]);
+    if (!value) return value.unexpected();
+
+    if (value.value().type() != typeid(float)) {
+      return error::Unexpected{error::RuntimeError(
+          loop.keyword, "Parallel loop bounds must be numbers")};
+    }
+
+    bounds[i] = std::any_cast<float>(value.value());
+
+    if (!std::isfinite(bounds[i])) {
+      return error::Unexpected{error::RuntimeError(
+          loop.keyword, "Parallel loop bounds must be finite")};
+    }
+  }
+
+  const auto [start, end, step] = bounds;
+
+  if (step <= 0.f) {
+    return error::Unexpected{error::RuntimeError(
+        loop.keyword, "Parallel loop step must be positive")};
+  }
+
+  const float span = (end - start) / step;
+
+  // Past this, which the span of bounds far apart reaches as infinity, the
+  // count would not fit once rounded up to whole chunks.
+  if (span >= 0x1p62f) {
+    return error::Unexpected{error::RuntimeError(
+        loop.keyword, "Parallel loop has too many iterations")};
+  }
+
+  std::size_t count = 0;
+
+  if (loop.inclusive && span >= 0.f) {
+    count = static_cast<std::size_t>(std::floor(span)) + 1;
+  } else if (!loop.inclusive && span > 0.f) {
+    count = static_cast<std::size_t>(std::ceil(span));
+  }
+
+  std::vector<float> initial;
+  initial.reserve(loop.reductions.size());
+
+  for (const auto &reduction : loop.reductions) {
+    // Chunks keep private copies of the reduction variables in their own
+    // frames, which the cells of captured variables are not part of.
+    if (reduction.binding.kind == ast::Binding::Kind::CAPTURED) {
+      return error::Unexpected{error::RuntimeError(
+          reduction.target, "Reduction variable '" +
+                                reduction.target.lexeme.value() +
+                                "' must be declared in the function running "
+                                "the loop")};
+    }
+
+    const auto value = lookUp(reduction.target, reduction.binding);
+    if (!value) return value.unexpected();
+
+    if (value.value().type() != typeid(float)) {
+      return error::Unexpected{error::RuntimeError(
+          reduction.target, "Reduction variable '" +
+                                reduction.target.lexeme.value() +
+                                "' must be a number")};
+    }
+
+    initial.push_back(std::any_cast<float>(value.value()));
+  }
+
+  const auto identity = [](ast::ReductionKind kind) {
+    switch (kind) {
+      case ast::ReductionKind::MINIMO:
+        return std::numeric_limits<float>::infinity();
+      case ast::ReductionKind::MAXIMO:
+        return -std::numeric_limits<float>::infinity();
+      default:
+        return 0.f;
+    }
+  };
+
+  const auto combine = [](ast::ReductionKind kind, float a, float b) {
+    switch (kind) {
+      case ast::ReductionKind::MINIMO:
+        return std::min(a, b);
+      case ast::ReductionKind::MAXIMO:
+        return std::max(a, b);
+      default:
+        return a + b;
+    }
+  };
+
+  // The chunking only depends on the iteration count, so that sums are
+  // added up in the same order on every machine.
+  const std::size_t chunk_size =
+      std::max<std::size_t>(1, (count + kParallelChunks - 1) / kParallelChunks);
+  const std::size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+
+  struct Chunk {
+    std::ostringstream output;
+    std::vector<float> partials;
+    std::optional<error::RuntimeError> error;
+  };
+
+  std::vector<Chunk> chunks(chunk_count);
+  // Chunks after a failing one are not needed.
+  std::atomic<std::size_t> first_failure = chunk_count;
+
+  const auto run_chunk = [&](std::size_t index) {
+    if (index > first_failure.load()) return;
 
-Interpreter::Interpreter(error::ErrorState &error_state,
-                         const state::RunningMode &mode)
-    : error_state_(error_state), current_env_({}), mode_(mode) {}
+    const Owned::Ownership ownership;
+    Chunk &chunk = chunks[index];
+    Interpreter worker(*this, chunk.output);
 
-void Interpreter::interpret(const std::vector<ast::Stmt> &stmts) {
-  try {
-    for (const ast::Stmt &stmt : stmts) {
-      execute(stmt);
+    for (const auto &reduction : loop.reductions) {
+      if (reduction.binding.kind == ast::Binding::Kind::LOCAL) {
+        worker.local(reduction.binding.index) = identity(reduction.kind);
+      } else {
+        worker.globals_.define(reduction.target.lexeme.value(),
+                               identity(reduction.kind));
+      }
     }
-  } catch (error::RuntimeError &error) {
-    error_state_.runtimeError(error);
-  }
-}
 
-void Interpreter::execute(const ast::Stmt &stmt) {
-  struct VoidVisitor {
-    Interpreter &interpreter;
+    const std::size_t first = index * chunk_size;
+    const std::size_t last = std::min(count, first + chunk_size);
 
-    void operator()(const ast::Block &block) {
-      interpreter.executeBlock(block,
-                               env::Environment{interpreter.current_env_});
-    };
+    for (std::size_t i = first; i < last; i++) {
+      worker.define(loop.variable, loop.slot,
+                    start + static_cast<float>(i) * step);
 
-    void operator()(const ast::Expression &expression) {
-      const auto result = interpreter.evaluate(*expression.expression);
+      auto result = worker.execute(*loop.body);
 
-      // If the interpreter is running in "REPL mode," print the result of
-      // evaluated expressions.
-      if (interpreter.mode_ == state::RunningMode::REPL) {
-        std::cout << interpreter.stringify(result) << std::endl;
-      }
-    };
+      if (!result) {
+        chunk.error = result.error();
 
-    void operator()(const ast::Imprima &imprima) {
-      const std::any value = interpreter.evaluate(*imprima.expression);
-      std::cout << interpreter.stringify(value) << std::endl;
+        std::size_t failure = first_failure.load();
+        while (index < failure &&
+               !first_failure.compare_exchange_weak(failure, index)) {
+        }
+        return;
+      }
     }
 
-    void operator()(const ast::Var &variable) {
-      std::any value = env::Uninitialized{};
-
-      const auto &initializer = variable.initializer;
+    for (const auto &reduction : loop.reductions) {
+      const auto value = worker.lookUp(reduction.target, reduction.binding);
 
-      if (initializer.has_value()) {
-        value = interpreter.evaluate(*initializer.value());
+      if (value.value().type() != typeid(float)) {
+        chunk.error = error::RuntimeError(
+            reduction.target, "Reduction variable '" +
+                                  reduction.target.lexeme.value() +
+                                  "' must remain a number");
+        return;
       }
 
-      interpreter.current_env_.define(variable.name.lexeme.value(), value);
+      chunk.partials.push_back(std::any_cast<float>(value.value()));
     }
+  };
 
-    void operator()(const ast::If &stmt) {
-      const auto condition = interpreter.evaluate(*stmt.condition);
-      if (interpreter.isTruthy(condition)) {
-        interpreter.execute(*stmt.then_branch);
-      } else if (stmt.else_branch.has_value()) {
-        interpreter.execute(*stmt.else_branch.value());
-      }
-    }
+  if (worker_) {
+    for (std::size_t i = 0; i < chunk_count; i++) run_chunk(i);
+  } else {
+    WorkStealingPool::shared().parallelFor(chunk_count, run_chunk);
+  }
 
-    void operator()(const ast::While &stmt) {
-      // Immediately evaluates the condition, and, if truthy, the statement body
-      // is executed.
-      auto condition = interpreter.evaluate(*stmt.condition);
-      while (interpreter.isTruthy(condition)) {
-        interpreter.execute(*stmt.body);
-        // Evaluates the condition again after the body is executed, because if
-        // it is not truthy, the loop will be left immediately.
-        condition = interpreter.evaluate(*stmt.condition);
-      }
+  std::vector<float> totals = initial;
+
+  for (auto &chunk : chunks) {
+    {
+      const auto lock = lockOutput();
+      output_ << chunk.output.view();
     }
 
-    void operator()(const ast::ErrorStmt &error) {
-      assert(false && "Overload not implemented.");
+    if (chunk.error.has_value()) return error::Unexpected{chunk.error.value()};
+
+    for (std::size_t i = 0; i < totals.size(); i++) {
+      totals[i] =
+          combine(loop.reductions[i].kind, totals[i], chunk.partials[i]);
     }
-  };
-  VoidVisitor visitor{.interpreter = *this};
-  std::visit(visitor, stmt.var);
+  }
+
+  for (std::size_t i = 0; i < totals.size(); i++) {
+    const auto result = assign(loop.reductions[i].target,
+                               loop.reductions[i].binding, totals[i]);
+    if (!result) return result;
+  }
+
+  return {};
+}
+
+// Starts the body of `tarefa` on the task runtime, with a copy of the
+// variables visible here, and of what they hold (see `TaskCopy`): what the
+// task assigns stays private to it, and tasks only share the channels they
+// were given.
+void Interpreter::startTask(const ast::Tarefa &tarefa) {
+  if (tasks_ == nullptr) {
+    tasks_ = std::make_shared<TaskGroup>(TaskRuntime::shared());
+  }
+
+  // The task may outlive the interpreter that starts it, if that one is a
+  // task too, so it only refers to what the whole program shares.
+  std::shared_ptr<Interpreter> task(
+      new Interpreter(*this, globals_.snapshot()));
+  const ast::Stmt *body = tarefa.body.get();
+
+  TaskCopy copies;
+
+  for (auto &[name, value] : task->globals_.getValues()) {
+    value = copies.copy(value);
+  }
+
+  for (std::size_t slot = 0; slot < task->frame_.top; slot++) {
+    task->stack_[slot] = copies.copy(task->stack_[slot]);
+  }
+
+  if (task->closure_.get() != nullptr) {
+    task->closure_ = copies.copy(task->closure_);
+    task->frame_.closure = task->closure_.get();
+  }
+
+  tasks_->spawn([task, body] { return task->execute(*body); });
+}
+
+std::optional<error::RuntimeError> Interpreter::joinTasks() {
+  if (tasks_ == nullptr) return std::nullopt;
+  return tasks_->wait();
+}
+
+error::RuntimeResult<std::shared_ptr<Channel>> Interpreter::evaluateChannel(
+    const token::Token &keyword, const ast::Expr &expr) {
+  const auto value = evaluate(expr);
+  if (!value) return value.unexpected();
+
+  if (value.value().type() != typeid(std::shared_ptr<Channel>)) {
+    return error::Unexpected{
+        error::RuntimeError(keyword, "Operand must be a channel")};
+  }
+
+  return std::any_cast<std::shared_ptr<Channel>>(value.value());
+}
+
+// Locks the output shared with the tasks of the program, if any.
+std::unique_lock<std::mutex> Interpreter::lockOutput() {
+  if (output_mutex_ == nullptr) return {};
+  return std::unique_lock<std::mutex>(*output_mutex_);
+}
+
+bool Interpreter::isResumable(const ast::Stmt &stmt) const {
+  return std::holds_alternative<ast::Block>(stmt.var) ||
+         std::holds_alternative<ast::LazyBlock>(stmt.var) ||
+         std::holds_alternative<ast::If>(stmt.var) ||
+         std::holds_alternative<ast::While>(stmt.var) ||
+         std::holds_alternative<ast::ForEach>(stmt.var) ||
+         std::holds_alternative<ast::Escolha>(stmt.var) ||
+         std::ranges::any_of(operands(stmt), callsFunction);
+}
+
+// Mirrors `evaluate()` for the expressions that call functions. The operands
+// of an expression are evaluated here, each resumably, and then handed to
+// `evaluate()` through `resolved_`; only conditions, which decide what else
+// is evaluated, and calls, which run a body, are evaluated here entirely.
+coro::Task<error::RuntimeResult<std::any>> Interpreter::evaluateResumable(
+    const ast::Expr &expr, coro::Slice &slice) {
+  if (!callsFunction(&expr)) co_return evaluate(expr);
+
+  if (const auto *call = std::get_if<ast::Call>(&expr.var)) {
+    co_return co_await callResumable(*call, slice);
+  }
+
+  if (const auto *grouping = std::get_if<ast::Grouping>(&expr.var)) {
+    co_return co_await evaluateResumable(*grouping->expression, slice);
+  }
+
+  if (const auto *logical = std::get_if<ast::Logical>(&expr.var)) {
+    auto left = co_await evaluateResumable(*logical->left, slice);
+    if (!left) co_return left;
+
+    const bool ou = logical->opr.type == token::TokenType::KW_OU;
+    if (isTruthy(left.value()) == ou) co_return left;
+
+    co_return co_await evaluateResumable(*logical->right, slice);
+  }
+
+  if (const auto *ternary = std::get_if<ast::Ternary>(&expr.var)) {
+    const auto condition =
+        co_await evaluateResumable(*ternary->condition, slice);
+    if (!condition) co_return condition;
+
+    co_return co_await evaluateResumable(
+        isTruthy(condition.value()) ? *ternary->then_expr : *ternary->else_expr,
+        slice);
+  }
+
+  const auto resolved = co_await resolveResumable(operands(expr), slice);
+  if (!resolved) co_return resolved.unexpected();
+
+  auto value = evaluate(expr);
+  resolved_.clear();
+
+  co_return value;
 }
 
-void Interpreter::executeBlock(const ast::Block &block,
-                               const env::Environment &env) {
-  env::Environment &prev = current_env_;
+// Evaluates `operands` in order, resumably, into `resolved_`. As the calls
+// they make run code that may evaluate the same expressions, in a recursive
+// call, the values are only stored once all of them are known.
+coro::Task<error::RuntimeResult<>> Interpreter::resolveResumable(
+    std::vector<const ast::Expr *> operands, coro::Slice &slice) {
+  if (!std::ranges::any_of(operands, callsFunction)) {
+    co_return error::RuntimeResult<>{};
+  }
+
+  std::vector<std::pair<const ast::Expr *, std::any>> values;
+  values.reserve(operands.size());
 
-  current_env_ = env;
+  for (const ast::Expr *operand : operands) {
+    auto value = co_await evaluateResumable(*operand, slice);
+    if (!value) co_return value.unexpected();
 
-  for (auto &stmt : block.stmts) {
-    execute(*stmt);
+    values.emplace_back(operand, std::move(value.value()));
   }
 
-  current_env_ = prev;
+  resolved_ = std::move(values);
+
+  co_return error::RuntimeResult<>{};
 }
 
-std::any Interpreter::evaluate(const ast::Expr &expr) {
+error::RuntimeResult<std::any> Interpreter::evaluate(const ast::Expr &expr) {
+  if (!resolved_.empty()) {
+    const auto operand = std::ranges::find(
+        resolved_, &expr, &std::pair<const ast::Expr *, std::any>::first);
+
+    if (operand != resolved_.end()) {
+      std::any value = std::move(operand->second);
+      resolved_.erase(operand);
+
+      return value;
+    }
+  }
+
   struct AnyVisitor {
     Interpreter &interpreter;
 
-    std::any operator()(const ast::Assign &assign) {
-      const std::any &value = interpreter.evaluate(*assign.value);
-      interpreter.current_env_.assign(assign.name, value);
+    error::RuntimeResult<std::any> operator()(const ast::Assign &assign) {
+      auto value = interpreter.evaluate(*assign.value);
+      if (!value) return value;
+
+      const auto result =
+          interpreter.assign(assign.name, assign.binding, value.value());
+      if (!result) return result.unexpected();
+
       return value;
     }
 
-    std::any operator()(const ast::Ternary &ternary) {
-      const std::any condition = interpreter.evaluate(*ternary.condition);
+    error::RuntimeResult<std::any> operator()(const ast::Update &update) {
+      std::any before;
+
+      const auto target =
+          interpreter.update(update, update.postfix ? &before : nullptr);
+      if (!target) return target.unexpected();
+
+      if (update.postfix) return before;
+      return *target.value();
+    }
+
+    error::RuntimeResult<std::any> operator()(const ast::Ternary &ternary) {
+      const auto condition = interpreter.evaluate(*ternary.condition);
+      if (!condition) return condition;
 
-      return interpreter.isTruthy(condition)
+      return interpreter.isTruthy(condition.value())
                  ? interpreter.evaluate(*ternary.then_expr)
                  : interpreter.evaluate(*ternary.else_expr);
     }
 
-    std::any operator()(const ast::Binary &binary) {
-      const std::any left = interpreter.evaluate(*binary.left);
-      const std::any right = interpreter.evaluate(*binary.right);
+    error::RuntimeResult<std::any> operator()(const ast::Binary &binary) {
+      auto left_result = interpreter.evaluate(*binary.left);
+      if (!left_result) return left_result;
+
+      auto right_result = interpreter.evaluate(*binary.right);
+      if (!right_result) return right_result;
+
+      const std::any &left = left_result.value();
+      const std::any &right = right_result.value();
 
       switch (binary.opr.type) {
         case token::TokenType::SC_MINUS:
-          interpreter.checkNumberOperands(binary.opr, left, right);
-          return std::any_cast<float>(left) - std::any_cast<float>(right);
         case token::TokenType::SC_PLUS:
-          if (left.type() == right.type()) {
-            return interpreter.combineStrict(binary.opr, left, right);
-          } else {
-            return interpreter.combineLoose(binary.opr, left, right);
-          }
-        case token::TokenType::SC_COMMA:
-          return right;
-        case token::TokenType::SC_FORWARD_SLASH: {
-          interpreter.checkNumberOperands(binary.opr, left, right);
-          const float divisor = std::any_cast<float>(right);
-          if (divisor == 0.f) {
-            throw error::RuntimeError(binary.opr,
-                                      "Attempted to divide by zero");
-          }
-          return std::any_cast<float>(left) / divisor;
-        }
+        case token::TokenType::SC_FORWARD_SLASH:
         case token::TokenType::SC_STAR:
-          interpreter.checkNumberOperands(binary.opr, left, right);
-          return std::any_cast<float>(left) * std::any_cast<float>(right);
+          return interpreter.arithmetic(binary.opr, binary.opr.type, left,
+                                        right);
+        case token::TokenType::SC_COMMA:
+          return right_result;
         case token::TokenType::MC_GREATER:
           if (left.type() == typeid(float) && right.type() == typeid(float)) {
             return std::any_cast<float>(left) > std::any_cast<float>(right);
@@ -155,8 +2079,8 @@ std::any Interpreter::evaluate(const ast::Expr &expr) {
                    std::any_cast<std::string>(right);
           }
 
-          throw error::RuntimeError(
-              binary.opr, "Operands must be two numbers or two strings");
+          return error::Unexpected{error::RuntimeError(
+              binary.opr, "Operands must be two numbers or two strings")};
         case token::TokenType::MC_GREATER_EQUAL:
           if (left.type() == typeid(float) && right.type() == typeid(float)) {
             return std::any_cast<float>(left) >= std::any_cast<float>(right);
@@ -168,8 +2092,8 @@ std::any Interpreter::evaluate(const ast::Expr &expr) {
                    std::any_cast<std::string>(right);
           }
 
-          throw error::RuntimeError(
-              binary.opr, "Operands must be two numbers or two strings");
+          return error::Unexpected{error::RuntimeError(
+              binary.opr, "Operands must be two numbers or two strings")};
         case token::TokenType::MC_LESS:
           if (left.type() == typeid(float) && right.type() == typeid(float)) {
             return std::any_cast<float>(left) < std::any_cast<float>(right);
@@ -181,8 +2105,8 @@ std::any Interpreter::evaluate(const ast::Expr &expr) {
                    std::any_cast<std::string>(right);
           }
 
-          throw error::RuntimeError(
-              binary.opr, "Operands must be two numbers or two strings");
+          return error::Unexpected{error::RuntimeError(
+              binary.opr, "Operands must be two numbers or two strings")};
         case token::TokenType::MC_LESS_EQUAL:
           if (left.type() == typeid(float) && right.type() == typeid(float)) {
             return std::any_cast<float>(left) <= std::any_cast<float>(right);
@@ -194,73 +2118,359 @@ std::any Interpreter::evaluate(const ast::Expr &expr) {
                    std::any_cast<std::string>(right);
           }
 
-          throw error::RuntimeError(
-              binary.opr, "Operands must be two numbers or two strings");
+          return error::Unexpected{error::RuntimeError(
+              binary.opr, "Operands must be two numbers or two strings")};
         case token::TokenType::MC_EXCL_EQUAL:
           return !interpreter.isEqual(left, right);
         case token::TokenType::MC_EQUAL_EQUAL:
           return interpreter.isEqual(left, right);
       }
 
-      throw error::RuntimeError(
-          binary.opr, "Binary operation '" + token::toString(binary.opr.type) +
-                          "' not supported.");
+      return error::Unexpected{error::RuntimeError(
+          binary.opr, "Binary operation '" +
+                          std::string(token::toString(binary.opr.type)) +
+                          "' not supported.")};
     }
 
-    std::any operator()(const ast::Grouping &grouping) {
+    error::RuntimeResult<std::any> operator()(const ast::Grouping &grouping) {
       return interpreter.evaluate(*grouping.expression);
     }
 
-    std::any operator()(const ast::Literal &literal) { return literal.value; }
+    error::RuntimeResult<std::any> operator()(const ast::Literal &literal) {
+      return literal.value;
+    }
 
-    std::any operator()(const ast::Logical &logical) {
-      const std::any left = interpreter.evaluate(*logical.left);
+    error::RuntimeResult<std::any> operator()(const ast::Logical &logical) {
+      auto left = interpreter.evaluate(*logical.left);
+      if (!left) return left;
 
       if (logical.opr.type == token::TokenType::KW_OU) {
-        if (interpreter.isTruthy(left)) return left;
+        if (interpreter.isTruthy(left.value())) return left;
       } else {
-        if (!interpreter.isTruthy(left)) return left;
+        if (!interpreter.isTruthy(left.value())) return left;
       }
 
       return interpreter.evaluate(*logical.right);
     }
 
-    std::any operator()(const ast::Unary &unary) {
-      const std::any right = interpreter.evaluate(*unary.right);
+    error::RuntimeResult<std::any> operator()(const ast::Unary &unary) {
+      const auto right = interpreter.evaluate(*unary.right);
+      if (!right) return right;
 
       switch (unary.opr.type) {
         case token::TokenType::MC_EXCL:
-          return !interpreter.isTruthy(right);
+          return !interpreter.isTruthy(right.value());
         case token::TokenType::SC_MINUS:
-          interpreter.checkNumberOperand(unary.opr, right);
-          return -std::any_cast<float>(right);
+          if (auto check =
+                  interpreter.checkNumberOperand(unary.opr, right.value());
+              !check) {
+            return check.unexpected();
+          }
+          return -std::any_cast<float>(right.value());
       }
 
-      throw error::RuntimeError(unary.opr, "Unary operation '" +
-                                               token::toString(unary.opr.type) +
-                                               "' not supported.");
+      return error::Unexpected{error::RuntimeError(
+          unary.opr, "Unary operation '" +
+                         std::string(token::toString(unary.opr.type)) +
+                         "' not supported.")};
     }
 
-    std::any operator()(const ast::Variable &variable) {
-      const auto value = interpreter.current_env_.get(variable.name);
+    error::RuntimeResult<std::any> operator()(const ast::Variable &variable) {
+      auto value = interpreter.lookUp(variable.name, variable.binding);
+      if (!value) return value;
 
-      if (value.type() == typeid(env::Uninitialized)) {
-        throw error::RuntimeError(
+      if (value.value().type() == typeid(env::Uninitialized)) {
+        return error::Unexpected{error::RuntimeError(
             variable.name,
-            "Uninitialized variable '" + variable.name.lexeme.value() + "'");
+            "Uninitialized variable '" + variable.name.lexeme.value() + "'")};
+      }
+
+      return value;
+    }
+
+    error::RuntimeResult<std::any> operator()(const ast::Call &call) {
+      return interpreter.call(call);
+    }
+
+    error::RuntimeResult<std::any> operator()(const ast::Canal &canal) {
+      float capacity = kDefaultChannelCapacity;
+
+      if (canal.capacity.has_value()) {
+        const auto value = interpreter.evaluate(*canal.capacity.value());
+        if (!value) return value;
+
+        if (value.value().type() != typeid(float) ||
+            std::any_cast<float>(value.value()) < 1.f ||
+            std::any_cast<float>(value.value()) > kMaxChannelCapacity) {
+          return error::Unexpected{error::RuntimeError(
+              canal.keyword,
+              "Channel capacity must be a number from 1 to " +
+                  interpreter.stringify(kMaxChannelCapacity))};
+        }
+
+        capacity = std::any_cast<float>(value.value());
+      }
+
+      return std::make_shared<Channel>(
+          channelType(canal.type.lexeme.value()),
+          static_cast<std::size_t>(capacity));
+    }
+
+    error::RuntimeResult<std::any> operator()(const ast::Receba &receba) {
+      const auto channel =
+          interpreter.evaluateChannel(receba.keyword, *receba.channel);
+      if (!channel) return channel.unexpected();
+
+      auto value = channel.value()->receive();
+      if (!value.has_value()) return std::any{nullptr};
+
+      return std::move(value.value());
+    }
+
+    error::RuntimeResult<std::any> operator()(const ast::Get &get) {
+      std::any receiver;
+
+      auto value = interpreter.getProperty(get, receiver);
+      if (!value || !receiver.has_value()) return value;
+
+      return BoundMethod::create(
+          std::any_cast<Instance::Ref>(std::move(receiver)),
+          std::any_cast<Closure::Ref>(std::move(value.value())));
+    }
+
+    error::RuntimeResult<std::any> operator()(const ast::Set &set) {
+      auto object = interpreter.evaluate(*set.object);
+      if (!object) return object;
+
+      auto *instance = std::any_cast<Instance::Ref>(&object.value());
+
+      if (instance == nullptr) {
+        return error::Unexpected{
+            error::RuntimeError(set.name, "Only instances have fields")};
+      }
+
+      auto value = interpreter.evaluate(*set.value);
+      if (!value) return value;
+
+      if ((*instance)->isShared()) {
+        return error::Unexpected{error::RuntimeError(
+            set.name,
+            "Parallel loop iterations cannot assign the fields of an "
+            "instance created outside the loop")};
+      }
+
+      set.cache->set(**instance, set.name.lexeme.value(), value.value());
+
+      return value;
+    }
+
+    error::RuntimeResult<std::any> operator()(const ast::Esse &esse) {
+      return interpreter.lookUp(esse.keyword, esse.binding);
+    }
+
+    error::RuntimeResult<std::any> operator()(const ast::Super &super) {
+      std::any receiver;
+
+      auto method = interpreter.getSuper(super, receiver);
+      if (!method) return method;
+
+      return BoundMethod::create(
+          std::any_cast<Instance::Ref>(std::move(receiver)),
+          std::any_cast<Closure::Ref>(std::move(method.value())));
+    }
+
+    error::RuntimeResult<std::any> operator()(const ast::ArrayLiteral &array) {
+      std::vector<std::any> values;
+      values.reserve(array.elements.size());
+
+      for (const auto &element : array.elements) {
+        auto value = interpreter.evaluate(*element);
+        if (!value) return value;
+
+        values.push_back(std::move(value.value()));
+      }
+
+      return Array::create(std::move(values));
+    }
+
+    error::RuntimeResult<std::any> operator()(
+        const ast::DictionaryLiteral &dictionary) {
+      std::vector<std::pair<Dictionary::Key, std::any>> entries;
+      entries.reserve(dictionary.keys.size());
+
+      for (std::size_t i = 0; i < dictionary.keys.size(); i++) {
+        auto key = interpreter.evaluateKey(dictionary.curly,
+                                           *dictionary.keys[i]);
+        if (!key) return key.unexpected();
+
+        auto value = interpreter.evaluate(*dictionary.values[i]);
+        if (!value) return value;
+
+        entries.emplace_back(std::move(key.value()),
+                             std::move(value.value()));
+      }
+
+      auto result = Dictionary::create();
+      result->insert(entries);
+
+      return result;
+    }
+
+    // A key a dictionary does not have reads as `nulo`.
+    error::RuntimeResult<std::any> operator()(const ast::Index &index) {
+      auto object = interpreter.evaluate(*index.object);
+      if (!object) return object;
+
+      if (auto *dictionary = std::any_cast<Dictionary::Ref>(&object.value())) {
+        const auto key = interpreter.evaluateKey(index.bracket, *index.index);
+        if (!key) return key.unexpected();
+
+        const std::any *value = (*dictionary)->find(key.value());
+        return value != nullptr ? *value : std::any{nullptr};
+      }
+
+      const auto *array = std::any_cast<Array::Ref>(&object.value());
+
+      if (array == nullptr) {
+        return error::Unexpected{error::RuntimeError(
+            index.bracket, "Only arrays and dictionaries can be indexed")};
+      }
+
+      const auto position =
+          interpreter.evaluateIndex(index.bracket, **array, *index.index);
+      if (!position) return position.unexpected();
+
+      return (*array)->get(position.value());
+    }
+
+    error::RuntimeResult<std::any> operator()(const ast::SetIndex &set) {
+      auto object = interpreter.evaluate(*set.object);
+      if (!object) return object;
+
+      if (auto *dictionary = std::any_cast<Dictionary::Ref>(&object.value())) {
+        auto key = interpreter.evaluateKey(set.bracket, *set.index);
+        if (!key) return key.unexpected();
+
+        auto value = interpreter.evaluate(*set.value);
+        if (!value) return value;
+
+        if ((*dictionary)->isShared()) {
+          return error::Unexpected{error::RuntimeError(
+              set.bracket,
+              "Parallel loop iterations cannot assign the entries of a "
+              "dictionary created outside the loop")};
+        }
+
+        (*dictionary)->insert(std::move(key.value()), value.value());
+
+        return value;
+      }
+
+      const auto *array = std::any_cast<Array::Ref>(&object.value());
+
+      if (array == nullptr) {
+        return error::Unexpected{error::RuntimeError(
+            set.bracket, "Only arrays and dictionaries can be indexed")};
+      }
+
+      const auto position =
+          interpreter.evaluateIndex(set.bracket, **array, *set.index);
+      if (!position) return position.unexpected();
+
+      auto value = interpreter.evaluate(*set.value);
+      if (!value) return value;
+
+      // Numbers stored in a packed array go in place, each in its element.
+      if ((*array)->isShared() && (!(*array)->isPacked() ||
+                                   value.value().type() != typeid(float))) {
+        return error::Unexpected{error::RuntimeError(
+            set.bracket,
+            "Parallel loop iterations can only store numbers in the packed "
+            "arrays created outside the loop")};
       }
 
+      (*array)->set(position.value(), value.value());
+
       return value;
     }
 
-    std::any operator()(const ast::ErrorExpr &error) {
+    error::RuntimeResult<std::any> operator()(const ast::ErrorExpr &error) {
       assert(false && "Overload not implemented.");
+      return std::any{};
     }
   };
   AnyVisitor visitor{.interpreter = *this};
   return std::visit(visitor, expr.var);
 }
 
+error::RuntimeResult<Interpreter::LoopSource> Interpreter::evaluateSource(
+    const ast::ForEach &loop) {
+  const auto value = evaluate(*loop.source);
+  if (!value) return value.unexpected();
+
+  auto source = LoopSource::of(value.value());
+
+  if (!source.has_value()) {
+    return error::Unexpected{error::RuntimeError(
+        loop.keyword, "Can only iterate over ranges, arrays and dictionaries")};
+  }
+
+  return std::move(source.value());
+}
+
+// The body of the case the value is a label of, or of `padrao`, or null when
+// there is neither.
+error::RuntimeResult<const ast::Stmt *> Interpreter::evaluateCase(
+    const ast::Escolha &escolha) {
+  const auto value = evaluate(*escolha.value);
+  if (!value) return value.unexpected();
+
+  int index = escolha.table->find(value.value());
+  if (index < 0) index = escolha.fallback;
+
+  if (index < 0) return nullptr;
+  return escolha.bodies[index].get();
+}
+
+error::RuntimeResult<Dictionary::Key> Interpreter::evaluateKey(
+    const token::Token &token, const ast::Expr &expr) {
+  const auto value = evaluate(expr);
+  if (!value) return value.unexpected();
+
+  auto key = Dictionary::toKey(value.value());
+
+  if (!key.has_value()) {
+    return error::Unexpected{
+        error::RuntimeError(token, "Keys must be strings or numbers")};
+  }
+
+  return std::move(key.value());
+}
+
+// The index is evaluated before the element is read or assigned, so that the
+// bounds it is checked against are the ones of the access.
+error::RuntimeResult<std::size_t> Interpreter::evaluateIndex(
+    const token::Token &bracket, const Array &array, const ast::Expr &expr) {
+  const auto value = evaluate(expr);
+  if (!value) return value.unexpected();
+
+  const auto *index = std::any_cast<float>(&value.value());
+
+  if (index == nullptr || *index != std::floor(*index)) {
+    return error::Unexpected{
+        error::RuntimeError(bracket, "Index must be a whole number")};
+  }
+
+  if (*index < 0 || *index >= static_cast<float>(array.size())) {
+    return error::Unexpected{error::RuntimeError(
+        bracket, "Index " + helper::formatNumber(*index) +
+                     " is out of bounds for an array of size " +
+                     std::to_string(array.size()))};
+  }
+
+  return static_cast<std::size_t>(*index);
+}
+
 bool Interpreter::isTruthy(std::any value) {
   if (value.type() == typeid(nullptr)) return false;
   if (value.type() == typeid(bool)) return std::any_cast<bool>(value);
@@ -279,25 +2489,92 @@ bool Interpreter::isEqual(std::any a, std::any b) {
   if (a.type() == typeid(float) && b.type() == typeid(float)) {
     return std::any_cast<float>(a) == std::any_cast<float>(b);
   }
+  if (a.type() == typeid(std::shared_ptr<Channel>) &&
+      b.type() == typeid(std::shared_ptr<Channel>)) {
+    return std::any_cast<std::shared_ptr<Channel>>(a) ==
+           std::any_cast<std::shared_ptr<Channel>>(b);
+  }
+  if (a.type() == typeid(Closure::Ref) && b.type() == typeid(Closure::Ref)) {
+    return std::any_cast<Closure::Ref>(a) == std::any_cast<Closure::Ref>(b);
+  }
+  if (a.type() == typeid(NativeFunction::Ref) &&
+      b.type() == typeid(NativeFunction::Ref)) {
+    return std::any_cast<NativeFunction::Ref>(a) ==
+           std::any_cast<NativeFunction::Ref>(b);
+  }
+  if (a.type() == typeid(Class::Ref) && b.type() == typeid(Class::Ref)) {
+    return std::any_cast<Class::Ref>(a) == std::any_cast<Class::Ref>(b);
+  }
+  if (a.type() == typeid(Instance::Ref) && b.type() == typeid(Instance::Ref)) {
+    return std::any_cast<Instance::Ref>(a) == std::any_cast<Instance::Ref>(b);
+  }
+  if (a.type() == typeid(BoundMethod::Ref) &&
+      b.type() == typeid(BoundMethod::Ref)) {
+    return std::any_cast<BoundMethod::Ref>(a) ==
+           std::any_cast<BoundMethod::Ref>(b);
+  }
+  if (a.type() == typeid(Array::Ref) && b.type() == typeid(Array::Ref)) {
+    return std::any_cast<Array::Ref>(a) == std::any_cast<Array::Ref>(b);
+  }
+  if (a.type() == typeid(Dictionary::Ref) &&
+      b.type() == typeid(Dictionary::Ref)) {
+    return std::any_cast<Dictionary::Ref>(a) ==
+           std::any_cast<Dictionary::Ref>(b);
+  }
+  if (a.type() == typeid(Range::Ref) && b.type() == typeid(Range::Ref)) {
+    return std::any_cast<Range::Ref>(a) == std::any_cast<Range::Ref>(b);
+  }
 
   // Loose equality comparison (type coercion) is false.
   return false;
 }
 
-void Interpreter::checkNumberOperand(token::Token opr, std::any value) {
-  if (value.type() == typeid(float)) return;
-  throw error::RuntimeError(opr, "Operand must be a number");
+error::RuntimeResult<> Interpreter::checkNumberOperand(
+    const token::Token &opr, const std::any &value) {
+  if (value.type() == typeid(float)) return {};
+  return error::Unexpected{
+      error::RuntimeError(opr, "Operand must be a number")};
 }
 
-void Interpreter::checkNumberOperands(token::Token opr, std::any left,
-                                      std::any right) {
-  if (left.type() == typeid(float) && right.type() == typeid(float)) return;
-  throw error::RuntimeError(opr, "Operands must be numbers");
+error::RuntimeResult<> Interpreter::checkNumberOperands(
+    const token::Token &opr, const std::any &left, const std::any &right) {
+  if (left.type() == typeid(float) && right.type() == typeid(float)) return {};
+  return error::Unexpected{
+      error::RuntimeError(opr, "Operands must be numbers")};
+}
+
+// `left opr right` for `-`, `+`, `/` and `*`, reporting errors at `opr`.
+error::RuntimeResult<std::any> Interpreter::arithmetic(
+    const token::Token &opr, token::TokenType operation, const std::any &left,
+    const std::any &right) {
+  if (operation == token::TokenType::SC_PLUS) {
+    if (left.type() == right.type()) return combineStrict(opr, left, right);
+    return combineLoose(opr, left, right);
+  }
+
+  if (auto check = checkNumberOperands(opr, left, right); !check) {
+    return check.unexpected();
+  }
+
+  const float a = std::any_cast<float>(left);
+  const float b = std::any_cast<float>(right);
+
+  switch (operation) {
+    case token::TokenType::SC_MINUS:
+      return a - b;
+    case token::TokenType::SC_FORWARD_SLASH:
+      if (b == 0.f) {
+        return error::Unexpected{
+            error::RuntimeError(opr, "Attempted to divide by zero")};
+      }
+      return a / b;
+    default:
+      return a * b;
+  }
 }
 
-std::any Interpreter::combineStrict(const token::Token &opr,
-                                    const std::any &left,
-                                    const std::any &right) {
+error::RuntimeResult<std::any> Interpreter::combineStrict(
+    const token::Token &opr, const std::any &left, const std::any &right) {
   if (left.type() == typeid(float) && right.type() == typeid(float)) {
     return std::any_cast<float>(left) + std::any_cast<float>(right);
   }
@@ -307,14 +2584,13 @@ std::any Interpreter::combineStrict(const token::Token &opr,
     return std::any_cast<std::string>(left) + std::any_cast<std::string>(right);
   }
 
-  throw error::RuntimeError(
+  return error::Unexpected{error::RuntimeError(
       opr,
-      "Operands must be two numbers or two strings for strict combination");
+      "Operands must be two numbers or two strings for strict combination")};
 }
 
-std::any Interpreter::combineLoose(const token::Token &opr,
-                                   const std::any &left,
-                                   const std::any &right) {
+error::RuntimeResult<std::any> Interpreter::combineLoose(
+    const token::Token &opr, const std::any &left, const std::any &right) {
   // Loose binary operations where the left operand is a string.
   if (left.type() == typeid(std::string)) {
     const auto left_str = std::any_cast<std::string>(left);
@@ -331,7 +2607,8 @@ std::any Interpreter::combineLoose(const token::Token &opr,
       return left_str + stringify(right);
     }
 
-    throw error::RuntimeError(opr, "Invalid right-hand side operand type");
+    return error::Unexpected{
+        error::RuntimeError(opr, "Invalid right-hand side operand type")};
   }
 
   // Loose binary operations where the left operand is a float.
@@ -346,7 +2623,8 @@ std::any Interpreter::combineLoose(const token::Token &opr,
       return left_str;
     }
 
-    throw error::RuntimeError(opr, "Invalid right-hand side operand type");
+    return error::Unexpected{
+        error::RuntimeError(opr, "Invalid right-hand side operand type")};
   }
 
   // Loose binary operations where the left operand is a boolean.
@@ -359,25 +2637,99 @@ std::any Interpreter::combineLoose(const token::Token &opr,
       return stringify(right);
     }
 
-    throw error::RuntimeError(opr, "Invalid right-hand side operand type");
+    return error::Unexpected{
+        error::RuntimeError(opr, "Invalid right-hand side operand type")};
   }
 
-  throw error::RuntimeError(opr, "Unsupported loose combination operands");
+  return error::Unexpected{
+      error::RuntimeError(opr, "Unsupported loose combination operands")};
 }
 
 std::string Interpreter::stringify(const std::any &value) {
-  if (value.type() == typeid(nullptr)) return token::KW_NULO;
+  if (value.type() == typeid(nullptr)) return std::string(token::KW_NULO);
 
   if (value.type() == typeid(float)) {
-    auto str = std::to_string(std::any_cast<float>(value));
-
-    return helper::endsWith(str, ".000000") ? str.substr(0, str.length() - 7)
-                                            : str;
+    return helper::formatNumber(std::any_cast<float>(value));
   }
 
   if (value.type() == typeid(bool)) {
-    return std::any_cast<bool>(value) ? token::KW_VERDADEIRO : token::KW_FALSO;
+    return std::string(std::any_cast<bool>(value) ? token::KW_VERDADEIRO
+                                                   : token::KW_FALSO);
+  }
+
+  if (value.type() == typeid(std::shared_ptr<Channel>)) {
+    const auto channel = std::any_cast<std::shared_ptr<Channel>>(value);
+    return "<canal " + std::string(channelTypeName(channel->getType())) + ">";
+  }
+
+  if (const auto *closure = std::any_cast<Closure::Ref>(&value)) {
+    return "<funcao " + (*closure)->getDeclaration().name.lexeme.value() +
+           ">";
+  }
+
+  if (const auto *native = std::any_cast<NativeFunction::Ref>(&value)) {
+    return "<funcao nativa " + (*native)->getName() + ">";
+  }
+
+  if (const auto *klass = std::any_cast<Class::Ref>(&value)) {
+    return "<classe " + (*klass)->getName() + ">";
+  }
+
+  if (const auto *instance = std::any_cast<Instance::Ref>(&value)) {
+    return "<instancia " + (*instance)->getClass()->getName() + ">";
+  }
+
+  if (const auto *bound = std::any_cast<BoundMethod::Ref>(&value)) {
+    return "<funcao " +
+           bound->get()->getMethod()->getDeclaration().name.lexeme.value() +
+           ">";
+  }
+
+  if (value.type() == typeid(Array::Ref) ||
+      value.type() == typeid(Dictionary::Ref)) {
+    return stringify(value, 0);
+  }
+
+  if (const auto *range = std::any_cast<Range::Ref>(&value)) {
+    return "intervalo(" + helper::formatNumber((*range)->getStart()) + ", " +
+           helper::formatNumber((*range)->getEnd()) + ", " +
+           helper::formatNumber((*range)->getStep()) + ")";
   }
 
   return std::any_cast<std::string>(value);
 }
+
+// Arrays and dictionaries, whose elements are printed like values, except
+// for the arrays and dictionaries among them, which nest one level deeper.
+std::string Interpreter::stringify(const std::any &value, int depth) {
+  if (const auto *array = std::any_cast<Array::Ref>(&value)) {
+    if (depth == kMaxPrintDepth) return "[...]";
+
+    std::string result = "[";
+
+    for (std::size_t i = 0; i < (*array)->size(); i++) {
+      if (i > 0) result += ", ";
+      result += stringify((*array)->get(i), depth + 1);
+    }
+
+    return result + "]";
+  }
+
+  if (const auto *dictionary = std::any_cast<Dictionary::Ref>(&value)) {
+    if (depth == kMaxPrintDepth) return "{...}";
+
+    std::string result = "{";
+
+    (*dictionary)->forEach([&](const Dictionary::Key &key,
+                               const std::any &element) {
+      if (result.size() > 1) result += ", ";
+
+      result += stringify(Dictionary::toValue(key)) + ": " +
+                stringify(element, depth + 1);
+    });
+
+    return result + "}";
+  }
+
+  return stringify(value);
+}
@@ -0,0 +1,368 @@
+#include "lusoscript/json.hh"
+
+#include <charconv>
+#include <cmath>
+
+namespace {
+// Arrays and objects nested deeper than this are not parsed, rather than
+// overflowing the stack.
+constexpr int kMaxDepth = 512;
+
+class JsonParser {
+ public:
+  explicit JsonParser(std::string_view text)
+      : text_(text), current_(0), depth_(0) {}
+
+  std::optional<json::Value> parseDocument() {
+    auto value = parseValue();
+    skipWhitespace();
+
+    if (!value.has_value() || current_ != text_.size()) return std::nullopt;
+
+    return value;
+  }
+
+ private:
+  std::string_view text_;
+  std::size_t current_;
+  // Arrays and objects being parsed.
+  int depth_;
+
+  std::optional<json::Value> parseValue() {
+    skipWhitespace();
+
+    if (current_ >= text_.size()) return std::nullopt;
+
+    switch (text_[current_]) {
+      case '{':
+      case '[': {
+        if (depth_ == kMaxDepth) return std::nullopt;
+
+        depth_++;
+        auto value = text_[current_] == '{' ? parseObject() : parseArray();
+        depth_--;
+
+        return value;
+      }
+      case '"': {
+        auto str = parseString();
+        if (!str.has_value()) return std::nullopt;
+        return json::Value{std::move(str.value())};
+      }
+      case 't':
+        return parseLiteral("true", json::Value{true});
+      case 'f':
+        return parseLiteral("false", json::Value{false});
+      case 'n':
+        return parseLiteral("null", json::Value{nullptr});
+      default:
+        return parseNumber();
+    }
+  }
+
+  std::optional<json::Value> parseObject() {
+    json::Object object;
+    current_++;
+
+    skipWhitespace();
+    if (match('}')) return json::Value{std::move(object)};
+
+    do {
+      skipWhitespace();
+
+      auto key = parseString();
+      if (!key.has_value()) return std::nullopt;
+
+      skipWhitespace();
+      if (!match(':')) return std::nullopt;
+
+      auto value = parseValue();
+      if (!value.has_value()) return std::nullopt;
+
+      object[std::move(key.value())] = std::move(value.value());
+
+      skipWhitespace();
+    } while (match(','));
+
+    if (!match('}')) return std::nullopt;
+
+    return json::Value{std::move(object)};
+  }
+
+  std::optional<json::Value> parseArray() {
+    json::Array array;
+    current_++;
+
+    skipWhitespace();
+    if (match(']')) return json::Value{std::move(array)};
+
+    do {
+      auto value = parseValue();
+      if (!value.has_value()) return std::nullopt;
+
+      array.push_back(std::move(value.value()));
+
+      skipWhitespace();
+    } while (match(','));
+
+    if (!match(']')) return std::nullopt;
+
+    return json::Value{std::move(array)};
+  }
+
+  std::optional<std::string> parseString() {
+    if (!match('"')) return std::nullopt;
+
+    std::string output;
+
+    while (current_ < text_.size() && text_[current_] != '"') {
+      char c = text_[current_++];
+
+      if (c != '\\') {
+        output.push_back(c);
+        continue;
+      }
+
+      if (current_ >= text_.size()) return std::nullopt;
+
+      c = text_[current_++];
+      switch (c) {
+        case 'b':
+          output.push_back('\b');
+          break;
+        case 'f':
+          output.push_back('\f');
+          break;
+        case 'n':
+          output.push_back('\n');
+          break;
+        case 'r':
+          output.push_back('\r');
+          break;
+        case 't':
+          output.push_back('\t');
+          break;
+        case 'u': {
+          unsigned int code = 0;
+          if (!parseHex(code)) return std::nullopt;
+
+          // Surrogate pairs encode code points above the BMP.
+          if (code >= 0xD800 && code <= 0xDBFF && match('\\') && match('u')) {
+            unsigned int low = 0;
+            if (!parseHex(low)) return std::nullopt;
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+          }
+
+          appendUtf8(output, code);
+          break;
+        }
+        default:
+          output.push_back(c);
+          break;
+      }
+    }
+
+    if (!match('"')) return std::nullopt;
+
+    return output;
+  }
+
+  std::optional<json::Value> parseNumber() {
+    const std::size_t start = current_;
+
+    while (current_ < text_.size() &&
+           std::string_view("+-0123456789.eE").find(text_[current_]) !=
+               std::string_view::npos) {
+      current_++;
+    }
+
+    double number = 0;
+    const auto [end, ec] =
+        std::from_chars(text_.data() + start, text_.data() + current_, number);
+
+    if (ec != std::errc() || end != text_.data() + current_) {
+      return std::nullopt;
+    }
+
+    return json::Value{number};
+  }
+
+  std::optional<json::Value> parseLiteral(std::string_view literal,
+                                          json::Value value) {
+    if (text_.substr(current_, literal.size()) != literal) return std::nullopt;
+
+    current_ += literal.size();
+
+    return value;
+  }
+
+  bool parseHex(unsigned int &code) {
+    if (current_ + 4 > text_.size()) return false;
+
+    const auto [end, ec] = std::from_chars(
+        text_.data() + current_, text_.data() + current_ + 4, code, 16);
+    if (ec != std::errc() || end != text_.data() + current_ + 4) return false;
+
+    current_ += 4;
+
+    return true;
+  }
+
+  static void appendUtf8(std::string &output, unsigned int code) {
+    if (code < 0x80) {
+      output.push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+      output.push_back(static_cast<char>(0xC0 | (code >> 6)));
+      output.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+      output.push_back(static_cast<char>(0xE0 | (code >> 12)));
+      output.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+      output.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else {
+      output.push_back(static_cast<char>(0xF0 | (code >> 18)));
+      output.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+      output.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+      output.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+  }
+
+  void skipWhitespace() {
+    while (current_ < text_.size() &&
+           (text_[current_] == ' ' || text_[current_] == '\n' ||
+            text_[current_] == '\r' || text_[current_] == '\t')) {
+      current_++;
+    }
+  }
+
+  bool match(char expected) {
+    if (current_ >= text_.size() || text_[current_] != expected) return false;
+
+    current_++;
+
+    return true;
+  }
+};
+
+void serializeString(const std::string &str, std::string &output) {
+  output.push_back('"');
+
+  for (const char c : str) {
+    switch (c) {
+      case '"':
+        output.append("\\\"");
+        break;
+      case '\\':
+        output.append("\\\\");
+        break;
+      case '\n':
+        output.append("\\n");
+        break;
+      case '\r':
+        output.append("\\r");
+        break;
+      case '\t':
+        output.append("\\t");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          constexpr char kHex[] = "0123456789abcdef";
+          output.append("\\u00");
+          output.push_back(kHex[(c >> 4) & 0xF]);
+          output.push_back(kHex[c & 0xF]);
+        } else {
+          output.push_back(c);
+        }
+        break;
+    }
+  }
+
+  output.push_back('"');
+}
+
+void serializeValue(const json::Value &value, std::string &output) {
+  struct Visitor {
+    std::string &output;
+
+    void operator()(std::nullptr_t) { output.append("null"); }
+
+    void operator()(bool boolean) { output.append(boolean ? "true" : "false"); }
+
+    void operator()(double number) {
+      if (std::trunc(number) == number && std::abs(number) < 1e15) {
+        output.append(std::to_string(static_cast<long long>(number)));
+      } else {
+        output.append(std::to_string(number));
+      }
+    }
+
+    void operator()(const std::string &str) { serializeString(str, output); }
+
+    void operator()(const json::Array &array) {
+      output.push_back('[');
+
+      for (std::size_t i = 0; i < array.size(); i++) {
+        if (i > 0) output.push_back(',');
+        serializeValue(array[i], output);
+      }
+
+      output.push_back(']');
+    }
+
+    void operator()(const json::Object &object) {
+      output.push_back('{');
+
+      bool first = true;
+      for (const auto &[key, member] : object) {
+        if (!first) output.push_back(',');
+        first = false;
+
+        serializeString(key, output);
+        output.push_back(':');
+        serializeValue(member, output);
+      }
+
+      output.push_back('}');
+    }
+  };
+  Visitor visitor{.output = output};
+  std::visit(visitor, value.var);
+}
+}  // namespace
+
+const json::Value *json::Value::get(std::string_view key) const {
+  const auto *object = std::get_if<Object>(&var);
+  if (object == nullptr) return nullptr;
+
+  const auto it = object->find(std::string(key));
+  if (it == object->end()) return nullptr;
+
+  return &it->second;
+}
+
+const std::string *json::Value::getString(std::string_view key) const {
+  const Value *member = get(key);
+  if (member == nullptr) return nullptr;
+
+  return std::get_if<std::string>(&member->var);
+}
+
+std::optional<double> json::Value::getNumber(std::string_view key) const {
+  const Value *member = get(key);
+  if (member == nullptr) return std::nullopt;
+
+  const auto *number = std::get_if<double>(&member->var);
+  if (number == nullptr) return std::nullopt;
+
+  return *number;
+}
+
+std::optional<json::Value> json::parse(std::string_view text) {
+  JsonParser parser(text);
+  return parser.parseDocument();
+}
+
+std::string json::serialize(const Value &value) {
+  std::string output;
+  serializeValue(value, output);
+  return output;
+}
@@ -0,0 +1,296 @@
+#include "lusoscript/language_server.hh"
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+
+namespace {
+// JSON-RPC error code for unknown requests.
+constexpr int kMethodNotFound = -32601;
+
+// Bodies longer than this are skipped rather than read.
+constexpr std::size_t kMaxMessageLength = 64 * 1024 * 1024;
+
+// The value of a `Content-Length` header, or nothing if it is not a number.
+std::optional<std::size_t> parseLength(std::string_view value) {
+  const auto first = value.find_first_not_of(" \t");
+  if (first == std::string_view::npos) return std::nullopt;
+
+  value.remove_prefix(first);
+  value.remove_suffix(value.size() - value.find_last_not_of(" \t") - 1);
+
+  std::size_t length = 0;
+  const auto [end, ec] =
+      std::from_chars(value.data(), value.data() + value.size(), length);
+
+  if (ec != std::errc() || end != value.data() + value.size()) {
+    return std::nullopt;
+  }
+
+  return length;
+}
+
+// Converts an LSP position (zero-based line and UTF-16 column) to a byte
+// offset into `text`, clamping positions past the end of a line or the text.
+int offsetAt(const std::string &text, int line, int character) {
+  std::size_t offset = 0;
+
+  for (int i = 0; i < line; i++) {
+    const std::size_t newline = text.find('\n', offset);
+    if (newline == std::string::npos) return static_cast<int>(text.size());
+    offset = newline + 1;
+  }
+
+  int units = 0;
+  while (offset < text.size() && text[offset] != '\n' && units < character) {
+    const auto lead = static_cast<unsigned char>(text[offset]);
+    const int length = lead < 0x80   ? 1
+                       : lead < 0xE0 ? 2
+                       : lead < 0xF0 ? 3
+                                     : 4;
+
+    // Code points outside the BMP take two UTF-16 code units.
+    units += length == 4 ? 2 : 1;
+    offset = std::min(offset + length, text.size());
+  }
+
+  return static_cast<int>(offset);
+}
+
+json::Value position(int line, int character) {
+  return json::Value{json::Object{
+      {"line", json::Value{static_cast<double>(line)}},
+      {"character", json::Value{static_cast<double>(character)}},
+  }};
+}
+}  // namespace
+
+LanguageServer::LanguageServer(std::istream &input, std::ostream &output)
+    : input_(input), output_(output), shutdown_(false) {}
+
+int LanguageServer::run() {
+  while (auto message = readMessage()) {
+    const std::string *method = message->getString("method");
+
+    if (method != nullptr && *method == "exit") return shutdown_ ? 0 : 1;
+
+    handle(message.value());
+  }
+
+  // The client went away without asking the server to exit.
+  return 1;
+}
+
+// Reads one message framed by a `Content-Length` header. Returns nothing once
+// the input ends. Malformed bodies are skipped, and so are the ones too long
+// to read; a frame without a valid length has no body to skip.
+std::optional<json::Value> LanguageServer::readMessage() {
+  while (true) {
+    std::optional<std::size_t> length;
+    std::string header;
+
+    while (std::getline(input_, header)) {
+      if (!header.empty() && header.back() == '\r') header.pop_back();
+      if (header.empty()) break;
+
+      constexpr std::string_view kContentLength = "Content-Length:";
+      if (header.starts_with(kContentLength)) {
+        length = parseLength(
+            std::string_view(header).substr(kContentLength.size()));
+      }
+    }
+
+    if (!input_) return std::nullopt;
+    if (!length.has_value()) continue;
+
+    if (length.value() > kMaxMessageLength) {
+      if (!input_.ignore(static_cast<std::streamsize>(std::min<std::size_t>(
+              length.value(), std::numeric_limits<std::streamsize>::max())))) {
+        return std::nullopt;
+      }
+      continue;
+    }
+
+    std::string body(length.value(), '\0');
+    if (!input_.read(body.data(),
+                     static_cast<std::streamsize>(length.value()))) {
+      return std::nullopt;
+    }
+
+    if (auto message = json::parse(body)) return message;
+  }
+}
+
+void LanguageServer::send(const json::Value &message) {
+  const std::string body = json::serialize(message);
+
+  output_ << "Content-Length: " << body.size() << "\r\n\r\n" << body;
+  output_.flush();
+}
+
+void LanguageServer::respond(const json::Value &id, json::Value result) {
+  send(json::Value{json::Object{
+      {"jsonrpc", json::Value{std::string("2.0")}},
+      {"id", id},
+      {"result", std::move(result)},
+  }});
+}
+
+void LanguageServer::respondError(const json::Value &id, int code,
+                                  const std::string &message) {
+  send(json::Value{json::Object{
+      {"jsonrpc", json::Value{std::string("2.0")}},
+      {"id", id},
+      {"error", json::Value{json::Object{
+                    {"code", json::Value{static_cast<double>(code)}},
+                    {"message", json::Value{message}},
+                }}},
+  }});
+}
+
+void LanguageServer::handle(const json::Value &message) {
+  const std::string *method = message.getString("method");
+  const json::Value *id = message.get("id");
+  const json::Value *params = message.get("params");
+
+  // Responses to requests from the server are not expected.
+  if (method == nullptr) return;
+
+  if (*method == "initialize" && id != nullptr) {
+    respond(*id, json::Value{json::Object{
+                     {"capabilities",
+                      json::Value{json::Object{
+                          {"textDocumentSync",
+                           json::Value{json::Object{
+                               {"openClose", json::Value{true}},
+                               // Incremental synchronization.
+                               {"change", json::Value{2.0}},
+                           }}},
+                      }}},
+                     {"serverInfo", json::Value{json::Object{
+                                        {"name", json::Value{std::string(
+                                                     "luso-lsp")}},
+                                    }}},
+                 }});
+  } else if (*method == "shutdown" && id != nullptr) {
+    shutdown_ = true;
+    respond(*id, json::Value{nullptr});
+  } else if (*method == "textDocument/didOpen" && params != nullptr) {
+    didOpen(*params);
+  } else if (*method == "textDocument/didChange" && params != nullptr) {
+    didChange(*params);
+  } else if (*method == "textDocument/didClose" && params != nullptr) {
+    didClose(*params);
+  } else if (id != nullptr) {
+    respondError(*id, kMethodNotFound, "Method not found: " + *method);
+  }
+}
+
+void LanguageServer::didOpen(const json::Value &params) {
+  const json::Value *text_document = params.get("textDocument");
+  if (text_document == nullptr) return;
+
+  const std::string *uri = text_document->getString("uri");
+  const std::string *text = text_document->getString("text");
+  if (uri == nullptr || text == nullptr) return;
+
+  documents_.erase(*uri);
+  documents_.emplace(*uri, *text);
+
+  publishDiagnostics(*uri);
+}
+
+void LanguageServer::didChange(const json::Value &params) {
+  const json::Value *text_document = params.get("textDocument");
+  const json::Value *changes = params.get("contentChanges");
+  if (text_document == nullptr || changes == nullptr) return;
+
+  const std::string *uri = text_document->getString("uri");
+  if (uri == nullptr) return;
+
+  const auto it = documents_.find(*uri);
+  const auto *change_list = std::get_if<json::Array>(&changes->var);
+  if (it == documents_.end() || change_list == nullptr) return;
+
+  Document &document = it->second;
+
+  for (const json::Value &change : *change_list) {
+    const std::string *text = change.getString("text");
+    if (text == nullptr) continue;
+
+    const json::Value *range = change.get("range");
+    const json::Value *start = range ? range->get("start") : nullptr;
+    const json::Value *end = range ? range->get("end") : nullptr;
+
+    if (start == nullptr || end == nullptr) {
+      // A change without a range replaces the whole text.
+      document.edit(0, static_cast<int>(document.getText().size()), *text);
+      continue;
+    }
+
+    const std::string &current = document.getText();
+    const int start_offset = offsetAt(
+        current, static_cast<int>(start->getNumber("line").value_or(0)),
+        static_cast<int>(start->getNumber("character").value_or(0)));
+    const int end_offset = offsetAt(
+        current, static_cast<int>(end->getNumber("line").value_or(0)),
+        static_cast<int>(end->getNumber("character").value_or(0)));
+
+    document.edit(start_offset, std::max(0, end_offset - start_offset), *text);
+  }
+
+  publishDiagnostics(*uri);
+}
+
+void LanguageServer::didClose(const json::Value &params) {
+  const json::Value *text_document = params.get("textDocument");
+  if (text_document == nullptr) return;
+
+  const std::string *uri = text_document->getString("uri");
+  if (uri == nullptr) return;
+
+  documents_.erase(*uri);
+
+  // Clear the diagnostics of the closed file.
+  send(json::Value{json::Object{
+      {"jsonrpc", json::Value{std::string("2.0")}},
+      {"method", json::Value{std::string("textDocument/publishDiagnostics")}},
+      {"params", json::Value{json::Object{
+                     {"uri", json::Value{*uri}},
+                     {"diagnostics", json::Value{json::Array{}}},
+                 }}},
+  }});
+}
+
+void LanguageServer::publishDiagnostics(const std::string &uri) {
+  json::Array diagnostics;
+
+  for (const auto &diagnostic : documents_.at(uri).getDiagnostics()) {
+    // Diagnostics only carry a line, so they cover it entirely.
+    const int line = std::max(0, diagnostic.line - 1);
+    const std::string message =
+        diagnostic.where.empty()
+            ? diagnostic.message
+            : diagnostic.where.substr(1) + ": " + diagnostic.message;
+
+    diagnostics.push_back(json::Value{json::Object{
+        {"range", json::Value{json::Object{
+                      {"start", position(line, 0)},
+                      {"end", position(line + 1, 0)},
+                  }}},
+        // Error.
+        {"severity", json::Value{1.0}},
+        {"source", json::Value{std::string("luso")}},
+        {"message", json::Value{message}},
+    }});
+  }
+
+  send(json::Value{json::Object{
+      {"jsonrpc", json::Value{std::string("2.0")}},
+      {"method", json::Value{std::string("textDocument/publishDiagnostics")}},
+      {"params", json::Value{json::Object{
+                     {"uri", json::Value{uri}},
+                     {"diagnostics", json::Value{std::move(diagnostics)}},
+                 }}},
+  }});
+}
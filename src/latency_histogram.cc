@@ -0,0 +1,65 @@
+#include "lusoscript/latency_histogram.hh"
+
+#include <algorithm>
+#include <bit>
+#include <sstream>
+#include <utility>
+
+LatencyHistogram::LatencyHistogram(std::string name)
+    : name_(std::move(name)), buckets_{} {}
+
+void LatencyHistogram::record(std::chrono::nanoseconds latency) {
+  const auto micros = static_cast<std::uint64_t>(std::max<std::int64_t>(
+      0, std::chrono::duration_cast<std::chrono::microseconds>(latency)
+             .count()));
+  const std::size_t index =
+      std::min<std::size_t>(std::bit_width(micros), kBuckets - 1);
+
+  buckets_[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string LatencyHistogram::report() const {
+  std::array<std::uint64_t, kBuckets> counts;
+  std::uint64_t total = 0;
+
+  for (std::size_t i = 0; i < kBuckets; i++) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+
+  std::ostringstream output;
+  output << name_ << ": " << total << " requests";
+
+  // Bucket holding the sample of rank `quantile * total`.
+  const auto percentile = [&](double quantile) {
+    const auto rank = static_cast<std::uint64_t>(quantile * total);
+    std::uint64_t seen = 0;
+
+    for (std::size_t i = 0; i < kBuckets; i++) {
+      seen += counts[i];
+      if (seen > rank) return i;
+    }
+
+    return kBuckets - 1;
+  };
+
+  if (total > 0) {
+    output << ", p50 < " << bound(percentile(0.5)) << " us, p99 < "
+           << bound(percentile(0.99)) << " us";
+  }
+
+  output << "\n";
+
+  for (std::size_t i = 0; i < kBuckets; i++) {
+    if (counts[i] == 0) continue;
+
+    output << "  [" << (i == 0 ? 0 : bound(i - 1)) << ", " << bound(i)
+           << ") us: " << counts[i] << "\n";
+  }
+
+  return output.str();
+}
+
+std::uint64_t LatencyHistogram::bound(std::size_t index) {
+  return std::uint64_t{1} << index;
+}
@@ -1,11 +1,15 @@
 #include "lusoscript/lexer.hh"
 
 Lexer::Lexer(const std::string &source, error::ErrorState &error_state)
+    : Lexer(source, error_state, 0, 1) {}
+
+Lexer::Lexer(const std::string &source, error::ErrorState &error_state,
+             int offset, int line)
     : source_(source),
       error_state_(error_state),
-      start_(0),
-      current_(0),
-      line_(1) {}
+      start_(offset),
+      current_(offset),
+      line_(line) {}
 
 std::vector<token::Token> Lexer::scanTokens() {
   while (!isAtEnd()) {
@@ -13,12 +17,32 @@ std::vector<token::Token> Lexer::scanTokens() {
     scanToken();
   }
 
-  tokens_.push_back(
-      {.type = token::TokenType::END_OF_FILE, .lexeme = "", .line = line_});
+  tokens_.push_back({.type = token::TokenType::END_OF_FILE,
+                     .lexeme = "",
+                     .line = line_,
+                     .start = current_,
+                     .end = current_});
 
   return tokens_;
 }
 
+std::optional<token::Token> Lexer::nextToken() {
+  while (!isAtEnd()) {
+    start_ = current_;
+    scanToken();
+
+    if (!tokens_.empty()) {
+      token::Token token = std::move(tokens_.back());
+      tokens_.pop_back();
+      return token;
+    }
+  }
+
+  return std::nullopt;
+}
+
+int Lexer::offset() { return current_; }
+
 bool Lexer::isAtEnd() { return current_ >= source_.length(); }
 
 void Lexer::scanToken() {
@@ -37,6 +61,12 @@ void Lexer::scanToken() {
     case '}':
       addToken(token::TokenType::SC_CLOSE_CURLY);
       break;
+    case '[':
+      addToken(token::TokenType::SC_OPEN_BRACKET);
+      break;
+    case ']':
+      addToken(token::TokenType::SC_CLOSE_BRACKET);
+      break;
     case ',':
       addToken(token::TokenType::SC_COMMA);
       break;
@@ -44,10 +74,14 @@ void Lexer::scanToken() {
       addToken(token::TokenType::SC_DOT);
       break;
     case '-':
-      addToken(token::TokenType::SC_MINUS);
+      addToken(match('-')   ? token::TokenType::MC_MINUS_MINUS
+               : match('=') ? token::TokenType::MC_MINUS_EQUAL
+                            : token::TokenType::SC_MINUS);
       break;
     case '+':
-      addToken(token::TokenType::SC_PLUS);
+      addToken(match('+')   ? token::TokenType::MC_PLUS_PLUS
+               : match('=') ? token::TokenType::MC_PLUS_EQUAL
+                            : token::TokenType::SC_PLUS);
       break;
     case ':':
       addToken(token::TokenType::SC_COLON);
@@ -56,7 +90,8 @@ void Lexer::scanToken() {
       addToken(token::TokenType::SC_SEMICOLON);
       break;
     case '*':
-      addToken(token::TokenType::SC_STAR);
+      addToken(match('=') ? token::TokenType::MC_STAR_EQUAL
+                          : token::TokenType::SC_STAR);
       break;
     case '?':
       addToken(token::TokenType::MC_QUESTION);
@@ -83,7 +118,8 @@ void Lexer::scanToken() {
       } else if (match('*')) {
         scanMultilineComment();
       } else {
-        addToken(token::TokenType::SC_FORWARD_SLASH);
+        addToken(match('=') ? token::TokenType::MC_SLASH_EQUAL
+                            : token::TokenType::SC_FORWARD_SLASH);
       }
       break;
     case ' ':
@@ -170,21 +206,21 @@ void Lexer::scanIdentifier() {
   // possible).
   while (isAlphaNumeric(peek())) advance();
 
-  std::string text = source_.substr(start_, current_ - start_);
+  const std::string_view text(source_.data() + start_, current_ - start_);
 
   // If the text extracted does not correspond to a keyword, treat it as a user
   // identifier.
-  const auto it = token::Keywords.find(text);
-  if (it != token::Keywords.end()) {
-    addToken(it->second);
+  const auto keyword = token::lookupKeyword(text);
+  if (!keyword.has_value()) {
+    tokens_.push_back({.type = token::TokenType::LT_IDENTIFIER,
+                       .lexeme = getLexeme(),
+                       .line = line_,
+                       .start = start_,
+                       .end = current_});
+  } else if (keyword.value() == token::TokenType::KW_NULO) {
+    addToken(token::TokenType::KW_NULO, nullptr);
   } else {
-    if (text == token::KW_NULO) {
-      addToken(token::TokenType::KW_NULO, nullptr);
-    } else {
-      tokens_.push_back({.type = token::TokenType::LT_IDENTIFIER,
-                         .lexeme = getLexeme(),
-                         .line = line_});
-    }
+    addToken(keyword.value());
   }
 }
 
@@ -221,12 +257,13 @@ bool Lexer::match(char expected) {
 }
 
 void Lexer::addToken(token::TokenType token_type) {
-  tokens_.push_back({.type = token_type, .line = line_});
+  tokens_.push_back(
+      {.type = token_type, .line = line_, .start = start_, .end = current_});
 }
 
 void Lexer::addToken(token::TokenType token_type, std::any literal) {
   const auto lexeme = getLexeme();
-  tokens_.push_back({token_type, lexeme, literal, line_});
+  tokens_.push_back({token_type, lexeme, literal, line_, start_, current_});
 }
 
 std::string Lexer::getLexeme() {
@@ -0,0 +1,10 @@
+#include <iostream>
+
+#include "lusoscript/language_server.hh"
+
+int main() {
+  std::ios::sync_with_stdio(false);
+
+  LanguageServer server(std::cin, std::cout);
+  return server.run();
+}
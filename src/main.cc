@@ -1,23 +1,66 @@
 #include <sysexits.h>
 
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <iostream>
+#include <thread>
 
+#include "lusoscript/batch.hh"
+#include "lusoscript/columnar.hh"
 #include "lusoscript/repl.hh"
+#include "lusoscript/server.hh"
 #include "lusoscript/source_file.hh"
 
+namespace {
+int usage() {
+  std::cerr << "Usage: luso [script]" << std::endl;
+  std::cerr << "       luso --jobs N script..." << std::endl;
+  std::cerr << "       luso --columnar rule table [output]" << std::endl;
+  std::cerr << "       luso --serve socket" << std::endl;
+  std::cerr << "       luso --connect socket (script | --stats | --stop)"
+            << std::endl;
+  return EX_USAGE;
+}
+}  // namespace
+
 int main(int argc, char* argv[]) {
-  if (argc == 2) {
-    SourceFile source_file;
-    source_file.run(argv[1]);
+  if ((argc == 4 || argc == 5) && std::strcmp(argv[1], "--columnar") == 0) {
+    return columnar::run(
+        argv[2], argv[3],
+        argc == 5 ? std::optional<std::string>(argv[4]) : std::nullopt,
+        std::cout, std::cerr);
+  } else if (argc == 3 && std::strcmp(argv[1], "--serve") == 0) {
+    Server server(argv[2], static_cast<int>(std::max(
+                               1u, std::thread::hardware_concurrency())));
+    return server.run();
+  } else if (argc == 4 && std::strcmp(argv[1], "--connect") == 0) {
+    Client client(argv[2]);
 
-    return EXIT_SUCCESS;
+    if (std::strcmp(argv[3], "--stats") == 0) return client.stats();
+    if (std::strcmp(argv[3], "--stop") == 0) return client.stop();
+
+    return client.run(argv[3]);
+  } else if (argc >= 2 && std::strcmp(argv[1], "--jobs") == 0) {
+    int jobs = 0;
+
+    if (argc < 4) return usage();
+
+    const char* jobs_end = argv[2] + std::strlen(argv[2]);
+    const auto [end, ec] = std::from_chars(argv[2], jobs_end, jobs);
+    if (ec != std::errc() || end != jobs_end || jobs < 1) return usage();
+
+    Batch batch(jobs);
+    return batch.run(std::vector<std::string>(argv + 3, argv + argc));
+  } else if (argc == 2) {
+    SourceFile source_file;
+    return source_file.run(argv[1], std::cout, std::cerr);
   } else if (argc == 1) {
     Repl repl;
     repl.run();
 
     return EXIT_SUCCESS;
   } else {
-    std::cerr << "Usage: luso [script]" << std::endl;
-    exit(EX_USAGE);
+    return usage();
   }
 }
@@ -0,0 +1,183 @@
+#include "lusoscript/module_loader.hh"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "lusoscript/cache.hh"
+#include "lusoscript/lexer.hh"
+#include "lusoscript/parser.hh"
+#include "lusoscript/thread_pool.hh"
+
+namespace {
+// Capacity of the first block of the arena of a module.
+constexpr std::size_t kArenaBlockSize = 256 * 1024;
+
+std::string canonicalPath(const std::filesystem::path &path) {
+  std::error_code error;
+  const auto result = std::filesystem::weakly_canonical(path, error);
+
+  return error ? path.string() : result.string();
+}
+}  // namespace
+
+const ModuleLoader::Module *ModuleLoader::load(const std::string &path,
+                                               const std::string &source,
+                                               error::ErrorState &error_state) {
+  Module &script = modules_.emplace_back(Module{.path = canonicalPath(path)});
+  paths_[script.path] = &script;
+
+  parse(script, source, error_state);
+  if (error_state.getHadError()) return nullptr;
+
+  const bool imports =
+      std::any_of(script.statements.begin(), script.statements.end(),
+                  [](const ast::Stmt &stmt) {
+                    return std::holds_alternative<ast::Importe>(stmt.var);
+                  });
+
+  // Most scripts import nothing and need no threads.
+  if (imports) {
+    ThreadPool pool(static_cast<int>(
+        std::max(1u, std::thread::hardware_concurrency())));
+
+    resolveImports(script, error_state, &pool);
+    pool.wait();
+  }
+
+  // Reported in a fixed order, whatever the order the modules loaded in.
+  std::vector<const Module *> failed;
+  for (const auto &[module, diagnostics] : errors_) failed.push_back(module);
+
+  std::sort(failed.begin(), failed.end(),
+            [](const Module *a, const Module *b) { return a->path < b->path; });
+
+  for (const Module *module : failed) {
+    for (error::Diagnostic diagnostic : errors_.at(module)) {
+      diagnostic.where = " in '" + module->path + "'" + diagnostic.where;
+      error_state.error(std::move(diagnostic));
+    }
+  }
+
+  return error_state.getHadError() ? nullptr : &script;
+}
+
+const ModuleLoader::Module *ModuleLoader::find(
+    const ast::Importe &importe) const {
+  const auto it = imports_.find(&importe);
+  return it != imports_.end() ? it->second : nullptr;
+}
+
+std::uint64_t ModuleLoader::getKey() const {
+  std::vector<std::string> entries;
+
+  for (const Module &module : modules_) {
+    entries.push_back(module.path + '\0' + std::to_string(module.key));
+  }
+
+  std::sort(entries.begin(), entries.end());
+
+  std::string contents;
+  for (const auto &entry : entries) contents.append(entry).push_back('\n');
+
+  return cache::key(contents);
+}
+
+void ModuleLoader::parse(Module &module, const std::string &source,
+                         error::ErrorState &error_state) {
+  module.key = cache::key(source);
+  module.allocator = std::make_unique<arena::Arena>(kArenaBlockSize);
+
+  const std::string cache_path =
+      cache::path(module.path, module.key, ".lusoc");
+
+  if (auto statements =
+          cache::load(cache_path, module.key, *module.allocator)) {
+    module.statements = std::move(statements.value());
+    return;
+  }
+
+  // Whatever an invalid file left in the arena.
+  module.allocator->reset();
+
+  Lexer lexer(source, error_state);
+  std::vector<token::Token> tokens = lexer.scanTokens();
+
+  // The whole module is parsed, to be stored.
+  Parser parser(module.allocator.get(), error_state, tokens);
+  module.statements = parser.parse();
+
+  if (!error_state.getHadError()) {
+    cache::store(cache_path, module.key, module.statements);
+  }
+}
+
+// Finds the modules imported by `module`, starting to load the ones seen for
+// the first time on `pool`.
+void ModuleLoader::resolveImports(Module &module,
+                                  error::ErrorState &error_state,
+                                  ThreadPool *pool) {
+  const std::filesystem::path directory =
+      std::filesystem::path(module.path).parent_path();
+
+  for (const ast::Stmt &stmt : module.statements) {
+    const auto *importe = std::get_if<ast::Importe>(&stmt.var);
+    if (importe == nullptr) continue;
+
+    const auto &relative = std::any_cast<const std::string &>(
+        importe->path.literal);
+    const std::filesystem::path target = directory / relative;
+
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(target, error)) {
+      error_state.error(importe->path,
+                        "Cannot find module '" + relative + "'.");
+      continue;
+    }
+
+    std::string path = canonicalPath(target);
+    Module *imported;
+    bool first = false;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      auto [it, inserted] = paths_.try_emplace(std::move(path), nullptr);
+      if (inserted) {
+        it->second = &modules_.emplace_back(Module{.path = it->first});
+        first = true;
+      }
+
+      imported = it->second;
+      imports_[importe] = imported;
+    }
+
+    if (first) {
+      pool->submit([this, imported, pool] { loadImported(*imported, pool); });
+    }
+  }
+}
+
+void ModuleLoader::loadImported(Module &module, ThreadPool *pool) {
+  // Errors are kept aside, since modules load concurrently.
+  error::ErrorState error_state(nullptr);
+
+  std::ifstream file(module.path);
+
+  if (!file) {
+    error_state.error(1, "Cannot read module.");
+  } else {
+    std::stringstream source;
+    source << file.rdbuf();
+
+    parse(module, source.str(), error_state);
+    if (!error_state.getHadError()) resolveImports(module, error_state, pool);
+  }
+
+  if (error_state.getHadError()) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    errors_[&module] = error_state.getDiagnostics();
+  }
+}
@@ -0,0 +1,373 @@
+#include "lusoscript/native.hh"
+
+#include <chrono>
+#include <cmath>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "lusoscript/simd.hh"
+
+namespace {
+const auto kStart = std::chrono::steady_clock::now();
+
+// Elements of an array made by `lista` at most.
+constexpr float kMaxArraySize = 16777216.f;
+
+// Seconds since the interpreter started, for timing parts of a script. Small
+// enough to keep the precision of a `float`.
+float relogio() {
+  const auto elapsed = std::chrono::steady_clock::now() - kStart;
+  return std::chrono::duration<float>(elapsed).count();
+}
+
+error::Result<float, std::string> raiz(float x) {
+  if (x < 0) {
+    return error::Unexpected<std::string>{
+        "Cannot take the square root of a negative number"};
+  }
+
+  return std::sqrt(x);
+}
+
+error::Result<float, std::string> tamanho(const std::any &value) {
+  if (const auto *text = std::any_cast<std::string>(&value)) {
+    return static_cast<float>(text->size());
+  }
+
+  if (const auto *array = std::any_cast<Array::Ref>(&value)) {
+    return static_cast<float>((*array)->size());
+  }
+
+  if (const auto *dictionary = std::any_cast<Dictionary::Ref>(&value)) {
+    return static_cast<float>((*dictionary)->size());
+  }
+
+  if (const auto *range = std::any_cast<Range::Ref>(&value)) {
+    return static_cast<float>((*range)->size());
+  }
+
+  return error::Unexpected<std::string>{
+      "Argument 1 of 'tamanho' must be a string, an array, a dictionary or a "
+      "range"};
+}
+
+error::Result<Range::Ref, std::string> intervalo(float start, float end,
+                                                 float step) {
+  if (!std::isfinite(start) || !std::isfinite(end) || !std::isfinite(step)) {
+    return error::Unexpected<std::string>{
+        "The numbers of 'intervalo' must be finite"};
+  }
+
+  if (step == 0) {
+    return error::Unexpected<std::string>{
+        "The step of 'intervalo' cannot be 0"};
+  }
+
+  return Range::create(start, end, step);
+}
+
+error::Result<Dictionary::Key, std::string> toKey(const std::any &value) {
+  auto key = Dictionary::toKey(value);
+  if (!key.has_value()) {
+    return error::Unexpected<std::string>{"Keys must be strings or numbers"};
+  }
+
+  return std::move(key.value());
+}
+
+Array::Ref chaves(const Dictionary::Ref &dictionary) {
+  std::vector<std::any> keys;
+  keys.reserve(dictionary->size());
+
+  dictionary->forEach([&keys](const Dictionary::Key &key, const std::any &) {
+    keys.push_back(Dictionary::toValue(key));
+  });
+
+  return Array::create(std::move(keys));
+}
+
+Array::Ref valores(const Dictionary::Ref &dictionary) {
+  std::vector<std::any> values;
+  values.reserve(dictionary->size());
+
+  dictionary->forEach(
+      [&values](const Dictionary::Key &, const std::any &value) {
+        values.push_back(value);
+      });
+
+  return Array::create(std::move(values));
+}
+
+// The value of `key`, or `fallback` if the dictionary does not have it.
+error::Result<std::any, std::string> obtenha(const Dictionary::Ref &dictionary,
+                                             const std::any &key,
+                                             const std::any &fallback) {
+  const auto found = toKey(key);
+  if (!found) return found.unexpected();
+
+  const std::any *value = dictionary->find(found.value());
+  return value != nullptr ? *value : fallback;
+}
+
+// The error of a built-in function changing a container that the iterations
+// of a parallel loop share. See `Owned`.
+error::Unexpected<std::string> sharedError(std::string_view function) {
+  return error::Unexpected<std::string>{
+      "Parallel loop iterations cannot call '" + std::string(function) +
+      "' on a container created outside the loop"};
+}
+
+// Adds the elements of `keys` with the ones of `values` at the same index.
+error::Result<Dictionary::Ref, std::string> insira(
+    const Dictionary::Ref &dictionary, const Array::Ref &keys,
+    const Array::Ref &values) {
+  if (dictionary->isShared()) return sharedError("insira");
+
+  if (keys->size() != values->size()) {
+    return error::Unexpected<std::string>{
+        "The arrays of 'insira' have different sizes"};
+  }
+
+  std::vector<std::pair<Dictionary::Key, std::any>> entries;
+  entries.reserve(keys->size());
+
+  for (std::size_t i = 0; i < keys->size(); i++) {
+    auto key = toKey(keys->get(i));
+    if (!key) return key.unexpected();
+
+    entries.emplace_back(std::move(key.value()), values->get(i));
+  }
+
+  dictionary->insert(entries);
+
+  return dictionary;
+}
+
+// The elements of `array`, as numbers. A packed array has them at hand; the
+// ones of any other array are copied to `copy`, and must all be numbers.
+error::Result<std::span<const float>, std::string> numbers(
+    const Array &array, std::vector<float> &copy, std::string_view function) {
+  if (array.isPacked()) return array.getNumbers();
+
+  copy.reserve(array.size());
+
+  for (std::size_t i = 0; i < array.size(); i++) {
+    const std::any element = array.get(i);
+    const auto *number = std::any_cast<float>(&element);
+
+    if (number == nullptr) {
+      return error::Unexpected<std::string>{"The elements of the arrays of '" +
+                                            std::string(function) +
+                                            "' must be numbers"};
+    }
+
+    copy.push_back(*number);
+  }
+
+  return std::span<const float>(copy);
+}
+
+error::Result<Array::Ref, std::string> lista(float size,
+                                             const std::any &value) {
+  if (size < 0 || size != std::floor(size)) {
+    return error::Unexpected<std::string>{
+        "The size of an array must be a whole number, not negative"};
+  }
+
+  // Numbers are only all whole up to 2^24, so no element past that could be
+  // indexed; a larger size would only exhaust the memory.
+  if (size > kMaxArraySize) {
+    return error::Unexpected<std::string>{
+        "The size of an array cannot be over " +
+        std::to_string(static_cast<std::size_t>(kMaxArraySize))};
+  }
+
+  const auto count = static_cast<std::size_t>(size);
+
+  if (const auto *number = std::any_cast<float>(&value)) {
+    std::vector<float> numbers(count);
+    simd::fill(numbers.data(), *number, count);
+
+    return Array::create(std::move(numbers));
+  }
+
+  return Array::create(std::vector<std::any>(count, value));
+}
+
+error::Result<std::any, std::string> preencha(const Array::Ref &array,
+                                              const std::any &value) {
+  if (array->isShared()) return sharedError("preencha");
+
+  const auto *number = std::any_cast<float>(&value);
+
+  if (array->isPacked() && number != nullptr) {
+    const std::span<float> elements = array->getNumbers();
+    simd::fill(elements.data(), *number, elements.size());
+    return std::any{nullptr};
+  }
+
+  for (std::size_t i = 0; i < array->size(); i++) array->set(i, value);
+
+  return std::any{nullptr};
+}
+
+error::Result<float, std::string> somatorio(const Array::Ref &array) {
+  std::vector<float> copy;
+
+  const auto elements = numbers(*array, copy, "somatorio");
+  if (!elements) return elements.unexpected();
+
+  return simd::sum(elements.value().data(), elements.value().size());
+}
+
+// Runs `reduce` over the numbers of `array`, which must have some.
+template <typename Reduce>
+error::Result<float, std::string> extreme(const Array::Ref &array,
+                                          std::string_view function,
+                                          Reduce reduce) {
+  std::vector<float> copy;
+
+  const auto elements = numbers(*array, copy, function);
+  if (!elements) return elements.unexpected();
+
+  if (elements.value().empty()) {
+    return error::Unexpected<std::string>{
+        "The array of '" + std::string(function) + "' is empty"};
+  }
+
+  return reduce(elements.value().data(), elements.value().size());
+}
+
+// Runs `kernel` over the numbers of `a` and `b`, which must have as many.
+template <typename Kernel,
+          typename R = std::invoke_result_t<Kernel, std::span<const float>,
+                                            std::span<const float>>>
+error::Result<R, std::string> combine(const Array::Ref &a, const Array::Ref &b,
+                                      std::string_view function,
+                                      Kernel kernel) {
+  std::vector<float> a_copy;
+  std::vector<float> b_copy;
+
+  const auto left = numbers(*a, a_copy, function);
+  if (!left) return left.unexpected();
+
+  const auto right = numbers(*b, b_copy, function);
+  if (!right) return right.unexpected();
+
+  if (left.value().size() != right.value().size()) {
+    return error::Unexpected<std::string>{
+        "The arrays of '" + std::string(function) + "' have different sizes"};
+  }
+
+  return kernel(left.value(), right.value());
+}
+
+error::Result<float, std::string> escalar(const Array::Ref &a,
+                                          const Array::Ref &b) {
+  return combine(a, b, "escalar", [](auto left, auto right) {
+    return simd::dot(left.data(), right.data(), left.size());
+  });
+}
+
+// A new array with the results of `Kernel` on the elements of `a` and `b`.
+template <void (*Kernel)(const float *, const float *, float *, std::size_t)>
+error::Result<Array::Ref, std::string> elementWise(const Array::Ref &a,
+                                                   const Array::Ref &b,
+                                                   std::string_view function) {
+  return combine(a, b, function, [](auto left, auto right) {
+    std::vector<float> out(left.size());
+    Kernel(left.data(), right.data(), out.data(), out.size());
+
+    return Array::create(std::move(out));
+  });
+}
+
+std::vector<NativeFunction::Ref> createBuiltins() {
+  std::vector<NativeFunction::Ref> builtins;
+
+  builtins.push_back(NativeFunction::create("relogio", relogio));
+  builtins.push_back(NativeFunction::create("raiz", raiz));
+  builtins.push_back(NativeFunction::create(
+      "potencia", [](float x, float y) { return std::pow(x, y); }));
+  builtins.push_back(NativeFunction::create(
+      "absoluto", [](float x) { return std::fabs(x); }));
+  builtins.push_back(NativeFunction::create(
+      "piso", [](float x) { return std::floor(x); }));
+  builtins.push_back(NativeFunction::create(
+      "teto", [](float x) { return std::ceil(x); }));
+  builtins.push_back(NativeFunction::create(
+      "seno", [](float x) { return std::sin(x); }));
+  builtins.push_back(NativeFunction::create(
+      "cosseno", [](float x) { return std::cos(x); }));
+  builtins.push_back(NativeFunction::create("tamanho", tamanho));
+  builtins.push_back(NativeFunction::create("intervalo", intervalo));
+  builtins.push_back(NativeFunction::create("lista", lista));
+  builtins.push_back(NativeFunction::create(
+      "anexe",
+      [](const Array::Ref &array,
+         const std::any &value) -> error::Result<std::any, std::string> {
+        if (array->isShared()) return sharedError("anexe");
+
+        array->append(value);
+        return std::any{nullptr};
+      }));
+  builtins.push_back(NativeFunction::create("preencha", preencha));
+  builtins.push_back(NativeFunction::create("somatorio", somatorio));
+  builtins.push_back(NativeFunction::create("escalar", escalar));
+  builtins.push_back(
+      NativeFunction::create("minimo", [](const Array::Ref &array) {
+        return extreme(array, "minimo", simd::minimum);
+      }));
+  builtins.push_back(
+      NativeFunction::create("maximo", [](const Array::Ref &array) {
+        return extreme(array, "maximo", simd::maximum);
+      }));
+  builtins.push_back(NativeFunction::create(
+      "adicao", [](const Array::Ref &a, const Array::Ref &b) {
+        return elementWise<simd::add>(a, b, "adicao");
+      }));
+  builtins.push_back(NativeFunction::create(
+      "multiplicacao", [](const Array::Ref &a, const Array::Ref &b) {
+        return elementWise<simd::multiply>(a, b, "multiplicacao");
+      }));
+  builtins.push_back(NativeFunction::create("chaves", chaves));
+  builtins.push_back(NativeFunction::create("valores", valores));
+  builtins.push_back(NativeFunction::create(
+      "contem",
+      [](const Dictionary::Ref &dictionary,
+         const std::any &key) -> error::Result<bool, std::string> {
+        const auto found = toKey(key);
+        if (!found) return found.unexpected();
+
+        return dictionary->find(found.value()) != nullptr;
+      }));
+  builtins.push_back(NativeFunction::create("obtenha", obtenha));
+  builtins.push_back(NativeFunction::create(
+      "remova",
+      [](const Dictionary::Ref &dictionary,
+         const std::any &key) -> error::Result<bool, std::string> {
+        if (dictionary->isShared()) return sharedError("remova");
+
+        const auto found = toKey(key);
+        if (!found) return found.unexpected();
+
+        return dictionary->erase(found.value());
+      }));
+  builtins.push_back(NativeFunction::create("insira", insira));
+
+  return builtins;
+}
+}  // namespace
+
+// The functions are created once, and shared by every program.
+void native::defineBuiltins(env::Environment &globals) {
+  static const std::vector<NativeFunction::Ref> builtins = createBuiltins();
+
+  for (const NativeFunction::Ref &function : builtins) {
+    if (!globals.getValues().contains(function->getName())) {
+      globals.define(function->getName(), function);
+    }
+  }
+}
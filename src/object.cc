@@ -0,0 +1,199 @@
+#include "lusoscript/object.hh"
+
+#include <utility>
+
+const Shape *Shape::with(const std::string &name) const {
+  const std::lock_guard lock(mutex_);
+
+  auto &child = transitions_[name];
+
+  if (child == nullptr) {
+    child = std::make_unique<Shape>();
+    child->fields_ = fields_;
+    child->fields_.push_back(name);
+  }
+
+  return child.get();
+}
+
+// Instances have few fields, which a linear search finds faster than a hash
+// would. Inline caches make this the slow path anyway.
+int Shape::find(const std::string &name) const {
+  for (std::size_t slot = 0; slot < fields_.size(); slot++) {
+    if (fields_[slot] == name) return static_cast<int>(slot);
+  }
+
+  return -1;
+}
+
+Class::Ref Class::create(
+    std::string name, Ref superclass,
+    std::unordered_map<std::string, Closure::Ref> methods) {
+  return Ref::adopt(
+      new Class(std::move(name), std::move(superclass), std::move(methods)));
+}
+
+const std::string &Class::getName() const { return name_; }
+
+const Class::Ref &Class::getSuperclass() const { return superclass_; }
+
+const std::unordered_map<std::string, Closure::Ref> &Class::getMethods()
+    const {
+  return methods_;
+}
+
+const Closure::Ref *Class::findMethod(const std::string &name) const {
+  for (const Class *klass = this; klass != nullptr;
+       klass = klass->superclass_.get()) {
+    if (const auto method = klass->methods_.find(name);
+        method != klass->methods_.end()) {
+      return &method->second;
+    }
+  }
+
+  return nullptr;
+}
+
+const Closure::Ref *Class::getInitializer() const { return initializer_; }
+
+const Shape *Class::getShape() const { return &root_; }
+
+std::size_t Class::getFieldCount() const {
+  return field_count_.load(std::memory_order_relaxed);
+}
+
+void Class::countFields(std::size_t count) const {
+  if (count > getFieldCount()) {
+    field_count_.store(count, std::memory_order_relaxed);
+  }
+}
+
+Class::Class(std::string name, Ref superclass,
+             std::unordered_map<std::string, Closure::Ref> methods)
+    : name_(std::move(name)),
+      superclass_(std::move(superclass)),
+      methods_(std::move(methods)),
+      initializer_(findMethod("inicie")) {}
+
+Instance::Ref Instance::create(Class::Ref klass) {
+  return Ref::adopt(new Instance(std::move(klass)));
+}
+
+const Class::Ref &Instance::getClass() const { return class_; }
+
+const Shape *Instance::getShape() const { return shape_; }
+
+std::any &Instance::getField(int slot) { return fields_[slot]; }
+
+void Instance::addField(const Shape *shape, std::any value) {
+  fields_.push_back(std::move(value));
+  shape_ = shape;
+
+  class_->countFields(fields_.size());
+}
+
+// The slots are reserved up front, so that adding the fields the instances of
+// the class usually get does not reallocate them.
+Instance::Instance(Class::Ref klass)
+    : class_(std::move(klass)), shape_(class_->getShape()) {
+  fields_.reserve(class_->getFieldCount());
+}
+
+BoundMethod::Ref BoundMethod::create(Instance::Ref receiver,
+                                     Closure::Ref method) {
+  return Ref::adopt(new BoundMethod(std::move(receiver), std::move(method)));
+}
+
+const Instance::Ref &BoundMethod::getReceiver() const { return receiver_; }
+
+const Closure::Ref &BoundMethod::getMethod() const { return method_; }
+
+BoundMethod::BoundMethod(Instance::Ref receiver, Closure::Ref method)
+    : receiver_(std::move(receiver)), method_(std::move(method)) {}
+
+// Fields hide methods of the same name. The shape of an instance belongs to
+// its class, so it tells both where the fields are and which methods apply.
+PropertyCache::Property PropertyCache::get(const Instance &instance,
+                                           const std::string &name) {
+  const Shape *shape = instance.getShape();
+
+  if (const Entry *entry = find(shape)) return entry->property;
+
+  Property property{.slot = shape->find(name)};
+  if (property.slot < 0) {
+    property.method = instance.getClass()->findMethod(name);
+  }
+
+  if (property.slot >= 0 || property.method != nullptr) {
+    add(shape, {.property = property, .owner = instance.getClass()});
+  }
+
+  return property;
+}
+
+// The root shape of a class stands for the class.
+const Closure::Ref *PropertyCache::getMethod(const Class::Ref &klass,
+                                             const std::string &name) {
+  if (const Entry *entry = find(klass->getShape())) {
+    return entry->property.method;
+  }
+
+  const Closure::Ref *method = klass->findMethod(name);
+
+  if (method != nullptr) {
+    add(klass->getShape(), {.property = {.method = method}, .owner = klass});
+  }
+
+  return method;
+}
+
+void PropertyCache::set(Instance &instance, const std::string &name,
+                        std::any value) {
+  const Shape *shape = instance.getShape();
+  const Entry *entry = find(shape);
+
+  Entry missed;
+
+  if (entry == nullptr) {
+    missed = {.property = {.slot = shape->find(name)},
+              .owner = instance.getClass()};
+
+    if (missed.property.slot < 0) {
+      missed.property.slot = static_cast<int>(shape->size());
+      missed.transition = shape->with(name);
+    }
+
+    add(shape, missed);
+    entry = &missed;
+  }
+
+  if (entry->transition != nullptr) {
+    instance.addField(entry->transition, std::move(value));
+  } else {
+    instance.getField(entry->property.slot) = std::move(value);
+  }
+}
+
+const PropertyCache::Entry *PropertyCache::find(const Shape *shape) const {
+  for (int i = 0; i < kEntries; i++) {
+    const Shape *cached = shapes_[i].load(std::memory_order_acquire);
+
+    if (cached == nullptr) return nullptr;
+    if (cached == shape) return &entries_[i];
+  }
+
+  return nullptr;
+}
+
+// An entry is written before its shape is published, and never again. Two
+// threads missing on the same shape may both add it, which only wastes an
+// entry.
+void PropertyCache::add(const Shape *shape, Entry entry) {
+  if (used_.load(std::memory_order_relaxed) >= kEntries) return;
+
+  const int index = used_.fetch_add(1, std::memory_order_relaxed);
+  if (index >= kEntries) return;
+
+  entries_[index] = std::move(entry);
+  shapes_[index].store(shape, std::memory_order_release);
+}
@@ -12,73 +12,290 @@
  * When the time comes to parse statements, this distinction needs to be
  * addressed at parsetime (https://www.geeksforgeeks.org/c/comma-in-c/),
  * specially considering proper error handling.
+ *
+ * 19/10/2026 - Expressions are parsed by precedence climbing
+ * (`parsePrecedence()`) over the operator table `kInfixRules` instead of one
+ * function per level. The comma operator is simply the loosest entry of that
+ * table.
  */
 
 #include "lusoscript/parser.hh"
 
+#include <assert.h>
+
+#include <set>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+
+#include "lusoscript/case_table.hh"
+#include "lusoscript/dictionary.hh"
+#include "lusoscript/object.hh"
+#include "lusoscript/resolver.hh"
+
 Parser::Parser(arena::Arena *allocator, error::ErrorState &error_state,
-               std::vector<token::Token> tokens)
+               const std::vector<token::Token> &tokens, bool lazy_blocks)
     : allocator_(allocator),
       error_state_(error_state),
-      tokens_(std::move(tokens)),
-      current_(0) {}
+      tokens_(tokens),
+      current_(0),
+      lazy_blocks_(lazy_blocks),
+      validating_(false),
+      validated_(false),
+      returns_allowed_(false),
+      initializer_(false),
+      class_kind_(ClassKind::NONE) {}
 
 std::vector<ast::Stmt> Parser::parse() {
   std::vector<ast::Stmt> statements;
 
   while (!isAtEnd()) {
-    statements.push_back(declaration());
+    statements.push_back(topLevelDeclaration());
   }
 
   return statements;
 }
 
-ast::Stmt Parser::declaration() {
-  try {
-    if (match({token::TokenType::KW_VAR})) return varDeclaration();
+ast::Stmt Parser::parseDeclaration(int &position,
+                                   Resolver::Constants &constants) {
+  current_ = position;
+  constants_ = constants;
 
-    return statement();
-  } catch (error::ParserError) {
-    const token::Token prev_token = previous();
+  ast::Stmt stmt = topLevelDeclaration();
 
-    synchronize();
+  position = current_;
+  constants = constants_;
 
-    return ast::Stmt{ast::ErrorStmt{prev_token}};
+  return stmt;
+}
+
+// Snapshot markers and imports are only parsed here; inside blocks they are
+// errors. Other declarations are resolved once parsed.
+ast::Stmt Parser::topLevelDeclaration() {
+  const bool marker = match(token::TokenType::KW_INSTANTANEO);
+
+  if (!marker && !match(token::TokenType::KW_IMPORTE)) {
+    ast::Stmt stmt = declaration();
+    Resolver(error_state_, constants_).resolve(stmt);
+
+    return stmt;
   }
+
+  auto stmt = marker ? instantaneoStatement() : importeStatement();
+  if (stmt) return std::move(stmt.value());
+
+  const token::Token prev_token = previous();
+
+  synchronize();
+
+  return ast::Stmt{ast::ErrorStmt{prev_token}};
 }
 
-ast::Stmt Parser::varDeclaration() {
-  token::Token name =
-      consume(token::TokenType::LT_IDENTIFIER, "Expected variable name.");
+ast::Stmt Parser::declaration() {
+  auto stmt = match(token::TokenType::KW_VAR)         ? varDeclaration()
+              : match(token::TokenType::KW_CONSTANTE) ? varDeclaration(true)
+              : match(token::TokenType::KW_FUNCAO)    ? functionDeclaration()
+              : match(token::TokenType::KW_CLASSE)    ? classDeclaration()
+                                                      : statement();
+
+  if (stmt) return std::move(stmt.value());
+
+  // The very first token of the source may be the one that failed.
+  const token::Token prev_token = current_ > 0 ? previous() : peek();
+
+  synchronize();
 
-  auto var_decl = ast::Var{name};
+  return ast::Stmt{ast::ErrorStmt{prev_token}};
+}
+
+// A constant must be given its value where it is declared.
+error::ParseResult<ast::Stmt> Parser::varDeclaration(bool constant) {
+  auto name = consume(token::TokenType::LT_IDENTIFIER,
+                      constant ? "Expected constant name."
+                               : "Expected variable name.");
+  if (!name) return name.unexpected();
+
+  auto var_decl = ast::Var{name.value()};
+  var_decl.constant = constant;
 
-  if (match({token::TokenType::MC_EQUAL})) {
-    ast::Expr initializer = expression();
+  if (constant && !check(token::TokenType::MC_EQUAL)) {
+    return error(peek(), "Expected '=' after constant name.");
+  }
+
+  if (match(token::TokenType::MC_EQUAL)) {
+    auto initializer = expression();
+    if (!initializer) return initializer.unexpected();
 
-    auto init_ptr = allocator_->make_unique<ast::Expr>(std::move(initializer));
+    auto init_ptr = wrap(std::move(initializer.value()));
     var_decl.initializer = std::move(init_ptr);
   }
 
-  consume(token::TokenType::SC_SEMICOLON,
-          "Expected ';' after variable declaration.");
+  if (auto semicolon = consume(token::TokenType::SC_SEMICOLON,
+                               "Expected ';' after variable declaration.");
+      !semicolon) {
+    return semicolon.unexpected();
+  }
 
   return ast::Stmt{std::move(var_decl)};
 }
 
-ast::Stmt Parser::statement() {
-  if (match({token::TokenType::KW_PARA})) return forStatement();
-  if (match({token::TokenType::KW_SE})) return ifStatement();
-  if (match({token::TokenType::KW_IMPRIMA})) return imprimaStatement();
-  if (match({token::TokenType::KW_ENQUANTO})) return whileStatement();
-  if (match({token::TokenType::SC_OPEN_CURLY})) {
-    std::vector<ast::Stmt> stmts = block();
+error::ParseResult<ast::Stmt> Parser::functionDeclaration() {
+  auto function = this->function(ast::Function::Kind::FUNCTION);
+  if (!function) return function.unexpected();
+
+  return ast::Stmt{std::move(function.value())};
+}
+
+// Parses a function, or a method when `kind` says so, from its name on.
+error::ParseResult<ast::Function> Parser::function(ast::Function::Kind kind) {
+  const auto name = consume(token::TokenType::LT_IDENTIFIER,
+                            kind == ast::Function::Kind::FUNCTION
+                                ? "Expected the name of the function."
+                                : "Expected the name of the method.");
+  if (!name) return name.unexpected();
+
+  if (kind != ast::Function::Kind::FUNCTION &&
+      name.value().lexeme.value() == "inicie") {
+    kind = ast::Function::Kind::INITIALIZER;
+  }
+
+  if (auto paren = consume(token::TokenType::SC_OPEN_PAREN,
+                           "Expected '(' after the name of the function.");
+      !paren) {
+    return paren.unexpected();
+  }
+
+  std::vector<token::Token> params;
+
+  if (!check(token::TokenType::SC_CLOSE_PAREN)) {
+    do {
+      if (params.size() == kMaxArguments) {
+        error_state_.error(peek(), "Cannot have more than 255 parameters.");
+      }
+
+      auto param = consume(token::TokenType::LT_IDENTIFIER,
+                           "Expected the name of the parameter.");
+      if (!param) return param.unexpected();
+
+      params.push_back(std::move(param.value()));
+    } while (match(token::TokenType::SC_COMMA));
+  }
+
+  if (auto paren = consume(token::TokenType::SC_CLOSE_PAREN,
+                           "Expected ')' after the parameters.");
+      !paren) {
+    return paren.unexpected();
+  }
+
+  if (auto curly = consume(token::TokenType::SC_OPEN_CURLY,
+                           "Expected '{' before the body of the function.");
+      !curly) {
+    return curly.unexpected();
+  }
+
+  // The body is parsed eagerly, since its locals are resolved along with the
+  // function.
+  const bool lazy_blocks = std::exchange(lazy_blocks_, false);
+  const bool returns_allowed = std::exchange(returns_allowed_, true);
+  const bool initializer = std::exchange(
+      initializer_, kind == ast::Function::Kind::INITIALIZER);
+
+  auto stmts = block();
+
+  lazy_blocks_ = lazy_blocks;
+  returns_allowed_ = returns_allowed;
+  initializer_ = initializer;
+
+  if (!stmts) return stmts.unexpected();
+
+  auto function =
+      ast::Function{.name = name.value(), .params = params, .kind = kind};
+  function.body.reserve(stmts.value().size());
+
+  for (auto &s : stmts.value()) function.body.push_back(wrap(std::move(s)));
+
+  return function;
+}
+
+error::ParseResult<ast::Stmt> Parser::classDeclaration() {
+  const auto name = consume(token::TokenType::LT_IDENTIFIER,
+                            "Expected the name of the class.");
+  if (!name) return name.unexpected();
+
+  auto klass = ast::Classe{.name = name.value()};
+
+  if (match(token::TokenType::MC_LESS)) {
+    const auto superclass = consume(token::TokenType::LT_IDENTIFIER,
+                                    "Expected the name of the superclass.");
+    if (!superclass) return superclass.unexpected();
+
+    if (superclass.value().lexeme == name.value().lexeme) {
+      error_state_.error(superclass.value(),
+                         "A class cannot inherit from itself.");
+    }
+
+    klass.superclass = wrap(ast::Expr{ast::Variable{superclass.value()}});
+  }
+
+  if (auto curly = consume(token::TokenType::SC_OPEN_CURLY,
+                           "Expected '{' before the body of the class.");
+      !curly) {
+    return curly.unexpected();
+  }
+
+  const ClassKind class_kind = std::exchange(
+      class_kind_, klass.superclass.has_value() ? ClassKind::SUBCLASS
+                                                : ClassKind::CLASS);
+
+  while (!check(token::TokenType::SC_CLOSE_CURLY) && !isAtEnd()) {
+    auto method = function(ast::Function::Kind::METHOD);
+
+    if (!method) {
+      class_kind_ = class_kind;
+      return method.unexpected();
+    }
+
+    klass.methods.push_back(std::move(method.value()));
+  }
+
+  class_kind_ = class_kind;
+
+  if (auto curly = consume(token::TokenType::SC_CLOSE_CURLY,
+                           "Expected '}' after the body of the class.");
+      !curly) {
+    return curly.unexpected();
+  }
+
+  return ast::Stmt{std::move(klass)};
+}
+
+error::ParseResult<ast::Stmt> Parser::statement() {
+  if (match(token::TokenType::KW_PARA)) return forStatement();
+  if (match(token::TokenType::KW_SE)) return ifStatement();
+  if (match(token::TokenType::KW_IMPRIMA)) return imprimaStatement();
+  if (match(token::TokenType::KW_ENQUANTO)) return whileStatement();
+  if (match(token::TokenType::KW_ESCOLHA)) return escolhaStatement();
+  if (match(token::TokenType::KW_TAREFA)) return tarefaStatement();
+  if (match(token::TokenType::KW_ENVIE)) return envieStatement();
+  if (match(token::TokenType::KW_FECHE)) return fecheStatement();
+  if (match(token::TokenType::KW_RETORNE)) return retorneStatement();
+  if (match(token::TokenType::KW_INSTANTANEO)) {
+    return error(previous(),
+                 "A snapshot marker must be at the top level of the script.");
+  }
+  if (match(token::TokenType::KW_IMPORTE)) {
+    return error(previous(),
+                 "Modules can only be imported at the top level of a file.");
+  }
+  if (match(token::TokenType::SC_OPEN_CURLY)) {
+    auto stmts = block();
+    if (!stmts) return stmts.unexpected();
 
     std::vector<ast::StmtPtr> stmt_ptrs;
-    stmt_ptrs.reserve(stmts.size());
+    stmt_ptrs.reserve(stmts.value().size());
 
-    for (auto &s : stmts) {
-      stmt_ptrs.emplace_back(allocator_->make_unique<ast::Stmt>(std::move(s)));
+    for (auto &s : stmts.value()) {
+      stmt_ptrs.emplace_back(wrap(std::move(s)));
     }
 
     return ast::Stmt{ast::Block{std::move(stmt_ptrs)}};
@@ -87,39 +304,72 @@ ast::Stmt Parser::statement() {
   return expressionStatement();
 }
 
-ast::Stmt Parser::forStatement() {
-  consume(token::TokenType::SC_OPEN_PAREN, "Expected '(' after para.");
+error::ParseResult<ast::Stmt> Parser::forStatement() {
+  if (match(token::TokenType::KW_PARALELO)) return parallelForStatement();
+
+  // `cada`, like `em`, is only a keyword here, so that it is still a valid
+  // name elsewhere.
+  if (check(token::TokenType::LT_IDENTIFIER) &&
+      peek().lexeme.value() == "cada") {
+    advance();
+    return forEachStatement();
+  }
+
+  if (auto paren =
+          consume(token::TokenType::SC_OPEN_PAREN, "Expected '(' after para.");
+      !paren) {
+    return paren.unexpected();
+  }
 
   std::optional<ast::Stmt> initializer;
 
-  if (match({token::TokenType::SC_SEMICOLON})) {
+  if (match(token::TokenType::SC_SEMICOLON)) {
     // Empty initializer statement clause.
     initializer = std::nullopt;
-  } else if (match({token::TokenType::KW_VAR})) {
-    initializer = varDeclaration();
   } else {
-    initializer = expressionStatement();
+    auto clause = match(token::TokenType::KW_VAR) ? varDeclaration()
+                                                  : expressionStatement();
+    if (!clause) return clause;
+
+    initializer = std::move(clause.value());
   }
 
   std::optional<ast::Expr> condition = std::nullopt;
 
   if (!check(token::TokenType::SC_SEMICOLON)) {
     // Empty condition expression clause.
-    condition = expression();
+    auto clause = expression();
+    if (!clause) return clause.unexpected();
+
+    condition = std::move(clause.value());
   }
 
-  consume(token::TokenType::SC_SEMICOLON, "Expected ';' after loop condition.");
+  if (auto semicolon = consume(token::TokenType::SC_SEMICOLON,
+                               "Expected ';' after loop condition.");
+      !semicolon) {
+    return semicolon.unexpected();
+  }
 
   std::optional<ast::Expr> increment = std::nullopt;
 
   if (!check(token::TokenType::SC_CLOSE_PAREN)) {
     // Empty increment expression clause.
-    increment = expression();
+    auto clause = expression();
+    if (!clause) return clause.unexpected();
+
+    increment = std::move(clause.value());
+  }
+
+  if (auto paren = consume(token::TokenType::SC_CLOSE_PAREN,
+                           "Expected ')' after para clauses.");
+      !paren) {
+    return paren.unexpected();
   }
 
-  consume(token::TokenType::SC_CLOSE_PAREN, "Expected ')' after para clauses.");
+  auto body_result = bodyStatement();
+  if (!body_result) return body_result;
 
-  ast::Stmt body = statement();
+  ast::Stmt body = std::move(body_result.value());
 
   if (increment.has_value()) {
     // For the increment, add, to the body, a block that contains the previous
@@ -127,15 +377,14 @@ ast::Stmt Parser::forStatement() {
     std::vector<ast::Stmt> stmts;
     stmts.push_back(std::move(body));
 
-    auto incr_ptr =
-        allocator_->make_unique<ast::Expr>(std::move(increment.value()));
+    auto incr_ptr = wrap(std::move(increment.value()));
     stmts.push_back({ast::Expression{std::move(incr_ptr)}});
 
     std::vector<ast::StmtPtr> stmt_ptrs;
     stmt_ptrs.reserve(stmts.size());
 
     for (auto &s : stmts) {
-      stmt_ptrs.emplace_back(allocator_->make_unique<ast::Stmt>(std::move(s)));
+      stmt_ptrs.emplace_back(wrap(std::move(s)));
     }
 
     // Here, the `body` variable is the actual loop body, followed by the
@@ -150,11 +399,8 @@ ast::Stmt Parser::forStatement() {
 
   // Here, the `body` variable is the primitive (`enquanto`) while loop, with
   // the condition being either the user-defined one or the infinite loop.
-  auto cond_ptr =
-      allocator_->make_unique<ast::Expr>(std::move(condition.value()));
-  body = ast::Stmt{
-      ast::While{std::move(cond_ptr),
-                 allocator_->make_unique<ast::Stmt>(std::move(body))}};
+  auto cond_ptr = wrap(std::move(condition.value()));
+  body = ast::Stmt{ast::While{std::move(cond_ptr), wrap(std::move(body))}};
 
   if (initializer.has_value()) {
     // If there's an initializer, it's executed once (variable `initializer`)
@@ -167,7 +413,7 @@ ast::Stmt Parser::forStatement() {
     stmt_ptrs.reserve(stmts.size());
 
     for (auto &s : stmts) {
-      stmt_ptrs.emplace_back(allocator_->make_unique<ast::Stmt>(std::move(s)));
+      stmt_ptrs.emplace_back(wrap(std::move(s)));
     }
 
     // Here, the `body` variable is the initializer followed by the (`enquanto`)
@@ -178,350 +424,1350 @@ ast::Stmt Parser::forStatement() {
   return body;
 }
 
-ast::Stmt Parser::ifStatement() {
-  consume(token::TokenType::SC_OPEN_PAREN, "Expected '(' after se.");
+// Parses `para cada (var x em fonte) body`, after `cada`.
+error::ParseResult<ast::Stmt> Parser::forEachStatement() {
+  const token::Token keyword = previous();
 
-  ast::Expr condition = expression();
+  if (auto paren = consume(token::TokenType::SC_OPEN_PAREN,
+                           "Expected '(' after cada.");
+      !paren) {
+    return paren.unexpected();
+  }
 
-  consume(token::TokenType::SC_CLOSE_PAREN, "Expected ')' after condition.");
+  if (auto var = consume(token::TokenType::KW_VAR,
+                         "Expected 'var' to declare the loop variable.");
+      !var) {
+    return var.unexpected();
+  }
 
-  ast::Stmt then_branch = statement();
+  const auto variable =
+      consume(token::TokenType::LT_IDENTIFIER, "Expected variable name.");
+  if (!variable) return variable.unexpected();
+
+  const auto in = consume(token::TokenType::LT_IDENTIFIER,
+                          "Expected 'em' after the loop variable.");
+  if (!in) return in.unexpected();
+
+  if (in.value().lexeme.value() != "em") {
+    return error(in.value(), "Expected 'em' after the loop variable.");
+  }
+
+  auto source = expression();
+  if (!source) return source.unexpected();
+
+  if (auto paren = consume(token::TokenType::SC_CLOSE_PAREN,
+                           "Expected ')' after the loop source.");
+      !paren) {
+    return paren.unexpected();
+  }
+
+  auto body = bodyStatement();
+  if (!body) return body;
+
+  return ast::Stmt{ast::ForEach{.keyword = keyword,
+                                .variable = variable.value(),
+                                .source = wrap(std::move(source.value())),
+                                .body = wrap(std::move(body.value()))}};
+}
 
-  auto cond_ptr = allocator_->make_unique<ast::Expr>(std::move(condition));
-  auto then_ptr = allocator_->make_unique<ast::Stmt>(std::move(then_branch));
+// Parses a parallel loop, which must have the canonical form
+// `para paralelo (var i = inicio; i < fim; i = i + passo)`, optionally
+// followed by `reduza(operador: variavel, ...)`, and checks that its
+// iterations are independent.
+error::ParseResult<ast::Stmt> Parser::parallelForStatement() {
+  const token::Token keyword = previous();
+
+  if (auto paren = consume(token::TokenType::SC_OPEN_PAREN,
+                           "Expected '(' after paralelo.");
+      !paren) {
+    return paren.unexpected();
+  }
+
+  if (auto var = consume(token::TokenType::KW_VAR,
+                         "Expected 'var' to declare the parallel loop "
+                         "variable.");
+      !var) {
+    return var.unexpected();
+  }
+
+  const auto variable =
+      consume(token::TokenType::LT_IDENTIFIER, "Expected variable name.");
+  if (!variable) return variable.unexpected();
+
+  const std::string &name = variable.value().lexeme.value();
+
+  // Consumes an occurrence of the loop variable.
+  const auto loop_variable = [this, &name](const std::string &message) {
+    auto identifier = consume(token::TokenType::LT_IDENTIFIER, message);
+    if (identifier && identifier.value().lexeme.value() != name) {
+      return error::ParseResult<token::Token>(
+          error(identifier.value(), message));
+    }
+    return identifier;
+  };
+
+  if (auto equal = consume(token::TokenType::MC_EQUAL,
+                           "Expected '=' after the parallel loop variable.");
+      !equal) {
+    return equal.unexpected();
+  }
+
+  auto start = expression();
+  if (!start) return start.unexpected();
+
+  if (auto semicolon = consume(token::TokenType::SC_SEMICOLON,
+                               "Expected ';' after loop initializer.");
+      !semicolon) {
+    return semicolon.unexpected();
+  }
+
+  constexpr std::string_view kConditionMessage =
+      "Expected a parallel loop condition of the form 'i < fim' or "
+      "'i <= fim'.";
+
+  if (auto tested = loop_variable(std::string(kConditionMessage)); !tested) {
+    return tested.unexpected();
+  }
+
+  if (!match({token::TokenType::MC_LESS, token::TokenType::MC_LESS_EQUAL})) {
+    return error(peek(), std::string(kConditionMessage));
+  }
+
+  const bool inclusive = previous().type == token::TokenType::MC_LESS_EQUAL;
+
+  auto end = parsePrecedence(Precedence::TERM);
+  if (!end) return end.unexpected();
+
+  if (auto semicolon = consume(token::TokenType::SC_SEMICOLON,
+                               "Expected ';' after loop condition.");
+      !semicolon) {
+    return semicolon.unexpected();
+  }
+
+  const std::string increment_message =
+      "Expected a parallel loop increment of the form 'i = i + passo', "
+      "'i += passo' or 'i++'.";
+
+  if (auto assigned = loop_variable(increment_message); !assigned) {
+    return assigned.unexpected();
+  }
+
+  error::ParseResult<ast::Expr> step =
+      ast::Expr{ast::Literal{token::TokenType::LT_NUMBER, 1.f}};
+
+  if (!match(token::TokenType::MC_PLUS_PLUS)) {
+    if (!match(token::TokenType::MC_PLUS_EQUAL)) {
+      if (auto equal = consume(token::TokenType::MC_EQUAL, increment_message);
+          !equal) {
+        return equal.unexpected();
+      }
+
+      if (auto incremented = loop_variable(increment_message); !incremented) {
+        return incremented.unexpected();
+      }
+
+      if (auto plus = consume(token::TokenType::SC_PLUS, increment_message);
+          !plus) {
+        return plus.unexpected();
+      }
+    }
+
+    step = parsePrecedence(Precedence::FACTOR);
+    if (!step) return step.unexpected();
+  }
+
+  if (auto paren = consume(token::TokenType::SC_CLOSE_PAREN,
+                           "Expected ')' after para clauses.");
+      !paren) {
+    return paren.unexpected();
+  }
+
+  std::vector<ast::Reduction> reductions;
+
+  if (match(token::TokenType::KW_REDUZA)) {
+    if (auto paren = consume(token::TokenType::SC_OPEN_PAREN,
+                             "Expected '(' after reduza.");
+        !paren) {
+      return paren.unexpected();
+    }
+
+    do {
+      auto item = reduction();
+      if (!item) return item.unexpected();
+
+      reductions.push_back(std::move(item.value()));
+    } while (match(token::TokenType::SC_COMMA));
+
+    if (auto paren = consume(token::TokenType::SC_CLOSE_PAREN,
+                             "Expected ')' after reductions.");
+        !paren) {
+      return paren.unexpected();
+    }
+  }
+
+  // The body is parsed eagerly, even inside a lazily parsed block: the
+  // dependency check needs its AST, and the iterations must not race to
+  // parse it.
+  const bool lazy_blocks = std::exchange(lazy_blocks_, false);
+  const bool validating = std::exchange(validating_, false);
+  const bool returns_allowed = std::exchange(returns_allowed_, false);
+
+  auto body = bodyStatement();
+
+  if (body) checkParallelBody(variable.value(), reductions, body.value());
+
+  lazy_blocks_ = lazy_blocks;
+  validating_ = validating;
+  returns_allowed_ = returns_allowed;
+
+  if (!body) return body;
+
+  auto loop = ast::ParallelFor{
+      .keyword = keyword,
+      .variable = variable.value(),
+      .start = wrap(std::move(start.value())),
+      .end = wrap(std::move(end.value())),
+      .inclusive = inclusive,
+      .step = wrap(std::move(step.value())),
+      .reductions = std::move(reductions),
+      .body = wrap(std::move(body.value())),
+  };
+
+  return ast::Stmt{std::move(loop)};
+}
+
+error::ParseResult<ast::Reduction> Parser::reduction() {
+  const auto kind = consume(token::TokenType::LT_IDENTIFIER,
+                            "Expected a reduction: soma, minimo or maximo.");
+  if (!kind) return kind.unexpected();
+
+  ast::ReductionKind reduction_kind;
+  const std::string &lexeme = kind.value().lexeme.value();
+
+  if (lexeme == "soma") {
+    reduction_kind = ast::ReductionKind::SOMA;
+  } else if (lexeme == "minimo") {
+    reduction_kind = ast::ReductionKind::MINIMO;
+  } else if (lexeme == "maximo") {
+    reduction_kind = ast::ReductionKind::MAXIMO;
+  } else {
+    return error(kind.value(), "Expected a reduction: soma, minimo or maximo.");
+  }
+
+  if (auto colon = consume(token::TokenType::SC_COLON,
+                           "Expected ':' after the reduction.");
+      !colon) {
+    return colon.unexpected();
+  }
+
+  const auto target = consume(token::TokenType::LT_IDENTIFIER,
+                              "Expected the variable of the reduction.");
+  if (!target) return target.unexpected();
+
+  return ast::Reduction{reduction_kind, target.value()};
+}
+
+namespace {
+// Walks the body of a parallel loop in source order, reporting assignments to
+// variables that iterations would share.
+class ParallelBodyChecker {
+ public:
+  ParallelBodyChecker(error::ErrorState &error_state,
+                      const token::Token &variable,
+                      const std::vector<ast::Reduction> &reductions)
+      : error_state_(error_state), variable_(variable) {
+    for (const auto &reduction : reductions) {
+      const std::string &target = reduction.target.lexeme.value();
+
+      if (target == variable.lexeme.value()) {
+        error_state_.error(reduction.target,
+                           "The parallel loop variable cannot be a "
+                           "reduction.");
+      }
+
+      reduction_targets_.insert(target);
+    }
+  }
+
+  void check(const ast::Stmt &stmt) {
+    struct Visitor {
+      ParallelBodyChecker &checker;
+
+      void operator()(const ast::Block &block) {
+        for (const auto &child : block.stmts) checker.check(*child);
+      }
+
+      void operator()(const ast::Expression &expression) {
+        checker.check(*expression.expression);
+      }
+
+      void operator()(const ast::Imprima &imprima) {
+        checker.check(*imprima.expression);
+      }
+
+      void operator()(const ast::Var &var) {
+        if (var.initializer.has_value()) {
+          checker.check(*var.initializer.value());
+        }
+
+        checker.declare(var.name);
+      }
+
+      void operator()(const ast::If &stmt) {
+        checker.check(*stmt.condition);
+        checker.check(*stmt.then_branch);
+        if (stmt.else_branch.has_value()) {
+          checker.check(*stmt.else_branch.value());
+        }
+      }
+
+      void operator()(const ast::While &stmt) {
+        checker.check(*stmt.condition);
+        checker.check(*stmt.body);
+      }
+
+      void operator()(const ast::LazyBlock &) {}
+
+      // A nested parallel loop checks its own body; from here, it only
+      // assigns its reduction targets.
+      void operator()(const ast::ParallelFor &loop) {
+        checker.check(*loop.start);
+        checker.check(*loop.end);
+        checker.check(*loop.step);
+
+        for (const auto &reduction : loop.reductions) {
+          checker.assign(reduction.target);
+        }
+      }
+
+      void operator()(const ast::ForEach &loop) {
+        checker.check(*loop.source);
+        checker.declare(loop.variable);
+        checker.check(*loop.body);
+      }
+
+      void operator()(const ast::Escolha &escolha) {
+        checker.check(*escolha.value);
+        for (const auto &body : escolha.bodies) checker.check(*body);
+      }
+
+      // A task would outlive the iteration that starts it.
+      void operator()(const ast::Tarefa &tarefa) {
+        checker.error_state_.error(tarefa.keyword,
+                                   "Cannot start a task inside a parallel "
+                                   "loop.");
+      }
+
+      void operator()(const ast::Envie &envie) {
+        checker.check(*envie.channel);
+        checker.check(*envie.value);
+      }
+
+      void operator()(const ast::Feche &feche) {
+        checker.check(*feche.channel);
+      }
+
+      void operator()(const ast::Instantaneo &) {}
+
+      void operator()(const ast::Importe &) {}
+
+      // What a function declared in the body assigns is checked like the
+      // body itself, its parameters being private to it.
+      void operator()(const ast::Function &function) {
+        checker.declare(function.name);
+        for (const auto &param : function.params) checker.declare(param);
+        for (const auto &child : function.body) checker.check(*child);
+      }
+
+      void operator()(const ast::Retorne &retorne) {
+        if (retorne.value.has_value()) checker.check(*retorne.value.value());
+      }
+
+      void operator()(const ast::Classe &klass) {
+        checker.declare(klass.name);
+        for (const auto &method : klass.methods) (*this)(method);
+      }
+
+      void operator()(const ast::ErrorStmt &) {}
+    };
+    std::visit(Visitor{.checker = *this}, stmt.var);
+  }
+
+  void check(const ast::Expr &expr) {
+    struct Visitor {
+      ParallelBodyChecker &checker;
+
+      void operator()(const ast::Assign &assign) {
+        checker.check(*assign.value);
+        checker.assign(assign.name);
+      }
+
+      void operator()(const ast::Update &update) {
+        if (update.value != nullptr) checker.check(*update.value);
+        checker.assign(update.name);
+      }
+
+      void operator()(const ast::Ternary &ternary) {
+        checker.check(*ternary.condition);
+        checker.check(*ternary.then_expr);
+        checker.check(*ternary.else_expr);
+      }
+
+      void operator()(const ast::Binary &binary) {
+        checker.check(*binary.left);
+        checker.check(*binary.right);
+      }
+
+      void operator()(const ast::Grouping &grouping) {
+        checker.check(*grouping.expression);
+      }
+
+      void operator()(const ast::Literal &) {}
+
+      void operator()(const ast::Logical &logical) {
+        checker.check(*logical.left);
+        checker.check(*logical.right);
+      }
+
+      void operator()(const ast::Unary &unary) { checker.check(*unary.right); }
+
+      void operator()(const ast::Variable &) {}
+
+      void operator()(const ast::Call &call) {
+        checker.check(*call.callee);
+        for (const auto &argument : call.arguments) checker.check(*argument);
+      }
+
+      void operator()(const ast::Canal &canal) {
+        if (canal.capacity.has_value()) checker.check(*canal.capacity.value());
+      }
+
+      void operator()(const ast::Receba &receba) {
+        checker.check(*receba.channel);
+      }
+
+      void operator()(const ast::Get &get) { checker.check(*get.object); }
+
+      // Iterations cannot assign the fields of the instances they share, but
+      // the ones they create are their own; the interpreter tells them apart.
+      void operator()(const ast::Set &set) {
+        checker.check(*set.object);
+        checker.check(*set.value);
+      }
+
+      void operator()(const ast::Esse &) {}
+
+      void operator()(const ast::Super &) {}
+
+      void operator()(const ast::ArrayLiteral &array) {
+        for (const auto &element : array.elements) checker.check(*element);
+      }
+
+      void operator()(const ast::DictionaryLiteral &dictionary) {
+        for (const auto &key : dictionary.keys) checker.check(*key);
+        for (const auto &value : dictionary.values) checker.check(*value);
+      }
+
+      void operator()(const ast::Index &index) {
+        checker.check(*index.object);
+        checker.check(*index.index);
+      }
+
+      // Iterations may fill the elements of an array they share, each its
+      // own, as long as they store numbers, so that the array stays packed,
+      // but not the entries of a dictionary they share, which may grow. The
+      // two cannot be told apart here, so the interpreter checks them.
+      void operator()(const ast::SetIndex &set) {
+        checker.check(*set.object);
+        checker.check(*set.index);
+        checker.check(*set.value);
+      }
+
+      void operator()(const ast::ErrorExpr &error) {
+        if (error.expr != nullptr) checker.check(*error.expr);
+      }
+    };
+    std::visit(Visitor{.checker = *this}, expr.var);
+  }
+
+ private:
+  error::ErrorState &error_state_;
+  const token::Token &variable_;
+  std::unordered_set<std::string> reduction_targets_;
+  // Variables declared by the body so far, which each iteration owns.
+  std::unordered_set<std::string> locals_;
+
+  void declare(const token::Token &name) {
+    const std::string &identifier = name.lexeme.value();
+
+    if (reduction_targets_.contains(identifier)) {
+      error_state_.error(name, "Reduction variable '" + identifier +
+                                   "' must be declared outside the loop.");
+    }
+
+    locals_.insert(identifier);
+  }
+
+  void assign(const token::Token &name) {
+    const std::string &identifier = name.lexeme.value();
+
+    if (identifier == variable_.lexeme.value()) {
+      error_state_.error(name, "Cannot assign the parallel loop variable.");
+      return;
+    }
+
+    if (locals_.contains(identifier) ||
+        reduction_targets_.contains(identifier)) {
+      return;
+    }
+
+    error_state_.error(name, "Parallel loop iterations cannot assign the "
+                             "shared variable '" +
+                                 identifier +
+                                 "'; declare it inside the loop or reduce "
+                                 "it.");
+  }
+};
+}  // namespace
+
+void Parser::checkParallelBody(const token::Token &variable,
+                               const std::vector<ast::Reduction> &reductions,
+                               const ast::Stmt &body) {
+  ParallelBodyChecker checker(error_state_, variable, reductions);
+  checker.check(body);
+}
+
+error::ParseResult<ast::Stmt> Parser::ifStatement() {
+  if (auto paren =
+          consume(token::TokenType::SC_OPEN_PAREN, "Expected '(' after se.");
+      !paren) {
+    return paren.unexpected();
+  }
+
+  auto condition = expression();
+  if (!condition) return condition.unexpected();
+
+  if (auto paren = consume(token::TokenType::SC_CLOSE_PAREN,
+                           "Expected ')' after condition.");
+      !paren) {
+    return paren.unexpected();
+  }
+
+  auto then_branch = bodyStatement();
+  if (!then_branch) return then_branch;
+
+  auto cond_ptr = wrap(std::move(condition.value()));
+  auto then_ptr = wrap(std::move(then_branch.value()));
 
   auto if_stmt = ast::If{std::move(cond_ptr), std::move(then_ptr)};
 
-  if (match({token::TokenType::KW_SENAO})) {
-    ast::Stmt else_branch = statement();
+  if (match(token::TokenType::KW_SENAO)) {
+    auto else_branch = bodyStatement();
+    if (!else_branch) return else_branch;
 
-    if_stmt.else_branch =
-        allocator_->make_unique<ast::Stmt>(std::move(else_branch));
+    if_stmt.else_branch = wrap(std::move(else_branch.value()));
   }
 
   return ast::Stmt{std::move(if_stmt)};
 }
 
-ast::Stmt Parser::imprimaStatement() {
-  consume(token::TokenType::SC_OPEN_PAREN, "Expected '(' before value.");
+error::ParseResult<ast::Stmt> Parser::imprimaStatement() {
+  if (auto paren = consume(token::TokenType::SC_OPEN_PAREN,
+                           "Expected '(' before value.");
+      !paren) {
+    return paren.unexpected();
+  }
+
+  auto value = expression();
+  if (!value) return value.unexpected();
 
-  ast::Expr value = expression();
+  if (auto paren = consume(token::TokenType::SC_CLOSE_PAREN,
+                           "Expected ')' after value.");
+      !paren) {
+    return paren.unexpected();
+  }
 
-  consume(token::TokenType::SC_CLOSE_PAREN, "Expected ')' after value.");
-  consume(token::TokenType::SC_SEMICOLON,
-          "Expected ';' after closing the parentheses.");
+  if (auto semicolon = consume(token::TokenType::SC_SEMICOLON,
+                               "Expected ';' after closing the parentheses.");
+      !semicolon) {
+    return semicolon.unexpected();
+  }
 
-  auto value_ptr = allocator_->make_unique<ast::Expr>(std::move(value));
+  auto value_ptr = wrap(std::move(value.value()));
   return ast::Stmt{ast::Imprima{std::move(value_ptr)}};
 }
 
-ast::Stmt Parser::whileStatement() {
-  consume(token::TokenType::SC_OPEN_PAREN, "Expected '(' after enquanto.");
+error::ParseResult<ast::Stmt> Parser::whileStatement() {
+  if (auto paren = consume(token::TokenType::SC_OPEN_PAREN,
+                           "Expected '(' after enquanto.");
+      !paren) {
+    return paren.unexpected();
+  }
 
-  ast::Expr condition = expression();
+  auto condition = expression();
+  if (!condition) return condition.unexpected();
 
-  consume(token::TokenType::SC_CLOSE_PAREN, "Expected ')' after condition.");
+  if (auto paren = consume(token::TokenType::SC_CLOSE_PAREN,
+                           "Expected ')' after condition.");
+      !paren) {
+    return paren.unexpected();
+  }
 
-  ast::Stmt body = statement();
+  auto body = bodyStatement();
+  if (!body) return body;
 
-  auto cond_ptr = allocator_->make_unique<ast::Expr>(std::move(condition));
-  auto body_ptr = allocator_->make_unique<ast::Stmt>(std::move(body));
+  auto cond_ptr = wrap(std::move(condition.value()));
+  auto body_ptr = wrap(std::move(body.value()));
 
   return ast::Stmt{ast::While{std::move(cond_ptr), std::move(body_ptr)}};
 }
 
-std::vector<ast::Stmt> Parser::block() {
-  std::vector<ast::Stmt> statements;
+// Parses `escolha (valor) { caso rotulo, ...: ... padrao: ... }`, after
+// `escolha`. The labels are number and string literals, which the parser turns
+// into the table the statement finds its cases with (see case_table.hh).
+error::ParseResult<ast::Stmt> Parser::escolhaStatement() {
+  const token::Token keyword = previous();
+
+  if (auto paren = consume(token::TokenType::SC_OPEN_PAREN,
+                           "Expected '(' after escolha.");
+      !paren) {
+    return paren.unexpected();
+  }
+
+  auto value = expression();
+  if (!value) return value.unexpected();
+
+  if (auto paren = consume(token::TokenType::SC_CLOSE_PAREN,
+                           "Expected ')' after the value.");
+      !paren) {
+    return paren.unexpected();
+  }
+
+  if (auto curly = consume(token::TokenType::SC_OPEN_CURLY,
+                           "Expected '{' before the cases.");
+      !curly) {
+    return curly.unexpected();
+  }
+
+  ast::Escolha escolha{.keyword = keyword,
+                       .value = wrap(std::move(value.value()))};
+  std::set<Dictionary::Key> seen;
 
   while (!check(token::TokenType::SC_CLOSE_CURLY) && !isAtEnd()) {
-    statements.push_back(declaration());
+    std::vector<std::any> labels;
+
+    if (match(token::TokenType::KW_PADRAO)) {
+      if (escolha.fallback >= 0) {
+        error_state_.error(previous(), "An escolha can only have one padrao.");
+      }
+
+      escolha.fallback = static_cast<int>(escolha.bodies.size());
+    } else if (match(token::TokenType::KW_CASO)) {
+      do {
+        auto label = caseLabel();
+        if (!label) return label.unexpected();
+
+        if (!seen.insert(Dictionary::toKey(label.value()).value()).second) {
+          error_state_.error(previous(), "Duplicate case label.");
+        }
+
+        labels.push_back(std::move(label.value()));
+      } while (match(token::TokenType::SC_COMMA));
+    } else {
+      return error(peek(), "Expected caso or padrao.");
+    }
+
+    if (auto colon = consume(token::TokenType::SC_COLON,
+                             "Expected ':' after the case.");
+        !colon) {
+      return colon.unexpected();
+    }
+
+    std::vector<ast::StmtPtr> stmts;
+
+    while (!check(token::TokenType::KW_CASO) &&
+           !check(token::TokenType::KW_PADRAO) &&
+           !check(token::TokenType::SC_CLOSE_CURLY) && !isAtEnd()) {
+      ast::Stmt stmt = declaration();
+      if (!validating_) stmts.push_back(wrap(std::move(stmt)));
+    }
+
+    escolha.labels.push_back(std::move(labels));
+    escolha.bodies.push_back(wrap(ast::Stmt{ast::Block{std::move(stmts)}}));
+  }
+
+  if (auto curly = consume(token::TokenType::SC_CLOSE_CURLY,
+                           "Expected '}' after the cases.");
+      !curly) {
+    return curly.unexpected();
   }
 
-  consume(token::TokenType::SC_CLOSE_CURLY, "Expected '}' after block.");
+  escolha.table = CaseTable::create(escolha.labels);
 
-  return statements;
+  return ast::Stmt{std::move(escolha)};
 }
 
-ast::Stmt Parser::expressionStatement() {
-  ast::Expr expr = expression();
+// A number, possibly negated, or a string.
+error::ParseResult<std::any> Parser::caseLabel() {
+  const bool negated = match(token::TokenType::SC_MINUS);
 
-  consume(token::TokenType::SC_SEMICOLON, "Expected ';' after expression.");
+  if (match(token::TokenType::LT_NUMBER)) {
+    const float number = std::any_cast<float>(previous().literal);
+    return std::any(negated ? -number : number);
+  }
 
-  auto expr_ptr = allocator_->make_unique<ast::Expr>(std::move(expr));
-  return ast::Stmt{ast::Expression{std::move(expr_ptr)}};
+  if (!negated && match(token::TokenType::LT_STRING)) {
+    return previous().literal;
+  }
+
+  return error(peek(), "Expected a number or a string after caso.");
 }
 
-ast::Expr Parser::expression() { return comma(); }
+error::ParseResult<ast::Stmt> Parser::tarefaStatement() {
+  const token::Token keyword = previous();
 
-ast::Expr Parser::comma() {
-  ast::Expr left_expr;
+  if (auto curly = consume(token::TokenType::SC_OPEN_CURLY,
+                           "Expected '{' after tarefa.");
+      !curly) {
+    return curly.unexpected();
+  }
 
-  // In case the expression starts with the binary comma operator...
-  if (match({token::TokenType::SC_COMMA})) {
-    error_state_.error(previous(),
-                       "Binary operator ',' has no left-hand side.");
+  // Like the body of a parallel loop, the body of a task is parsed eagerly,
+  // so that it never races the rest of the program to parse a lazy block.
+  const bool lazy_blocks = std::exchange(lazy_blocks_, false);
+  const bool validating = std::exchange(validating_, false);
+  const bool returns_allowed = std::exchange(returns_allowed_, false);
 
-    // Parses the right-hand side and discards it by not assigning it.
-    ast::Expr right_expr = assignment();
+  auto stmts = block();
 
-    // Creates a placeholder for the invalid left-hand side expression (the spot
-    // before the dangling comma) and passes the right-hand side to it (metadata
-    // for later use).
-    auto right = allocator_->make_unique<ast::Expr>(std::move(right_expr));
-    left_expr = ast::Expr{ast::ErrorExpr{std::move(right)}};
-  } else {
-    // Parse the assignment (descending) as usual.
-    left_expr = assignment();
+  lazy_blocks_ = lazy_blocks;
+  validating_ = validating;
+  returns_allowed_ = returns_allowed;
+
+  if (!stmts) return stmts.unexpected();
+
+  std::vector<ast::StmtPtr> stmt_ptrs;
+  stmt_ptrs.reserve(stmts.value().size());
+
+  for (auto &s : stmts.value()) {
+    stmt_ptrs.emplace_back(wrap(std::move(s)));
   }
 
-  while (match({token::TokenType::SC_COMMA})) {
-    const token::Token opr = previous();
-    ast::Expr right_expr = assignment();
+  auto body = wrap(ast::Stmt{ast::Block{std::move(stmt_ptrs)}});
 
-    auto left = allocator_->make_unique<ast::Expr>(std::move(left_expr));
-    auto right = allocator_->make_unique<ast::Expr>(std::move(right_expr));
+  return ast::Stmt{ast::Tarefa{keyword, std::move(body)}};
+}
+
+error::ParseResult<ast::Stmt> Parser::envieStatement() {
+  const token::Token keyword = previous();
 
-    left_expr = ast::Expr{ast::Binary{std::move(left), opr, std::move(right)}};
+  if (auto paren = consume(token::TokenType::SC_OPEN_PAREN,
+                           "Expected '(' after envie.");
+      !paren) {
+    return paren.unexpected();
   }
 
-  return left_expr;
+  // The arguments are separated by commas, so they bind tighter than the
+  // comma operator.
+  auto channel = parsePrecedence(Precedence::ASSIGNMENT);
+  if (!channel) return channel.unexpected();
+
+  if (auto comma = consume(token::TokenType::SC_COMMA,
+                           "Expected ',' after the channel.");
+      !comma) {
+    return comma.unexpected();
+  }
+
+  auto value = parsePrecedence(Precedence::ASSIGNMENT);
+  if (!value) return value.unexpected();
+
+  if (auto paren = consume(token::TokenType::SC_CLOSE_PAREN,
+                           "Expected ')' after value.");
+      !paren) {
+    return paren.unexpected();
+  }
+
+  if (auto semicolon = consume(token::TokenType::SC_SEMICOLON,
+                               "Expected ';' after closing the parentheses.");
+      !semicolon) {
+    return semicolon.unexpected();
+  }
+
+  return ast::Stmt{ast::Envie{keyword, wrap(std::move(channel.value())),
+                              wrap(std::move(value.value()))}};
 }
 
-ast::Expr Parser::assignment() {
-  ast::Expr expr = ternary();
+error::ParseResult<ast::Stmt> Parser::fecheStatement() {
+  const token::Token keyword = previous();
 
-  if (match({token::TokenType::MC_EQUAL})) {
-    const token::Token equals = previous();
-    ast::Expr value = assignment();
+  if (auto paren = consume(token::TokenType::SC_OPEN_PAREN,
+                           "Expected '(' after feche.");
+      !paren) {
+    return paren.unexpected();
+  }
 
-    if (std::holds_alternative<ast::Variable>(expr.var)) {
-      const auto &var = std::get<ast::Variable>(expr.var);
+  auto channel = expression();
+  if (!channel) return channel.unexpected();
 
-      auto value_ptr = allocator_->make_unique<ast::Expr>(std::move(value));
-      return ast::Expr{ast::Assign{var.name, std::move(value_ptr)}};
-    }
+  if (auto paren = consume(token::TokenType::SC_CLOSE_PAREN,
+                           "Expected ')' after the channel.");
+      !paren) {
+    return paren.unexpected();
+  }
 
-    error(equals, "Invalid assignment target.");
+  if (auto semicolon = consume(token::TokenType::SC_SEMICOLON,
+                               "Expected ';' after closing the parentheses.");
+      !semicolon) {
+    return semicolon.unexpected();
   }
 
-  return expr;
+  return ast::Stmt{ast::Feche{keyword, wrap(std::move(channel.value()))}};
 }
 
-ast::Expr Parser::ternary() {
-  ast::Expr condition = logicalOr();
+error::ParseResult<ast::Stmt> Parser::instantaneoStatement() {
+  const token::Token keyword = previous();
 
-  if (match({token::TokenType::MC_QUESTION})) {
-    const auto question = previous();
-    ast::Expr then_expr = expression();
+  if (auto semicolon = consume(token::TokenType::SC_SEMICOLON,
+                               "Expected ';' after instantaneo.");
+      !semicolon) {
+    return semicolon.unexpected();
+  }
 
-    const auto colon =
-        consume(token::TokenType::SC_COLON, "Expected ':' after expression.");
+  return ast::Stmt{ast::Instantaneo{keyword}};
+}
 
-    ast::Expr else_expr = ternary();
+error::ParseResult<ast::Stmt> Parser::importeStatement() {
+  const token::Token keyword = previous();
 
-    auto cond_ptr = allocator_->make_unique<ast::Expr>(std::move(condition));
-    auto then_ptr = allocator_->make_unique<ast::Expr>(std::move(then_expr));
-    auto else_ptr = allocator_->make_unique<ast::Expr>(std::move(else_expr));
+  auto path = consume(token::TokenType::LT_STRING,
+                      "Expected the path of the module after importe.");
+  if (!path) return path.unexpected();
 
-    condition = ast::Expr{ast::Ternary{std::move(cond_ptr), question,
-                                       std::move(then_ptr), colon,
-                                       std::move(else_ptr)}};
+  if (auto semicolon = consume(token::TokenType::SC_SEMICOLON,
+                               "Expected ';' after the path of the module.");
+      !semicolon) {
+    return semicolon.unexpected();
   }
 
-  return condition;
+  return ast::Stmt{ast::Importe{keyword, path.value()}};
 }
 
-ast::Expr Parser::logicalOr() {
-  ast::Expr left_expr = logicalAnd();
+error::ParseResult<ast::Stmt> Parser::retorneStatement() {
+  const token::Token keyword = previous();
 
-  while (match({token::TokenType::KW_OU})) {
-    const token::Token opr = previous();
-    ast::Expr right_expr = logicalAnd();
+  if (!returns_allowed_) {
+    return error(keyword, "Can only return from the body of a function.");
+  }
+
+  std::optional<ast::ExprPtr> value;
+
+  if (!check(token::TokenType::SC_SEMICOLON)) {
+    if (initializer_) {
+      error_state_.error(keyword, "Cannot return a value from an initializer.");
+    }
 
-    auto left = allocator_->make_unique<ast::Expr>(std::move(left_expr));
-    auto right = allocator_->make_unique<ast::Expr>(std::move(right_expr));
+    auto expr = expression();
+    if (!expr) return expr.unexpected();
 
-    left_expr = ast::Expr{ast::Logical{std::move(left), opr, std::move(right)}};
+    value = wrap(std::move(expr.value()));
   }
 
-  return left_expr;
+  if (auto semicolon = consume(token::TokenType::SC_SEMICOLON,
+                               "Expected ';' after the return value.");
+      !semicolon) {
+    return semicolon.unexpected();
+  }
+
+  return ast::Stmt{ast::Retorne{keyword, std::move(value)}};
 }
 
-ast::Expr Parser::logicalAnd() {
-  ast::Expr left_expr = equality();
+error::ParseResult<std::vector<ast::Stmt>> Parser::block() {
+  std::vector<ast::Stmt> statements;
 
-  while (match({token::TokenType::KW_E})) {
-    const token::Token opr = previous();
-    ast::Expr right_expr = equality();
+  while (!check(token::TokenType::SC_CLOSE_CURLY) && !isAtEnd()) {
+    ast::Stmt stmt = declaration();
 
-    auto left = allocator_->make_unique<ast::Expr>(std::move(left_expr));
-    auto right = allocator_->make_unique<ast::Expr>(std::move(right_expr));
+    // A validating scan only reports errors; it keeps no statements.
+    if (!validating_) statements.push_back(std::move(stmt));
+  }
 
-    left_expr = ast::Expr{ast::Logical{std::move(left), opr, std::move(right)}};
+  if (auto curly = consume(token::TokenType::SC_CLOSE_CURLY,
+                           "Expected '}' after block.");
+      !curly) {
+    return curly.unexpected();
   }
 
-  return left_expr;
+  return statements;
 }
 
-ast::Expr Parser::equality() {
-  const std::vector<token::TokenType> operators = {
-      token::TokenType::MC_EXCL_EQUAL, token::TokenType::MC_EQUAL_EQUAL};
-
-  ast::Expr left_expr;
+// Parses the body of a `se`, `senao`, `enquanto` or `para` statement. In lazy
+// mode, a braced body is not turned into an AST: the parser only validates it
+// (reporting any syntax error) and records its token range, which is parsed by
+// `parseLazyBlock()` the first time the body runs.
+error::ParseResult<ast::Stmt> Parser::bodyStatement() {
+  if (!lazy_blocks_ || validating_ || !check(token::TokenType::SC_OPEN_CURLY)) {
+    return statement();
+  }
 
-  // In case the expression starts with one of the binary equality operators...
-  if (match(operators)) {
-    const token::Token prev_token = previous();
-    error_state_.error(prev_token, "Binary operator '" +
-                                       token::toString(prev_token.type) +
-                                       "' has no left-hand side.");
+  advance();
 
-    ast::Expr right_expr = comparison();
+  const int begin = current_;
 
-    auto right = allocator_->make_unique<ast::Expr>(std::move(right_expr));
-    left_expr = ast::Expr{ast::ErrorExpr{std::move(right)}};
+  if (validated_) {
+    // The enclosing block was validated before, so matching the braces is
+    // enough to find where this one ends.
+    skipBlock();
   } else {
-    left_expr = comparison();
+    validating_ = true;
+    const auto validation = block();
+    validating_ = false;
+
+    if (!validation) return validation.unexpected();
   }
 
-  while (match(operators)) {
-    const token::Token opr = previous();
-    ast::Expr right_expr = comparison();
+  return ast::Stmt{ast::LazyBlock{this, begin, current_}};
+}
+
+// Also called while the rest of the script is being parsed, for a body the
+// resolver needs to see at once.
+const ast::Stmt &Parser::parseLazyBlock(const ast::LazyBlock &lazy) {
+  if (lazy.parsed != nullptr) return *lazy.parsed;
 
-    auto left = allocator_->make_unique<ast::Expr>(std::move(left_expr));
-    auto right = allocator_->make_unique<ast::Expr>(std::move(right_expr));
+  const int resume = current_;
+  const bool validated = std::exchange(validated_, true);
 
-    left_expr = ast::Expr{ast::Binary{std::move(left), opr, std::move(right)}};
+  current_ = lazy.begin;
+
+  // The body was validated when it was first scanned, so it parses without
+  // errors.
+  auto stmts = block();
+  assert(stmts.hasValue());
+
+  current_ = resume;
+  validated_ = validated;
+
+  std::vector<ast::StmtPtr> stmt_ptrs;
+  stmt_ptrs.reserve(stmts.value().size());
+
+  for (auto &s : stmts.value()) {
+    stmt_ptrs.emplace_back(wrap(std::move(s)));
   }
 
-  return left_expr;
+  ast::Stmt parsed{ast::Block{std::move(stmt_ptrs)}};
+  Resolver(error_state_, constants_).resolve(lazy, parsed);
+
+  // The parsed block lives in the arena for as long as the program does.
+  lazy.parsed = wrap(std::move(parsed)).release();
+
+  return *lazy.parsed;
 }
 
-ast::Expr Parser::comparison() {
-  const std::vector<token::TokenType> operators = {
-      token::TokenType::MC_GREATER, token::TokenType::MC_GREATER_EQUAL,
-      token::TokenType::MC_LESS, token::TokenType::MC_LESS_EQUAL};
+namespace {
+// The operators that assign the variable named right before them.
+constexpr token::TokenSet kAssignmentOperators = {
+    token::TokenType::MC_EQUAL,       token::TokenType::MC_PLUS_EQUAL,
+    token::TokenType::MC_MINUS_EQUAL, token::TokenType::MC_STAR_EQUAL,
+    token::TokenType::MC_SLASH_EQUAL, token::TokenType::MC_PLUS_PLUS,
+    token::TokenType::MC_MINUS_MINUS};
+// The tokens that assign the variable named right after them: the prefix
+// increments, and the ':' of a reduction.
+constexpr token::TokenSet kAssigningPrefixes = {
+    token::TokenType::MC_PLUS_PLUS, token::TokenType::MC_MINUS_MINUS,
+    token::TokenType::SC_COLON};
+}  // namespace
+
+// Looks at the tokens only, so a variable that shadows a constant, or a
+// property with its name, counts as the constant.
+bool Parser::mayAssign(
+    const ast::LazyBlock &lazy,
+    const std::function<bool(const std::string &)> &constant) const {
+  std::unordered_set<std::string> declared;
+
+  for (int i = lazy.begin; i + 1 < lazy.end; i++) {
+    if (tokens_[i].type == token::TokenType::KW_CONSTANTE &&
+        tokens_[i + 1].type == token::TokenType::LT_IDENTIFIER) {
+      declared.insert(tokens_[i + 1].lexeme.value());
+    }
+  }
 
-  ast::Expr left_expr;
+  const auto frozen = [&](int i) {
+    if (i < lazy.begin || i >= lazy.end ||
+        tokens_[i].type != token::TokenType::LT_IDENTIFIER) {
+      return false;
+    }
 
-  // In case the expression starts with one of the binary comparison
-  // operators...
-  if (match(operators)) {
-    const token::Token prev_token = previous();
-    error_state_.error(prev_token, "Binary operator '" +
-                                       token::toString(prev_token.type) +
-                                       "' has no left-hand side.");
+    const std::string &name = tokens_[i].lexeme.value();
+    return declared.contains(name) || constant(name);
+  };
 
-    ast::Expr right_expr = term();
+  for (int i = lazy.begin; i < lazy.end; i++) {
+    const token::TokenType type = tokens_[i].type;
 
-    auto right = allocator_->make_unique<ast::Expr>(std::move(right_expr));
-    left_expr = ast::Expr{ast::ErrorExpr{{std::move(right)}}};
-  } else {
-    left_expr = term();
+    // The '=' of a declaration gives the variable its first value.
+    if (type == token::TokenType::MC_EQUAL && i - 2 >= lazy.begin &&
+        (tokens_[i - 2].type == token::TokenType::KW_VAR ||
+         tokens_[i - 2].type == token::TokenType::KW_CONSTANTE)) {
+      continue;
+    }
+
+    if ((kAssignmentOperators.contains(type) && frozen(i - 1)) ||
+        (kAssigningPrefixes.contains(type) && frozen(i + 1))) {
+      return true;
+    }
   }
 
-  while (match(operators)) {
-    const token::Token opr = previous();
-    ast::Expr right_expr = term();
+  return false;
+}
 
-    auto left = allocator_->make_unique<ast::Expr>(std::move(left_expr));
-    auto right = allocator_->make_unique<ast::Expr>(std::move(right_expr));
+void Parser::skipBlock() {
+  int depth = 1;
 
-    left_expr = ast::Expr{ast::Binary{std::move(left), opr, std::move(right)}};
-  }
+  while (depth > 0 && !isAtEnd()) {
+    const token::TokenType type = advance().type;
 
-  return left_expr;
+    if (type == token::TokenType::SC_OPEN_CURLY) depth++;
+    if (type == token::TokenType::SC_CLOSE_CURLY) depth--;
+  }
 }
 
-ast::Expr Parser::term() {
-  ast::Expr left_expr;
+error::ParseResult<ast::Stmt> Parser::expressionStatement() {
+  auto expr = expression();
+  if (!expr) return expr.unexpected();
 
-  // Only checks the binary arithmetic addition operator, because the
-  // subtraction operator is parsed as a unary expression at the highest
-  // level.
-  if (match({token::TokenType::SC_PLUS})) {
-    error_state_.error(previous(),
-                       "Binary operator '+' has no left-hand side.");
+  if (auto semicolon = consume(token::TokenType::SC_SEMICOLON,
+                               "Expected ';' after expression.");
+      !semicolon) {
+    return semicolon.unexpected();
+  }
 
-    ast::Expr right_expr = factor();
+  auto expr_ptr = wrap(std::move(expr.value()));
+  return ast::Stmt{ast::Expression{std::move(expr_ptr)}};
+}
 
-    auto right = allocator_->make_unique<ast::Expr>(std::move(right_expr));
-    left_expr = ast::Expr{ast::ErrorExpr{{std::move(right)}}};
-  } else {
-    left_expr = factor();
+namespace {
+constexpr token::TokenSet kUnaryOperators = {token::TokenType::MC_EXCL,
+                                             token::TokenType::SC_MINUS};
+constexpr token::TokenSet kIncrements = {token::TokenType::MC_PLUS_PLUS,
+                                         token::TokenType::MC_MINUS_MINUS};
+
+// The binary operator an update applies.
+token::TokenType operationOf(token::TokenType type) {
+  switch (type) {
+    case token::TokenType::MC_MINUS_EQUAL:
+    case token::TokenType::MC_MINUS_MINUS:
+      return token::TokenType::SC_MINUS;
+    case token::TokenType::MC_STAR_EQUAL:
+      return token::TokenType::SC_STAR;
+    case token::TokenType::MC_SLASH_EQUAL:
+      return token::TokenType::SC_FORWARD_SLASH;
+    default:
+      return token::TokenType::SC_PLUS;
   }
+}
+}  // namespace
+
+// Operator table driving `parsePrecedence()`, indexed by token type. Tokens
+// without an entry do not continue an expression. The subtraction operator
+// does not recover from a missing left-hand side, because it is parsed as a
+// unary expression in that position.
+const std::array<Parser::InfixRule, token::kTokenTypeCount>
+    Parser::kInfixRules = [] {
+      std::array<InfixRule, token::kTokenTypeCount> rules{};
+
+      const auto set = [&rules](token::TokenType type, Precedence precedence,
+                                InfixKind kind, bool recovers) {
+        rules[static_cast<std::size_t>(type)] = {precedence, kind, recovers};
+      };
+
+      set(token::TokenType::SC_COMMA, Precedence::COMMA, InfixKind::BINARY,
+          true);
+      set(token::TokenType::MC_EQUAL, Precedence::ASSIGNMENT,
+          InfixKind::ASSIGNMENT, false);
+
+      for (const auto type : {token::TokenType::MC_PLUS_EQUAL,
+                              token::TokenType::MC_MINUS_EQUAL,
+                              token::TokenType::MC_STAR_EQUAL,
+                              token::TokenType::MC_SLASH_EQUAL}) {
+        set(type, Precedence::ASSIGNMENT, InfixKind::UPDATE, false);
+      }
+
+      set(token::TokenType::MC_QUESTION, Precedence::TERNARY,
+          InfixKind::TERNARY, false);
+      set(token::TokenType::KW_OU, Precedence::LOGIC_OR, InfixKind::LOGICAL,
+          false);
+      set(token::TokenType::KW_E, Precedence::LOGIC_AND, InfixKind::LOGICAL,
+          false);
+      set(token::TokenType::MC_EXCL_EQUAL, Precedence::EQUALITY,
+          InfixKind::BINARY, true);
+      set(token::TokenType::MC_EQUAL_EQUAL, Precedence::EQUALITY,
+          InfixKind::BINARY, true);
+      set(token::TokenType::MC_GREATER, Precedence::COMPARISON,
+          InfixKind::BINARY, true);
+      set(token::TokenType::MC_GREATER_EQUAL, Precedence::COMPARISON,
+          InfixKind::BINARY, true);
+      set(token::TokenType::MC_LESS, Precedence::COMPARISON, InfixKind::BINARY,
+          true);
+      set(token::TokenType::MC_LESS_EQUAL, Precedence::COMPARISON,
+          InfixKind::BINARY, true);
+      set(token::TokenType::SC_MINUS, Precedence::TERM, InfixKind::BINARY,
+          false);
+      set(token::TokenType::SC_PLUS, Precedence::TERM, InfixKind::BINARY, true);
+      set(token::TokenType::SC_FORWARD_SLASH, Precedence::FACTOR,
+          InfixKind::BINARY, true);
+      set(token::TokenType::SC_STAR, Precedence::FACTOR, InfixKind::BINARY,
+          true);
+      set(token::TokenType::SC_OPEN_PAREN, Precedence::CALL, InfixKind::CALL,
+          false);
+      set(token::TokenType::SC_DOT, Precedence::CALL, InfixKind::PROPERTY,
+          false);
+      set(token::TokenType::SC_OPEN_BRACKET, Precedence::CALL,
+          InfixKind::INDEX, false);
+      set(token::TokenType::MC_PLUS_PLUS, Precedence::CALL,
+          InfixKind::POSTFIX, false);
+      set(token::TokenType::MC_MINUS_MINUS, Precedence::CALL,
+          InfixKind::POSTFIX, false);
+
+      return rules;
+    }();
+
+error::ParseResult<ast::Expr> Parser::expression() {
+  return parsePrecedence(Precedence::COMMA);
+}
 
-  while (match({token::TokenType::SC_MINUS, token::TokenType::SC_PLUS})) {
-    const token::Token opr = previous();
-    ast::Expr right_expr = factor();
+// Parses an expression whose operators bind at least as tightly as
+// `min_precedence`. Left-associative operators parse their right-hand side one
+// level tighter; right-associative ones (assignment, ternary) at their own
+// level.
+error::ParseResult<ast::Expr> Parser::parsePrecedence(
+    Precedence min_precedence) {
+  auto left_expr = prefix(min_precedence);
+  if (!left_expr) return left_expr;
 
-    auto left = allocator_->make_unique<ast::Expr>(std::move(left_expr));
-    auto right = allocator_->make_unique<ast::Expr>(std::move(right_expr));
+  while (true) {
+    const InfixRule &rule = kInfixRules[static_cast<std::size_t>(peek().type)];
 
-    left_expr = ast::Expr{ast::Binary{std::move(left), opr, std::move(right)}};
+    if (rule.kind == InfixKind::NONE || rule.precedence < min_precedence) {
+      break;
+    }
+
+    advance();
+    left_expr = infix(std::move(left_expr.value()), rule);
+    if (!left_expr) return left_expr;
   }
 
   return left_expr;
 }
 
-ast::Expr Parser::factor() {
-  const std::vector<token::TokenType> operators = {
-      token::TokenType::SC_FORWARD_SLASH, token::TokenType::SC_STAR};
+error::ParseResult<ast::Expr> Parser::prefix(Precedence min_precedence) {
+  if (match(kUnaryOperators)) {
+    const token::Token opr = previous();
+    auto right_operand = parsePrecedence(Precedence::UNARY);
+    if (!right_operand) return right_operand;
+
+    auto right = wrap(std::move(right_operand.value()));
+
+    return ast::Expr{ast::Unary{opr, std::move(right)}};
+  }
 
-  ast::Expr left_expr;
+  if (match(kIncrements)) {
+    const token::Token opr = previous();
+    auto operand = parsePrecedence(Precedence::UNARY);
+    if (!operand) return operand;
 
-  // In case the expression starts with the binary arithmetic division or
-  // multiplication operators...
-  if (match(operators)) {
-    const token::Token prev_token = previous();
+    return update(std::move(operand.value()), opr, nullptr, false);
+  }
+
+  const InfixRule &rule = kInfixRules[static_cast<std::size_t>(peek().type)];
+
+  // In case the expression starts with a binary operator that is allowed at
+  // this level...
+  if (rule.recovers && rule.precedence >= min_precedence) {
+    const token::Token prev_token = advance();
     error_state_.error(prev_token, "Binary operator '" +
-                                       token::toString(prev_token.type) +
+                                       std::string(token::toString(
+                                           prev_token.type)) +
                                        "' has no left-hand side.");
 
-    ast::Expr right_expr = unary();
+    // Parses the right-hand side and creates a placeholder for the invalid
+    // left-hand side expression (the spot before the dangling operator),
+    // passing the right-hand side to it (metadata for later use).
+    const auto operand_precedence =
+        static_cast<Precedence>(static_cast<int>(rule.precedence) + 1);
+    auto right_expr = parsePrecedence(operand_precedence);
+    if (!right_expr) return right_expr;
 
-    auto right = allocator_->make_unique<ast::Expr>(std::move(right_expr));
-    left_expr = ast::Expr{ast::ErrorExpr{std::move(right)}};
-  } else {
-    left_expr = unary();
+    auto right = wrap(std::move(right_expr.value()));
+    return ast::Expr{ast::ErrorExpr{std::move(right)}};
   }
 
-  while (match(operators)) {
-    const token::Token opr = previous();
-    ast::Expr right_expr = unary();
+  return primary();
+}
 
-    auto left = allocator_->make_unique<ast::Expr>(std::move(left_expr));
-    auto right = allocator_->make_unique<ast::Expr>(std::move(right_expr));
+error::ParseResult<ast::Expr> Parser::infix(ast::Expr left_expr,
+                                            const InfixRule &rule) {
+  const token::Token opr = previous();
+
+  switch (rule.kind) {
+    case InfixKind::ASSIGNMENT: {
+      // Assignment is right-associative.
+      auto value = parsePrecedence(Precedence::ASSIGNMENT);
+      if (!value) return value;
+
+      if (std::holds_alternative<ast::Variable>(left_expr.var)) {
+        const auto &var = std::get<ast::Variable>(left_expr.var);
+
+        auto value_ptr = wrap(std::move(value.value()));
+        return ast::Expr{ast::Assign{var.name, std::move(value_ptr)}};
+      }
+
+      if (auto *get = std::get_if<ast::Get>(&left_expr.var)) {
+        return ast::Expr{ast::Set{.object = std::move(get->object),
+                                  .name = get->name,
+                                  .value = wrap(std::move(value.value())),
+                                  .cache = std::move(get->cache)}};
+      }
+
+      if (auto *index = std::get_if<ast::Index>(&left_expr.var)) {
+        return ast::Expr{
+            ast::SetIndex{.object = std::move(index->object),
+                          .bracket = index->bracket,
+                          .index = std::move(index->index),
+                          .value = wrap(std::move(value.value()))}};
+      }
+
+      error(opr, "Invalid assignment target.");
+
+      return left_expr;
+    }
+    case InfixKind::UPDATE: {
+      // Like assignment, right-associative.
+      auto value = parsePrecedence(Precedence::ASSIGNMENT);
+      if (!value) return value;
 
-    left_expr = ast::Expr{ast::Binary{std::move(left), opr, std::move(right)}};
+      return update(std::move(left_expr), opr, wrap(std::move(value.value())),
+                    false);
+    }
+    case InfixKind::POSTFIX:
+      return update(std::move(left_expr), opr, nullptr, true);
+    case InfixKind::TERNARY: {
+      auto then_expr = expression();
+      if (!then_expr) return then_expr;
+
+      const auto colon =
+          consume(token::TokenType::SC_COLON, "Expected ':' after expression.");
+      if (!colon) return colon.unexpected();
+
+      // The else branch nests to the right.
+      auto else_expr = parsePrecedence(Precedence::TERNARY);
+      if (!else_expr) return else_expr;
+
+      auto cond_ptr = wrap(std::move(left_expr));
+      auto then_ptr = wrap(std::move(then_expr.value()));
+      auto else_ptr = wrap(std::move(else_expr.value()));
+
+      return ast::Expr{ast::Ternary{std::move(cond_ptr), opr,
+                                    std::move(then_ptr), colon.value(),
+                                    std::move(else_ptr)}};
+    }
+    case InfixKind::CALL:
+      return call(std::move(left_expr));
+    case InfixKind::PROPERTY: {
+      const auto name = consume(token::TokenType::LT_IDENTIFIER,
+                                "Expected the name of the property after "
+                                "'.'.");
+      if (!name) return name.unexpected();
+
+      return ast::Expr{ast::Get{.object = wrap(std::move(left_expr)),
+                                .name = name.value(),
+                                .cache = std::make_shared<PropertyCache>()}};
+    }
+    case InfixKind::INDEX: {
+      auto index = expression();
+      if (!index) return index;
+
+      if (auto bracket = consume(token::TokenType::SC_CLOSE_BRACKET,
+                                 "Expected ']' after the index.");
+          !bracket) {
+        return bracket.unexpected();
+      }
+
+      return ast::Expr{ast::Index{wrap(std::move(left_expr)), opr,
+                                  wrap(std::move(index.value()))}};
+    }
+    default:
+      break;
   }
 
-  return left_expr;
+  const auto operand_precedence =
+      static_cast<Precedence>(static_cast<int>(rule.precedence) + 1);
+  auto right_expr = parsePrecedence(operand_precedence);
+  if (!right_expr) return right_expr;
+
+  auto left = wrap(std::move(left_expr));
+  auto right = wrap(std::move(right_expr.value()));
+
+  if (rule.kind == InfixKind::LOGICAL) {
+    return ast::Expr{ast::Logical{std::move(left), opr, std::move(right)}};
+  }
+
+  return ast::Expr{ast::Binary{std::move(left), opr, std::move(right)}};
 }
 
-ast::Expr Parser::unary() {
-  if (match({token::TokenType::MC_EXCL, token::TokenType::SC_MINUS})) {
-    const token::Token opr = previous();
-    ast::Expr right_operand = unary();
+// An update of `target` by `opr`, which only variables can be the target of.
+ast::Expr Parser::update(ast::Expr target, const token::Token &opr,
+                         ast::ExprPtr value, bool postfix) {
+  const auto *variable = std::get_if<ast::Variable>(&target.var);
+
+  if (variable == nullptr) {
+    error(opr, "Only variables can be updated with '" +
+                   std::string(token::toString(opr.type)) + "'.");
+    return target;
+  }
 
-    auto right = allocator_->make_unique<ast::Expr>(std::move(right_operand));
+  return ast::Expr{ast::Update{.name = variable->name,
+                               .opr = opr,
+                               .operation = operationOf(opr.type),
+                               .value = std::move(value),
+                               .postfix = postfix}};
+}
 
-    return ast::Expr{ast::Unary{opr, std::move(right)}};
+// Parses the arguments of a call to `callee`, after its opening parenthesis.
+error::ParseResult<ast::Expr> Parser::call(ast::Expr callee) {
+  std::vector<ast::ExprPtr> arguments;
+
+  if (!check(token::TokenType::SC_CLOSE_PAREN)) {
+    do {
+      if (arguments.size() == kMaxArguments) {
+        error_state_.error(peek(), "Cannot have more than 255 arguments.");
+      }
+
+      // The arguments are separated by commas, so they bind tighter than the
+      // comma operator.
+      auto argument = parsePrecedence(Precedence::ASSIGNMENT);
+      if (!argument) return argument;
+
+      arguments.push_back(wrap(std::move(argument.value())));
+    } while (match(token::TokenType::SC_COMMA));
   }
 
-  return primary();
+  const auto paren = consume(token::TokenType::SC_CLOSE_PAREN,
+                             "Expected ')' after the arguments.");
+  if (!paren) return paren.unexpected();
+
+  return ast::Expr{ast::Call{wrap(std::move(callee)), paren.value(),
+                             std::move(arguments)}};
 }
 
-ast::Expr Parser::primary() {
-  if (match({token::TokenType::KW_FALSO})) {
+error::ParseResult<ast::Expr> Parser::primary() {
+  if (match(token::TokenType::KW_FALSO)) {
     return ast::Expr{ast::Literal{previous().type, false}};
   }
 
-  if (match({token::TokenType::KW_VERDADEIRO})) {
+  if (match(token::TokenType::KW_VERDADEIRO)) {
     return ast::Expr{ast::Literal{previous().type, true}};
   }
 
-  if (match({token::TokenType::KW_NULO})) {
+  if (match(token::TokenType::KW_NULO)) {
     return ast::Expr{ast::Literal{previous().type, nullptr}};
   }
 
@@ -529,37 +1775,220 @@ ast::Expr Parser::primary() {
     return ast::Expr{ast::Literal{previous().type, previous().literal}};
   }
 
-  if (match({token::TokenType::LT_IDENTIFIER})) {
+  if (match(token::TokenType::LT_IDENTIFIER)) {
     return ast::Expr{ast::Variable{previous()}};
   }
 
-  if (match({token::TokenType::SC_OPEN_PAREN})) {
-    ast::Expr group_expr = expression();
+  if (match(token::TokenType::KW_ESSE)) {
+    if (class_kind_ == ClassKind::NONE) {
+      error_state_.error(previous(), "Cannot use 'esse' outside of a class.");
+    }
+
+    return ast::Expr{ast::Esse{previous()}};
+  }
 
-    consume(token::TokenType::SC_CLOSE_PAREN, "Expected ')' after expression.");
+  if (match(token::TokenType::KW_SUPER)) return super();
+
+  if (match(token::TokenType::KW_CANAL)) return channel();
+
+  if (match(token::TokenType::SC_OPEN_BRACKET)) return array();
+
+  if (match(token::TokenType::SC_OPEN_CURLY)) return dictionary();
+
+  if (match(token::TokenType::KW_RECEBA)) {
+    const token::Token keyword = previous();
+
+    if (auto paren = consume(token::TokenType::SC_OPEN_PAREN,
+                             "Expected '(' after receba.");
+        !paren) {
+      return paren.unexpected();
+    }
 
-    auto grouping = allocator_->make_unique<ast::Expr>(std::move(group_expr));
+    auto channel_expr = expression();
+    if (!channel_expr) return channel_expr;
+
+    if (auto paren = consume(token::TokenType::SC_CLOSE_PAREN,
+                             "Expected ')' after the channel.");
+        !paren) {
+      return paren.unexpected();
+    }
+
+    return ast::Expr{
+        ast::Receba{keyword, wrap(std::move(channel_expr.value()))}};
+  }
+
+  if (match(token::TokenType::SC_OPEN_PAREN)) {
+    auto group_expr = expression();
+    if (!group_expr) return group_expr;
+
+    if (auto paren = consume(token::TokenType::SC_CLOSE_PAREN,
+                             "Expected ')' after expression.");
+        !paren) {
+      return paren.unexpected();
+    }
+
+    auto grouping = wrap(std::move(group_expr.value()));
 
     return ast::Expr{ast::Grouping{std::move(grouping)}};
   }
 
-  throw error(peek(), "Expect expression.");
+  return error(peek(), "Expect expression.");
 }
 
-bool Parser::match(std::vector<token::TokenType> types) {
-  for (token::TokenType type : types) {
-    if (check(type)) {
-      advance();
-      return true;
-    }
+// Parses the rest of `super.metodo`.
+error::ParseResult<ast::Expr> Parser::super() {
+  const token::Token keyword = previous();
+
+  if (class_kind_ == ClassKind::NONE) {
+    error_state_.error(keyword, "Cannot use 'super' outside of a class.");
+  } else if (class_kind_ == ClassKind::CLASS) {
+    error_state_.error(keyword,
+                       "Cannot use 'super' in a class with no superclass.");
   }
 
-  return false;
+  if (auto dot =
+          consume(token::TokenType::SC_DOT, "Expected '.' after super.");
+      !dot) {
+    return dot.unexpected();
+  }
+
+  const auto method = consume(token::TokenType::LT_IDENTIFIER,
+                              "Expected the name of a method of the "
+                              "superclass.");
+  if (!method) return method.unexpected();
+
+  return ast::Expr{ast::Super{.keyword = keyword,
+                              .method = method.value(),
+                              .cache = std::make_shared<PropertyCache>()}};
+}
+
+// Parses the rest of `canal(tipo)` or `canal(tipo, capacidade)`.
+error::ParseResult<ast::Expr> Parser::channel() {
+  const token::Token keyword = previous();
+
+  if (auto paren = consume(token::TokenType::SC_OPEN_PAREN,
+                           "Expected '(' after canal.");
+      !paren) {
+    return paren.unexpected();
+  }
+
+  constexpr std::string_view kTypeMessage =
+      "Expected a channel type: numero, texto or logico.";
+
+  const auto type =
+      consume(token::TokenType::LT_IDENTIFIER, std::string(kTypeMessage));
+  if (!type) return type.unexpected();
+
+  const std::string &type_name = type.value().lexeme.value();
+
+  if (type_name != "numero" && type_name != "texto" && type_name != "logico") {
+    return error(type.value(), std::string(kTypeMessage));
+  }
+
+  auto canal = ast::Canal{keyword, type.value()};
+
+  if (match(token::TokenType::SC_COMMA)) {
+    auto capacity = parsePrecedence(Precedence::ASSIGNMENT);
+    if (!capacity) return capacity;
+
+    canal.capacity = wrap(std::move(capacity.value()));
+  }
+
+  if (auto paren = consume(token::TokenType::SC_CLOSE_PAREN,
+                           "Expected ')' after the channel type.");
+      !paren) {
+    return paren.unexpected();
+  }
+
+  return ast::Expr{std::move(canal)};
+}
+
+// Parses the rest of `[elemento, ...]`, after its opening bracket.
+error::ParseResult<ast::Expr> Parser::array() {
+  const token::Token bracket = previous();
+  std::vector<ast::ExprPtr> elements;
+
+  if (!check(token::TokenType::SC_CLOSE_BRACKET)) {
+    do {
+      // Like arguments, the elements bind tighter than the comma operator.
+      auto element = parsePrecedence(Precedence::ASSIGNMENT);
+      if (!element) return element;
+
+      elements.push_back(wrap(std::move(element.value())));
+    } while (match(token::TokenType::SC_COMMA));
+  }
+
+  if (auto close = consume(token::TokenType::SC_CLOSE_BRACKET,
+                           "Expected ']' after the elements.");
+      !close) {
+    return close.unexpected();
+  }
+
+  return ast::Expr{ast::ArrayLiteral{bracket, std::move(elements)}};
+}
+
+// Parses the rest of `{chave: valor, ...}`, after its opening brace, which
+// only starts a dictionary where an expression is expected.
+error::ParseResult<ast::Expr> Parser::dictionary() {
+  ast::DictionaryLiteral dictionary{.curly = previous()};
+
+  if (!check(token::TokenType::SC_CLOSE_CURLY)) {
+    do {
+      auto key = parsePrecedence(Precedence::ASSIGNMENT);
+      if (!key) return key;
+
+      if (auto colon = consume(token::TokenType::SC_COLON,
+                               "Expected ':' after the key.");
+          !colon) {
+        return colon.unexpected();
+      }
+
+      auto value = parsePrecedence(Precedence::ASSIGNMENT);
+      if (!value) return value;
+
+      dictionary.keys.push_back(wrap(std::move(key.value())));
+      dictionary.values.push_back(wrap(std::move(value.value())));
+    } while (match(token::TokenType::SC_COMMA));
+  }
+
+  if (auto curly = consume(token::TokenType::SC_CLOSE_CURLY,
+                           "Expected '}' after the entries.");
+      !curly) {
+    return curly.unexpected();
+  }
+
+  return ast::Expr{std::move(dictionary)};
+}
+
+// Moves a node into the arena. A validating scan allocates nothing.
+ast::ExprPtr Parser::wrap(ast::Expr expr) {
+  if (validating_) return nullptr;
+  return allocator_->make_unique<ast::Expr>(std::move(expr));
+}
+
+ast::StmtPtr Parser::wrap(ast::Stmt stmt) {
+  if (validating_) return nullptr;
+  return allocator_->make_unique<ast::Stmt>(std::move(stmt));
+}
+
+bool Parser::match(token::TokenType type) {
+  if (!check(type)) return false;
+
+  advance();
+  return true;
+}
+
+bool Parser::match(token::TokenSet types) {
+  if (isAtEnd() || !types.contains(peek().type)) return false;
+
+  advance();
+  return true;
 }
 
-token::Token Parser::consume(token::TokenType type, std::string message) {
+error::ParseResult<token::Token> Parser::consume(token::TokenType type,
+                                                 std::string message) {
   if (check(type)) return advance();
-  throw error(peek(), message);
+  return error(peek(), message);
 }
 
 bool Parser::check(token::TokenType type) {
@@ -567,20 +1996,23 @@ bool Parser::check(token::TokenType type) {
   return peek().type == type;
 }
 
-token::Token Parser::advance() {
+const token::Token &Parser::advance() {
   if (!isAtEnd()) current_++;
   return previous();
 }
 
 bool Parser::isAtEnd() { return peek().type == token::TokenType::END_OF_FILE; }
 
-token::Token Parser::peek() { return tokens_.at(current_); }
+const token::Token &Parser::peek() { return tokens_.at(current_); }
 
-token::Token Parser::previous() { return tokens_.at(current_ - 1); }
+const token::Token &Parser::previous() { return tokens_.at(current_ - 1); }
 
-error::ParserError Parser::error(token::Token token, std::string message) {
+// Reports a syntax error and returns it, ready to abort the current
+// declaration.
+error::Unexpected<error::ParserError> Parser::error(const token::Token &token,
+                                                    std::string message) {
   error_state_.error(token, message);
-  return error::ParserError(message);
+  return {error::ParserError(std::move(message))};
 }
 
 void Parser::synchronize() {
@@ -593,9 +2025,12 @@ void Parser::synchronize() {
       case token::TokenType::KW_CLASSE:
       case token::TokenType::KW_FUNCAO:
       case token::TokenType::KW_VAR:
+      case token::TokenType::KW_CONSTANTE:
       case token::TokenType::KW_PARA:
       case token::TokenType::KW_SE:
       case token::TokenType::KW_ENQUANTO:
+      case token::TokenType::KW_ESCOLHA:
+      case token::TokenType::KW_TAREFA:
       case token::TokenType::KW_IMPRIMA:
       case token::TokenType::KW_RETORNE:
         return;
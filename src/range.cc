@@ -0,0 +1,27 @@
+#include "lusoscript/range.hh"
+
+#include <cmath>
+#include <limits>
+
+Range::Ref Range::create(float start, float end, float step) {
+  return Ref::adopt(new Range(start, end, step));
+}
+
+float Range::at(std::uint64_t index) const {
+  return static_cast<float>(static_cast<double>(start_) +
+                            static_cast<double>(index) * step_);
+}
+
+// The count is worked out in doubles, so that it is exact for the ranges of
+// whole numbers a `float` cannot count to one by one. Counts too large for
+// any loop to get through saturate.
+Range::Range(float start, float end, float step)
+    : start_(start), end_(end), step_(step), size_(0) {
+  const double steps = std::ceil((static_cast<double>(end) - start) / step);
+
+  if (steps >= 0x1p64) {
+    size_ = std::numeric_limits<std::uint64_t>::max();
+  } else if (steps > 0) {
+    size_ = static_cast<std::uint64_t>(steps);
+  }
+}
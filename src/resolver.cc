@@ -0,0 +1,637 @@
+#include "lusoscript/resolver.hh"
+
+#include <algorithm>
+#include <limits>
+
+#include "lusoscript/parser.hh"
+
+namespace {
+// The names `esse` and `super` are bound to, which, being keywords, no
+// variable can take.
+const std::string kEsse(token::KW_ESSE);
+const std::string kSuper(token::KW_SUPER);
+
+// The literal of `value`: a number, a string, a boolean or null.
+ast::Literal literal(std::any value) {
+  auto type = token::TokenType::LT_NUMBER;
+
+  if (value.type() == typeid(std::string)) {
+    type = token::TokenType::LT_STRING;
+  } else if (const auto *boolean = std::any_cast<bool>(&value)) {
+    type = *boolean ? token::TokenType::KW_VERDADEIRO
+                    : token::TokenType::KW_FALSO;
+  } else if (value.type() == typeid(std::nullptr_t)) {
+    type = token::TokenType::KW_NULO;
+  }
+
+  return {type, std::move(value)};
+}
+
+const std::any *valueOf(const ast::Expr &expr) {
+  const auto *literal = std::get_if<ast::Literal>(&expr.var);
+  return literal != nullptr ? &literal->value : nullptr;
+}
+
+// Truthiness and equality of literals, as the interpreter has them.
+bool isTruthy(const std::any &value) {
+  if (value.type() == typeid(std::nullptr_t)) return false;
+  if (const auto *boolean = std::any_cast<bool>(&value)) return *boolean;
+  return true;
+}
+
+bool isEqual(const std::any &a, const std::any &b) {
+  if (a.type() != b.type()) return false;
+  if (a.type() == typeid(std::nullptr_t)) return true;
+  if (a.type() == typeid(bool)) {
+    return std::any_cast<bool>(a) == std::any_cast<bool>(b);
+  }
+  if (a.type() == typeid(float)) {
+    return std::any_cast<float>(a) == std::any_cast<float>(b);
+  }
+  return std::any_cast<const std::string &>(a) ==
+         std::any_cast<const std::string &>(b);
+}
+
+// The comparisons of numbers, and of strings.
+template <typename T>
+std::optional<ast::Literal> compare(token::TokenType opr, const T &a,
+                                    const T &b) {
+  switch (opr) {
+    case token::TokenType::MC_GREATER:
+      return literal(a > b);
+    case token::TokenType::MC_GREATER_EQUAL:
+      return literal(a >= b);
+    case token::TokenType::MC_LESS:
+      return literal(a < b);
+    case token::TokenType::MC_LESS_EQUAL:
+      return literal(a <= b);
+    default:
+      return std::nullopt;
+  }
+}
+
+// Operators are only folded where the interpreter would not fail, so that
+// errors are still reported when the program runs, where they happen.
+std::optional<ast::Literal> fold(const ast::Binary &binary) {
+  const std::any *left = valueOf(*binary.left);
+  const std::any *right = valueOf(*binary.right);
+  if (left == nullptr || right == nullptr) return std::nullopt;
+
+  switch (binary.opr.type) {
+    case token::TokenType::SC_COMMA:
+      return literal(*right);
+    case token::TokenType::MC_EQUAL_EQUAL:
+      return literal(isEqual(*left, *right));
+    case token::TokenType::MC_EXCL_EQUAL:
+      return literal(!isEqual(*left, *right));
+    default:
+      break;
+  }
+
+  const auto *a = std::any_cast<float>(left);
+  const auto *b = std::any_cast<float>(right);
+
+  if (a != nullptr && b != nullptr) {
+    switch (binary.opr.type) {
+      case token::TokenType::SC_MINUS:
+        return literal(*a - *b);
+      case token::TokenType::SC_PLUS:
+        return literal(*a + *b);
+      case token::TokenType::SC_STAR:
+        return literal(*a * *b);
+      case token::TokenType::SC_FORWARD_SLASH:
+        if (*b == 0.f) return std::nullopt;
+        return literal(*a / *b);
+      default:
+        return compare(binary.opr.type, *a, *b);
+    }
+  }
+
+  const auto *x = std::any_cast<std::string>(left);
+  const auto *y = std::any_cast<std::string>(right);
+
+  if (x != nullptr && y != nullptr) {
+    if (binary.opr.type == token::TokenType::SC_PLUS) return literal(*x + *y);
+    return compare(binary.opr.type, *x, *y);
+  }
+
+  return std::nullopt;
+}
+
+std::optional<ast::Literal> fold(const ast::Unary &unary) {
+  const std::any *right = valueOf(*unary.right);
+  if (right == nullptr) return std::nullopt;
+
+  if (unary.opr.type == token::TokenType::MC_EXCL) {
+    return literal(!isTruthy(*right));
+  }
+
+  const auto *number = std::any_cast<float>(right);
+  if (unary.opr.type != token::TokenType::SC_MINUS || number == nullptr) {
+    return std::nullopt;
+  }
+
+  return literal(-*number);
+}
+
+// `e` and `ou` give one of their operands, and only need the right one when
+// the left one does not decide.
+std::optional<ast::Literal> fold(const ast::Logical &logical) {
+  const std::any *left = valueOf(*logical.left);
+  if (left == nullptr) return std::nullopt;
+
+  if (isTruthy(*left) == (logical.opr.type == token::TokenType::KW_OU)) {
+    return literal(*left);
+  }
+
+  const std::any *right = valueOf(*logical.right);
+  if (right == nullptr) return std::nullopt;
+
+  return literal(*right);
+}
+
+std::optional<ast::Literal> fold(const ast::Ternary &ternary) {
+  const std::any *condition = valueOf(*ternary.condition);
+  if (condition == nullptr) return std::nullopt;
+
+  const std::any *value = valueOf(
+      isTruthy(*condition) ? *ternary.then_expr : *ternary.else_expr);
+  if (value == nullptr) return std::nullopt;
+
+  return literal(*value);
+}
+}  // namespace
+
+Resolver::Resolver(error::ErrorState &error_state, Constants &constants)
+    : error_state_(error_state),
+      constants_(constants),
+      visible_constants_(std::numeric_limits<std::size_t>::max()) {}
+
+void Resolver::resolve(ast::Stmt &stmt) {
+  // A new top-level statement, outside of every scope.
+  if (functions_.empty()) {
+    functions_.push_back({.function = nullptr});
+
+    resolve(stmt);
+
+    functions_.clear();
+    return;
+  }
+
+  struct Visitor {
+    Resolver &resolver;
+
+    void operator()(ast::Block &block) {
+      resolver.beginScope();
+      resolver.resolve(block.stmts);
+      resolver.endScope();
+    }
+
+    void operator()(ast::Expression &expression) {
+      resolver.resolve(*expression.expression);
+    }
+
+    void operator()(ast::Imprima &imprima) {
+      resolver.resolve(*imprima.expression);
+    }
+
+    void operator()(ast::Var &var) {
+      // The initializer sees the variables of the enclosing scopes, even one
+      // with the same name.
+      if (var.initializer.has_value()) {
+        resolver.resolve(*var.initializer.value());
+      }
+
+      var.slot = resolver.declare(var.name);
+      if (var.constant) resolver.freeze(var);
+    }
+
+    void operator()(ast::If &stmt) {
+      resolver.resolve(*stmt.condition);
+      resolver.resolve(*stmt.then_branch);
+      if (stmt.else_branch.has_value()) {
+        resolver.resolve(*stmt.else_branch.value());
+      }
+    }
+
+    void operator()(ast::While &stmt) {
+      resolver.resolve(*stmt.condition);
+      resolver.resolve(*stmt.body);
+    }
+
+    // Only the script has lazy blocks, since the bodies of functions are
+    // parsed eagerly. A body that may assign a constant is parsed now, for
+    // the assignment to be reported before the program runs.
+    void operator()(ast::LazyBlock &lazy) {
+      lazy.scope.clear();
+
+      for (const Local &local : resolver.functions_.front().locals) {
+        lazy.scope.push_back({.name = *local.name,
+                              .constant = local.constant,
+                              .value = local.value});
+      }
+
+      lazy.constants = resolver.constants_.size();
+
+      if (lazy.parser->mayAssign(lazy, [this](const std::string &name) {
+            return resolver.constant(name) != nullptr;
+          })) {
+        lazy.parser->parseLazyBlock(lazy);
+      }
+    }
+
+    void operator()(ast::ParallelFor &loop) {
+      resolver.resolve(*loop.start);
+      resolver.resolve(*loop.end);
+      resolver.resolve(*loop.step);
+
+      std::vector<std::string> reduced;
+
+      for (auto &reduction : loop.reductions) {
+        const std::string &target = reduction.target.lexeme.value();
+
+        resolver.assign(reduction.target);
+
+        if (resolver.constant(target) != nullptr &&
+            resolver.reduced_constants_.insert(target).second) {
+          reduced.push_back(target);
+        }
+
+        reduction.binding = resolver.bind(reduction.target);
+      }
+
+      resolver.beginScope();
+      loop.slot = resolver.declare(loop.variable);
+      resolver.resolve(*loop.body);
+      resolver.endScope();
+
+      for (const auto &target : reduced) {
+        resolver.reduced_constants_.erase(target);
+      }
+    }
+
+    void operator()(ast::ForEach &loop) {
+      resolver.resolve(*loop.source);
+
+      resolver.beginScope();
+      loop.slot = resolver.declare(loop.variable);
+      resolver.resolve(*loop.body);
+      resolver.endScope();
+    }
+
+    // Each body is a block, with its own scope.
+    void operator()(ast::Escolha &escolha) {
+      resolver.resolve(*escolha.value);
+      for (const auto &body : escolha.bodies) resolver.resolve(*body);
+    }
+
+    void operator()(ast::Tarefa &tarefa) { resolver.resolve(*tarefa.body); }
+
+    void operator()(ast::Envie &envie) {
+      resolver.resolve(*envie.channel);
+      resolver.resolve(*envie.value);
+    }
+
+    void operator()(ast::Feche &feche) { resolver.resolve(*feche.channel); }
+
+    void operator()(ast::Instantaneo &) {}
+
+    void operator()(ast::Importe &) {}
+
+    // The name is declared before the body is resolved, so that the
+    // function can call itself.
+    void operator()(ast::Function &function) {
+      function.slot = resolver.declare(function.name);
+      resolver.function(function);
+    }
+
+    void operator()(ast::Retorne &retorne) {
+      if (retorne.value.has_value()) resolver.resolve(*retorne.value.value());
+    }
+
+    // The superclass is a local of a scope around the methods, which capture
+    // it for `super`.
+    void operator()(ast::Classe &klass) {
+      klass.slot = resolver.declare(klass.name);
+
+      if (klass.superclass.has_value()) {
+        resolver.resolve(*klass.superclass.value());
+
+        resolver.beginScope();
+        klass.super_slot = resolver.declare(kSuper);
+      }
+
+      for (auto &method : klass.methods) resolver.function(method);
+
+      if (klass.superclass.has_value()) resolver.endScope();
+    }
+
+    void operator()(ast::ErrorStmt &) {}
+  };
+  std::visit(Visitor{.resolver = *this}, stmt.var);
+}
+
+void Resolver::resolve(const ast::LazyBlock &lazy, ast::Stmt &block) {
+  FunctionScope script{.function = nullptr, .depth = 1};
+
+  for (const ast::ScopeLocal &local : lazy.scope) {
+    script.locals.push_back({.name = &local.name,
+                             .depth = 1,
+                             .constant = local.constant,
+                             .value = local.value});
+  }
+
+  visible_constants_ = lazy.constants;
+
+  functions_.push_back(std::move(script));
+
+  resolve(block);
+
+  functions_.clear();
+}
+
+void Resolver::resolve(ast::Expr &expr) {
+  struct Visitor {
+    Resolver &resolver;
+    // The literal that replaces the expression, if it folds to one.
+    std::optional<ast::Literal> folded;
+
+    void operator()(ast::Assign &assign) {
+      resolver.resolve(*assign.value);
+      resolver.assign(assign.name);
+      assign.binding = resolver.bind(assign.name);
+    }
+
+    void operator()(ast::Update &update) {
+      if (update.value != nullptr) resolver.resolve(*update.value);
+      resolver.assign(update.name);
+      update.binding = resolver.bind(update.name);
+    }
+
+    void operator()(ast::Ternary &ternary) {
+      resolver.resolve(*ternary.condition);
+      resolver.resolve(*ternary.then_expr);
+      resolver.resolve(*ternary.else_expr);
+      folded = fold(ternary);
+    }
+
+    void operator()(ast::Binary &binary) {
+      resolver.resolve(*binary.left);
+      resolver.resolve(*binary.right);
+      folded = fold(binary);
+    }
+
+    void operator()(ast::Grouping &grouping) {
+      resolver.resolve(*grouping.expression);
+
+      if (const std::any *value = valueOf(*grouping.expression)) {
+        folded = literal(*value);
+      }
+    }
+
+    void operator()(ast::Literal &) {}
+
+    void operator()(ast::Logical &logical) {
+      resolver.resolve(*logical.left);
+      resolver.resolve(*logical.right);
+      folded = fold(logical);
+    }
+
+    void operator()(ast::Unary &unary) {
+      resolver.resolve(*unary.right);
+      folded = fold(unary);
+    }
+
+    // A constant whose value is known is not bound, and so never captured.
+    void operator()(ast::Variable &variable) {
+      const auto *value = resolver.constant(variable.name.lexeme.value());
+
+      if (value != nullptr && value->has_value()) {
+        folded = value->value();
+        return;
+      }
+
+      variable.binding = resolver.bind(variable.name);
+    }
+
+    void operator()(ast::Call &call) {
+      resolver.resolve(*call.callee);
+      for (auto &argument : call.arguments) resolver.resolve(*argument);
+    }
+
+    void operator()(ast::Canal &canal) {
+      if (canal.capacity.has_value()) resolver.resolve(*canal.capacity.value());
+    }
+
+    void operator()(ast::Receba &receba) { resolver.resolve(*receba.channel); }
+
+    void operator()(ast::Get &get) { resolver.resolve(*get.object); }
+
+    void operator()(ast::Set &set) {
+      resolver.resolve(*set.object);
+      resolver.resolve(*set.value);
+    }
+
+    void operator()(ast::Esse &esse) { esse.binding = resolver.bind(kEsse); }
+
+    void operator()(ast::Super &super) {
+      super.binding = resolver.bind(kSuper);
+      super.receiver = resolver.bind(kEsse);
+    }
+
+    void operator()(ast::ArrayLiteral &array) {
+      for (auto &element : array.elements) resolver.resolve(*element);
+    }
+
+    void operator()(ast::DictionaryLiteral &dictionary) {
+      for (auto &key : dictionary.keys) resolver.resolve(*key);
+      for (auto &value : dictionary.values) resolver.resolve(*value);
+    }
+
+    void operator()(ast::Index &index) {
+      resolver.resolve(*index.object);
+      resolver.resolve(*index.index);
+    }
+
+    void operator()(ast::SetIndex &set) {
+      resolver.resolve(*set.object);
+      resolver.resolve(*set.index);
+      resolver.resolve(*set.value);
+    }
+
+    void operator()(ast::ErrorExpr &error) {
+      if (error.expr != nullptr) resolver.resolve(*error.expr);
+    }
+  };
+
+  Visitor visitor{.resolver = *this};
+  std::visit(visitor, expr.var);
+
+  if (visitor.folded.has_value()) expr.var = std::move(visitor.folded.value());
+}
+
+void Resolver::resolve(std::vector<ast::StmtPtr> &stmts) {
+  for (auto &stmt : stmts) {
+    if (stmt != nullptr) resolve(*stmt);
+  }
+}
+
+// Methods take `esse` in slot 0.
+void Resolver::function(ast::Function &function) {
+  function.captures.clear();
+
+  functions_.push_back({.function = &function});
+  beginScope();
+
+  if (function.kind != ast::Function::Kind::FUNCTION) declare(kEsse);
+  for (const auto &param : function.params) declare(param);
+
+  resolve(function.body);
+
+  functions_.pop_back();
+}
+
+void Resolver::beginScope() { functions_.back().depth++; }
+
+void Resolver::endScope() {
+  FunctionScope &scope = functions_.back();
+  scope.depth--;
+
+  while (!scope.locals.empty() && scope.locals.back().depth > scope.depth) {
+    scope.locals.pop_back();
+  }
+}
+
+// A global with the name of a constant would replace it.
+int Resolver::declare(const token::Token &name) {
+  const int slot = declare(name.lexeme.value());
+
+  if (slot < 0 && constants_.contains(name.lexeme.value())) {
+    error_state_.error(name, "Already a constant named '" +
+                                 name.lexeme.value() + "'.");
+  }
+
+  return slot;
+}
+
+// Returns the slot of the new local, or -1 for a global. The local refers to
+// `name`, which must outlive it.
+int Resolver::declare(const std::string &name) {
+  FunctionScope &scope = functions_.back();
+
+  if (scope.function == nullptr && scope.depth == 0) return -1;
+
+  const int slot = static_cast<int>(scope.locals.size());
+  scope.locals.push_back({.name = &name, .depth = scope.depth});
+
+  if (scope.function != nullptr) {
+    scope.function->frame_size = std::max(scope.function->frame_size, slot + 1);
+  }
+
+  return slot;
+}
+
+// Marks the variable `var` just declared as a constant, with the literal its
+// initializer folded to, if it did.
+void Resolver::freeze(const ast::Var &var) {
+  std::optional<ast::Literal> value;
+
+  if (const auto *literal =
+          std::get_if<ast::Literal>(&var.initializer.value()->var)) {
+    value = *literal;
+  }
+
+  if (var.slot >= 0) {
+    Local &local = functions_.back().locals.back();
+    local.constant = true;
+    local.value = std::move(value);
+    return;
+  }
+
+  constants_.try_emplace(var.name.lexeme.value(),
+                         Constant{.order = constants_.size(),
+                                  .value = std::move(value)});
+}
+
+void Resolver::assign(const token::Token &name) {
+  if (constant(name.lexeme.value()) != nullptr &&
+      !reduced_constants_.contains(name.lexeme.value())) {
+    error_state_.error(name, "Cannot assign the constant '" +
+                                 name.lexeme.value() + "'.");
+  }
+}
+
+// The value of the constant `name` refers to, or null if it refers to a
+// variable. Like `bind()`, it looks in the innermost function first.
+const std::optional<ast::Literal> *Resolver::constant(
+    const std::string &name) const {
+  for (auto scope = functions_.rbegin(); scope != functions_.rend(); scope++) {
+    if (const int slot = find(*scope, name); slot >= 0) {
+      const Local &local = scope->locals[slot];
+      return local.constant ? &local.value : nullptr;
+    }
+  }
+
+  const auto it = constants_.find(name);
+
+  if (it == constants_.end() || it->second.order >= visible_constants_) {
+    return nullptr;
+  }
+
+  return &it->second.value;
+}
+
+ast::Binding Resolver::bind(const token::Token &name) {
+  return bind(name.lexeme.value());
+}
+
+ast::Binding Resolver::bind(const std::string &identifier) {
+  if (const int slot = find(functions_.back(), identifier); slot >= 0) {
+    return {.kind = ast::Binding::Kind::LOCAL, .index = slot};
+  }
+
+  if (const int index = capture(functions_.size() - 1, identifier);
+      index >= 0) {
+    return {.kind = ast::Binding::Kind::CAPTURED, .index = index};
+  }
+
+  return {};
+}
+
+// The slot of the innermost local named `name`, if any.
+int Resolver::find(const FunctionScope &scope, const std::string &name) {
+  for (int slot = static_cast<int>(scope.locals.size()) - 1; slot >= 0;
+       slot--) {
+    if (*scope.locals[slot].name == name) return slot;
+  }
+
+  return -1;
+}
+
+// Returns the index of `name` among the captures of `functions_[function]`,
+// adding it (and capturing it in the functions in between) if it is a local
+// of an enclosing function, or -1 if it is not.
+int Resolver::capture(std::size_t function, const std::string &name) {
+  if (function == 0) return -1;
+
+  ast::Capture capture{.local = true,
+                       .index = find(functions_[function - 1], name)};
+
+  if (capture.index < 0) {
+    capture = {.local = false, .index = this->capture(function - 1, name)};
+    if (capture.index < 0) return -1;
+  }
+
+  auto &captures = functions_[function].function->captures;
+
+  for (std::size_t i = 0; i < captures.size(); i++) {
+    if (captures[i].local == capture.local &&
+        captures[i].index == capture.index) {
+      return static_cast<int>(i);
+    }
+  }
+
+  captures.push_back(capture);
+
+  return static_cast<int>(captures.size() - 1);
+}
@@ -0,0 +1,114 @@
+#include "lusoscript/scheduler.hh"
+
+#include <sysexits.h>
+
+#include <optional>
+
+#include "lusoscript/arena.hh"
+#include "lusoscript/coroutine.hh"
+#include "lusoscript/interpreter.hh"
+#include "lusoscript/lexer.hh"
+#include "lusoscript/parser.hh"
+#include "lusoscript/state.hh"
+
+namespace {
+// Initial arena block of a script. Scripts are expected to be small and many,
+// so the arena starts small and grows when needed.
+constexpr std::size_t kScriptArenaSize = 64 * 1024;
+}  // namespace
+
+// Everything a script needs across its time slices. Lexing and parsing happen
+// in the first slice, on a worker thread.
+struct Scheduler::Script {
+  state::AppState app_state;
+  std::vector<token::Token> tokens;
+  arena::Arena allocator{kScriptArenaSize};
+  std::optional<Parser> parser;
+  std::vector<ast::Stmt> statements;
+  std::optional<Interpreter> interpreter;
+  std::optional<coro::Task<error::RuntimeResult<>>> task;
+  coro::Slice slice;
+  int exit_code = EXIT_SUCCESS;
+};
+
+Scheduler::Scheduler(int threads, int slice) : slice_(slice), pool_(threads) {}
+
+Scheduler::~Scheduler() = default;
+
+void Scheduler::add(std::string source, std::ostream &output,
+                    std::ostream &error_output) {
+  auto script = std::make_unique<Script>();
+  script->app_state = {.mode = state::RunningMode::SourceFile,
+                       .source = std::move(source),
+                       .error = error::ErrorState{&error_output},
+                       .output = &output};
+
+  scripts_.push_back(std::move(script));
+}
+
+std::vector<int> Scheduler::run() {
+  for (auto &script : scripts_) {
+    pool_.submit([this, &script = *script] { step(script); });
+  }
+
+  pool_.wait();
+
+  std::vector<int> exit_codes;
+  exit_codes.reserve(scripts_.size());
+
+  for (const auto &script : scripts_) {
+    exit_codes.push_back(script->exit_code);
+  }
+
+  scripts_.clear();
+
+  return exit_codes;
+}
+
+// Runs one time slice of `script`, and queues it again unless it finished.
+void Scheduler::step(Script &script) {
+  state::AppState &app_state = script.app_state;
+
+  if (!script.task.has_value()) {
+    Lexer lexer(app_state.source, app_state.error);
+    script.tokens = lexer.scanTokens();
+
+    script.parser.emplace(&script.allocator, app_state.error, script.tokens,
+                          true);
+    script.statements = script.parser->parse();
+
+    if (app_state.error.getHadError()) {
+      app_state.error.summary(*app_state.output);
+      script.exit_code = EX_DATAERR;
+      return;
+    }
+
+    script.interpreter.emplace(app_state.error, app_state.mode,
+                               *app_state.output);
+    script.task.emplace(script.interpreter->interpretResumable(
+        script.statements, script.slice));
+  }
+
+  script.slice.refill(slice_);
+
+  const std::coroutine_handle<> resume_point = script.slice.takeResumePoint();
+  if (resume_point) {
+    resume_point.resume();
+  } else {
+    script.task->handle().resume();
+  }
+
+  if (!script.task->done()) {
+    pool_.submit([this, &script] { step(script); });
+    return;
+  }
+
+  if (!script.task->result()) script.exit_code = EX_SOFTWARE;
+
+  // Frees the script's memory as soon as it is done.
+  script.task.reset();
+  script.interpreter.reset();
+  script.parser.reset();
+  script.statements.clear();
+  script.allocator.reset();
+}
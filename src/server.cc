@@ -0,0 +1,285 @@
+#include "lusoscript/server.hh"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sysexits.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <optional>
+
+#include "lusoscript/arena.hh"
+#include "lusoscript/source_file.hh"
+#include "lusoscript/thread_pool.hh"
+
+namespace {
+// Same size as the arena of `Driver::process()`.
+constexpr std::size_t kArenaSize = 1024 * 1024 * 4;
+
+// Time a request may take to arrive once it started to, before the connection
+// is dropped.
+constexpr timeval kReadTimeout = {.tv_sec = 5, .tv_usec = 0};
+
+std::optional<sockaddr_un> socketAddress(const std::string &path) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+
+  if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+    return std::nullopt;
+  }
+
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+  return address;
+}
+}  // namespace
+
+Server::Server(std::string socket_path, int threads)
+    : socket_path_(std::move(socket_path)),
+      threads_(threads),
+      listener_(-1),
+      wake_{-1, -1},
+      stopping_(false),
+      request_latency_("request"),
+      script_latency_("script") {}
+
+int Server::run() {
+  const auto address = socketAddress(socket_path_);
+
+  if (!address.has_value()) {
+    std::cerr << "Invalid socket path '" << socket_path_ << "'." << std::endl;
+    return EX_USAGE;
+  }
+
+  // Replaces the socket of a previous server, but nothing else.
+  struct stat status;
+  if (::lstat(socket_path_.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+    ::unlink(socket_path_.c_str());
+  }
+
+  listener_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if (listener_ < 0 ||
+      ::bind(listener_, reinterpret_cast<const sockaddr *>(&address.value()),
+             sizeof(sockaddr_un)) != 0 ||
+      ::listen(listener_, SOMAXCONN) != 0 || ::pipe(wake_) != 0 ||
+      ::fcntl(wake_[0], F_SETFL, O_NONBLOCK) != 0 ||
+      ::fcntl(wake_[1], F_SETFL, O_NONBLOCK) != 0) {
+    std::cerr << "Cannot listen on '" << socket_path_
+              << "': " << std::strerror(errno) << "." << std::endl;
+    if (listener_ >= 0) ::close(listener_);
+    return EX_OSERR;
+  }
+
+  // The connections waiting for a request.
+  std::vector<int> idle;
+
+  {
+    ThreadPool pool(threads_);
+    std::vector<pollfd> polled;
+
+    while (!stopping_.load()) {
+      polled.clear();
+      polled.push_back({.fd = listener_, .events = POLLIN, .revents = 0});
+      polled.push_back({.fd = wake_[0], .events = POLLIN, .revents = 0});
+
+      for (const int connection : idle) {
+        polled.push_back({.fd = connection, .events = POLLIN, .revents = 0});
+      }
+
+      if (::poll(polled.data(), polled.size(), -1) < 0) {
+        if (errno == EINTR) continue;
+        break;
+      }
+
+      // Connections with a request, or closed, go to the pool, which reads
+      // the request or finds the end of the input.
+      for (std::size_t i = 2; i < polled.size(); i++) {
+        if (polled[i].revents == 0) continue;
+
+        const int connection = polled[i].fd;
+        idle.erase(std::find(idle.begin(), idle.end(), connection));
+        pool.submit([this, connection] { serve(connection); });
+      }
+
+      if (polled[1].revents != 0) {
+        char bytes[64];
+        while (::read(wake_[0], bytes, sizeof(bytes)) == sizeof(bytes)) {
+        }
+
+        const std::lock_guard lock(mutex_);
+        idle.insert(idle.end(), served_.begin(), served_.end());
+        served_.clear();
+      }
+
+      if (polled[0].revents != 0) {
+        const int connection = ::accept(listener_, nullptr, nullptr);
+
+        if (connection < 0) {
+          if (errno == EINTR || errno == ECONNABORTED) continue;
+          break;
+        }
+
+        ::setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &kReadTimeout,
+                     sizeof(kReadTimeout));
+        idle.push_back(connection);
+      }
+    }
+
+    // Lets the requests being served finish.
+    pool.wait();
+  }
+
+  for (const int connection : idle) ::close(connection);
+  for (const int connection : served_) ::close(connection);
+
+  ::close(wake_[0]);
+  ::close(wake_[1]);
+  ::close(listener_);
+  ::unlink(socket_path_.c_str());
+
+  std::cerr << report();
+
+  return EXIT_SUCCESS;
+}
+
+void Server::serve(int connection) {
+  // Each worker thread keeps its arena warm across requests.
+  thread_local arena::Arena allocator(kArenaSize);
+
+  frame::Frame request;
+
+  if (frame::read(connection, request)) {
+    const auto start = std::chrono::steady_clock::now();
+
+    if (request.type == frame::Type::RUN) {
+      int exit_code;
+
+      {
+        frame::Writer output(connection, frame::Type::OUTPUT);
+        frame::Writer error_output(connection, frame::Type::ERROR_OUTPUT);
+
+        const auto script_start = std::chrono::steady_clock::now();
+
+        SourceFile source_file;
+        exit_code = source_file.runSource(std::move(request.payload), output,
+                                          error_output, &allocator);
+        allocator.reset();
+
+        script_latency_.record(std::chrono::steady_clock::now() -
+                               script_start);
+      }
+
+      if (frame::writeExit(connection, exit_code)) {
+        request_latency_.record(std::chrono::steady_clock::now() - start);
+        giveBack(connection);
+        return;
+      }
+    } else if (request.type == frame::Type::STATS) {
+      if (frame::write(connection, frame::Type::OUTPUT, report()) &&
+          frame::writeExit(connection, EXIT_SUCCESS)) {
+        giveBack(connection);
+        return;
+      }
+    } else if (request.type == frame::Type::STOP) {
+      stopping_.store(true);
+      wake();
+      frame::writeExit(connection, EXIT_SUCCESS);
+    } else {
+      frame::write(connection, frame::Type::ERROR_OUTPUT,
+                   "Unknown request.\n");
+      frame::writeExit(connection, EX_PROTOCOL);
+    }
+  }
+
+  ::close(connection);
+}
+
+void Server::giveBack(int connection) {
+  {
+    const std::lock_guard lock(mutex_);
+    served_.push_back(connection);
+  }
+
+  wake();
+}
+
+// Never blocks, since the pipe does not: when it is full, the polling thread
+// is bound to wake up anyway.
+void Server::wake() {
+  const char byte = 0;
+  [[maybe_unused]] const auto written = ::write(wake_[1], &byte, 1);
+}
+
+std::string Server::report() const {
+  return request_latency_.report() + script_latency_.report();
+}
+
+Client::Client(std::string socket_path)
+    : socket_path_(std::move(socket_path)) {}
+
+int Client::run(const std::string &file_path) {
+  SourceFile source_file;
+
+  const auto source = source_file.read(file_path, std::cerr);
+  if (!source.has_value()) return EXIT_FAILURE;
+
+  return request(frame::Type::RUN, source.value());
+}
+
+int Client::stats() { return request(frame::Type::STATS, ""); }
+
+int Client::stop() { return request(frame::Type::STOP, ""); }
+
+int Client::request(frame::Type type, std::string_view payload) {
+  const auto address = socketAddress(socket_path_);
+
+  if (!address.has_value()) {
+    std::cerr << "Invalid socket path '" << socket_path_ << "'." << std::endl;
+    return EX_USAGE;
+  }
+
+  const int connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if (connection < 0 ||
+      ::connect(connection,
+                reinterpret_cast<const sockaddr *>(&address.value()),
+                sizeof(sockaddr_un)) != 0) {
+    std::cerr << "Cannot connect to '" << socket_path_
+              << "': " << std::strerror(errno) << "." << std::endl;
+    if (connection >= 0) ::close(connection);
+    return EX_UNAVAILABLE;
+  }
+
+  std::optional<int> exit_code;
+  frame::Frame response;
+
+  if (frame::write(connection, type, payload)) {
+    while (frame::read(connection, response)) {
+      if (response.type == frame::Type::OUTPUT) {
+        std::cout << response.payload << std::flush;
+      } else if (response.type == frame::Type::ERROR_OUTPUT) {
+        std::cerr << response.payload << std::flush;
+      } else if (response.type == frame::Type::EXIT) {
+        exit_code = frame::exitCode(response);
+        break;
+      }
+    }
+  }
+
+  ::close(connection);
+
+  if (!exit_code.has_value()) {
+    std::cerr << "The server closed the connection." << std::endl;
+    return EX_PROTOCOL;
+  }
+
+  return exit_code.value();
+}
@@ -0,0 +1,385 @@
+#include "lusoscript/simd.hh"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+#if defined(__SSE2__)
+// Applies `vector` to blocks of four numbers and `scalar` to the rest.
+template <typename Vector, typename Scalar>
+void arithmetic(const float *a, const float *b, float *out, std::size_t n,
+                Vector vector, Scalar scalar) {
+  std::size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    _mm_storeu_ps(out + i, vector(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+  }
+
+  for (; i < n; i++) out[i] = scalar(a[i], b[i]);
+}
+
+// Compares blocks of sixteen numbers, packing the lane masks of four vector
+// comparisons into sixteen bytes.
+template <typename Vector, typename Scalar>
+void compare(const float *a, const float *b, std::uint8_t *out, std::size_t n,
+             Vector vector, Scalar scalar) {
+  const __m128i ones = _mm_set1_epi8(1);
+  std::size_t i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    __m128i lanes[4];
+
+    for (int j = 0; j < 4; j++) {
+      lanes[j] = _mm_castps_si128(
+          vector(_mm_loadu_ps(a + i + 4 * j), _mm_loadu_ps(b + i + 4 * j)));
+    }
+
+    const __m128i low = _mm_packs_epi32(lanes[0], lanes[1]);
+    const __m128i high = _mm_packs_epi32(lanes[2], lanes[3]);
+    const __m128i bytes = _mm_packs_epi16(low, high);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                     _mm_and_si128(bytes, ones));
+  }
+
+  for (; i < n; i++) out[i] = scalar(a[i], b[i]) ? 1 : 0;
+}
+
+template <typename Vector, typename Scalar>
+void bytes(const std::uint8_t *a, const std::uint8_t *b, std::uint8_t *out,
+           std::size_t n, Vector vector, Scalar scalar) {
+  std::size_t i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), vector(x, y));
+  }
+
+  for (; i < n; i++) out[i] = scalar(a[i], b[i]);
+}
+
+// Folds blocks of four numbers of `a` and `b` into the lanes of an
+// accumulator, starting from `lanes`, and leaves the result in `lanes`.
+// Returns the index of the first number left over.
+template <typename Vector, typename Scalar>
+std::size_t fold(const float *a, const float *b, std::size_t n, float *lanes,
+                 Vector vector, Scalar) {
+  __m128 accumulator = _mm_loadu_ps(lanes);
+  std::size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    accumulator =
+        vector(accumulator, _mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+  }
+
+  _mm_storeu_ps(lanes, accumulator);
+
+  return i;
+}
+#else
+template <typename Vector, typename Scalar>
+std::size_t fold(const float *a, const float *b, std::size_t n, float *lanes,
+                 Vector, Scalar scalar) {
+  std::size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    for (std::size_t j = 0; j < 4; j++) {
+      lanes[j] = scalar(lanes[j], a[i + j], b[i + j]);
+    }
+  }
+
+  return i;
+}
+
+template <typename Vector, typename Scalar>
+void arithmetic(const float *a, const float *b, float *out, std::size_t n,
+                Vector, Scalar scalar) {
+  for (std::size_t i = 0; i < n; i++) out[i] = scalar(a[i], b[i]);
+}
+
+template <typename Vector, typename Scalar>
+void compare(const float *a, const float *b, std::uint8_t *out, std::size_t n,
+             Vector, Scalar scalar) {
+  for (std::size_t i = 0; i < n; i++) out[i] = scalar(a[i], b[i]) ? 1 : 0;
+}
+
+template <typename Vector, typename Scalar>
+void bytes(const std::uint8_t *a, const std::uint8_t *b, std::uint8_t *out,
+           std::size_t n, Vector, Scalar scalar) {
+  for (std::size_t i = 0; i < n; i++) out[i] = scalar(a[i], b[i]);
+}
+#endif
+}  // namespace
+
+// Without SSE2, the vector operations are never called; they only need to be
+// well-formed.
+#if defined(__SSE2__)
+#define LUSOSCRIPT_VECTOR(expression) \
+  [](auto x, [[maybe_unused]] auto y) { return expression; }
+#define LUSOSCRIPT_FOLD(expression) \
+  [](__m128 acc, __m128 x, [[maybe_unused]] __m128 y) { return expression; }
+#else
+#define LUSOSCRIPT_VECTOR(expression) nullptr
+#define LUSOSCRIPT_FOLD(expression) nullptr
+#endif
+
+void simd::add(const float *a, const float *b, float *out, std::size_t n) {
+  arithmetic(a, b, out, n, LUSOSCRIPT_VECTOR(_mm_add_ps(x, y)),
+             [](float x, float y) { return x + y; });
+}
+
+void simd::subtract(const float *a, const float *b, float *out,
+                    std::size_t n) {
+  arithmetic(a, b, out, n, LUSOSCRIPT_VECTOR(_mm_sub_ps(x, y)),
+             [](float x, float y) { return x - y; });
+}
+
+void simd::multiply(const float *a, const float *b, float *out,
+                    std::size_t n) {
+  arithmetic(a, b, out, n, LUSOSCRIPT_VECTOR(_mm_mul_ps(x, y)),
+             [](float x, float y) { return x * y; });
+}
+
+void simd::divide(const float *a, const float *b, float *out, std::size_t n) {
+  arithmetic(a, b, out, n, LUSOSCRIPT_VECTOR(_mm_div_ps(x, y)),
+             [](float x, float y) { return x / y; });
+}
+
+void simd::negate(const float *a, float *out, std::size_t n) {
+  // Subtracting from zero would turn 0 into 0 rather than -0.
+  for (std::size_t i = 0; i < n; i++) out[i] = -a[i];
+}
+
+void simd::greater(const float *a, const float *b, std::uint8_t *out,
+                   std::size_t n) {
+  compare(a, b, out, n, LUSOSCRIPT_VECTOR(_mm_cmpgt_ps(x, y)),
+          [](float x, float y) { return x > y; });
+}
+
+void simd::greaterEqual(const float *a, const float *b, std::uint8_t *out,
+                        std::size_t n) {
+  compare(a, b, out, n, LUSOSCRIPT_VECTOR(_mm_cmpge_ps(x, y)),
+          [](float x, float y) { return x >= y; });
+}
+
+void simd::equal(const float *a, const float *b, std::uint8_t *out,
+                 std::size_t n) {
+  compare(a, b, out, n, LUSOSCRIPT_VECTOR(_mm_cmpeq_ps(x, y)),
+          [](float x, float y) { return x == y; });
+}
+
+void simd::notEqual(const float *a, const float *b, std::uint8_t *out,
+                    std::size_t n) {
+  compare(a, b, out, n, LUSOSCRIPT_VECTOR(_mm_cmpneq_ps(x, y)),
+          [](float x, float y) { return x != y; });
+}
+
+void simd::equal(const std::uint8_t *a, const std::uint8_t *b,
+                 std::uint8_t *out, std::size_t n) {
+  bytes(a, b, out, n,
+        LUSOSCRIPT_VECTOR(_mm_and_si128(_mm_cmpeq_epi8(x, y),
+                                        _mm_set1_epi8(1))),
+        [](std::uint8_t x, std::uint8_t y) -> std::uint8_t { return x == y; });
+}
+
+void simd::notEqual(const std::uint8_t *a, const std::uint8_t *b,
+                    std::uint8_t *out, std::size_t n) {
+  bytes(a, b, out, n, LUSOSCRIPT_VECTOR(_mm_xor_si128(x, y)),
+        [](std::uint8_t x, std::uint8_t y) -> std::uint8_t { return x ^ y; });
+}
+
+void simd::logicalAnd(const std::uint8_t *a, const std::uint8_t *b,
+                      std::uint8_t *out, std::size_t n) {
+  bytes(a, b, out, n, LUSOSCRIPT_VECTOR(_mm_and_si128(x, y)),
+        [](std::uint8_t x, std::uint8_t y) -> std::uint8_t { return x & y; });
+}
+
+void simd::logicalOr(const std::uint8_t *a, const std::uint8_t *b,
+                     std::uint8_t *out, std::size_t n) {
+  bytes(a, b, out, n, LUSOSCRIPT_VECTOR(_mm_or_si128(x, y)),
+        [](std::uint8_t x, std::uint8_t y) -> std::uint8_t { return x | y; });
+}
+
+void simd::logicalNot(const std::uint8_t *a, std::uint8_t *out,
+                      std::size_t n) {
+  // XOR with a column of ones.
+  bytes(a, a, out, n,
+        LUSOSCRIPT_VECTOR(_mm_xor_si128(x, _mm_set1_epi8(1))),
+        [](std::uint8_t x, std::uint8_t) -> std::uint8_t { return x ^ 1; });
+}
+
+void simd::select(const std::uint8_t *mask, const float *a, const float *b,
+                  float *out, std::size_t n) {
+  std::size_t i = 0;
+
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+
+  for (; i + 4 <= n; i += 4) {
+    // Widens four mask bytes to four lane masks.
+    std::int32_t packed;
+    std::memcpy(&packed, mask + i, sizeof(packed));
+
+    __m128i lanes = _mm_cvtsi32_si128(packed);
+    lanes = _mm_unpacklo_epi8(lanes, zero);
+    lanes = _mm_unpacklo_epi16(lanes, zero);
+
+    const __m128 selected = _mm_castsi128_ps(_mm_cmpgt_epi32(lanes, zero));
+    const __m128 result =
+        _mm_or_ps(_mm_and_ps(selected, _mm_loadu_ps(a + i)),
+                  _mm_andnot_ps(selected, _mm_loadu_ps(b + i)));
+
+    _mm_storeu_ps(out + i, result);
+  }
+#endif
+
+  for (; i < n; i++) out[i] = mask[i] ? a[i] : b[i];
+}
+
+void simd::select(const std::uint8_t *mask, const std::uint8_t *a,
+                  const std::uint8_t *b, std::uint8_t *out, std::size_t n) {
+  std::size_t i = 0;
+
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+
+  for (; i + 16 <= n; i += 16) {
+    const auto load = [](const std::uint8_t *p) {
+      return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    };
+
+    const __m128i selected = _mm_cmpgt_epi8(load(mask + i), zero);
+    const __m128i result =
+        _mm_or_si128(_mm_and_si128(selected, load(a + i)),
+                     _mm_andnot_si128(selected, load(b + i)));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), result);
+  }
+#endif
+
+  for (; i < n; i++) out[i] = mask[i] ? a[i] : b[i];
+}
+
+std::size_t simd::findZero(const float *a, std::size_t n) {
+  std::size_t i = 0;
+
+#if defined(__SSE2__)
+  const __m128 zero = _mm_setzero_ps();
+
+  for (; i + 4 <= n; i += 4) {
+    if (_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(a + i), zero)) != 0) break;
+  }
+#endif
+
+  for (; i < n; i++) {
+    if (a[i] == 0.f) return i;
+  }
+
+  return n;
+}
+
+void simd::fill(float *out, float value, std::size_t n) {
+  std::size_t i = 0;
+
+#if defined(__SSE2__)
+  const __m128 values = _mm_set1_ps(value);
+  for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, values);
+#endif
+
+  for (; i < n; i++) out[i] = value;
+}
+
+// The lanes are added pairwise, then the numbers left over in order.
+float simd::sum(const float *a, std::size_t n) {
+  float lanes[4] = {0.f, 0.f, 0.f, 0.f};
+
+  std::size_t i =
+      fold(a, a, n, lanes, LUSOSCRIPT_FOLD(_mm_add_ps(acc, x)),
+           [](float acc, float x, float) { return acc + x; });
+
+  float total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  for (; i < n; i++) total += a[i];
+
+  return total;
+}
+
+float simd::dot(const float *a, const float *b, std::size_t n) {
+  float lanes[4] = {0.f, 0.f, 0.f, 0.f};
+
+  std::size_t i =
+      fold(a, b, n, lanes, LUSOSCRIPT_FOLD(_mm_add_ps(acc, _mm_mul_ps(x, y))),
+           [](float acc, float x, float y) { return acc + x * y; });
+
+  float total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  for (; i < n; i++) total += a[i] * b[i];
+
+  return total;
+}
+
+// The scalar comparisons pick the same operand as `_mm_min_ps(x, acc)` and
+// `_mm_max_ps(x, acc)`, which return `acc` when either is NaN.
+float simd::minimum(const float *a, std::size_t n) {
+  float lanes[4] = {a[0], a[0], a[0], a[0]};
+
+  std::size_t i =
+      fold(a, a, n, lanes, LUSOSCRIPT_FOLD(_mm_min_ps(x, acc)),
+           [](float acc, float x, float) { return x < acc ? x : acc; });
+
+  float result = lanes[0];
+  for (int j = 1; j < 4; j++) result = lanes[j] < result ? lanes[j] : result;
+  for (; i < n; i++) result = a[i] < result ? a[i] : result;
+
+  return result;
+}
+
+float simd::maximum(const float *a, std::size_t n) {
+  float lanes[4] = {a[0], a[0], a[0], a[0]};
+
+  std::size_t i =
+      fold(a, a, n, lanes, LUSOSCRIPT_FOLD(_mm_max_ps(x, acc)),
+           [](float acc, float x, float) { return x > acc ? x : acc; });
+
+  float result = lanes[0];
+  for (int j = 1; j < 4; j++) result = lanes[j] > result ? lanes[j] : result;
+  for (; i < n; i++) result = a[i] > result ? a[i] : result;
+
+  return result;
+}
+
+std::uint32_t simd::matchBytes(const std::uint8_t *group, std::uint8_t value) {
+#if defined(__SSE2__)
+  const __m128i bytes =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+  const __m128i values = _mm_set1_epi8(static_cast<char>(value));
+
+  return static_cast<std::uint32_t>(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, values)));
+#else
+  std::uint32_t mask = 0;
+
+  for (std::size_t i = 0; i < kGroupSize; i++) {
+    if (group[i] == value) mask |= 1u << i;
+  }
+
+  return mask;
+#endif
+}
+
+std::uint32_t simd::highBits(const std::uint8_t *group) {
+#if defined(__SSE2__)
+  return static_cast<std::uint32_t>(_mm_movemask_epi8(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(group))));
+#else
+  std::uint32_t mask = 0;
+
+  for (std::size_t i = 0; i < kGroupSize; i++) {
+    if ((group[i] & 0x80) != 0) mask |= 1u << i;
+  }
+
+  return mask;
+#endif
+}
@@ -4,50 +4,81 @@
 
 #include <filesystem>
 #include <fstream>
-#include <iostream>
+#include <sstream>
 
 #include "lusoscript/driver.hh"
 #include "lusoscript/state.hh"
 
-void SourceFile::run(std::string file_path) {
-  std::filesystem::path path = file_path;
-
-  if (!std::filesystem::exists(path)) {
-    std::cerr << "File not found " << path << "." << std::endl;
-    exit(EXIT_FAILURE);
-  }
+int SourceFile::run(std::string file_path, std::ostream &output,
+                    std::ostream &error_output) {
+  auto source = read(file_path, error_output);
+  if (!source.has_value()) return EXIT_FAILURE;
 
-  if (!path.has_extension()) {
-    std::cerr << "Invalid file." << std::endl;
-    exit(EXIT_FAILURE);
-  }
+  state::AppState app_state{.mode = state::RunningMode::SourceFile,
+                            .source = std::move(source.value()),
+                            .error = error::ErrorState{&error_output},
+                            .output = &output};
 
-  if (path.extension() != ".luso") {
-    std::cerr << "Invalid LusoScript file." << std::endl;
-    exit(EXIT_FAILURE);
-  }
+  Driver driver;
+  driver.process(&app_state, file_path);
 
-  std::string file_content;
-  {
-    std::stringstream contents_stream;
-    std::fstream file_stream(path, std::ios::in);
-    contents_stream << file_stream.rdbuf();
-    file_content = contents_stream.str();
-  }
+  return exitCode(app_state, output);
+}
 
+int SourceFile::runSource(std::string source, std::ostream &output,
+                          std::ostream &error_output,
+                          arena::Arena *allocator) {
   state::AppState app_state{.mode = state::RunningMode::SourceFile,
-                            .source = std::move(file_content),
-                            .error = error::ErrorState{}};
+                            .source = std::move(source),
+                            .error = error::ErrorState{&error_output},
+                            .output = &output};
 
   Driver driver;
-  driver.process(&app_state);
 
+  if (allocator != nullptr) {
+    driver.process(&app_state, *allocator);
+  } else {
+    driver.process(&app_state);
+  }
+
+  return exitCode(app_state, output);
+}
+
+int SourceFile::exitCode(state::AppState &app_state, std::ostream &output) {
   if (app_state.error.getHadError()) {
-    app_state.error.summary();
-    exit(EX_DATAERR);
+    app_state.error.summary(output);
+    return EX_DATAERR;
   }
 
   if (app_state.error.getHadRuntimeError()) {
-    exit(EX_SOFTWARE);
+    return EX_SOFTWARE;
   }
+
+  return EXIT_SUCCESS;
+}
+
+std::optional<std::string> SourceFile::read(std::string file_path,
+                                            std::ostream &error_output) {
+  std::filesystem::path path = file_path;
+
+  if (!std::filesystem::exists(path)) {
+    error_output << "File not found " << path << "." << std::endl;
+    return std::nullopt;
+  }
+
+  if (!path.has_extension()) {
+    error_output << "Invalid file." << std::endl;
+    return std::nullopt;
+  }
+
+  if (path.extension() != ".luso") {
+    error_output << "Invalid LusoScript file." << std::endl;
+    return std::nullopt;
+  }
+
+  std::stringstream contents_stream;
+  std::fstream file_stream(path, std::ios::in);
+  contents_stream << file_stream.rdbuf();
+
+  return contents_stream.str();
 }
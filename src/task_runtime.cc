@@ -0,0 +1,130 @@
+#include "lusoscript/task_runtime.hh"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+// Jobs queued at most; spawning waits for room past that.
+constexpr std::size_t kQueueCapacity = 1 << 16;
+
+// Runtime whose worker is running on this thread, if any.
+thread_local TaskRuntime *current_runtime = nullptr;
+}  // namespace
+
+TaskRuntime::TaskRuntime(int threads)
+    : queue_(kQueueCapacity),
+      pushes_(0),
+      workers_(0),
+      blocked_(0),
+      stopping_(false) {
+  for (int i = 0; i < threads; i++) addWorker();
+}
+
+TaskRuntime::~TaskRuntime() {
+  stopping_.store(true);
+  pushes_.fetch_add(1);
+  pushes_.notify_all();
+
+  std::lock_guard<std::mutex> lock(threads_mutex_);
+
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+TaskRuntime &TaskRuntime::shared() {
+  static TaskRuntime runtime(
+      static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+  return runtime;
+}
+
+void TaskRuntime::spawn(std::function<void()> job) {
+  while (!queue_.tryPush(job)) {
+    // A worker spawning into a full queue runs jobs itself, in case it is the
+    // only one left to drain it.
+    if (current_runtime != this || !runOne()) std::this_thread::yield();
+  }
+
+  pushes_.fetch_add(1);
+  pushes_.notify_one();
+}
+
+void TaskRuntime::addWorker() {
+  std::lock_guard<std::mutex> lock(threads_mutex_);
+
+  workers_.fetch_add(1);
+  threads_.emplace_back([this] { work(); });
+}
+
+void TaskRuntime::work() {
+  current_runtime = this;
+
+  while (true) {
+    // Read before trying, so that a push in between wakes the wait up.
+    const std::uint32_t pushes = pushes_.load();
+
+    if (stopping_.load()) return;
+    if (runOne()) continue;
+
+    pushes_.wait(pushes);
+  }
+}
+
+bool TaskRuntime::runOne() {
+  std::function<void()> job;
+  if (!queue_.tryPop(job)) return false;
+
+  job();
+
+  return true;
+}
+
+TaskRuntime::BlockingScope::BlockingScope() : runtime_(current_runtime) {
+  if (runtime_ == nullptr) return;
+
+  if (runtime_->blocked_.fetch_add(1) + 1 >= runtime_->workers_.load()) {
+    runtime_->addWorker();
+  }
+}
+
+TaskRuntime::BlockingScope::~BlockingScope() {
+  if (runtime_ != nullptr) runtime_->blocked_.fetch_sub(1);
+}
+
+TaskGroup::TaskGroup(TaskRuntime &runtime)
+    : runtime_(runtime), started_(0), pending_(0) {}
+
+TaskGroup::~TaskGroup() { wait(); }
+
+void TaskGroup::spawn(std::function<error::RuntimeResult<>()> body) {
+  std::size_t index;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    index = started_++;
+    pending_++;
+  }
+
+  runtime_.spawn([this, index, body = std::move(body)] {
+    const auto result = body();
+
+    // Completion is only observed under the mutex, so the group outlives
+    // this job's last use of it.
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!result && (!failed_task_.has_value() || index < failed_task_)) {
+      failed_task_ = index;
+      failure_ = result.error();
+    }
+
+    if (--pending_ == 0) done_.notify_all();
+  });
+}
+
+std::optional<error::RuntimeError> TaskGroup::wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this] { return pending_ == 0; });
+
+  failed_task_.reset();
+  return std::exchange(failure_, std::nullopt);
+}
@@ -0,0 +1,147 @@
+#include "lusoscript/work_stealing_pool.hh"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+
+namespace {
+constexpr std::size_t kNoQueue = std::numeric_limits<std::size_t>::max();
+
+// Queue of the pool worker running on this thread, if any.
+thread_local std::size_t current_queue = kNoQueue;
+}  // namespace
+
+WorkStealingPool::WorkStealingPool(int threads)
+    : queued_(0), stopping_(false) {
+  for (int i = 0; i <= threads; i++) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+
+  threads_.reserve(threads);
+
+  for (int i = 0; i < threads; i++) {
+    threads_.emplace_back([this, i] { work(i); });
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stopping_ = true;
+  }
+
+  wake_.notify_all();
+
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+WorkStealingPool &WorkStealingPool::shared() {
+  static WorkStealingPool pool(
+      static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+  return pool;
+}
+
+void WorkStealingPool::parallelFor(
+    std::size_t count, const std::function<void(std::size_t)> &body) {
+  if (count == 0) return;
+
+  Group group{.body = &body, .remaining = count};
+
+  const std::size_t index =
+      current_queue != kNoQueue ? current_queue : queues_.size() - 1;
+
+  execute({&group, 0, count}, index);
+
+  // Helps with whatever is queued until the group is done. Completion is
+  // only observed under the group's mutex, so the last job has released
+  // `group` by the time it goes out of scope.
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(group.mutex);
+      if (group.remaining == 0) return;
+    }
+
+    if (runOne(index)) continue;
+
+    std::unique_lock<std::mutex> lock(group.mutex);
+    group.done.wait(lock, [&group] { return group.remaining == 0; });
+    return;
+  }
+}
+
+void WorkStealingPool::work(std::size_t index) {
+  current_queue = index;
+
+  while (true) {
+    if (runOne(index)) continue;
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_.wait(lock, [this] { return stopping_ || queued_.load() > 0; });
+
+    if (stopping_) return;
+  }
+}
+
+// Runs the newest job of queue `index`, or else steals the oldest job of
+// another queue. Returns whether a job ran.
+bool WorkStealingPool::runOne(std::size_t index) {
+  std::optional<Job> job;
+
+  {
+    Queue &own = *queues_[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+
+    if (!own.jobs.empty()) {
+      job = own.jobs.back();
+      own.jobs.pop_back();
+    }
+  }
+
+  for (std::size_t i = 1; !job.has_value() && i < queues_.size(); i++) {
+    Queue &victim = *queues_[(index + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+
+    if (!victim.jobs.empty()) {
+      job = victim.jobs.front();
+      victim.jobs.pop_front();
+    }
+  }
+
+  if (!job.has_value()) return false;
+
+  queued_--;
+  execute(job.value(), index);
+
+  return true;
+}
+
+void WorkStealingPool::execute(Job job, std::size_t index) {
+  // Keeps the first half and offers the second one to thieves.
+  while (job.end - job.begin > 1) {
+    const std::size_t middle = job.begin + (job.end - job.begin) / 2;
+    push(index, {job.group, middle, job.end});
+    job.end = middle;
+  }
+
+  (*job.group->body)(job.begin);
+
+  std::lock_guard<std::mutex> lock(job.group->mutex);
+  if (--job.group->remaining == 0) job.group->done.notify_all();
+}
+
+void WorkStealingPool::push(std::size_t index, Job job) {
+  {
+    Queue &queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.jobs.push_back(job);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    queued_++;
+  }
+
+  wake_.notify_one();
+}